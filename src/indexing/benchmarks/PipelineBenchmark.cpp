@@ -0,0 +1,600 @@
+#include "../clustering/Leiden.hpp"
+#include "../data-preprocessing/ChunkArena.hpp"
+#include "../data-preprocessing/DataCleaner.hpp"
+#include "../data-preprocessing/Deduplicator.hpp"
+#include "../data-preprocessing/DomainNormalizer.hpp"
+#include "../data-preprocessing/NegationTagger.hpp"
+#include "../data-preprocessing/VersionResolver.hpp"
+#include "../extraction/DeterministicExtractor.hpp"
+#include "../extraction/Disambiguator.hpp"
+#include "../graph-engine/GraphEngine.hpp"
+#include "../graph-engine/PartitionedGraph.hpp"
+#include "../semantic-indexing/VectorStore.hpp"
+#include "SyntheticCorpus.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @file PipelineBenchmark.cpp
+ * @brief Google Benchmark suite over every C++ stage, fed by
+ * SyntheticCorpus.
+ *
+ * Build and run; JSON output is meant to be kept per commit and diffed:
+ *
+ *   g++ -std=c++17 -O2 -DNDEBUG -pthread PipelineBenchmark.cpp \
+ *       -lbenchmark -o pipeline_bench
+ *   ./pipeline_bench --benchmark_out=bench.json --benchmark_out_format=json
+ *
+ * Every benchmark reports its throughput through the standard counters
+ * (bytes_per_second for text stages, items_per_second for documents and
+ * queries) plus allocs/op and alloc_bytes/op, counted by the global
+ * operator new below. Graph sizes run from 10^3 up to --max_edges
+ * (default 10^6; 10^8 needs roughly 8 GB of RAM).
+ */
+
+// Allocation accounting. Relaxed atomics: a benchmark reads the totals
+// only around its own timing loop.
+static std::atomic<uint64_t> allocCount{0};
+static std::atomic<uint64_t> allocBytes{0};
+
+static void *countedAlloc(size_t size, size_t align) {
+  allocCount.fetch_add(1, std::memory_order_relaxed);
+  allocBytes.fetch_add(size, std::memory_order_relaxed);
+  size = size ? (size + align - 1) / align * align : align;
+  void *p = align > alignof(std::max_align_t) ? std::aligned_alloc(align, size)
+                                               : std::malloc(size);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+// GCC cannot see that every operator new here ends in malloc.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void *operator new(size_t size) { return countedAlloc(size, 1); }
+void *operator new(size_t size, std::align_val_t align) {
+  return countedAlloc(size, size_t(align));
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+// The library's nothrow forms (std::stable_sort's buffer) must come here
+// too, or their blocks reach the free() above from another allocator.
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return countedAlloc(size, 1);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+void *operator new(size_t size, std::align_val_t align,
+                   const std::nothrow_t &) noexcept {
+  try {
+    return countedAlloc(size, size_t(align));
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+void operator delete(void *p, std::align_val_t,
+                     const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+
+/**
+ * @class AllocationScope
+ * @brief Counts allocations made while the scope is alive and reports
+ * them per iteration when it ends.
+ */
+class AllocationScope {
+public:
+  explicit AllocationScope(benchmark::State &state)
+      : state(state), count(allocCount.load()), bytes(allocBytes.load()) {}
+  ~AllocationScope() {
+    state.counters["allocs/op"] = benchmark::Counter(
+        double(allocCount.load() - count), benchmark::Counter::kAvgIterations);
+    state.counters["alloc_bytes/op"] = benchmark::Counter(
+        double(allocBytes.load() - bytes), benchmark::Counter::kAvgIterations);
+  }
+
+private:
+  benchmark::State &state;
+  uint64_t count;
+  uint64_t bytes;
+};
+
+/**
+ * @brief Runs fn(doc) over `docs` round-robin, one document per
+ * iteration, and reports bytes and documents processed.
+ */
+template <typename Fn>
+static void overDocuments(benchmark::State &state,
+                          const std::vector<std::string> &docs, Fn &&fn) {
+  size_t i = 0, bytes = 0;
+  {
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+      const std::string &doc = docs[i];
+      bytes += doc.size();
+      fn(doc);
+      i = (i + 1 == docs.size()) ? 0 : i + 1;
+    }
+  }
+  state.SetBytesProcessed(int64_t(bytes));
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_DataCleanerClean(benchmark::State &state) {
+  SyntheticCorpus corpus(1);
+  auto docs = corpus.many(64, [&](SyntheticCorpus &c) {
+    return c.rfcPage(size_t(state.range(0)));
+  });
+  DataCleaner cleaner;
+  overDocuments(state, docs, [&](const std::string &doc) {
+    benchmark::DoNotOptimize(cleaner.clean(doc));
+  });
+}
+BENCHMARK(BM_DataCleanerClean)->RangeMultiplier(8)->Range(512, 32 << 10);
+
+static void BM_DomainNormalizerNormalize(benchmark::State &state) {
+  SyntheticCorpus corpus(2);
+  auto docs = corpus.many(64, [&](SyntheticCorpus &c) {
+    return c.vendorNote(size_t(state.range(0)));
+  });
+  DomainNormalizer normalizer;
+  overDocuments(state, docs, [&](const std::string &doc) {
+    benchmark::DoNotOptimize(normalizer.normalize(doc));
+  });
+}
+BENCHMARK(BM_DomainNormalizerNormalize)
+    ->RangeMultiplier(8)
+    ->Range(512, 32 << 10);
+
+static void BM_DeterministicExtractorExtract(benchmark::State &state) {
+  SyntheticCorpus corpus(3);
+  auto lines =
+      corpus.many(4096, [](SyntheticCorpus &c) { return c.syslogLine(); });
+  DeterministicExtractor extractor;
+  overDocuments(state, lines, [&](const std::string &line) {
+    benchmark::DoNotOptimize(extractor.extract(line));
+  });
+}
+BENCHMARK(BM_DeterministicExtractorExtract);
+
+static void BM_DeterministicExtractorSpans(benchmark::State &state) {
+  SyntheticCorpus corpus(3);
+  auto lines =
+      corpus.many(4096, [](SyntheticCorpus &c) { return c.syslogLine(); });
+  DeterministicExtractor extractor;
+  std::vector<EntitySpan> spans;
+  overDocuments(state, lines, [&](const std::string &line) {
+    spans.clear();
+    extractor.extractSpans(line, spans);
+    benchmark::DoNotOptimize(spans.data());
+  });
+}
+BENCHMARK(BM_DeterministicExtractorSpans);
+
+static void BM_DeduplicatorGenerateSignature(benchmark::State &state) {
+  SyntheticCorpus corpus(4);
+  auto docs = corpus.many(64, [&](SyntheticCorpus &c) {
+    return c.rfcPage(size_t(state.range(0)));
+  });
+  Deduplicator dedup;
+  overDocuments(state, docs, [&](const std::string &doc) {
+    benchmark::DoNotOptimize(dedup.generateSignature(doc));
+  });
+}
+BENCHMARK(BM_DeduplicatorGenerateSignature)
+    ->RangeMultiplier(8)
+    ->Range(512, 32 << 10);
+
+/**
+ * @brief Queries an index of range(0) chunks; a quarter of the queries
+ * are near-duplicates of an indexed chunk, the rest are fresh text.
+ */
+static void BM_DeduplicatorFindCandidates(benchmark::State &state) {
+  SyntheticCorpus corpus(5);
+  const size_t indexed = size_t(state.range(0));
+  auto docs =
+      corpus.many(indexed, [](SyntheticCorpus &c) { return c.rfcPage(1024); });
+  Deduplicator dedup;
+  for (size_t d = 0; d < docs.size(); ++d)
+    dedup.indexDocument(int(d), dedup.generateSignature(docs[d]));
+  std::vector<std::vector<uint64_t>> queries;
+  for (size_t q = 0; q < 256; ++q)
+    queries.push_back(dedup.generateSignature(
+        q % 4 == 0 ? corpus.nearDuplicate(docs[corpus.next() % indexed], 0.05)
+                   : corpus.rfcPage(1024)));
+  size_t q = 0, candidates = 0;
+  {
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+      candidates += dedup.findCandidates(queries[q]).size();
+      q = (q + 1) % queries.size();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["candidates/query"] = benchmark::Counter(
+      double(candidates), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_DeduplicatorFindCandidates)
+    ->RangeMultiplier(10)
+    ->Range(100, 10000);
+
+static void BM_DisambiguatorResolve(benchmark::State &state) {
+  SyntheticCorpus corpus(6);
+  static const char *terms[] = {"session", "Interface", "reset", "peer"};
+  std::vector<std::pair<std::string, std::string>> queries;
+  for (size_t q = 0; q < 1024; ++q)
+    queries.emplace_back(terms[q % 4],
+                         corpus.contextWindow(size_t(state.range(0))));
+  Disambiguator disambiguator;
+  size_t q = 0;
+  {
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(
+          disambiguator.resolve(queries[q].first, queries[q].second));
+      q = (q + 1) % queries.size();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DisambiguatorResolve)->Arg(8)->Arg(32)->Arg(128);
+
+/**
+ * @brief Runs one chunk per iteration through heap(chunk), or through
+ * inArena(chunk, arena) with a ChunkArena reset before every chunk. The
+ * chunks mix an RFC page, a vendor note, syslog and ambiguous terms.
+ */
+template <typename Heap, typename InArena>
+static void overChunks(benchmark::State &state, bool useArena,
+                       const Heap &heap, const InArena &inArena) {
+  static const std::vector<std::string> chunks = [] {
+    SyntheticCorpus corpus(9);
+    return corpus.many(64, [](SyntheticCorpus &c) {
+      std::string chunk = c.rfcPage(2048) + c.vendorNote(512);
+      for (int line = 0; line < 4; ++line)
+        chunk += c.syslogLine() + "\n";
+      return chunk + "The session was reset on the interface " +
+             c.contextWindow(32) + ". Supported on IOS-XR 7.1.2 and NCS-5500"
+             " only; LEGACY Trident+ linecards are NOT SUPPORTED.";
+    });
+  }();
+  if (!useArena) {
+    overDocuments(state, chunks, heap);
+    return;
+  }
+  ChunkArena arena;
+  overDocuments(state, chunks, [&](const std::string &chunk) {
+    arena.reset();
+    inArena(chunk, arena.resource());
+  });
+}
+
+static void BM_ChunkExtract(benchmark::State &state, bool useArena) {
+  DeterministicExtractor extractor;
+  overChunks(
+      state, useArena,
+      [&](const std::string &c) {
+        benchmark::DoNotOptimize(extractor.extract(c));
+      },
+      [&](const std::string &c, std::pmr::memory_resource *arena) {
+        benchmark::DoNotOptimize(extractor.extract(c, arena));
+      });
+}
+BENCHMARK_CAPTURE(BM_ChunkExtract, heap, false);
+BENCHMARK_CAPTURE(BM_ChunkExtract, arena, true);
+
+static void BM_VersionResolverResolve(benchmark::State &state, bool useArena) {
+  VersionResolver resolver;
+  overChunks(
+      state, useArena,
+      [&](const std::string &c) {
+        benchmark::DoNotOptimize(resolver.resolve(c));
+      },
+      [&](const std::string &c, std::pmr::memory_resource *arena) {
+        benchmark::DoNotOptimize(resolver.resolve(c, arena));
+      });
+}
+BENCHMARK_CAPTURE(BM_VersionResolverResolve, heap, false);
+BENCHMARK_CAPTURE(BM_VersionResolverResolve, arena, true);
+
+static void BM_NegationTaggerScan(benchmark::State &state, bool useArena) {
+  NegationTagger tagger;
+  overChunks(
+      state, useArena,
+      [&](const std::string &c) { benchmark::DoNotOptimize(tagger.scan(c)); },
+      [&](const std::string &c, std::pmr::memory_resource *arena) {
+        benchmark::DoNotOptimize(tagger.scan(c, arena));
+      });
+}
+BENCHMARK_CAPTURE(BM_NegationTaggerScan, heap, false);
+BENCHMARK_CAPTURE(BM_NegationTaggerScan, arena, true);
+
+static void BM_DisambiguatorResolveChunk(benchmark::State &state,
+                                         bool useArena) {
+  Disambiguator disambiguator;
+  overChunks(
+      state, useArena,
+      [&](const std::string &c) {
+        benchmark::DoNotOptimize(disambiguator.resolveChunk(c, 48));
+      },
+      [&](const std::string &c, std::pmr::memory_resource *arena) {
+        benchmark::DoNotOptimize(disambiguator.resolveChunk(c, 48, arena));
+      });
+}
+BENCHMARK_CAPTURE(BM_DisambiguatorResolveChunk, heap, false);
+BENCHMARK_CAPTURE(BM_DisambiguatorResolveChunk, arena, true);
+
+/**
+ * @brief Random causal graph with `edges` edges over edges / 4 nodes,
+ * built once per size. Most edges point "downstream" so paths exist
+ * without the graph being one giant cycle.
+ */
+static const GraphEngine &causalGraph(size_t edges) {
+  static std::unique_ptr<GraphEngine> graph;
+  static size_t builtEdges = 0;
+  if (!graph || builtEdges != edges) {
+    graph.reset(); // Free the previous size before building the next
+    graph = std::make_unique<GraphEngine>();
+    SyntheticCorpus corpus(7);
+    const uint64_t nodes = std::max<uint64_t>(2, edges / 4);
+    for (uint64_t n = 1; n <= nodes; ++n)
+      graph->addNode(n, "EVENT");
+    for (uint64_t e = 1; e <= edges; ++e) {
+      uint64_t a = 1 + corpus.next() % nodes, b = 1 + corpus.next() % nodes;
+      if (a > b && corpus.next() % 16 != 0)
+        std::swap(a, b);
+      graph->addEdge(e, a, b, "CAUSES", 0.9f);
+    }
+    graph->snapshot(); // Freeze outside the timed region
+    builtEdges = edges;
+  }
+  return *graph;
+}
+
+static void BM_GraphEngineFindPath(benchmark::State &state) {
+  const size_t edges = size_t(state.range(0));
+  const GraphEngine &graph = causalGraph(edges);
+  SyntheticCorpus corpus(8);
+  const uint64_t nodes = std::max<size_t>(2, edges / 4);
+  std::vector<std::pair<uint64_t, uint64_t>> pairs;
+  for (size_t p = 0; p < 256; ++p)
+    pairs.push_back({1 + corpus.next() % nodes, 1 + corpus.next() % nodes});
+  size_t p = 0, found = 0;
+  {
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+      found += !graph.findPath(pairs[p].first, pairs[p].second).empty();
+      p = (p + 1) % pairs.size();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["edges"] = double(edges);
+  state.counters["found"] =
+      benchmark::Counter(double(found), benchmark::Counter::kAvgIterations);
+}
+
+static void BM_LeidenRun(benchmark::State &state) {
+  const size_t edges = size_t(state.range(0));
+  auto g = causalGraph(edges).snapshot();
+  const WeightedGraph projection = WeightedGraph::fromEdges(
+      g->nodeCount(), WeightedGraph::structuralEdges(*g));
+  Leiden leiden;
+  size_t communities = 0;
+  for (auto _ : state)
+    communities = leiden.run(projection, 1.0).communities;
+  state.SetItemsProcessed(state.iterations() * int64_t(edges));
+  state.counters["communities"] = double(communities);
+}
+
+/**
+ * @brief 100k nodes in 1000 planted groups of 100 (eight edges inside the
+ * group, one to a random node), its snapshot and a Leiden partition of
+ * it, built once.
+ */
+struct CommunityGraph {
+  static constexpr uint64_t NODES = 100000, GROUP = 100;
+  GraphEngine engine;
+  std::shared_ptr<const CsrGraph> snapshot;
+  std::vector<uint32_t> membership;
+
+  CommunityGraph() {
+    SyntheticCorpus corpus(10);
+    for (uint64_t n = 1; n <= NODES; ++n)
+      engine.addNode(n, "EVENT");
+    uint64_t e = 0;
+    for (uint64_t n = 0; n < NODES; ++n) {
+      const uint64_t group = n / GROUP * GROUP;
+      for (int i = 0; i < 8; ++i)
+        engine.addEdge(++e, n + 1, group + corpus.next() % GROUP + 1, "CAUSES");
+      engine.addEdge(++e, n + 1, corpus.next() % NODES + 1, "PRECEDES");
+    }
+    snapshot = engine.snapshot();
+    membership = Leiden()
+                     .run(WeightedGraph::fromEdges(
+                              snapshot->nodeCount(),
+                              WeightedGraph::structuralEdges(*snapshot)),
+                          5.0)
+                     .membership;
+  }
+
+  static const CommunityGraph &get() {
+    static const CommunityGraph graph;
+    return graph;
+  }
+};
+
+static void BM_PartitionedFindPath(benchmark::State &state, bool byCommunity) {
+  const CommunityGraph &graph = CommunityGraph::get();
+  const size_t shards = size_t(state.range(0));
+  PartitionedGraph partitioned(
+      *graph.snapshot,
+      byCommunity
+          ? PartitionedGraph::assignByCommunity(graph.membership, shards)
+          : PartitionedGraph::assignByHash(*graph.snapshot, shards),
+      byCommunity ? PartitionedGraph::bridgeNodes(*graph.snapshot,
+                                                  graph.membership, 1000)
+                  : std::vector<uint32_t>());
+  SyntheticCorpus corpus(11);
+  std::vector<std::pair<uint64_t, uint64_t>> pairs;
+  for (size_t p = 0; p < 256; ++p)
+    pairs.push_back({1 + corpus.next() % CommunityGraph::NODES,
+                     1 + corpus.next() % CommunityGraph::NODES});
+  size_t p = 0;
+  PartitionedGraph::Stats total;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        partitioned.findPath(pairs[p].first, pairs[p].second));
+    const PartitionedGraph::Stats &s = partitioned.lastStats();
+    total.messages += s.messages;
+    total.pathHops += s.pathHops;
+    total.crossHops += s.crossHops;
+    p = (p + 1) % pairs.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["cross_hop_ratio"] =
+      double(total.crossHops) / double(std::max<uint64_t>(1, total.pathHops));
+  state.counters["messages"] = benchmark::Counter(
+      double(total.messages), benchmark::Counter::kAvgIterations);
+  state.counters["edge_cut"] = double(partitioned.crossShardEdges()) /
+                               double(graph.snapshot->edgeCount());
+}
+BENCHMARK_CAPTURE(BM_PartitionedFindPath, hash, false)
+    ->Arg(4)
+    ->Arg(16)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_PartitionedFindPath, community, true)
+    ->Arg(4)
+    ->Arg(16)
+    ->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief 20k clustered 384-dimension vectors (MiniLM's width) and a
+ * store over them, built once per encoding.
+ */
+struct VectorCorpus {
+  static constexpr size_t ROWS = 20000, DIM = 384, TOPICS = 200;
+  std::vector<float> rows;
+  std::vector<float> queries;
+
+  VectorCorpus() : rows(ROWS * DIM), queries(256 * DIM) {
+    std::mt19937_64 gen(9);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<float> centers(TOPICS * DIM);
+    for (float &c : centers)
+      c = noise(gen);
+    for (size_t r = 0; r < ROWS; ++r)
+      for (size_t d = 0; d < DIM; ++d)
+        rows[r * DIM + d] = centers[(r % TOPICS) * DIM + d] + 0.6f * noise(gen);
+    for (size_t q = 0; q < 256; ++q)
+      for (size_t d = 0; d < DIM; ++d)
+        queries[q * DIM + d] =
+            rows[(q * 77 % ROWS) * DIM + d] + 0.3f * noise(gen);
+  }
+
+  static const VectorCorpus &get() {
+    static const VectorCorpus corpus;
+    return corpus;
+  }
+};
+
+static const VectorStore &vectorStore(VectorEncoding encoding) {
+  static std::unique_ptr<VectorStore> stores[2];
+  auto &store = stores[encoding == VectorEncoding::INT8];
+  if (!store) {
+    const VectorCorpus &corpus = VectorCorpus::get();
+    VectorStore::Options opts;
+    opts.encoding = encoding;
+    store = std::make_unique<VectorStore>(VectorCorpus::DIM, opts);
+    std::vector<uint64_t> ids(VectorCorpus::ROWS);
+    for (size_t i = 0; i < ids.size(); ++i)
+      ids[i] = i + 1;
+    store->add(corpus.rows.data(), ids.size(), ids.data());
+  }
+  return *store;
+}
+
+static void BM_VectorStoreSearch(benchmark::State &state,
+                                 VectorEncoding encoding) {
+  const VectorStore &store = vectorStore(encoding);
+  const VectorCorpus &corpus = VectorCorpus::get();
+  const size_t ef = size_t(state.range(0));
+  size_t q = 0;
+  {
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(
+          store.search(corpus.queries.data() + q * VectorCorpus::DIM, 10, ef));
+      q = (q + 1) % 256;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["vectors"] = double(store.size());
+}
+BENCHMARK_CAPTURE(BM_VectorStoreSearch, int8, VectorEncoding::INT8)
+    ->Arg(16)
+    ->Arg(64)
+    ->Arg(256);
+BENCHMARK_CAPTURE(BM_VectorStoreSearch, float16, VectorEncoding::FLOAT16)
+    ->Arg(16)
+    ->Arg(64)
+    ->Arg(256);
+
+/**
+ * @brief Strips --max_edges=N from argv (Google Benchmark rejects flags
+ * it does not know) and returns N.
+ */
+static size_t takeMaxEdges(int &argc, char **argv) {
+  static const char flag[] = "--max_edges=";
+  size_t maxEdges = 1000000;
+  int kept = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], flag, sizeof(flag) - 1) == 0)
+      maxEdges = std::strtoull(argv[i] + sizeof(flag) - 1, nullptr, 10);
+    else
+      argv[kept++] = argv[i];
+  }
+  argc = kept;
+  return maxEdges;
+}
+
+int main(int argc, char **argv) {
+  size_t maxEdges = takeMaxEdges(argc, argv);
+  auto *findPath = benchmark::RegisterBenchmark("BM_GraphEngineFindPath",
+                                                BM_GraphEngineFindPath);
+  for (size_t edges = 1000; edges <= maxEdges; edges *= 10)
+    findPath->Arg(int64_t(edges));
+  findPath->Unit(benchmark::kMicrosecond);
+  auto *leiden = benchmark::RegisterBenchmark("BM_LeidenRun", BM_LeidenRun);
+  for (size_t edges = 10000; edges <= maxEdges; edges *= 10)
+    leiden->Arg(int64_t(edges));
+  leiden->Unit(benchmark::kMillisecond);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::AddCustomContext("corpus", "SyntheticCorpus, fixed seeds");
+  benchmark::AddCustomContext("max_edges", std::to_string(maxEdges));
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
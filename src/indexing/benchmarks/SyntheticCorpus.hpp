@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @class SyntheticCorpus
+ * @brief Seeded generator of the three text shapes the pipeline ingests:
+ * RFC pages, vendor notes and syslog lines.
+ *
+ * The text is built to hit every rule the stages implement. RFC pages
+ * carry headers, footers and "[Page N]" markers for DataCleaner plus the
+ * acronyms it expands. Vendor notes use the interface aliases, protocol
+ * variants and state words that DomainNormalizer rewrites. Syslog lines
+ * mix every DeterministicExtractor entity with near-misses. The same seed
+ * always gives the same corpus, so runs are comparable over time.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: No data files; any size on demand, from one line to gigabytes.
+ * - CON: The word distribution is uniform over small vocabularies, so it
+ *   is only as realistic as the templates. Absolute numbers on real
+ *   corpora will differ; the suite is meant for tracking regressions.
+ */
+class SyntheticCorpus {
+public:
+  explicit SyntheticCorpus(uint64_t seed = 42) : gen(seed) {}
+
+  /**
+   * @brief One RFC page of about `bytes` bytes: a header line, wrapped
+   * normative prose, and a footer with the page marker.
+   */
+  std::string rfcPage(size_t bytes) {
+    static const char *rfcs[] = {"RFC 4271", "RFC 2328", "RFC 5340",
+                                 "RFC 1191", "RFC 8201"};
+    static const char *months[] = {"January 2006", "April 1998",
+                                   "July 2008", "November 1990"};
+    std::string page = std::string(pick(rfcs)) + "                 " +
+                       pick(PROTOCOLS) + "                 " + pick(months) +
+                       "\n\n";
+    size_t column = 0;
+    while (page.size() < bytes) {
+      std::string sentence = rfcSentence();
+      for (size_t i = 0; i < sentence.size(); ++i) {
+        // Wrap like a plain-text RFC, so whitespace runs are realistic.
+        if (sentence[i] == ' ' && column > 66) {
+          page += "\n   ";
+          column = 3;
+          continue;
+        }
+        page += sentence[i];
+        ++column;
+      }
+      if (gen() % 5 == 0) {
+        page += "\n\n   ";
+        column = 3;
+      } else {
+        page += ' ';
+        ++column;
+      }
+    }
+    page += "\n\nRekhter, et al.             Standards Track"
+            "                 [Page " +
+            std::to_string(++pageNumber) + "]\n";
+    return page;
+  }
+
+  /**
+   * @brief An operator's note of about `bytes` bytes, written with the
+   * short forms vendors and engineers use.
+   */
+  std::string vendorNote(size_t bytes) {
+    static const char *aliases[] = {"Gi", "Te", "Fa", "Eth", "Po", "Lo"};
+    static const char *protocols[] = {"BGP-4", "BGPv4", "OSPFv2", "OSPFv3",
+                                      "Border Gateway Protocol", "IS-IS"};
+    static const char *states[] = {"Established", "Down", "Shut", "Active",
+                                   "Idle", "up"};
+    static const char *verbs[] = {"went", "stayed", "flapped to",
+                                  "was found", "is now"};
+    std::string note;
+    while (note.size() < bytes) {
+      note += "Observed ";
+      note += pick(aliases);
+      note += std::to_string(gen() % 4) + "/" + std::to_string(gen() % 48);
+      note += ' ';
+      note += pick(verbs);
+      note += ' ';
+      note += pick(states);
+      note += " after the ";
+      note += pick(protocols);
+      note += " peer ";
+      note += ipAddress();
+      note += gen() % 2 ? " reset. " : " timed out; see ticket. ";
+    }
+    return note;
+  }
+
+  /**
+   * @brief One syslog line with well-formed entities and near-misses.
+   */
+  std::string syslogLine() {
+    static const char *codes[] = {"%BGP-5-ADJCHANGE", "%LINK-3-UPDOWN",
+                                  "%OSPF-5-ADJCHG", "%LINEPROTO-5-UPDOWN",
+                                  "%SYS-X-Y", "%AS10-2-"};
+    static const char *interfaces[] = {"GigabitEthernet", "TenGigabitEthernet",
+                                       "FastEthernet", "Port-Channel",
+                                       "Loopback", "Ethernet"};
+    static const char *tails[] = {" Down BGP Notification sent",
+                                  " changed state to down", " Up",
+                                  " from FULL to DOWN, Neighbor Down"};
+    std::string line = "Mar " + std::to_string(1 + gen() % 28) + " 10:" +
+                       std::to_string(10 + gen() % 50) + ":0" +
+                       std::to_string(gen() % 10) + " core-rtr-" +
+                       std::to_string(gen() % 64) + " " + pick(codes) + ": ";
+    switch (gen() % 4) {
+    case 0:
+      line += "neighbor " + ipAddress() + " AS" +
+              std::to_string(64512 + gen() % 1000);
+      break;
+    case 1:
+      line += "Interface " + std::string(pick(interfaces)) +
+              std::to_string(gen() % 4) + "/" + std::to_string(gen() % 48);
+      break;
+    case 2:
+      line += "Source MAC: 00:1A:2B:" + std::to_string(10 + gen() % 89) +
+              ":4D:5E on Vlan" + std::to_string(gen() % 4096);
+      break;
+    default:
+      line += "bad peer 256.1.1." + std::to_string(gen() % 300) +
+              " in as4200000000";
+    }
+    return line + pick(tails);
+  }
+
+  /**
+   * @brief A context window around an ambiguous term, drawing keywords
+   * from both senses so resolution has to weigh them.
+   */
+  std::string contextWindow(size_t words) {
+    static const char *vocabulary[] = {
+        "bgp",      "ospf",    "established", "neighbor", "keepalive",
+        "terminal", "ssh",     "login",       "vty",      "gigabit",
+        "optic",    "cable",   "vlan",        "tunnel",   "loopback",
+        "peer",     "fsm",     "reload",      "chassis",  "power",
+        "the",      "after",   "was",         "on",       "router"};
+    std::string window;
+    for (size_t w = 0; w < words; ++w) {
+      window += w ? " " : "";
+      window += pick(vocabulary);
+    }
+    return window;
+  }
+
+  /**
+   * @brief Copy of `text` with about `rate` of its words replaced, for
+   * near-duplicate workloads.
+   */
+  std::string nearDuplicate(const std::string &text, double rate) {
+    std::string out;
+    out.reserve(text.size());
+    std::bernoulli_distribution edit(rate);
+    size_t start = 0;
+    while (start < text.size()) {
+      size_t end = text.find(' ', start);
+      if (end == std::string::npos)
+        end = text.size();
+      if (edit(gen))
+        out += pick(PROTOCOLS);
+      else
+        out.append(text, start, end - start);
+      if (end < text.size())
+        out += ' ';
+      start = end + 1;
+    }
+    return out;
+  }
+
+  template <typename Make>
+  std::vector<std::string> many(size_t count, const Make &make) {
+    std::vector<std::string> docs;
+    docs.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+      docs.push_back(make(*this));
+    return docs;
+  }
+
+  uint64_t next() { return gen(); }
+
+private:
+  static constexpr const char *PROTOCOLS[] = {"BGP", "OSPF", "IS-IS",
+                                              "MPLS", "TCP", "ICMP"};
+
+  std::mt19937_64 gen;
+  size_t pageNumber = 0;
+
+  template <typename T, size_t N> const T &pick(const T (&options)[N]) {
+    return options[gen() % N];
+  }
+
+  std::string ipAddress() {
+    return std::to_string(10 + gen() % 190) + "." +
+           std::to_string(gen() % 256) + "." + std::to_string(gen() % 256) +
+           "." + std::to_string(1 + gen() % 254);
+  }
+
+  std::string rfcSentence() {
+    static const char *subjects[] = {"A BGP speaker", "The router",
+                                     "An OSPF implementation", "The FSM",
+                                     "Each AS border router",
+                                     "The receiving system"};
+    static const char *modals[] = {"MUST", "MUST NOT", "SHOULD", "MAY"};
+    static const char *actions[] = {
+        "send a NOTIFICATION message", "reset the Hold Timer",
+        "update the RIB", "discard the packet",
+        "advertise the route to its peers", "lower the path MTU",
+        "transition to the Idle state", "reply with ICMP Fragmentation Needed"};
+    static const char *conditions[] = {
+        "when the Hold Timer expires", "if the MTU is exceeded",
+        "after the OPEN message is accepted", "unless configured otherwise",
+        "while the adjacency is in ExStart", "for each received UPDATE"};
+    return std::string(pick(subjects)) + " " + pick(modals) + " " +
+           pick(actions) + " " + pick(conditions) + ".";
+  }
+};
@@ -0,0 +1,154 @@
+#include "CommunityDiff.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static double msSince(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - t)
+      .count();
+}
+
+int main(int argc, char **argv) {
+  // Two nights of a graph with 64-node micro communities inside 16 fault
+  // domains. Overnight 1% new nodes arrive and 0.2% of the old ones move
+  // to another micro community, sometimes in another domain.
+  const size_t n =
+      (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10) * 1000000;
+  const size_t domain = n / 16 + 1, micro = 64;
+  std::cout << "--- Community map diff: " << n << " nodes ---" << std::endl;
+  CommunityMap::Levels baseline;
+  baseline.resolutions = {0.1, 5.0};
+  baseline.membership.resize(2);
+  for (size_t v = 0; v < n; ++v) {
+    baseline.nodeIds.push_back(v * 7 + 3);
+    baseline.membership[0].push_back(static_cast<uint32_t>(v / domain));
+    baseline.membership[1].push_back(static_cast<uint32_t>(v / micro));
+  }
+  CommunityMap::Levels current = baseline;
+  std::mt19937_64 gen(3);
+  for (size_t i = 0; i < n / 500; ++i) {
+    const size_t v = gen() % n, like = gen() % n;
+    current.membership[0][v] = baseline.membership[0][like];
+    current.membership[1][v] = baseline.membership[1][like];
+  }
+  for (size_t i = 0; i < n / 100; ++i) {
+    const size_t like = gen() % n;
+    current.nodeIds.push_back((n + i) * 7 + 3);
+    current.membership[0].push_back(baseline.membership[0][like]);
+    current.membership[1].push_back(baseline.membership[1][like]);
+  }
+
+  // community_map.json would be ~60 bytes per node; the binary map is 16.
+  auto t = std::chrono::steady_clock::now();
+  std::string error;
+  const std::string basePath = "community_map_baseline.bin";
+  const std::string currentPath = "community_map.bin";
+  if (!CommunityMap::write(baseline, basePath, &error) ||
+      !CommunityMap::write(current, currentPath, &error)) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  std::printf("Wrote both maps in %.0f ms\n", msSince(t));
+  t = std::chrono::steady_clock::now();
+  auto baseMap = CommunityMap::open(basePath, &error);
+  auto currentMap = CommunityMap::open(currentPath, &error);
+  if (!baseMap || !currentMap) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  std::printf("Mapped %.0f MB in %.2f ms\n",
+              (baseMap->mappedBytes() + currentMap->mappedBytes()) / 1e6,
+              msSince(t));
+
+  CommunityDiff differ;
+  t = std::chrono::steady_clock::now();
+  CommunityDiff::Result drift = differ.diff(
+      CommunityDiff::View::of(*currentMap), CommunityDiff::View::of(*baseMap));
+  std::printf("\nDiff (%s, %zu threads) in %.0f ms: %zu stable, %zu migrated "
+              "(%zu across domains), %zu new, %zu removed | stability index "
+              "%.4f\n",
+              CommunityDiff::kernelName(), differ.options().threads,
+              msSince(t), drift.stable, drift.migrated.size(),
+              drift.macroDrift, drift.added.size(), drift.removed.size(),
+              drift.stabilityIndex());
+
+  // The same nodes in a different order take the join path.
+  CommunityMap::Levels shuffled = current;
+  for (size_t v = shuffled.nodeIds.size() - 1; v > 0; --v) {
+    const size_t w = gen() % (v + 1);
+    std::swap(shuffled.nodeIds[v], shuffled.nodeIds[w]);
+    std::swap(shuffled.membership[0][v], shuffled.membership[0][w]);
+    std::swap(shuffled.membership[1][v], shuffled.membership[1][w]);
+  }
+  t = std::chrono::steady_clock::now();
+  CommunityDiff::Result joined = differ.diff(
+      CommunityDiff::View::of(shuffled), CommunityDiff::View::of(*baseMap));
+  std::printf("Shuffled node order (joined by ID) in %.0f ms: %s counts\n",
+              msSince(t),
+              joined.migrated.size() == drift.migrated.size() &&
+                      joined.added.size() == drift.added.size() &&
+                      joined.macroDrift == drift.macroDrift
+                  ? "same"
+                  : "DIFFERENT");
+
+  // Hand-built Levels without levels view as an empty map.
+  CommunityMap::Levels unleveled;
+  unleveled.nodeIds = baseline.nodeIds;
+  CommunityDiff::Result gone = differ.diff(
+      CommunityDiff::View::of(unleveled), CommunityDiff::View::of(*baseMap));
+  std::printf("Levels without levels: %zu of %zu baseline nodes removed\n",
+              gone.removed.size(), baseline.nodeIds.size());
+  if (gone.removed.size() != baseline.nodeIds.size())
+    return 1;
+
+  t = std::chrono::steady_clock::now();
+  CommunityDiff::Fingerprints before =
+      differ.fingerprint(baseMap->nodeIds(), baseMap->micro());
+  CommunityDiff::Fingerprints after =
+      differ.fingerprint(currentMap->nodeIds(), currentMap->micro());
+  const double signMs = msSince(t);
+  t = std::chrono::steady_clock::now();
+  std::vector<CommunityDiff::Match> matches =
+      CommunityDiff::compare(after, before);
+  size_t identical = 0, similar = 0;
+  for (const CommunityDiff::Match &m : matches) {
+    identical += m.identical;
+    similar += !m.identical && m.similarity >= 0.9;
+  }
+  std::printf("\nFingerprinted 2 x %zu micro communities (%zu lanes) in %.0f "
+              "ms, compared in %.1f ms:\n%zu identical, %zu changed but >= "
+              "90%% similar, %zu to re-summarize\n",
+              after.communities(), after.width, signMs, msSince(t), identical,
+              similar, matches.size() - identical - similar);
+
+  // LeidenEngine.py's JSON converts once.
+  const size_t sample = 1000;
+  std::FILE *json = std::fopen("community_map.json", "w");
+  std::fprintf(json, "{");
+  for (size_t v = 0; v < sample; ++v)
+    std::fprintf(json,
+                 "%s\n    \"%llu\": {\n        \"macro_community\": %u,\n"
+                 "        \"micro_community\": %u\n    }",
+                 v ? "," : "", (unsigned long long)current.nodeIds[v],
+                 current.membership[0][v], current.membership[1][v]);
+  std::fprintf(json, "\n}\n");
+  std::fclose(json);
+  CommunityMap::Levels fromJson;
+  bool same = CommunityMap::readJson("community_map.json", fromJson, &error);
+  for (size_t v = 0; same && v < sample; ++v)
+    same = fromJson.nodeIds[v] == current.nodeIds[v] &&
+           fromJson.membership[1][v] == current.membership[1][v];
+  std::cout << "\ncommunity_map.json sample of " << sample << " nodes: "
+            << (same ? "read back identically" : "MISMATCH " + error)
+            << std::endl;
+  std::remove("community_map.json");
+  std::remove(basePath.c_str());
+  std::remove(currentPath.c_str());
+  return 0;
+}
@@ -0,0 +1,337 @@
+#pragma once
+
+#include "../graph-engine/ArrayRef.hpp"
+#include "../graph-engine/CsrGraph.hpp"
+#include "Leiden.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class CommunityMap
+ * @brief Memory-mappable binary community_map keyed by dense node index.
+ *
+ * FILE LAYOUT (native byte order, every section 64-byte aligned):
+ * - Header: magic, format version, endianness tag, node and level counts
+ *   and a table of (offset, bytes) per Section.
+ * - NODE_IDS: the external node ID of every dense index, in GraphEngine
+ *   snapshot order.
+ * - RESOLUTIONS: one double per level.
+ * - MEMBERSHIP: level-major uint32 community IDs, levelCount x nodeCount.
+ *   Level 0 is the coarsest (macro_community), the last one the finest
+ *   (micro_community), as in Leiden::Hierarchy. NONE marks a node that has
+ *   no community at that level.
+ *
+ * A 50M-node, two-level map is 800 MB instead of several GB of JSON, and
+ * opening it is a header check: CommunityDiff reads the mapped arrays
+ * directly.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: Dense indices are stable across snapshots of one GraphEngine
+ *   (nodes are only appended), so two maps usually line up element by
+ *   element and can be compared as flat arrays.
+ * - CON: Files are readable only with the same byte order and format
+ *   version; readJson() converts LeidenEngine.py output once.
+ * - CON: Like GraphFile, section contents are trusted once the header
+ *   validates.
+ */
+class CommunityMap {
+public:
+  static constexpr char MAGIC[8] = {'R', 'C', 'A', 'C', 'O', 'M', 'M', 'S'};
+  static constexpr uint32_t FORMAT_VERSION = 1;
+  static constexpr uint32_t ENDIAN_TAG = 0x01020304;
+  static constexpr uint64_t ALIGN = 64;
+  static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+  enum Section : uint32_t { NODE_IDS, RESOLUTIONS, MEMBERSHIP, SECTION_COUNT };
+
+  struct SectionEntry {
+    uint64_t offset;
+    uint64_t bytes;
+  };
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianTag;
+    uint64_t nodeCount;
+    uint64_t levelCount;
+    uint64_t fileBytes;
+    SectionEntry sections[SECTION_COUNT];
+  };
+
+  static_assert(std::is_trivially_copyable<Header>::value,
+                "Header is written and mapped as raw bytes");
+
+  /**
+   * @struct Levels
+   * @brief An in-memory map in the file's shape, for write().
+   */
+  struct Levels {
+    std::vector<uint64_t> nodeIds;
+    std::vector<double> resolutions;
+    std::vector<std::vector<uint32_t>> membership; // Per level, per node
+  };
+
+  /**
+   * @brief A hierarchy over snapshot `g`, ready for write().
+   */
+  static Levels fromHierarchy(const Leiden::Hierarchy &h, const CsrGraph &g) {
+    Levels l;
+    l.nodeIds.resize(g.nodeCount());
+    for (uint32_t v = 0; v < g.nodeCount(); ++v)
+      l.nodeIds[v] = g.nodeIdAt(v);
+    for (const Leiden::Partition &p : h.levels) {
+      l.resolutions.push_back(p.resolution);
+      l.membership.push_back(p.membership);
+      l.membership.back().resize(g.nodeCount(), NONE);
+    }
+    return l;
+  }
+
+  /**
+   * @brief Reads LeidenEngine.py's community_map.json ({"<node id>":
+   * {"macro_community": m, "micro_community": u}, ...}) as two levels, in
+   * file order. Missing levels become NONE.
+   * @return false if the file is unreadable or malformed (reason in
+   * *error).
+   */
+  static bool readJson(const std::string &path, Levels &out,
+                       std::string *error = nullptr) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+      return fail(error, "cannot open " + path);
+    const std::string text((std::istreambuf_iterator<char>(in)),
+                           std::istreambuf_iterator<char>());
+    out = Levels();
+    out.resolutions.assign(2, 0.0);
+    out.membership.resize(2);
+    const char *levelKeys[2] = {"\"macro_community\"", "\"micro_community\""};
+    size_t p = text.find('{');
+    if (p == std::string::npos)
+      return fail(error, path + " is not a JSON object");
+    for (++p;;) {
+      p = text.find_first_not_of(" \t\r\n,", p);
+      if (p == std::string::npos || text[p] == '}')
+        break;
+      // "<id>": { ... }
+      char *end = nullptr;
+      const uint64_t id = std::strtoull(text.c_str() + p + 1, &end, 10);
+      const size_t open = text.find('{', p);
+      const size_t close = text.find('}', open);
+      if (text[p] != '"' || end == text.c_str() + p + 1 || *end != '"' ||
+          open == std::string::npos || close == std::string::npos)
+        return fail(error, path + ": entry #" +
+                               std::to_string(out.nodeIds.size()) +
+                               " is not \"<node id>\": {...}");
+      out.nodeIds.push_back(id);
+      for (int l = 0; l < 2; ++l) {
+        uint32_t c = NONE;
+        const size_t key = text.find(levelKeys[l], open);
+        if (key < close) {
+          const size_t v = text.find_first_not_of(
+              " \t\r\n:", key + std::strlen(levelKeys[l]));
+          c = static_cast<uint32_t>(
+              std::strtoul(text.c_str() + v, nullptr, 10));
+        }
+        out.membership[l].push_back(c);
+      }
+      p = close + 1;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Writes `levels` to path, via a temporary file renamed over it.
+   * @return false on I/O failure or ragged levels (reason in *error).
+   */
+  static bool write(const Levels &levels, const std::string &path,
+                    std::string *error = nullptr) {
+    const size_t n = levels.nodeIds.size();
+    const size_t levelCount = levels.membership.size();
+    if (levels.resolutions.size() != levelCount)
+      return fail(error, "one resolution per level is required");
+    for (const std::vector<uint32_t> &m : levels.membership)
+      if (m.size() != n)
+        return fail(error, "every level needs one entry per node");
+
+    Header h{};
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = FORMAT_VERSION;
+    h.endianTag = ENDIAN_TAG;
+    h.nodeCount = n;
+    h.levelCount = levelCount;
+    const uint64_t bytes[SECTION_COUNT] = {n * sizeof(uint64_t),
+                                           levelCount * sizeof(double),
+                                           levelCount * n * sizeof(uint32_t)};
+    uint64_t cursor = alignUp(sizeof(Header));
+    for (uint32_t s = 0; s < SECTION_COUNT; ++s) {
+      h.sections[s] = {cursor, bytes[s]};
+      cursor = alignUp(cursor + bytes[s]);
+    }
+    h.fileBytes = cursor;
+
+    const std::string tmp = path + ".tmp";
+    {
+      std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+      if (!out)
+        return fail(error, "cannot create " + tmp);
+      static const char zeros[ALIGN] = {};
+      uint64_t written = 0;
+      auto put = [&](const void *data, size_t size) {
+        out.write(static_cast<const char *>(data), size);
+        written += size;
+      };
+      auto pad = [&](uint64_t to) { put(zeros, to - written); };
+      put(&h, sizeof(h));
+      pad(h.sections[NODE_IDS].offset);
+      put(levels.nodeIds.data(), bytes[NODE_IDS]);
+      pad(h.sections[RESOLUTIONS].offset);
+      put(levels.resolutions.data(), bytes[RESOLUTIONS]);
+      pad(h.sections[MEMBERSHIP].offset);
+      for (const std::vector<uint32_t> &m : levels.membership)
+        put(m.data(), m.size() * sizeof(uint32_t));
+      pad(h.fileBytes);
+      out.flush();
+      if (!out) {
+        out.close();
+        std::remove(tmp.c_str());
+        return fail(error, "short write to " + tmp);
+      }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+      std::remove(tmp.c_str());
+      return fail(error, "cannot rename " + tmp + " to " + path);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Maps and validates a community map file.
+   * @return nullptr if the file is missing, truncated, or was written by an
+   * incompatible format version or byte order (reason in *error).
+   */
+  static std::shared_ptr<const CommunityMap>
+  open(const std::string &path, std::string *error = nullptr) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return failMap(error, "cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 ||
+        static_cast<uint64_t>(st.st_size) < sizeof(Header)) {
+      ::close(fd);
+      return failMap(error, path + " is too small to be a community map");
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void *addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+      return failMap(error, "cannot mmap " + path);
+    auto map = std::shared_ptr<CommunityMap>(new CommunityMap());
+    map->region = std::make_shared<const Region>(addr, size);
+    const std::string why = map->bind();
+    if (!why.empty())
+      return failMap(error, path + ": " + why);
+    return map;
+  }
+
+  size_t nodeCount() const { return header->nodeCount; }
+  size_t levelCount() const { return header->levelCount; }
+  ArrayRef<uint64_t> nodeIds() const { return ids; }
+  double resolution(size_t level) const { return resolutions[level]; }
+
+  /**
+   * @brief Community of every dense node at `level` (0 = macro).
+   */
+  ArrayRef<uint32_t> level(size_t l) const {
+    return ArrayRef<uint32_t>(membership + l * nodeCount(), nodeCount());
+  }
+  ArrayRef<uint32_t> macro() const { return level(0); }
+  ArrayRef<uint32_t> micro() const { return level(levelCount() - 1); }
+
+  size_t mappedBytes() const { return region->size; }
+
+private:
+  /**
+   * @brief Owns the mapping; unmapped when the last view goes away.
+   */
+  struct Region {
+    void *addr;
+    size_t size;
+    Region(void *addr, size_t size) : addr(addr), size(size) {}
+    ~Region() { ::munmap(addr, size); }
+    Region(const Region &) = delete;
+    Region &operator=(const Region &) = delete;
+  };
+
+  std::shared_ptr<const Region> region;
+  const Header *header = nullptr;
+  ArrayRef<uint64_t> ids;
+  const double *resolutions = nullptr;
+  const uint32_t *membership = nullptr;
+
+  CommunityMap() = default;
+
+  std::string bind() {
+    const char *base = static_cast<const char *>(region->addr);
+    header = reinterpret_cast<const Header *>(base);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0)
+      return "not a community map";
+    if (header->endianTag != ENDIAN_TAG)
+      return "written with a different byte order";
+    if (header->version != FORMAT_VERSION)
+      return "format version " + std::to_string(header->version) +
+             ", expected " + std::to_string(FORMAT_VERSION);
+    if (header->fileBytes > region->size)
+      return "truncated";
+    if (header->levelCount == 0)
+      return "no levels";
+    const uint64_t expected[SECTION_COUNT] = {
+        header->nodeCount * sizeof(uint64_t),
+        header->levelCount * sizeof(double),
+        header->levelCount * header->nodeCount * sizeof(uint32_t)};
+    for (uint32_t s = 0; s < SECTION_COUNT; ++s) {
+      const SectionEntry &e = header->sections[s];
+      if (e.bytes != expected[s] || e.offset % ALIGN != 0 ||
+          e.offset + e.bytes > header->fileBytes)
+        return "section " + std::to_string(s) + " is out of bounds";
+    }
+    ids = ArrayRef<uint64_t>(
+        reinterpret_cast<const uint64_t *>(base +
+                                           header->sections[NODE_IDS].offset),
+        header->nodeCount);
+    resolutions = reinterpret_cast<const double *>(
+        base + header->sections[RESOLUTIONS].offset);
+    membership = reinterpret_cast<const uint32_t *>(
+        base + header->sections[MEMBERSHIP].offset);
+    return "";
+  }
+
+  static uint64_t alignUp(uint64_t v) { return (v + ALIGN - 1) & ~(ALIGN - 1); }
+
+  static bool fail(std::string *error, const std::string &why) {
+    if (error)
+      *error = why;
+    return false;
+  }
+
+  static std::shared_ptr<const CommunityMap> failMap(std::string *error,
+                                                     const std::string &why) {
+    fail(error, why);
+    return nullptr;
+  }
+};
@@ -1,3 +1,4 @@
+import hashlib
 import json
 import os
 
@@ -13,9 +14,14 @@ class DriftDetector:
         self.threshold = drift_threshold
         print(f"Drift Detector initialized (Sensitivity: {drift_threshold})")
 
-    def detect_drift(self, current_map_path, baseline_map_path):
+    def detect_drift(self, current_map_path, baseline_map_path, touched_communities=None):
         """
         Detects nodes that have migrated between communities.
+
+        touched_communities is LeidenEngine.cluster_incremental's delta
+        ({"macro_community": [...], "micro_community": [...]}). Community
+        IDs outside it were fixed during that run, so their nodes are
+        counted stable without comparing them.
         """
         print(f"Comparing {current_map_path} against baseline {baseline_map_path}...")
         
@@ -36,6 +42,11 @@ class DriftDetector:
             }
         }
 
+        touched = None
+        if touched_communities is not None:
+            touched = {level: set(touched_communities.get(level, []))
+                       for level in ("macro_community", "micro_community")}
+
         all_node_ids = set(current_map.keys()).union(set(baseline_map.keys()))
         drift_results["summary"]["total_nodes"] = len(all_node_ids)
 
@@ -47,6 +58,11 @@ class DriftDetector:
                 drift_results["new_nodes"].append(node_id)
                 continue
 
+            if touched_communities is not None and not any(
+                    m[level] in touched[level] for m in (curr, prev) for level in touched):
+                drift_results["stable_nodes"].append(node_id)
+                continue
+
             # Check for changes in Macro or Micro communities
             is_macro_drift = curr['macro_community'] != prev['macro_community']
             is_micro_drift = curr['micro_community'] != prev['micro_community']
@@ -88,7 +104,20 @@ if __name__ == "__main__":
     
     # Check if files exist, otherwise run with mocks
     if os.path.exists(current_file) and os.path.exists(baseline_file):
-        results = detector.detect_drift(current_file, baseline_file)
+        delta_file = "data/processed/community_delta.json"
+        touched = None
+        if os.path.exists(delta_file):
+            with open(delta_file, 'r') as f:
+                delta = json.load(f)
+            # The delta only stands in for comparing nodes when it was
+            # computed from exactly this baseline to this current map
+            digest = lambda path: hashlib.sha256(open(path, 'rb').read()).hexdigest()
+            if (delta.get("previous_map_sha256") == digest(baseline_file)
+                    and delta.get("map_sha256") == digest(current_file)):
+                touched = delta
+            else:
+                print(f"Ignoring {delta_file}: computed from other community maps.")
+        results = detector.detect_drift(current_file, baseline_file, touched)
         detector.save_analysis(results, "data/processed/drift_analysis.json")
     else:
         print("\n[Logical Verification Test]")
@@ -107,6 +136,8 @@ if __name__ == "__main__":
         with open("mock_current.json", 'w') as f: json.dump(mock_current, f)
         
         test_results = detector.detect_drift("mock_current.json", "mock_baseline.json")
+        delta = {"macro_community": [0, 1], "micro_community": [0, 1]}
+        assert detector.detect_drift("mock_current.json", "mock_baseline.json", delta)["summary"] == test_results["summary"]
         print(f"--- Logic Test Results ---")
         print(f"Total Nodes: {test_results['summary']['total_nodes']}")
         print(f"Drifted Nodes: {test_results['summary']['drift_count']}")
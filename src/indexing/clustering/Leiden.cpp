@@ -0,0 +1,255 @@
+#include "Leiden.hpp"
+#include "../graph-engine/PartitionedGraph.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+static double msSince(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - t)
+      .count();
+}
+
+/**
+ * @brief Purity of `found` against `planted`: the share of nodes that sit
+ * in their community's majority planted group. purity(planted, found)
+ * instead penalizes splitting a planted group.
+ */
+static double purity(const std::vector<uint32_t> &found,
+                     const std::vector<uint32_t> &planted) {
+  std::unordered_map<uint64_t, uint32_t> overlap;
+  std::unordered_map<uint32_t, uint32_t> best;
+  for (size_t v = 0; v < found.size(); ++v) {
+    uint32_t c = ++overlap[uint64_t(found[v]) << 32 | planted[v]];
+    best[found[v]] = std::max(best[found[v]], c);
+  }
+  size_t agree = 0;
+  for (const auto &entry : best)
+    agree += entry.second;
+  return double(agree) / found.size();
+}
+
+int main(int argc, char **argv) {
+  // Planted two-level structure: fault domains made of tightly knit
+  // micro communities, plus background noise across the whole graph.
+  const size_t domains = 4, microPerDomain = 250;
+  const size_t microSize =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100;
+  const size_t n = domains * microPerDomain * microSize;
+  std::vector<uint32_t> plantedMacro(n), plantedMicro(n);
+  for (size_t v = 0; v < n; ++v) {
+    plantedMicro[v] = static_cast<uint32_t>(v / microSize);
+    plantedMacro[v] = static_cast<uint32_t>(v / (microSize * microPerDomain));
+  }
+
+  std::cout << "--- Leiden over GraphEngine: " << n << " nodes ---"
+            << std::endl;
+  auto t = std::chrono::steady_clock::now();
+  GraphEngine engine;
+  for (size_t v = 0; v < n; ++v)
+    engine.addNode(v + 1, "EVENT");
+  std::mt19937_64 gen(5);
+  uint64_t edgeId = 0;
+  auto link = [&](size_t u, size_t v, const char *label) {
+    if (u != v)
+      engine.addEdge(++edgeId, u + 1, v + 1, label);
+  };
+  for (size_t v = 0; v < n; ++v) {
+    const size_t micro = plantedMicro[v] * microSize;
+    const size_t macro = plantedMacro[v] * microSize * microPerDomain;
+    for (int i = 0; i < 8; ++i)
+      link(v, micro + gen() % microSize, "CAUSES");
+    if (gen() % 2 == 0)
+      link(v, macro + gen() % (microSize * microPerDomain), "PRECEDES");
+    if (gen() % 8 == 0)
+      link(v, gen() % n, "PRECEDES");
+  }
+  auto snapshot = engine.snapshot();
+  std::cout << "Built " << edgeId << " edges in " << msSince(t) << " ms"
+            << std::endl;
+
+  // Projector.py's structural view (alpha = 1.0), built in memory.
+  t = std::chrono::steady_clock::now();
+  WeightedGraph projection = WeightedGraph::fromEdges(
+      snapshot->nodeCount(), WeightedGraph::structuralEdges(*snapshot));
+  std::cout << "Projected in " << msSince(t) << " ms ("
+            << projection.memoryBytes() / 1e6 << " MB)" << std::endl;
+
+  Leiden leiden;
+  std::cout << "\n--- Hierarchy (" << leiden.options().threads
+            << " threads) ---" << std::endl;
+  // LeidenEngineHierarchical's resolutions plus a finer one: at gamma 1
+  // the resolution limit of modularity still merges micro communities
+  // that happen to share a few PRECEDES links.
+  t = std::chrono::steady_clock::now();
+  Leiden::Hierarchy hierarchy =
+      leiden.runHierarchy(projection, {0.01, 0.1, 1.0, 5.0});
+  std::cout << "Four resolutions in " << msSince(t) << " ms" << std::endl;
+  std::printf("Planted: Q(domains) at gamma 0.1 %.4f, Q(micro) at gamma 5 "
+              "%.4f\n",
+              Leiden::quality(projection, plantedMacro, 0.1),
+              Leiden::quality(projection, plantedMicro, 5.0));
+  for (const Leiden::Partition &p : hierarchy.levels)
+    std::printf("gamma %-5g %6zu communities, Q %.4f | vs domains %.3f / "
+                "%.3f, vs micro %.3f / %.3f\n",
+                p.resolution, p.communities, p.quality,
+                purity(p.membership, plantedMacro),
+                purity(plantedMacro, p.membership),
+                purity(p.membership, plantedMicro),
+                purity(plantedMicro, p.membership));
+
+  // Community IDs land in node columns instead of community_map.json.
+  hierarchy.writeTo(engine);
+  const uint64_t probe = 4242 % n + 1;
+  auto macro = engine.getNodeProperty(probe, Leiden::MACRO_COMMUNITY);
+  auto micro = engine.getNodeProperty(probe, Leiden::MICRO_COMMUNITY);
+  std::cout << "\nNode " << probe << ": macro_community "
+            << std::get<int>(*macro) << ", micro_community "
+            << std::get<int>(*micro) << " | columns add "
+            << hierarchy.levels.size() + 2 << " x " << n * 4 / 1e6 << " MB"
+            << std::endl;
+
+  // A second pass seeded with the micro partition only refines it.
+  t = std::chrono::steady_clock::now();
+  Leiden::Partition again =
+      leiden.run(projection, 5.0, &hierarchy.levels.back().membership);
+  std::printf("Warm restart at gamma 5: %zu communities, Q %.4f in %.1f ms\n",
+              again.communities, again.quality, msSince(t));
+
+  // A delta from re-extracted chunks: two micro communities of domain 0
+  // become one, and a few random edges elsewhere are retracted. Only the
+  // communities of touched nodes are re-clustered.
+  std::vector<uint32_t> touched;
+  auto touch = [&](uint64_t id) {
+    touched.push_back(snapshot->indexOfNode(id));
+  };
+  for (int i = 0; i < 4 * int(microSize); ++i) {
+    size_t u = gen() % microSize, v = microSize + gen() % microSize;
+    link(u, v, "CAUSES");
+    touch(u + 1);
+    touch(v + 1);
+  }
+  for (int i = 0; i < 50; ++i) {
+    uint64_t id = 1 + gen() % edgeId, src, tgt;
+    if (engine.edgeEndpoints(id, src, tgt) && engine.removeEdge(id)) {
+      touch(src);
+      touch(tgt);
+    }
+  }
+  t = std::chrono::steady_clock::now();
+  snapshot = engine.snapshot();
+  projection = WeightedGraph::fromEdges(
+      snapshot->nodeCount(), WeightedGraph::structuralEdges(*snapshot));
+  std::printf("\nDelta: %zu touched nodes, snapshot + projection in %.1f ms\n",
+              touched.size(), msSince(t));
+  const Leiden::Partition &fine = hierarchy.levels.back();
+  t = std::chrono::steady_clock::now();
+  Leiden::Update u = leiden.update(projection, fine, touched);
+  std::printf("Incremental at gamma 5: %zu nodes re-clustered, %zu "
+              "communities changed, Q %.4f in %.1f ms\n",
+              u.reclustered, u.changed.size(), u.partition.quality,
+              msSince(t));
+  size_t kept = 0;
+  for (size_t v = 0; v < n; ++v)
+    kept += u.partition.membership[v] == fine.membership[v];
+  t = std::chrono::steady_clock::now();
+  Leiden::Partition full = leiden.run(projection, 5.0);
+  std::printf("Full run at gamma 5:    %zu communities, Q %.4f in %.1f ms "
+              "(incremental kept %.1f%% of IDs)\n",
+              full.communities, full.quality, msSince(t), 100.0 * kept / n);
+
+  // The micro communities seed the shards of a PartitionedGraph; hashed
+  // node IDs are the baseline. Paths must match the single engine's.
+  const size_t shardCount = 8;
+  std::cout << "\n--- " << shardCount << " shards ---" << std::endl;
+  std::vector<std::pair<uint64_t, uint64_t>> queries;
+  std::vector<size_t> hops;
+  for (int q = 0; q < 200; ++q) {
+    queries.push_back({1 + gen() % n, 1 + gen() % n});
+    hops.push_back(engine.findPath(queries.back().first, queries.back().second)
+                       .size());
+  }
+  const std::vector<uint32_t> &membership = u.partition.membership;
+  const std::vector<uint32_t> bridges =
+      PartitionedGraph::bridgeNodes(*snapshot, membership, n / 100);
+  struct Layout {
+    const char *name;
+    std::vector<uint16_t> owner;
+    std::vector<uint32_t> replicas;
+  };
+  const Layout layouts[] = {
+      {"hashed IDs", PartitionedGraph::assignByHash(*snapshot, shardCount),
+       {}},
+      {"communities",
+       PartitionedGraph::assignByCommunity(membership, shardCount), {}},
+      {"  + bridges",
+       PartitionedGraph::assignByCommunity(membership, shardCount), bridges}};
+  for (const Layout &layout : layouts) {
+    t = std::chrono::steady_clock::now();
+    PartitionedGraph shards(*snapshot, layout.owner, layout.replicas);
+    const double buildMs = msSince(t);
+    PartitionedGraph::Stats total;
+    size_t agree = 0;
+    t = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < queries.size(); ++q) {
+      agree += shards.findPath(queries[q].first, queries[q].second).size() ==
+               hops[q];
+      const PartitionedGraph::Stats &s = shards.lastStats();
+      total.messages += s.messages;
+      total.batches += s.batches;
+      total.pathHops += s.pathHops;
+      total.crossHops += s.crossHops;
+    }
+    const double queryMs = msSince(t) / queries.size();
+    size_t replicas = 0;
+    for (size_t s = 0; s < shards.shardCount(); ++s)
+      replicas += shards.shardReplicas(s);
+    std::printf("%-12s cut %4.1f%% of edges, %5zu replicas | %4.1f%% of path "
+                "hops cross shards, %7.0f messages in %4.1f batches per "
+                "query, %.2f ms/query | built in %.0f ms, %zu/%zu paths "
+                "match\n",
+                layout.name, 100.0 * shards.crossShardEdges() /
+                                 snapshot->edgeCount(),
+                replicas, 100.0 * total.crossHops / total.pathHops,
+                double(total.messages) / queries.size(),
+                double(total.batches) / queries.size(), queryMs, buildMs,
+                agree, queries.size());
+  }
+
+  // The batch size and thread count only change how the local moving
+  // phase is split up, never its result.
+  size_t differ = 0;
+  const size_t graphs = 40;
+  for (size_t trial = 0; trial < graphs; ++trial) {
+    const size_t nodes = 200 + gen() % 800;
+    std::vector<WeightedGraph::Edge> edges;
+    for (size_t e = 0, count = nodes * (2 + gen() % 6); e < count; ++e) {
+      const uint32_t u = gen() % nodes;
+      const uint32_t v = gen() % 4 ? (u + 1 + gen() % 20) % nodes
+                                   : gen() % nodes; // Mostly local links
+      edges.push_back({u, v, 1.0f + gen() % 4});
+    }
+    const WeightedGraph random = WeightedGraph::fromEdges(nodes, edges);
+    std::vector<uint32_t> reference;
+    for (size_t batch : {size_t(1), size_t(7), size_t(16384)})
+      for (size_t threads : {size_t(1), size_t(4)}) {
+        Leiden::Options o;
+        o.moveBatch = batch;
+        o.threads = threads;
+        const std::vector<uint32_t> membership =
+            Leiden(o).run(random, 1.0).membership;
+        if (reference.empty())
+          reference = membership;
+        differ += membership != reference;
+      }
+  }
+  std::cout << "\nBatch sizes 1 / 7 / 16384 x 1 / 4 threads on " << graphs
+            << " random graphs: " << differ << " runs differ from batch 1"
+            << std::endl;
+  return differ ? 1 : 0;
+}
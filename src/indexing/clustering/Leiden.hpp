@@ -0,0 +1,783 @@
+#pragma once
+
+#include "../data-preprocessing/Instrumentation.hpp"
+#include "../data-preprocessing/ParallelFor.hpp"
+#include "../graph-engine/GraphEngine.hpp"
+#include "WeightedGraph.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class Leiden
+ * @brief In-process Leiden community detection (Traag, Waltman & van Eck,
+ * 2019) over a WeightedGraph, replacing the igraph/leidenalg round trip of
+ * LeidenEngine.py and LeidenEngineHierarchical.py.
+ *
+ * The quality function is leidenalg's RBConfigurationVertexPartition on a
+ * directed weighted graph:
+ *
+ *   Q = 1/m * sum_c [ w_in(c) - gamma * K_out(c) * K_in(c) / m ]
+ *
+ * Every pass runs the three Leiden phases until the aggregate stops
+ * shrinking:
+ * 1. Local moving: nodes move to the neighboring community with the best
+ *    gain. Each round visits only the active nodes: all of them at first,
+ *    then the neighbors of nodes that moved. Active nodes are processed in
+ *    fixed-size batches. A batch's best moves are computed in parallel
+ *    against a frozen state, then applied in order. A move is recomputed
+ *    if, earlier in the batch, one of the node's neighbors moved or the
+ *    totals of its own or a neighboring community changed. Every applied
+ *    move is thus the one a serial pass in the same order makes, so the
+ *    result does not depend on the batch size either.
+ * 2. Refinement: each community is split back into singletons and
+ *    re-merged greedily, only between well-connected subsets, all
+ *    communities in parallel. This guarantees connected communities,
+ *    which Louvain does not.
+ * 3. Aggregation: the refined communities become the nodes of the next
+ *    level, initially placed in their unrefined community.
+ * A pass repeats the whole thing from the previous result (`iterations`,
+ * leidenalg's n_iterations, defaults to 2 as there).
+ *
+ * Results depend on `seed` only, not on the number of threads, so two
+ * runs over the same graph produce the same community IDs. IDs are numbered
+ * by decreasing community size, as leidenalg does.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: Runs on the snapshot in memory: no CSV, no pandas, no igraph
+ *   copy, no JSON. The projection is built once and reused for every
+ *   resolution of the hierarchy.
+ * - CON: Nodes next to an earlier move in their batch are re-evaluated
+ *   serially. Few are, early on, when the batch is a small slice of a
+ *   large level. On the small upper levels most are, and those levels
+ *   run close to serial.
+ * - CON: Refinement merges greedily (leidenalg's randomness parameter
+ *   theta -> 0), which keeps it deterministic without a per-community RNG.
+ */
+class Leiden {
+public:
+  static constexpr const char *MACRO_COMMUNITY = "macro_community";
+  static constexpr const char *MICRO_COMMUNITY = "micro_community";
+
+  struct Options {
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t iterations = 2;          // Full passes (leidenalg n_iterations)
+    size_t moveBatch = 16384;       // Active nodes per parallel batch
+    size_t maxMoveRounds = 64;      // Per local-moving phase
+    uint64_t seed = 42;             // Node visiting order
+  };
+
+  /**
+   * @struct Partition
+   * @brief One resolution's result: membership[v] is node v's community.
+   */
+  struct Partition {
+    double resolution = 1.0;
+    std::vector<uint32_t> membership;
+    size_t communities = 0; // IDs are below this; see update() for holes
+    double quality = 0; // Q above, at this resolution
+    size_t levels = 0;  // Aggregation levels of the final pass
+  };
+
+  /**
+   * @struct Hierarchy
+   * @brief LeidenEngineHierarchical's output: one partition per resolution,
+   * in increasing resolution order (broad fault domains first).
+   */
+  struct Hierarchy {
+    std::vector<Partition> levels;
+
+    /**
+     * @brief Column name of level i ("community_level_0", ...).
+     */
+    static std::string columnName(size_t level) {
+      return "community_level_" + std::to_string(level);
+    }
+
+    /**
+     * @brief Installs every level as a node column of `engine`, which must
+     * be the engine whose snapshot the graph was projected from. Also
+     * writes the community_map.json pair: macro_community (level 0) and
+     * micro_community (last level).
+     */
+    void writeTo(GraphEngine &engine) const {
+      for (size_t i = 0; i < levels.size(); ++i)
+        engine.setNodeColumn(columnName(i), levels[i].membership);
+      if (levels.empty())
+        return;
+      engine.setNodeColumn(MACRO_COMMUNITY, levels.front().membership);
+      engine.setNodeColumn(MICRO_COMMUNITY, levels.back().membership);
+    }
+  };
+
+  /**
+   * @struct Update
+   * @brief update()'s result.
+   */
+  struct Update {
+    Partition partition;
+    // Sorted IDs whose member set differs from the previous partition,
+    // including IDs that are no longer used.
+    std::vector<uint32_t> changed;
+    size_t reclustered = 0; // Nodes that were free to move
+  };
+
+  explicit Leiden(Options options) : opts(options) {
+    opts.threads = std::max<size_t>(1, opts.threads);
+    opts.moveBatch = std::max<size_t>(1, opts.moveBatch);
+  }
+  Leiden() : Leiden(Options()) {}
+
+  /**
+   * @brief Partitions the graph at one resolution (gamma above).
+   * @param initial Optional starting membership, one entry per node.
+   */
+  Partition run(const WeightedGraph &graph, double resolution,
+                const std::vector<uint32_t> *initial = nullptr) const {
+    RCA_SPAN("Leiden::run");
+    const size_t n = graph.nodeCount();
+    Partition result;
+    result.resolution = resolution;
+    result.membership.resize(n);
+    if (initial && initial->size() == n) {
+      result.membership = *initial;
+      renumber(result.membership);
+    } else {
+      std::iota(result.membership.begin(), result.membership.end(), 0u);
+    }
+    if (graph.totalWeight() > 0) {
+      for (size_t pass = 0; pass < opts.iterations; ++pass) {
+        bool moved = optimise(graph, resolution, pass, result.membership,
+                              result.levels);
+        if (!moved)
+          break;
+      }
+    }
+    result.communities = renumberBySize(result.membership);
+    result.quality = quality(graph, result.membership, resolution);
+    return result;
+  }
+
+  /**
+   * @brief One partition per resolution, sorted in increasing order like
+   * LeidenEngineHierarchical (default [0.01, 0.1, 1.0]).
+   */
+  Hierarchy runHierarchy(const WeightedGraph &graph,
+                         std::vector<double> resolutions = {0.01, 0.1,
+                                                            1.0}) const {
+    std::sort(resolutions.begin(), resolutions.end());
+    Hierarchy h;
+    for (double resolution : resolutions)
+      h.levels.push_back(run(graph, resolution));
+    return h;
+  }
+
+  /**
+   * @brief Re-clusters only what a graph delta can have changed.
+   *
+   * Every community of `previous` that holds a touched node is dissolved,
+   * and so are nodes added since (indices past previous.membership). Every
+   * other community is collapsed into a single node, so Leiden runs on a
+   * graph of the dissolved nodes plus one node per surviving community:
+   * dissolved nodes can regroup among themselves or join any survivor,
+   * and survivors can only move as a whole. Collapsing keeps all weights
+   * and strengths, so Q is that of the full graph.
+   *
+   * The new communities are matched to previous IDs by largest node
+   * overlap, so unaffected communities keep their ID and most changed ones
+   * do too. Unmatched communities take freed IDs, then fresh ones. IDs are
+   * no longer ordered by size and may leave holes below `communities`.
+   * @param graph The updated projection, one node per snapshot node.
+   * @param touched Dense indices of nodes whose edges changed (see
+   * IncrementalLoader::Delta::touchedNodes).
+   */
+  Update update(const WeightedGraph &graph, const Partition &previous,
+                const std::vector<uint32_t> &touched) const {
+    RCA_SPAN("Leiden::update");
+    const size_t n = graph.nodeCount();
+    const size_t known = std::min(n, previous.membership.size());
+    const std::vector<uint32_t> &old = previous.membership;
+    uint32_t bound = 0;
+    for (size_t v = 0; v < known; ++v)
+      bound = std::max(bound, old[v] + 1);
+    std::vector<uint32_t> oldSize(bound, 0);
+    std::vector<uint8_t> dissolved(bound, 0);
+    for (size_t v = 0; v < known; ++v)
+      oldSize[old[v]]++;
+    for (uint32_t v : touched)
+      if (v < known)
+        dissolved[old[v]] = 1;
+
+    // Compressed node of each node: its own if dissolved, else the one of
+    // its community.
+    std::vector<uint32_t> group(n), collapsed(bound, NEW_COMMUNITY);
+    std::vector<uint32_t> origin; // Compressed node -> old ID, if collapsed
+    Update u;
+    for (size_t v = 0; v < n; ++v) {
+      if (v >= known || dissolved[old[v]]) {
+        group[v] = static_cast<uint32_t>(origin.size());
+        origin.push_back(NEW_COMMUNITY);
+        u.reclustered++;
+      } else {
+        if (collapsed[old[v]] == NEW_COMMUNITY) {
+          collapsed[old[v]] = static_cast<uint32_t>(origin.size());
+          origin.push_back(old[v]);
+        }
+        group[v] = collapsed[old[v]];
+      }
+    }
+    Partition &p = u.partition;
+    p.resolution = previous.resolution;
+    if (u.reclustered == 0) {
+      p = previous;
+      return u;
+    }
+    Partition sub = run(aggregateBy(graph, group, origin.size()),
+                        previous.resolution);
+    p.levels = sub.levels;
+
+    // Node overlap of each (new community, old ID) pair, largest first.
+    struct Overlap {
+      uint32_t community;
+      uint32_t id;
+      uint32_t nodes;
+    };
+    std::vector<Overlap> overlaps;
+    std::vector<uint32_t> newSize(sub.communities, 0);
+    for (size_t k = 0; k < origin.size(); ++k)
+      if (origin[k] != NEW_COMMUNITY)
+        overlaps.push_back(
+            {sub.membership[k], origin[k], oldSize[origin[k]]});
+    for (size_t v = 0; v < n; ++v) {
+      const uint32_t c = sub.membership[group[v]];
+      newSize[c]++;
+      if (v < known && dissolved[old[v]])
+        overlaps.push_back({c, old[v], 1});
+    }
+    std::sort(overlaps.begin(), overlaps.end(),
+              [](const Overlap &a, const Overlap &b) {
+                return a.community != b.community ? a.community < b.community
+                                                  : a.id < b.id;
+              });
+    size_t merged = 0;
+    for (const Overlap &o : overlaps) {
+      if (merged > 0 && overlaps[merged - 1].community == o.community &&
+          overlaps[merged - 1].id == o.id)
+        overlaps[merged - 1].nodes += o.nodes;
+      else
+        overlaps[merged++] = o;
+    }
+    overlaps.resize(merged);
+    std::stable_sort(overlaps.begin(), overlaps.end(),
+                     [](const Overlap &a, const Overlap &b) {
+                       return a.nodes > b.nodes;
+                     });
+    std::vector<uint32_t> idOf(sub.communities, NEW_COMMUNITY);
+    std::vector<uint8_t> taken(bound, 0), same(sub.communities, 0);
+    for (const Overlap &o : overlaps) {
+      if (idOf[o.community] != NEW_COMMUNITY || taken[o.id])
+        continue;
+      idOf[o.community] = o.id;
+      taken[o.id] = 1;
+      same[o.community] =
+          o.nodes == oldSize[o.id] && o.nodes == newSize[o.community];
+    }
+    uint32_t freed = 0, fresh = bound;
+    for (uint32_t k = 0; k < sub.communities; ++k) {
+      if (idOf[k] == NEW_COMMUNITY) {
+        while (freed < bound && taken[freed])
+          ++freed;
+        idOf[k] = freed < bound ? freed++ : fresh++;
+      }
+      if (!same[k])
+        u.changed.push_back(idOf[k]);
+    }
+    for (uint32_t id = 0; id < bound; ++id)
+      if (oldSize[id] > 0 && !taken[id])
+        u.changed.push_back(id); // Vanished, unless reused above
+    std::sort(u.changed.begin(), u.changed.end());
+    u.changed.erase(std::unique(u.changed.begin(), u.changed.end()),
+                    u.changed.end());
+
+    p.membership.resize(n);
+    for (size_t v = 0; v < n; ++v)
+      p.membership[v] = idOf[sub.membership[group[v]]];
+    p.communities = std::max(bound, fresh);
+    p.quality = quality(graph, p.membership, p.resolution);
+    return u;
+  }
+
+  /**
+   * @brief update() for every level of `hierarchy`, in place.
+   * @return Per level, the changed community IDs.
+   */
+  std::vector<std::vector<uint32_t>>
+  update(const WeightedGraph &graph, Hierarchy &hierarchy,
+         const std::vector<uint32_t> &touched) const {
+    std::vector<std::vector<uint32_t>> changed;
+    for (Partition &level : hierarchy.levels) {
+      Update u = update(graph, level, touched);
+      level = std::move(u.partition);
+      changed.push_back(std::move(u.changed));
+    }
+    return changed;
+  }
+
+  /**
+   * @brief Q of an arbitrary membership on `graph` at `resolution`.
+   */
+  static double quality(const WeightedGraph &graph,
+                        const std::vector<uint32_t> &membership,
+                        double resolution) {
+    const double m = graph.totalWeight();
+    if (m <= 0)
+      return 0;
+    uint32_t c = 0;
+    for (uint32_t id : membership)
+      c = std::max(c, id + 1);
+    std::vector<double> inside(c, 0.0), out(c, 0.0), in(c, 0.0);
+    for (uint32_t v = 0; v < graph.nodeCount(); ++v) {
+      const uint32_t cv = membership[v];
+      out[cv] += graph.outWeight(v);
+      in[cv] += graph.inWeight(v);
+      inside[cv] += graph.selfLoop(v);
+      for (uint64_t p = graph.begin(v); p < graph.end(v); ++p)
+        if (membership[graph.neighborAt(p)] == cv)
+          inside[cv] += graph.weightAt(p) / 2; // Seen from both ends
+    }
+    double q = 0;
+    for (uint32_t k = 0; k < c; ++k)
+      q += inside[k] - resolution * out[k] * in[k] / m;
+    return q / m;
+  }
+
+  const Options &options() const { return opts; }
+
+private:
+  static constexpr uint32_t NEW_COMMUNITY =
+      std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @brief A node's best move, computed against a frozen state.
+   */
+  struct Proposal {
+    uint32_t target; // Current community if staying, NEW_COMMUNITY if alone
+  };
+
+  Options opts;
+
+  /**
+   * @brief One Leiden pass from `membership`, which it updates.
+   * @return Whether any node changed community.
+   */
+  bool optimise(const WeightedGraph &graph, double resolution, size_t pass,
+                std::vector<uint32_t> &membership, size_t &levels) const {
+    const size_t n = graph.nodeCount();
+    std::vector<uint32_t> comm = membership;
+    std::vector<uint32_t> nodeToAgg(n); // Original node -> current level
+    std::iota(nodeToAgg.begin(), nodeToAgg.end(), 0u);
+    const WeightedGraph *g = &graph;
+    WeightedGraph aggregate;
+    bool moved = false;
+    levels = 0;
+    for (;; ++levels) {
+      std::mt19937_64 rng(opts.seed + pass * 1000003 + levels);
+      moved |= moveNodes(*g, resolution, rng, comm) > 0;
+      const size_t communities = renumber(comm);
+      if (communities == g->nodeCount())
+        break;
+
+      std::vector<uint32_t> refined = refine(*g, resolution, rng, comm);
+      size_t refinedCount = renumber(refined);
+      std::vector<uint32_t> next(refinedCount);
+      if (refinedCount == g->nodeCount()) {
+        // Refinement merged nothing: aggregate the unrefined communities
+        // instead so that the level still shrinks.
+        refined = comm;
+        refinedCount = communities;
+        next.resize(refinedCount);
+        std::iota(next.begin(), next.end(), 0u);
+      } else {
+        for (uint32_t v = 0; v < g->nodeCount(); ++v)
+          next[refined[v]] = comm[v];
+      }
+      WeightedGraph coarser = aggregateBy(*g, refined, refinedCount);
+      ParallelFor::run<256>(
+          n, opts.threads,
+          [&](size_t v) { nodeToAgg[v] = refined[nodeToAgg[v]]; });
+      aggregate = std::move(coarser);
+      g = &aggregate;
+      comm = std::move(next);
+    }
+    for (size_t v = 0; v < n; ++v)
+      membership[v] = comm[nodeToAgg[v]];
+    return moved;
+  }
+
+  /**
+   * @brief Phase 1, local moving.
+   * @return Number of moves applied.
+   */
+  size_t moveNodes(const WeightedGraph &g, double gamma, std::mt19937_64 &rng,
+                   std::vector<uint32_t> &comm) const {
+    const size_t n = g.nodeCount();
+    const double m = g.totalWeight();
+    std::vector<double> kOut(n, 0.0), kIn(n, 0.0);
+    std::vector<uint32_t> size(n, 0);
+    for (uint32_t v = 0; v < n; ++v) {
+      kOut[comm[v]] += g.outWeight(v);
+      kIn[comm[v]] += g.inWeight(v);
+      size[comm[v]]++;
+    }
+    std::vector<uint32_t> empty;
+    for (uint32_t c = static_cast<uint32_t>(n); c-- > 0;)
+      if (size[c] == 0)
+        empty.push_back(c);
+
+    auto nullCost = [&](uint32_t v, uint32_t c, uint32_t own) {
+      double out = kOut[c], in = kIn[c];
+      if (c == own) {
+        out -= g.outWeight(v);
+        in -= g.inWeight(v);
+      }
+      return gamma * (g.outWeight(v) * in + g.inWeight(v) * out) / m;
+    };
+
+    std::vector<uint32_t> queue(n);
+    std::iota(queue.begin(), queue.end(), 0u);
+    std::shuffle(queue.begin(), queue.end(), rng);
+    std::vector<char> queued(n, 1);
+    std::vector<uint32_t> touchedIn(n, 0); // Batch in which a neighbor moved
+    std::vector<uint32_t> changedIn(n, 0); // Batch that changed c's totals
+    std::vector<Proposal> proposals;
+    uint32_t batch = 0;
+    size_t moves = 0;
+    for (size_t round = 0; !queue.empty() && round < opts.maxMoveRounds;
+         ++round) {
+      std::vector<uint32_t> next;
+      for (size_t start = 0; start < queue.size(); start += opts.moveBatch) {
+        const size_t count = std::min(opts.moveBatch, queue.size() - start);
+        ++batch;
+        proposals.resize(count);
+        ParallelFor::run<256>(count, opts.threads, [&](size_t i) {
+          proposals[i] = propose(g, queue[start + i], comm, nullCost, size);
+        });
+        for (size_t i = 0; i < count; ++i) {
+          const uint32_t v = queue[start + i];
+          const uint32_t own = comm[v];
+          // Stale if a neighbor moved, or if an earlier move in this batch
+          // changed the totals of any community the node weighed.
+          bool stale = touchedIn[v] == batch || changedIn[own] == batch;
+          for (uint64_t e = g.begin(v); !stale && e < g.end(v); ++e)
+            stale = changedIn[comm[g.neighborAt(e)]] == batch;
+          if (stale)
+            proposals[i] = propose(g, v, comm, nullCost, size);
+          const Proposal &p = proposals[i];
+          queued[v] = 0;
+          if (p.target == own)
+            continue;
+          while (p.target == NEW_COMMUNITY && size[empty.back()] != 0)
+            empty.pop_back(); // Refilled since it was pushed
+          const uint32_t target =
+              p.target == NEW_COMMUNITY ? empty.back() : p.target;
+          if (p.target == NEW_COMMUNITY)
+            empty.pop_back();
+          kOut[own] -= g.outWeight(v);
+          kIn[own] -= g.inWeight(v);
+          if (--size[own] == 0)
+            empty.push_back(own);
+          kOut[target] += g.outWeight(v);
+          kIn[target] += g.inWeight(v);
+          size[target]++;
+          comm[v] = target;
+          changedIn[own] = changedIn[target] = batch;
+          moves++;
+          for (uint64_t e = g.begin(v); e < g.end(v); ++e) {
+            const uint32_t u = g.neighborAt(e);
+            touchedIn[u] = batch;
+            if (!queued[u] && comm[u] != target) {
+              queued[u] = 1;
+              next.push_back(u);
+            }
+          }
+        }
+      }
+      queue = std::move(next);
+    }
+    return moves;
+  }
+
+  template <typename Cost>
+  static Proposal propose(const WeightedGraph &g, uint32_t v,
+                          const std::vector<uint32_t> &comm,
+                          const Cost &nullCost,
+                          const std::vector<uint32_t> &size) {
+    std::vector<double> &weight = weightScratch(g.nodeCount());
+    std::vector<uint32_t> &touched = touchedScratch();
+    const uint32_t own = comm[v];
+    touched.push_back(own);
+    weight[own] = 0; // Always a candidate, even with no link into it
+    for (uint64_t e = g.begin(v); e < g.end(v); ++e) {
+      const uint32_t c = comm[g.neighborAt(e)];
+      if (weight[c] == 0 && c != own)
+        touched.push_back(c);
+      weight[c] += g.weightAt(e);
+    }
+    const double ownGain = weight[own] - nullCost(v, own, own);
+    Proposal best{own};
+    double bestGain = ownGain;
+    for (uint32_t c : touched) {
+      if (c == own)
+        continue;
+      double gain = weight[c] - nullCost(v, c, own);
+      if (gain > bestGain) {
+        bestGain = gain;
+        best.target = c;
+      }
+    }
+    if (bestGain < 0 && size[own] > 1) // Better off alone
+      best = {NEW_COMMUNITY};
+    for (uint32_t c : touched)
+      weight[c] = 0;
+    touched.clear();
+    return best;
+  }
+
+  /**
+   * @brief Phase 2, refinement. Every community restarts as singletons that
+   * merge, within the community, into a well-connected neighbor subset
+   * with the best non-negative gain. Communities are independent and all
+   * state is indexed by their own member nodes, so they run in parallel.
+   * @return Refined membership; the ID of a subset is one of its nodes.
+   */
+  std::vector<uint32_t> refine(const WeightedGraph &g, double gamma,
+                               std::mt19937_64 &rng,
+                               const std::vector<uint32_t> &comm) const {
+    const size_t n = g.nodeCount();
+    const double m = g.totalWeight();
+    uint32_t communities = 0;
+    for (uint32_t c : comm)
+      communities = std::max(communities, c + 1);
+
+    // Members of each community, in a shuffled order.
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<uint32_t> start(communities + 1, 0), members(n);
+    for (uint32_t v = 0; v < n; ++v)
+      start[comm[v] + 1]++;
+    for (uint32_t c = 0; c < communities; ++c)
+      start[c + 1] += start[c];
+    std::vector<uint32_t> cursor(start.begin(), start.end() - 1);
+    for (uint32_t v : order)
+      members[cursor[comm[v]]++] = v;
+    std::vector<double> cOut(communities, 0.0), cIn(communities, 0.0);
+    for (uint32_t v = 0; v < n; ++v) {
+      cOut[comm[v]] += g.outWeight(v);
+      cIn[comm[v]] += g.inWeight(v);
+    }
+
+    std::vector<uint32_t> refined(n), size(n, 1);
+    std::iota(refined.begin(), refined.end(), 0u);
+    std::vector<double> rOut(n), rIn(n), external(n, 0.0);
+    ParallelFor::run<256>(n, opts.threads, [&](size_t v) {
+      rOut[v] = g.outWeight(static_cast<uint32_t>(v));
+      rIn[v] = g.inWeight(static_cast<uint32_t>(v));
+      for (uint64_t e = g.begin(static_cast<uint32_t>(v));
+           e < g.end(static_cast<uint32_t>(v)); ++e)
+        if (comm[g.neighborAt(e)] == comm[v])
+          external[v] += g.weightAt(e);
+    });
+    // A subset S of community c is well connected if its links to the
+    // rest of c are at least what the null model expects.
+    auto wellConnected = [&](uint32_t s, uint32_t c) {
+      return external[s] >= gamma *
+                                (rOut[s] * (cIn[c] - rIn[s]) +
+                                 rIn[s] * (cOut[c] - rOut[s])) /
+                                m;
+    };
+
+    ParallelFor::run<256>(communities, opts.threads, [&](size_t c) {
+      std::vector<double> &weight = weightScratch(n);
+      std::vector<uint32_t> &touched = touchedScratch();
+      const uint32_t cid = static_cast<uint32_t>(c);
+      for (uint32_t i = start[c]; i < start[c + 1]; ++i) {
+        const uint32_t v = members[i];
+        if (refined[v] != v || size[v] != 1 || !wellConnected(v, cid))
+          continue;
+        for (uint64_t e = g.begin(v); e < g.end(v); ++e) {
+          const uint32_t u = g.neighborAt(e);
+          if (comm[u] != cid || refined[u] == v)
+            continue;
+          if (weight[refined[u]] == 0)
+            touched.push_back(refined[u]);
+          weight[refined[u]] += g.weightAt(e);
+        }
+        uint32_t best = v;
+        double bestGain = 0;
+        for (uint32_t s : touched) {
+          if (!wellConnected(s, cid))
+            continue;
+          double gain = weight[s] - gamma *
+                                        (g.outWeight(v) * rIn[s] +
+                                         g.inWeight(v) * rOut[s]) /
+                                        m;
+          if (gain >= bestGain && (best == v || gain > bestGain)) {
+            bestGain = gain;
+            best = s;
+          }
+        }
+        if (best != v) {
+          external[best] += external[v] - 2 * weight[best];
+          rOut[best] += rOut[v];
+          rIn[best] += rIn[v];
+          size[best] += 1;
+          size[v] = 0;
+          refined[v] = best;
+        }
+        for (uint32_t s : touched)
+          weight[s] = 0;
+        touched.clear();
+      }
+    });
+    return refined;
+  }
+
+  /**
+   * @brief Phase 3, aggregation: one node per group of `group`, with the
+   * weights between groups summed and the weight inside a group folded
+   * into its self-loop. Each group is merged into a slot sized by its
+   * members' degrees, then the slots are compacted.
+   */
+  WeightedGraph aggregateBy(const WeightedGraph &g,
+                            const std::vector<uint32_t> &group,
+                            size_t groups) const {
+    const size_t n = g.nodeCount();
+    std::vector<uint32_t> start(groups + 1, 0), members(n);
+    std::vector<uint64_t> slot(groups + 1, 0);
+    for (uint32_t v = 0; v < n; ++v) {
+      start[group[v] + 1]++;
+      slot[group[v] + 1] += g.end(v) - g.begin(v);
+    }
+    for (size_t k = 0; k < groups; ++k) {
+      start[k + 1] += start[k];
+      slot[k + 1] += slot[k];
+    }
+    std::vector<uint32_t> cursor(start.begin(), start.end() - 1);
+    for (uint32_t v = 0; v < n; ++v)
+      members[cursor[group[v]]++] = v;
+
+    WeightedGraph out;
+    out.total = g.total;
+    out.outStrength.assign(groups, 0.0);
+    out.inStrength.assign(groups, 0.0);
+    out.selfWeight.assign(groups, 0.0);
+    out.offsets.assign(groups + 1, 0);
+    std::vector<uint32_t> slotNeighbors(slot[groups]);
+    std::vector<double> slotWeights(slot[groups]);
+    ParallelFor::run<256>(groups, opts.threads, [&](size_t k) {
+      std::vector<double> &weight = weightScratch(groups);
+      std::vector<uint32_t> &touched = touchedScratch();
+      double inside = 0;
+      for (uint32_t i = start[k]; i < start[k + 1]; ++i) {
+        const uint32_t v = members[i];
+        out.outStrength[k] += g.outWeight(v);
+        out.inStrength[k] += g.inWeight(v);
+        out.selfWeight[k] += g.selfLoop(v);
+        for (uint64_t e = g.begin(v); e < g.end(v); ++e) {
+          const uint32_t h = group[g.neighborAt(e)];
+          if (h == k) {
+            inside += g.weightAt(e);
+            continue;
+          }
+          if (weight[h] == 0)
+            touched.push_back(h);
+          weight[h] += g.weightAt(e);
+        }
+      }
+      out.selfWeight[k] += inside / 2; // Each pair seen from both ends
+      uint64_t pos = slot[k];
+      for (uint32_t h : touched) {
+        slotNeighbors[pos] = h;
+        slotWeights[pos++] = weight[h];
+        weight[h] = 0;
+      }
+      out.offsets[k + 1] = touched.size();
+      touched.clear();
+    });
+    for (size_t k = 0; k < groups; ++k)
+      out.offsets[k + 1] += out.offsets[k];
+    out.neighbors.resize(out.offsets[groups]);
+    out.weights.resize(out.offsets[groups]);
+    ParallelFor::run<256>(groups, opts.threads, [&](size_t k) {
+      const uint64_t degree = out.offsets[k + 1] - out.offsets[k];
+      std::copy_n(slotNeighbors.begin() + slot[k], degree,
+                  out.neighbors.begin() + out.offsets[k]);
+      std::copy_n(slotWeights.begin() + slot[k], degree,
+                  out.weights.begin() + out.offsets[k]);
+    });
+    return out;
+  }
+
+  /**
+   * @brief Maps community IDs onto [0, count) in order of first
+   * appearance.
+   * @return The number of communities.
+   */
+  static size_t renumber(std::vector<uint32_t> &ids) {
+    uint32_t bound = 0;
+    for (uint32_t id : ids)
+      bound = std::max(bound, id + 1);
+    std::vector<uint32_t> dense(bound, NEW_COMMUNITY);
+    uint32_t next = 0;
+    for (uint32_t &id : ids) {
+      if (dense[id] == NEW_COMMUNITY)
+        dense[id] = next++;
+      id = dense[id];
+    }
+    return next;
+  }
+
+  /**
+   * @brief Renumbers communities by decreasing size, ties by first node.
+   * @return The number of communities.
+   */
+  static size_t renumberBySize(std::vector<uint32_t> &ids) {
+    const size_t count = renumber(ids); // First appearance breaks ties
+    std::vector<uint32_t> size(count, 0);
+    for (uint32_t id : ids)
+      size[id]++;
+    std::vector<uint32_t> bySize(count);
+    std::iota(bySize.begin(), bySize.end(), 0u);
+    std::stable_sort(bySize.begin(), bySize.end(), [&](uint32_t a, uint32_t b) {
+      return size[a] > size[b];
+    });
+    std::vector<uint32_t> rank(count);
+    for (uint32_t r = 0; r < count; ++r)
+      rank[bySize[r]] = r;
+    for (uint32_t &id : ids)
+      id = rank[id];
+    return count;
+  }
+
+  /**
+   * @brief Per-thread accumulator, all zero between uses.
+   */
+  static std::vector<double> &weightScratch(size_t n) {
+    static thread_local std::vector<double> weight;
+    if (weight.size() < n)
+      weight.resize(n, 0.0);
+    return weight;
+  }
+
+  static std::vector<uint32_t> &touchedScratch() {
+    static thread_local std::vector<uint32_t> touched;
+    return touched;
+  }
+};
@@ -1,8 +1,10 @@
 import igraph as ig
 import leidenalg as la
 import pandas as pd
+import hashlib
 import json
 import os
+import shutil
 
 class LeidenEngine:
     """
@@ -56,6 +58,111 @@ class LeidenEngine:
 
         return community_map
 
+    def cluster_incremental(self, projection_path, previous_map,
+                            previous_projection_path=None, touched_nodes=None):
+        """
+        Re-clusters only the communities a graph delta touched.
+
+        Touched nodes are the endpoints of projection edges that were added,
+        removed or re-weighted since previous_projection_path (or the given
+        touched_nodes, e.g. IncrementalLoader's), plus nodes missing from
+        previous_map. At each level, their previous communities are freed;
+        every other node keeps its community fixed (leidenalg's
+        is_membership_fixed), so untouched communities keep their IDs.
+        Returns (community_map, delta), where delta lists the changed
+        communities per level for TopologyFilter and DriftDetector.
+        """
+        print(f"Loading weighted projection from {projection_path}...")
+        df = pd.read_csv(projection_path)
+
+        # 1. Find the touched nodes
+        if touched_nodes is None:
+            touched_nodes = set()
+            if previous_projection_path and os.path.exists(previous_projection_path):
+                keys = ['source', 'target', 'weight']
+                before = pd.read_csv(previous_projection_path)[keys]
+                diff = pd.concat([before, df[keys]]).drop_duplicates(keep=False)
+                touched_nodes.update(diff['source'].astype(int).astype(str))
+                touched_nodes.update(diff['target'].astype(int).astype(str))
+        touched_nodes = {str(n) for n in touched_nodes}
+
+        # 2. Build Graph
+        tuples = [tuple(x) for x in df[['source', 'target', 'weight']].values]
+        g = ig.Graph.TupleList(tuples, directed=True, edge_attrs=['weight'])
+        names = [str(int(name)) for name in g.vs['name']]
+        touched_nodes.update(n for n in names if n not in previous_map)
+        print(f"{len(touched_nodes)} of {len(names)} nodes touched by the delta.")
+
+        # 3. Re-optimize each level with untouched communities fixed
+        community_map = {n: {} for n in names}
+        delta = {"touched_nodes": sorted(touched_nodes, key=int)}
+        for level, resolution in (("macro_community", self.res_macro),
+                                  ("micro_community", self.res_micro)):
+            previous = {n: meta[level] for n, meta in previous_map.items()}
+            freed = {previous[n] for n in touched_nodes if n in previous}
+            fresh = max(previous.values(), default=-1) + 1
+            initial, fixed = [], []
+            for n in names:
+                if n in previous and previous[n] not in freed:
+                    initial.append(previous[n])
+                    fixed.append(True)
+                else:
+                    initial.append(fresh)  # Singleton until optimised
+                    fixed.append(False)
+                    fresh += 1
+            partition = la.RBConfigurationVertexPartition(
+                g,
+                weights='weight',
+                resolution_parameter=resolution,
+                initial_membership=initial
+            )
+            la.Optimiser().optimise_partition(partition, is_membership_fixed=fixed)
+
+            # Communities holding a fixed node keep its ID; the others take
+            # freed IDs first, then fresh ones.
+            labels = {}
+            for idx, k in enumerate(partition.membership):
+                if fixed[idx]:
+                    labels[k] = initial[idx]
+            reusable = sorted(freed - set(labels.values()))
+            next_id = max(previous.values(), default=-1) + 1
+            changed = set(freed)
+            for idx, k in enumerate(partition.membership):
+                if k not in labels:
+                    if reusable:
+                        labels[k] = reusable.pop(0)
+                    else:
+                        labels[k] = next_id
+                        next_id += 1
+                if not fixed[idx]:
+                    changed.add(labels[k])
+                community_map[names[idx]][level] = labels[k]
+            delta[level] = sorted(changed)
+            print(f"{level}: {len(changed)} communities changed.")
+
+        return community_map, delta
+
+    @staticmethod
+    def file_digest(path):
+        """SHA-256 of a file's bytes, tying a delta to the maps it describes."""
+        with open(path, 'rb') as f:
+            return hashlib.sha256(f.read()).hexdigest()
+
+    def save_community_delta(self, delta, output_path, previous_map_digest, map_path):
+        """
+        Persists the changed communities of cluster_incremental to JSON.
+
+        The delta only describes the step from the previous map to the
+        saved one, so both digests are stored with it; consumers ignore a
+        delta whose maps do not match theirs.
+        """
+        os.makedirs(os.path.dirname(output_path), exist_ok=True)
+        delta = dict(delta, previous_map_sha256=previous_map_digest,
+                     map_sha256=self.file_digest(map_path))
+        with open(output_path, 'w') as f:
+            json.dump(delta, f, indent=4)
+        print(f"Community delta persisted to {output_path}")
+
     def save_community_map(self, community_map, output_path):
         """Persists the node->community mapping to JSON."""
         os.makedirs(os.path.dirname(output_path), exist_ok=True)
@@ -69,13 +176,31 @@ if __name__ == "__main__":
     
     # Check if projection file exists
     proj_file = "data/processed/weighted_projection.csv"
+    map_file = "data/processed/community_map.json"
+    prev_proj_file = "data/processed/weighted_projection_previous.csv"
+    delta_file = "data/processed/community_delta.json"
     if os.path.exists(proj_file):
-        cmap = engine.cluster(proj_file)
+        delta = None
+        if os.path.exists(map_file) and os.path.exists(prev_proj_file):
+            # Later runs only re-cluster what changed since the last projection
+            previous_digest = engine.file_digest(map_file)
+            with open(map_file, 'r') as f:
+                previous_map = json.load(f)
+            cmap, delta = engine.cluster_incremental(proj_file, previous_map, prev_proj_file)
+        else:
+            cmap = engine.cluster(proj_file)
         
         print("\n--- Clustering Results ---")
         for node, meta in cmap.items():
             print(f"Node {node} | Macro: {meta['macro_community']} | Micro: {meta['micro_community']}")
             
-        engine.save_community_map(cmap, "data/processed/community_map.json")
+        engine.save_community_map(cmap, map_file)
+        if delta is not None:
+            engine.save_community_delta(delta, delta_file, previous_digest, map_file)
+        elif os.path.exists(delta_file):
+            # A full run renumbers communities; an older delta would hide drift
+            os.remove(delta_file)
+        # The next run diffs against this projection
+        shutil.copyfile(proj_file, prev_proj_file)
     else:
         print(f"Error: Projection file {proj_file} not found. Run Projector.py first.")
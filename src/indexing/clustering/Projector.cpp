@@ -0,0 +1,160 @@
+#include "Leiden.hpp"
+#include "Projector.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+static double msSince(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - t)
+      .count();
+}
+
+/**
+ * @brief Embedder.py-shaped output: row r is a noisy copy of topic
+ * r % topics, so rows of one topic sit near cosine 0.89 of each other.
+ */
+static void writeCorpus(const std::string &base, size_t rows, size_t dim,
+                        size_t topics, uint64_t firstId) {
+  std::mt19937_64 gen(3);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  std::vector<float> centers(topics * dim);
+  for (float &c : centers)
+    c = noise(gen);
+  std::vector<float> data(rows * dim);
+  for (size_t r = 0; r < rows; ++r)
+    for (size_t d = 0; d < dim; ++d)
+      data[r * dim + d] = centers[(r % topics) * dim + d] + 0.35f * noise(gen);
+  EmbeddingMatrix::write(base + ".npy", data.data(), rows, dim);
+  std::ofstream meta(base + ".json");
+  meta << "[\n";
+  for (size_t r = 0; r < rows; ++r)
+    meta << "    {\"id\": " << firstId + r << "}"
+         << (r + 1 < rows ? ",\n" : "\n");
+  meta << "]\n";
+}
+
+int main(int argc, char **argv) {
+  const size_t rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  const size_t dim = 384, topics = rows / 20;
+  const uint64_t firstId = 1;
+  const std::string dir = (std::filesystem::temp_directory_path() /
+                           ("projector_" + std::to_string(::getpid())))
+                              .string();
+  std::filesystem::create_directories(dir);
+  const std::string base = dir + "/knowledge_vectors";
+  writeCorpus(base, rows, dim, topics, firstId);
+
+  std::string error;
+  auto matrix = EmbeddingMatrix::open(base + ".npy", &error);
+  std::vector<uint64_t> ids;
+  if (!matrix ||
+      !EmbeddingMatrix::readMetadataIds(base + ".json", "id", ids, &error)) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  // The causal graph over the same chunks: CAUSES edges inside a topic,
+  // PRECEDES edges (not projected by default) anywhere.
+  GraphEngine engine;
+  for (uint64_t id : ids)
+    engine.addNode(id, "EVENT");
+  std::mt19937_64 gen(4);
+  uint64_t edgeId = 0;
+  for (size_t r = 0; r < rows; ++r) {
+    size_t peer = (r + topics * (1 + gen() % 19)) % rows;
+    engine.addEdge(++edgeId, ids[r], ids[peer], "CAUSES", 0.9f);
+    engine.addEdge(++edgeId, ids[r], ids[gen() % rows], "PRECEDES");
+  }
+  auto snapshot = engine.snapshot();
+
+  std::cout << "--- Graph Projection: " << rows << " x " << dim << ", "
+            << VectorKernels::kernelName() << " kernels ---" << std::endl;
+
+  // What the Python double loop does, in C++: one cosine per pair,
+  // measured on a slice and scaled to all n^2 / 2 pairs.
+  const size_t slice = std::min<size_t>(rows, 2000);
+  auto t = std::chrono::steady_clock::now();
+  size_t slicePairs = 0;
+  for (size_t i = 0; i < slice; ++i)
+    for (size_t j = i + 1; j < slice; ++j) {
+      const float *a = matrix->row(i), *b = matrix->row(j);
+      double dot = 0, na = 0, nb = 0;
+      for (size_t d = 0; d < dim; ++d) {
+        dot += a[d] * b[d];
+        na += a[d] * a[d];
+        nb += b[d] * b[d];
+      }
+      slicePairs += dot / std::sqrt(na * nb) >= 0.85;
+    }
+  const double pairLoopMs =
+      msSince(t) * (double(rows) * rows) / (double(slice) * slice);
+  std::printf("Per-pair loop (scaled from %zu rows): ~%.0f ms\n", slice,
+              pairLoopMs);
+
+  GraphProjector::Projection exact, approx;
+  GraphProjector::Options opts;
+  opts.method = GraphProjector::Method::EXACT;
+  t = std::chrono::steady_clock::now();
+  if (!GraphProjector(opts).project(*snapshot, *matrix, ids, exact, &error)) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  std::printf("EXACT tiled:  %7.0f ms, %zu structural + %zu semantic edges\n",
+              msSince(t), exact.structural, exact.semantic);
+
+  opts.method = GraphProjector::Method::ANN;
+  t = std::chrono::steady_clock::now();
+  GraphProjector(opts).project(*snapshot, *matrix, ids, approx);
+  size_t recovered = 0;
+  auto key = [](const WeightedGraph::Edge &e) {
+    return uint64_t(e.src) << 32 | e.tgt;
+  };
+  std::unordered_map<uint64_t, float> exactEdges;
+  for (size_t i = exact.structural; i < exact.edges.size(); ++i)
+    exactEdges[key(exact.edges[i])] = exact.edges[i].weight;
+  for (size_t i = approx.structural; i < approx.edges.size(); ++i)
+    recovered += exactEdges.count(key(approx.edges[i]));
+  std::printf("ANN (HNSW):   %7.0f ms, %zu semantic edges, recall %.3f, "
+              "precision %.3f\n",
+              msSince(t), approx.semantic,
+              double(recovered) / std::max<size_t>(1, exact.semantic),
+              double(recovered) / std::max<size_t>(1, approx.semantic));
+
+  // Straight into community detection: no CSV in between.
+  t = std::chrono::steady_clock::now();
+  WeightedGraph projection = exact.graph(snapshot->nodeCount());
+  Leiden::Partition p = Leiden().run(projection, 1.0);
+  std::vector<uint32_t> topic(rows);
+  for (size_t r = 0; r < rows; ++r)
+    topic[snapshot->indexOfNode(ids[r])] = static_cast<uint32_t>(r % topics);
+  std::unordered_map<uint64_t, uint32_t> overlap;
+  std::unordered_map<uint32_t, uint32_t> majority;
+  for (size_t v = 0; v < rows; ++v) {
+    uint32_t c = ++overlap[uint64_t(p.membership[v]) << 32 | topic[v]];
+    majority[p.membership[v]] = std::max(majority[p.membership[v]], c);
+  }
+  size_t agree = 0;
+  for (const auto &entry : majority)
+    agree += entry.second;
+  std::printf("Leiden on the projection: %zu communities for %zu topics, "
+              "purity %.3f, %.0f ms\n",
+              p.communities, topics, double(agree) / rows, msSince(t));
+
+  // The CSV Projector.py writes, for the Python stages that still read it.
+  const std::string csv = dir + "/weighted_projection.csv";
+  GraphProjector::writeCsv(csv, *snapshot, exact);
+  std::cout << "weighted_projection.csv: "
+            << std::filesystem::file_size(csv) / 1e6 << " MB" << std::endl;
+  std::filesystem::remove_all(dir);
+  return 0;
+}
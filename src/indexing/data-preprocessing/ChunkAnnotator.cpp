@@ -0,0 +1,129 @@
+#include "ChunkAnnotator.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static bool sameAs(const ChunkAnnotator::Annotation &a,
+                   const VersionResolver::ApplicabilityContext &v,
+                   const TemporalAnnotator::TemporalSignal &t,
+                   const std::vector<NegationTagger::Constraint> &c) {
+  if (a.version.rfcNumber != v.rfcNumber ||
+      a.version.obsoletes != v.obsoletes || a.version.updates != v.updates ||
+      a.version.osVersions != v.osVersions ||
+      a.version.hardwarePlatforms != v.hardwarePlatforms)
+    return false;
+  if (a.temporal.dateStr != t.dateStr || a.temporal.status != t.status ||
+      a.temporal.stabilityScore != t.stabilityScore ||
+      a.temporal.yearsOld != t.yearsOld)
+    return false;
+  if (a.constraints.size() != c.size())
+    return false;
+  for (size_t i = 0; i < c.size(); ++i)
+    if (a.constraints[i].type != c[i].type ||
+        a.constraints[i].phrase != c[i].phrase)
+      return false;
+  return true;
+}
+
+static std::vector<std::string> makeChunks(size_t count, uint64_t seed) {
+  static const char *sentences[] = {
+      "RFC 4271 - A Border Gateway Protocol 4 (BGP-4). ",
+      "Obsoletes: RFC 1771. Updates: RFC 1654. ",
+      "Category: Standards Track, Proposed Standard. ",
+      "In IOS-XR 7.1.1, the Jericho2 linecard supports enhanced BGP-LS. ",
+      "Not applicable for NCS-5500 with older ASICs. ",
+      "The BGP speaker MUST NOT send a NOTIFICATION if the session is Idle. ",
+      "This knob is DEPRECATED and NOT SUPPORTED on JunOS 21.4. ",
+      "Published January 2006; see Internet-Draft revisions. ",
+      "Routers SHOULD NOT reset the session unless the hold timer expires. ",
+      "The peer applies the route to the RIB and advertises it to neighbors. ",
+      "Hold Timer processing is described in Section 6.5 of this document. "};
+  const size_t kinds = sizeof(sentences) / sizeof(sentences[0]);
+  std::mt19937_64 gen(seed);
+  std::vector<std::string> chunks(count);
+  for (std::string &chunk : chunks)
+    for (size_t s = 0; s < 12; ++s)
+      chunk += sentences[gen() % kinds];
+  return chunks;
+}
+
+template <typename Fn> static double millis(Fn &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  std::chrono::duration<double, std::milli> d =
+      std::chrono::steady_clock::now() - start;
+  return d.count();
+}
+
+int main() {
+  VersionResolver resolver;
+  TemporalAnnotator temporal;
+  NegationTagger tagger;
+  ChunkAnnotator combined;
+
+  std::string chunk =
+      "RFC 4271 (January 2006), Proposed Standard. Obsoletes: RFC 1771. "
+      "In IOS-XR 7.1.1 the Jericho2 linecard MUST NOT be used, UNLESS the "
+      "DEPRECATED knob is set.";
+  std::cout << "--- Combined Chunk Annotation ---" << std::endl;
+  auto a = combined.annotate(chunk);
+  resolver.printContext(a.version);
+  temporal.printResults(a.temporal);
+  tagger.printResults(a.constraints);
+
+  std::vector<std::string> chunks = makeChunks(2000, 7);
+  size_t mismatches = 0;
+  for (const std::string &c : chunks)
+    if (!sameAs(combined.annotate(c), resolver.resolve(c),
+                temporal.annotate(c), tagger.scan(c)))
+      ++mismatches;
+
+  // Baseline: what each call used to do, compiling its patterns every time.
+  const std::vector<const char *> allPatterns = {
+      VersionResolver::RFC_PATTERN,
+      VersionResolver::OBSOLETES_PATTERN,
+      VersionResolver::UPDATES_PATTERN,
+      VersionResolver::OS_PATTERN,
+      VersionResolver::HARDWARE_PATTERN,
+      TemporalAnnotator::DATE_PATTERN,
+      TemporalAnnotator::INTERNET_STANDARD_PATTERN,
+      TemporalAnnotator::PROPOSED_STANDARD_PATTERN,
+      TemporalAnnotator::DRAFT_PATTERN,
+      NegationTagger::PROHIBITION_PATTERN,
+      NegationTagger::DEPRECATION_PATTERN,
+      NegationTagger::EXCEPTION_PATTERN};
+  const size_t sample = 200;
+  double compileMs = millis([&] {
+    for (size_t i = 0; i < sample; ++i)
+      for (const char *p : allPatterns)
+        std::regex(p, std::regex_constants::icase);
+  }) * chunks.size() / sample;
+  double separateMs = millis([&] {
+    for (const std::string &c : chunks) {
+      resolver.resolve(c);
+      temporal.annotate(c);
+      tagger.scan(c);
+    }
+  });
+  double combinedMs = millis([&] {
+    for (const std::string &c : chunks)
+      combined.annotate(c);
+  });
+
+  std::cout << "\n--- Benchmark: " << chunks.size() << " chunks ---"
+            << std::endl;
+  std::printf("  per-call compile (old)   : %8.1f ms + scans\n", compileMs);
+  std::printf("  cached, three scans      : %8.1f ms\n", separateMs);
+  std::printf("  cached, combined scan    : %8.1f ms\n", combinedMs);
+  std::printf("  registry patterns        : %8zu\n", PatternRegistry::size());
+  std::cout << "  results "
+            << (mismatches ? "DIFFER on " + std::to_string(mismatches) +
+                                 " chunks"
+                           : std::string("match"))
+            << std::endl;
+  return mismatches ? 1 : 0;
+}
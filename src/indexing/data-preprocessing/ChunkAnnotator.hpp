@@ -0,0 +1,198 @@
+#pragma once
+
+#include "NegationTagger.hpp"
+#include "PatternRegistry.hpp"
+#include "TemporalAnnotator.hpp"
+#include "VersionResolver.hpp"
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <regex>
+#include <string>
+#include <vector>
+
+/**
+ * @class ChunkAnnotator
+ * @brief Version, temporal and negation signals from one scan of a chunk.
+ *
+ * Run separately, the three annotators make twelve regex searches over the
+ * chunk. Every one of those patterns begins with a literal keyword (RFC,
+ * a month, MUST NOT, Jericho...), so a match can only start where one of
+ * the keywords occurs, ignoring case. A single walk tries a keyword trie at
+ * each position and runs the owning pattern, anchored, only there. The
+ * patterns are the annotators' own, shared through PatternRegistry, so the
+ * result is exactly what resolve(), annotate() and scan() return.
+ *
+ * Patterns that only need a first match (RFC number, date) or a yes/no
+ * (document status) drop out once satisfied. The others keep a resume
+ * offset to stay non-overlapping, like sregex_iterator.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: One pass, and the backtracking engine only runs at keyword hits
+ *   instead of being retried at every offset for every pattern.
+ * - CON: Keywords must be kept in sync with the patterns: a pattern whose
+ *   match can start with something other than its keywords would be
+ *   missed here.
+ */
+class ChunkAnnotator {
+public:
+  struct Annotation {
+    VersionResolver::ApplicabilityContext version;
+    TemporalAnnotator::TemporalSignal temporal;
+    std::vector<NegationTagger::Constraint> constraints;
+  };
+
+  ChunkAnnotator() {
+    nodes.emplace_back();
+    addSlot(RFC, VersionResolver::RFC_PATTERN, {"rfc"});
+    addSlot(OBSOLETES, VersionResolver::OBSOLETES_PATTERN, {"obsoletes:"});
+    addSlot(UPDATES, VersionResolver::UPDATES_PATTERN, {"updates:"});
+    addSlot(OS, VersionResolver::OS_PATTERN,
+            {"ios-xr", "junos", "cisco", "nx-os"});
+    addSlot(HARDWARE, VersionResolver::HARDWARE_PATTERN,
+            {"jericho", "trident", "ncs-", "asr-", "linecard", "asic"});
+    addSlot(DATE, TemporalAnnotator::DATE_PATTERN,
+            {"january", "february", "march", "april", "may", "june", "july",
+             "august", "september", "october", "november", "december"});
+    addSlot(INTERNET_STANDARD, TemporalAnnotator::INTERNET_STANDARD_PATTERN,
+            {"internet standard"});
+    addSlot(PROPOSED_STANDARD, TemporalAnnotator::PROPOSED_STANDARD_PATTERN,
+            {"proposed standard"});
+    addSlot(DRAFT, TemporalAnnotator::DRAFT_PATTERN,
+            {"draft", "internet-draft"});
+    addSlot(PROHIBITION, NegationTagger::PROHIBITION_PATTERN,
+            {"must not", "should not", "not supported", "never", "do not"});
+    addSlot(DEPRECATION, NegationTagger::DEPRECATION_PATTERN,
+            {"deprecated", "obsolete", "legacy", "discontinued"});
+    addSlot(EXCEPTION, NegationTagger::EXCEPTION_PATTERN,
+            {"except", "unless", "not applicable", "with the exception of"});
+  }
+
+  /**
+   * @brief Same result as VersionResolver::resolve,
+   * TemporalAnnotator::annotate and NegationTagger::scan on text.
+   */
+  Annotation annotate(const std::string &text) const {
+    Annotation out;
+    std::string date;
+    std::array<bool, SLOTS> done{};
+    std::array<size_t, SLOTS> resume{};
+    std::vector<NegationTagger::Constraint> negations[3];
+    std::smatch m;
+
+    const size_t n = text.size();
+    for (size_t i = 0; i < n; ++i) {
+      uint16_t hits = 0;
+      int32_t node = 0;
+      for (size_t j = i; j < n; ++j) {
+        unsigned char c = static_cast<unsigned char>(text[j]);
+        if (c >= 128 || (node = nodes[node].next[lower(c)]) < 0)
+          break;
+        hits |= nodes[node].slots;
+      }
+      for (unsigned s = 0; hits; ++s, hits >>= 1) {
+        if (!(hits & 1) || done[s] || i < resume[s])
+          continue;
+        auto flags = std::regex_constants::match_continuous;
+        if (i > 0)
+          flags |= std::regex_constants::match_prev_avail;
+        if (!std::regex_search(text.begin() + i, text.end(), m, *patterns[s],
+                               flags))
+          continue;
+        resume[s] = i + static_cast<size_t>(m.length(0));
+        switch (static_cast<Slot>(s)) {
+        case RFC:
+          out.version.rfcNumber = m[1].str();
+          break;
+        case OBSOLETES:
+          out.version.obsoletes = m[1].str();
+          break;
+        case UPDATES:
+          out.version.updates = m[1].str();
+          break;
+        case OS:
+          out.version.osVersions.insert(m.str());
+          break;
+        case HARDWARE:
+          out.version.hardwarePlatforms.insert(m.str());
+          break;
+        case DATE:
+          date = m.str();
+          break;
+        case PROHIBITION:
+          negations[0].push_back({"PROHIBITION", m.str(), true});
+          break;
+        case DEPRECATION:
+          negations[1].push_back({"DEPRECATION", m.str(), false});
+          break;
+        case EXCEPTION:
+          negations[2].push_back({"EXCEPTION", m.str(), false});
+          break;
+        default: // Status patterns only need to occur
+          break;
+        }
+        done[s] = !collectsAll(static_cast<Slot>(s));
+      }
+    }
+
+    out.temporal = TemporalAnnotator::fromMatches(
+        date, done[INTERNET_STANDARD], done[PROPOSED_STANDARD], done[DRAFT]);
+    for (auto &group : negations)
+      out.constraints.insert(out.constraints.end(), group.begin(),
+                             group.end());
+    return out;
+  }
+
+private:
+  enum Slot : uint8_t {
+    RFC,
+    OBSOLETES,
+    UPDATES,
+    OS,
+    HARDWARE,
+    DATE,
+    INTERNET_STANDARD,
+    PROPOSED_STANDARD,
+    DRAFT,
+    PROHIBITION,
+    DEPRECATION,
+    EXCEPTION,
+    SLOTS
+  };
+
+  struct Node {
+    std::array<int32_t, 128> next;
+    uint16_t slots = 0; // Slots with a keyword ending here
+    Node() { next.fill(-1); }
+  };
+
+  std::vector<Node> nodes;
+  std::array<const std::regex *, SLOTS> patterns{};
+
+  // The rest need only their first match, or only to occur.
+  static bool collectsAll(Slot s) {
+    return s == OS || s == HARDWARE || s >= PROHIBITION;
+  }
+
+  static unsigned char lower(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+  }
+
+  void addSlot(Slot slot, const char *pattern,
+               std::initializer_list<const char *> keywords) {
+    patterns[slot] = &PatternRegistry::icase(pattern);
+    for (const char *keyword : keywords) {
+      int32_t node = 0;
+      for (const char *k = keyword; *k; ++k) {
+        unsigned char c = static_cast<unsigned char>(*k);
+        if (nodes[node].next[c] < 0) {
+          nodes[node].next[c] = static_cast<int32_t>(nodes.size());
+          nodes.emplace_back();
+        }
+        node = nodes[node].next[c];
+      }
+      nodes[node].slots |= static_cast<uint16_t>(1u << slot);
+    }
+  }
+};
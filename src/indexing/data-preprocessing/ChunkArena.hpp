@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+/**
+ * @class ChunkArena
+ * @brief Monotonic memory for the results of one chunk (or one batch),
+ * released all at once by reset().
+ *
+ * The arena-taking overloads of DeterministicExtractor, VersionResolver,
+ * NegationTagger and Disambiguator put their result vectors, strings,
+ * sets and regex match state here. Allocation is a pointer bump and
+ * deallocation a no-op, so a chunk costs no malloc/free pairs.
+ *
+ * A monotonic_buffer_resource falls back to the heap once its buffer is
+ * full. reset() then grows the buffer to the high-water mark, so after a
+ * few chunks of steady input every chunk fits and the heap is never
+ * touched again.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: One reset() frees everything; no per-object destructor work.
+ * - CON: Anything allocated here dies at reset(). Results must be copied
+ *   out (or fully consumed) before the next chunk.
+ * - CON: Memory is held at the high-water mark of the largest chunk
+ *   seen. Not thread-safe: use one arena per worker.
+ */
+class ChunkArena {
+public:
+  explicit ChunkArena(size_t initialBytes = 64 << 10) : buffer(initialBytes) {
+    rebuild();
+  }
+
+  ChunkArena(const ChunkArena &) = delete;
+  ChunkArena &operator=(const ChunkArena &) = delete;
+
+  std::pmr::memory_resource *resource() { return &*pool; }
+
+  /**
+   * @brief Frees everything allocated since the last reset. Containers
+   * using the arena must be destroyed first, or never touched again.
+   */
+  void reset() {
+    size_t used = buffer.size() + upstream.bytes;
+    if (upstream.bytes)
+      buffer.resize(used + used / 4);
+    rebuild();
+  }
+
+  size_t capacity() const { return buffer.size(); }
+
+  /**
+   * @brief Heap blocks taken since the last reset (0 once warmed up).
+   */
+  size_t overflowAllocations() const { return upstream.allocations; }
+
+private:
+  /**
+   * @brief Heap fallback that records how far the buffer overflowed.
+   */
+  struct Upstream : std::pmr::memory_resource {
+    size_t bytes = 0;
+    size_t allocations = 0;
+
+    void *do_allocate(size_t size, size_t align) override {
+      bytes += size;
+      ++allocations;
+      return std::pmr::new_delete_resource()->allocate(size, align);
+    }
+    void do_deallocate(void *p, size_t size, size_t align) override {
+      std::pmr::new_delete_resource()->deallocate(p, size, align);
+    }
+    bool do_is_equal(const memory_resource &other) const noexcept override {
+      return this == &other;
+    }
+  };
+
+  std::vector<std::byte> buffer;
+  Upstream upstream;
+  std::optional<std::pmr::monotonic_buffer_resource> pool;
+
+  void rebuild() {
+    pool.reset(); // Returns the overflow blocks to the heap
+    upstream.bytes = 0;
+    upstream.allocations = 0;
+    pool.emplace(buffer.data(), buffer.size(), &upstream);
+  }
+};
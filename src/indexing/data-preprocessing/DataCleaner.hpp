@@ -0,0 +1,95 @@
+#pragma once
+
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Production-grade Data Cleaner for Networking Documents.
+ * Focuses on stripping RFC boilerplate and normalizing technical terminology.
+ */
+class DataCleaner {
+public:
+  DataCleaner() {
+    // Initialize common networking acronym expansion map
+    acronymMap = {{"BGP", "Border Gateway Protocol"},
+                  {"RFC", "Request for Comments"},
+                  {"FSM", "Finite State Machine"},
+                  {"RIB", "Routing Information Base"},
+                  {"MTU", "Maximum Transmission Unit"},
+                  {"AS", "Autonomous System"}};
+  }
+
+  /**
+   * @brief Performs a full cleaning pass on raw technical text.
+   */
+  std::string clean(const std::string &rawText) {
+    std::string text = rawText;
+
+    text = stripRFCBoilerplate(text);
+    text = normalizeWhitespace(text);
+    text = expandAcronyms(text);
+
+    return text;
+  }
+
+  /**
+   * @brief The acronym expansion table, e.g. for compiling into a fused
+   * engine.
+   */
+  const std::unordered_map<std::string, std::string> &acronyms() const {
+    return acronymMap;
+  }
+
+private:
+  std::unordered_map<std::string, std::string> acronymMap;
+
+  /**
+   * @brief Strips RFC headers, footers, and page markers.
+   * Matches patterns like "[Page 1]", "RFC 4271 ... January 2006", etc.
+   */
+  std::string stripRFCBoilerplate(const std::string &input) {
+    // Pattern 1: Page markers like [Page 12]
+    std::regex pagePattern(R"(\[Page\s+\d+\])");
+    std::string result = std::regex_replace(input, pagePattern, "");
+
+    // Pattern 2: Typical RFC Header/Footer lines
+    // e.g., "RFC 4271              BGP-4                 January 2006"
+    // and "Rekhter, et al.         Standards Track"
+    std::regex rfcLines(
+        R"(RFC\s+\d+.*[12][0-9]{3}|.*Standards Track.*|.*Category:.*|.*Informational.*)");
+    result = std::regex_replace(result, rfcLines, "");
+
+    return result;
+  }
+
+  /**
+   * @brief Collapses multiple spaces/newlines and trims.
+   */
+  std::string normalizeWhitespace(const std::string &input) {
+    std::regex spacePattern(R"(\s+)");
+    std::string result = std::regex_replace(input, spacePattern, " ");
+
+    // Trim
+    size_t first = result.find_first_not_of(' ');
+    if (std::string::npos == first)
+      return "";
+    size_t last = result.find_last_not_of(' ');
+    return result.substr(first, (last - first + 1));
+  }
+
+  /**
+   * @brief Simple dictionary-based acronym expansion for downstream clarity.
+   */
+  std::string expandAcronyms(const std::string &input) {
+    // Note: In a true production environment, we'd use a more sophisticated
+    // NER-based approach or word-boundary aware replacement.
+    std::string result = input;
+    for (const auto &[acronym, expansion] : acronymMap) {
+      std::regex wordBoundary(R"(\b)" + acronym + R"(\b)");
+      result = std::regex_replace(result, wordBoundary, expansion);
+    }
+    return result;
+  }
+};
@@ -1,138 +1,53 @@
+#include "Deduplicator.hpp"
+#include "LshIndex.hpp"
+
 #include <algorithm>
-#include <functional>
-#include <iomanip>
+#include <cstdio>
 #include <iostream>
+#include <numeric>
 #include <random>
-#include <set>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 /**
- * @brief Production-grade Deduplication Engine with LSH (Locality Sensitive
- * Hashing). Uses the 'Bands & Rows' technique to scale search to O(1).
+ * @brief dedupeBatch's clusters by brute force: every pair that shares a
+ * band bucket and is similar enough, joined transitively.
  */
-class Deduplicator {
-public:
-  Deduplicator(int numHashes = 200, int shingleSize = 5, int bands = 20,
-               int rows = 10)
-      : numHashes(numHashes), shingleSize(shingleSize), bands(bands),
-        rows(rows) {
-
-    if (numHashes != bands * rows) {
-      std::cerr
-          << "Warning: numHashes should equal bands * rows for optimal layout."
-          << std::endl;
+static std::vector<std::vector<int>>
+allPairsClusters(const Deduplicator &engine,
+                 const std::vector<Deduplicator::Document> &docs,
+                 double threshold) {
+  const size_t n = docs.size(), width = engine.hashCount();
+  std::vector<uint32_t> sigs(n * width);
+  for (size_t i = 0; i < n; ++i)
+    engine.generateSignature(docs[i].text, sigs.data() + i * width);
+  std::vector<size_t> root(n);
+  std::iota(root.begin(), root.end(), 0);
+  auto find = [&](size_t x) {
+    while (root[x] != x)
+      x = root[x];
+    return x;
+  };
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = i + 1; j < n; ++j) {
+      const uint32_t *a = sigs.data() + i * width, *b = sigs.data() + j * width;
+      bool bucketMates = false;
+      for (int band = 0; band < engine.bandCount() && !bucketMates; ++band)
+        bucketMates = engine.hashBand(a, band) == engine.hashBand(b, band);
+      if (bucketMates && engine.calculateSimilarity(a, b, width) >= threshold)
+        root[find(i)] = find(j);
     }
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<uint64_t> dist(1, MAX_PRIME - 1);
-
-    for (int i = 0; i < numHashes; ++i) {
-      hashCoeffsA.push_back(dist(gen));
-      hashCoeffsB.push_back(dist(gen));
+  std::vector<std::vector<int>> byRoot(n), clusters;
+  for (size_t i = 0; i < n; ++i)
+    byRoot[find(i)].push_back(docs[i].docId);
+  for (std::vector<int> &c : byRoot)
+    if (c.size() > 1) {
+      std::sort(c.begin(), c.end());
+      clusters.push_back(std::move(c));
     }
-  }
-
-  /**
-   * @brief Generates a MinHash signature.
-   */
-  std::vector<uint64_t> generateSignature(const std::string &text) {
-    std::set<std::string> shingles = getShingles(text);
-    std::vector<uint64_t> signature(numHashes,
-                                    std::numeric_limits<uint64_t>::max());
-
-    for (const auto &shingle : shingles) {
-      uint64_t shingleHash = std::hash<std::string>{}(shingle);
-      for (int i = 0; i < numHashes; ++i) {
-        uint64_t val =
-            (hashCoeffsA[i] * shingleHash + hashCoeffsB[i]) % MAX_PRIME;
-        signature[i] = std::min(signature[i], val);
-      }
-    }
-    return signature;
-  }
-
-  /**
-   * @brief Adds a document signature to the LSH index (Bucketing).
-   */
-  void indexDocument(int docId, const std::vector<uint64_t> &signature) {
-    for (int b = 0; b < bands; ++b) {
-      uint64_t bandHash = hashBand(signature, b);
-      lshBuckets[b][bandHash].push_back(docId);
-    }
-    allSignatures[docId] = signature;
-  }
-
-  /**
-   * @brief Finds near-duplicate candidates using LSH buckets.
-   */
-  std::vector<int> findCandidates(const std::vector<uint64_t> &querySignature) {
-    std::unordered_set<int> candidates;
-    for (int b = 0; b < bands; ++b) {
-      uint64_t bandHash = hashBand(querySignature, b);
-      if (lshBuckets[b].count(bandHash)) {
-        for (int docId : lshBuckets[b][bandHash]) {
-          candidates.insert(docId);
-        }
-      }
-    }
-    return std::vector<int>(candidates.begin(), candidates.end());
-  }
-
-  /**
-   * @brief Final verification: Calculate exact similarity for candidates.
-   */
-  double calculateSimilarity(const std::vector<uint64_t> &sig1,
-                             const std::vector<uint64_t> &sig2) {
-    int matchCount = 0;
-    for (size_t i = 0; i < std::min(sig1.size(), sig2.size()); ++i) {
-      if (sig1[i] == sig2[i])
-        matchCount++;
-    }
-    return static_cast<double>(matchCount) / numHashes;
-  }
-
-  const std::vector<uint64_t> &getSignature(int docId) {
-    return allSignatures[docId];
-  }
-
-private:
-  int numHashes, shingleSize, bands, rows;
-  const uint64_t MAX_PRIME = 4294967291ull;
-  std::vector<uint64_t> hashCoeffsA;
-  std::vector<uint64_t> hashCoeffsB;
-
-  // LSH Index: Band Index -> (Band Hash -> List of Doc IDs)
-  std::unordered_map<int, std::unordered_map<uint64_t, std::vector<int>>>
-      lshBuckets;
-  std::unordered_map<int, std::vector<uint64_t>> allSignatures;
-
-  /**
-   * @brief Hashes a single band of the signature.
-   */
-  uint64_t hashBand(const std::vector<uint64_t> &signature, int bandIdx) {
-    uint64_t h = 0;
-    int start = bandIdx * rows;
-    for (int i = 0; i < rows; ++i) {
-      // Simple robust hash combining for the band's values
-      h ^= signature[start + i] + 0x9e3779b9 + (h << 6) + (h >> 2);
-    }
-    return h;
-  }
-
-  std::set<std::string> getShingles(const std::string &text) {
-    std::set<std::string> shingles;
-    if (text.length() < (size_t)shingleSize)
-      return {text};
-    for (size_t i = 0; i <= text.length() - shingleSize; ++i) {
-      shingles.insert(text.substr(i, shingleSize));
-    }
-    return shingles;
-  }
-};
+  std::sort(clusters.begin(), clusters.end());
+  return clusters;
+}
 
 int main() {
   Deduplicator engine(200, 5, 20, 10); // 200 hashes = 20 bands * 10 rows
@@ -151,6 +66,7 @@ int main() {
   engine.indexDocument(102, engine.generateSignature(docDifferent));
 
   std::cout << "--- LSH Scalability Test ---" << std::endl;
+  std::cout << "MinHash kernel: " << MinHasher::kernelName() << std::endl;
 
   // 2. Querying with near-duplicate
   auto querySig = engine.generateSignature(docNearDup);
@@ -170,5 +86,100 @@ int main() {
     }
   }
 
+  std::cout << "\n--- Parallel Batch Deduplication ---" << std::endl;
+  std::string docVendor = "BGP FSM: the Finite State Machine consists of 6 "
+                          "states: Idle, Connect, Active, OpenSent, "
+                          "OpenConfirm, and Established.";
+  std::vector<Deduplicator::Document> batch = {{201, docSource},
+                                               {202, docDifferent},
+                                               {203, docNearDup},
+                                               {204, docVendor}};
+  for (const auto &cluster : engine.dedupeBatch(batch, 0.8)) {
+    std::cout << "Duplicate cluster:";
+    for (int docId : cluster)
+      std::cout << " " << docId;
+    std::cout << std::endl;
+  }
+
+  // Edits of one text are each close to it but often not to each other,
+  // so the unedited copy must join clusters that share no similar pair.
+  std::mt19937_64 gen(7);
+  const char *words[] = {"bgp", "peer", "ospf", "lsa",  "hold", "timer",
+                         "down", "link", "flap", "vlan", "arp", "mac"};
+  size_t mismatches = 0;
+  const size_t trials = 300;
+  for (size_t trial = 0; trial < trials; ++trial) {
+    std::vector<std::string> texts;
+    for (size_t bases = 1 + gen() % 4; bases > 0; --bases) {
+      std::vector<std::string> base(30);
+      for (std::string &w : base)
+        w = words[gen() % 12];
+      for (size_t copies = 2 + gen() % 5; copies > 0; --copies) {
+        std::vector<std::string> text = base;
+        for (size_t edits = copies > 1 ? 1 + gen() % 3 : 0; edits > 0; --edits)
+          text[gen() % text.size()] = words[gen() % 12];
+        texts.emplace_back();
+        for (const std::string &w : text)
+          texts.back() += w + " ";
+      }
+    }
+    std::shuffle(texts.begin(), texts.end(), gen);
+    std::vector<Deduplicator::Document> docs;
+    for (size_t i = 0; i < texts.size(); ++i)
+      docs.push_back({static_cast<int>(i), texts[i]});
+    const auto expected = allPairsClusters(engine, docs, 0.8);
+    for (size_t threads : {1, 4})
+      mismatches += engine.dedupeBatch(docs, 0.8, threads) != expected;
+  }
+  std::cout << "All-pairs reference: " << mismatches << " of " << 2 * trials
+            << " batches differ" << std::endl;
+  if (mismatches)
+    return 1;
+
+  std::cout << "\n--- Persistent Incremental LSH Index ---" << std::endl;
+  const std::string indexPath = "dedup_index.lsh";
+  std::string error;
+  {
+    auto index = LshIndex::create(indexPath, LshIndex::Params(), &error);
+    if (!index) {
+      std::cout << "Create failed: " << error << std::endl;
+      return 1;
+    }
+    index->add(301, docSource);
+    index->add(302, docDifferent);
+  } // Closing flushes the log
+
+  // A later nightly run reopens the index and only signs new releases.
+  auto index = LshIndex::open(indexPath, &error);
+  if (!index) {
+    std::cout << "Open failed: " << error << std::endl;
+    return 1;
+  }
+  for (const auto &m : index->query(docNearDup, 0.8))
+    std::cout << "Reopened index matches " << m.docId << " (similarity "
+              << m.similarity << ")" << std::endl;
+  index->add(303, docNearDup);
+  index->remove(301); // Superseded by the new release
+  index->compact();
+  std::cout << "Live documents: " << index->liveCount()
+            << " | Log records after compaction: " << index->logRecordCount()
+            << std::endl;
+
+  // Re-ingest: only chunks whose text changed are signed again and passed
+  // on to entity extraction; 302 is gone from this release.
+  std::string docRevised = docDifferent + " Entries age out after 4 hours.";
+  LshIndex::Delta delta =
+      index->sync({{303, docNearDup}, {304, docRevised}, {305, docVendor}});
+  std::cout << "Sync: " << delta.added.size() << " added, "
+            << delta.modified.size() << " modified, " << delta.removed.size()
+            << " removed, " << delta.unchanged << " unchanged" << std::endl;
+  delta =
+      index->sync({{303, docNearDup}, {304, docDifferent}, {305, docVendor}});
+  std::cout << "Resync: " << delta.modified.size() << " modified ("
+            << (delta.modified.empty() ? -1 : delta.modified[0]) << "), "
+            << delta.unchanged << " unchanged" << std::endl;
+  index.reset();
+  std::remove(indexPath.c_str());
+
   return 0;
 }
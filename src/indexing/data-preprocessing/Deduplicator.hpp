@@ -0,0 +1,312 @@
+#pragma once
+
+#include "Instrumentation.hpp"
+#include "MinHash.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @class ConcurrentUnionFind
+ * @brief Lock-free disjoint sets over [0, n) for parallel clustering.
+ *
+ * Roots are only ever re-pointed by a CAS from themselves to a smaller
+ * index, so the forest stays acyclic under any interleaving; find() halves
+ * paths opportunistically.
+ */
+class ConcurrentUnionFind {
+public:
+  explicit ConcurrentUnionFind(size_t n) : parent(n) {
+    for (size_t i = 0; i < n; ++i)
+      parent[i].store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+  }
+
+  uint32_t find(uint32_t x) {
+    for (;;) {
+      uint32_t p = parent[x].load(std::memory_order_acquire);
+      if (p == x)
+        return x;
+      uint32_t gp = parent[p].load(std::memory_order_acquire);
+      if (p != gp)
+        parent[x].compare_exchange_weak(p, gp, std::memory_order_release);
+      x = gp;
+    }
+  }
+
+  void unite(uint32_t a, uint32_t b) {
+    for (;;) {
+      a = find(a);
+      b = find(b);
+      if (a == b)
+        return;
+      if (a < b)
+        std::swap(a, b);
+      uint32_t expected = a; // Link the larger root under the smaller
+      if (parent[a].compare_exchange_strong(expected, b,
+                                            std::memory_order_acq_rel))
+        return;
+    }
+  }
+
+private:
+  std::vector<std::atomic<uint32_t>> parent;
+};
+
+/**
+ * @brief Production-grade Deduplication Engine with LSH (Locality Sensitive
+ * Hashing). Uses the 'Bands & Rows' technique to scale search to O(1).
+ */
+class Deduplicator {
+public:
+  /**
+   * @struct Document
+   * @brief One chunk to deduplicate. The text is borrowed for the call.
+   */
+  struct Document {
+    int docId;
+    std::string_view text;
+  };
+
+  // Per band, bucket keys are spread over this many independently locked
+  // tables during dedupeBatch.
+  static constexpr size_t BUCKET_SHARDS = 64;
+
+  // Each bucket member is verified against at most this many earlier
+  // members, which bounds the cost of huge boilerplate buckets.
+  static constexpr size_t PROBE_WINDOW = 32;
+
+  // Hash coefficients derive from the seed alone, so signatures produced
+  // by different processes (or a reopened LshIndex) are comparable.
+  static constexpr uint64_t DEFAULT_SEED = 0x5243414c534831ull;
+
+  Deduplicator(int numHashes = 200, int shingleSize = 5, int bands = 20,
+               int rows = 10, uint64_t seed = DEFAULT_SEED)
+      : numHashes(numHashes), shingleSize(shingleSize), bands(bands),
+        rows(rows), seed(seed), hasher(numHashes, shingleSize, seed),
+        lshBuckets(bands) {
+
+    if (numHashes != bands * rows) {
+      std::cerr
+          << "Warning: numHashes should equal bands * rows for optimal layout."
+          << std::endl;
+    }
+  }
+
+  /**
+   * @brief Generates a MinHash signature (see MinHasher for the kernel).
+   */
+  std::vector<uint64_t> generateSignature(std::string_view text) const {
+    std::vector<uint32_t> &lanes = signatureScratch();
+    lanes.resize(numHashes);
+    hasher.sign(text, lanes.data());
+    return std::vector<uint64_t>(lanes.begin(), lanes.end());
+  }
+
+  /**
+   * @brief Allocation-free variant: writes hashCount() values into out.
+   */
+  void generateSignature(std::string_view text, uint32_t *out) const {
+    hasher.sign(text, out);
+  }
+
+  /**
+   * @brief Hashes a single band of the signature.
+   */
+  template <typename T>
+  uint64_t hashBand(const T *signature, int bandIdx) const {
+    uint64_t h = 0;
+    int start = bandIdx * rows;
+    for (int i = 0; i < rows; ++i) {
+      // Simple robust hash combining for the band's values
+      h ^= signature[start + i] + 0x9e3779b9 + (h << 6) + (h >> 2);
+    }
+    return h;
+  }
+
+  int hashCount() const { return numHashes; }
+  int shingleLength() const { return shingleSize; }
+  int bandCount() const { return bands; }
+  int rowCount() const { return rows; }
+  uint64_t hashSeed() const { return seed; }
+
+  /**
+   * @brief Adds a document signature to the LSH index (Bucketing).
+   */
+  void indexDocument(int docId, const std::vector<uint64_t> &signature) {
+    for (int b = 0; b < bands; ++b) {
+      uint64_t bandHash = hashBand(signature.data(), b);
+      lshBuckets[b][bandHash].push_back(docId);
+    }
+    allSignatures[docId] = signature;
+  }
+
+  /**
+   * @brief Finds near-duplicate candidates using LSH buckets.
+   */
+  std::vector<int> findCandidates(const std::vector<uint64_t> &querySignature) {
+    std::unordered_set<int> candidates;
+    for (int b = 0; b < bands; ++b) {
+      uint64_t bandHash = hashBand(querySignature.data(), b);
+      auto it = lshBuckets[b].find(bandHash);
+      if (it != lshBuckets[b].end()) {
+        for (int docId : it->second) {
+          candidates.insert(docId);
+        }
+      }
+    }
+    RCA_COUNT(DEDUP_QUERIES, 1);
+    RCA_COUNT(DEDUP_CANDIDATES, candidates.size());
+    RCA_OBSERVE(DEDUP_CANDIDATES_PER_QUERY, candidates.size());
+    return std::vector<int>(candidates.begin(), candidates.end());
+  }
+
+  /**
+   * @brief Final verification: Calculate exact similarity for candidates.
+   */
+  double calculateSimilarity(const std::vector<uint64_t> &sig1,
+                             const std::vector<uint64_t> &sig2) const {
+    return calculateSimilarity(sig1.data(), sig2.data(),
+                               std::min(sig1.size(), sig2.size()));
+  }
+
+  template <typename T>
+  double calculateSimilarity(const T *sig1, const T *sig2,
+                             size_t length) const {
+    size_t matchCount = 0;
+    if constexpr (std::is_same<T, uint32_t>::value) {
+      matchCount = MinHasher::matchingLanes(sig1, sig2, length);
+    } else {
+      for (size_t i = 0; i < length; ++i)
+        matchCount += sig1[i] == sig2[i];
+    }
+    return static_cast<double>(matchCount) / numHashes;
+  }
+
+  /**
+   * @brief Clusters a whole batch of documents in parallel.
+   *
+   * 1. Signatures are computed on `threads` workers into one flat array.
+   * 2. Every (document, band) key goes into a per-band table split into
+   *    BUCKET_SHARDS mutex-guarded shards.
+   * 3. Shards are scanned in parallel; each member is verified with
+   *    calculateSimilarity against the PROBE_WINDOW members before it
+   *    that are not yet in its cluster, and similar pairs are merged in a
+   *    lock-free union-find.
+   *
+   * Clusters are the connected components of the similar pairs, so they
+   * do not depend on the thread count or on how shard tasks interleave.
+   * Independent of the incremental index built by indexDocument. Every
+   * verified bucket-mate counts toward dedup.pairs_verified, and those
+   * under the threshold (LSH false positives) toward
+   * dedup.false_positives.
+   * @return Clusters of two or more docIds, each sorted, ordered by their
+   * smallest member.
+   */
+  std::vector<std::vector<int>> dedupeBatch(const std::vector<Document> &docs,
+                                            double threshold = 0.8,
+                                            size_t threads = 0) const {
+    RCA_SPAN("Deduplicator::dedupeBatch");
+    const size_t n = docs.size();
+    const size_t width = static_cast<size_t>(numHashes);
+    const int usableBands = std::min(bands, numHashes / std::max(rows, 1));
+    if (threads == 0)
+      threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<uint32_t> signatures(n * width);
+    std::vector<std::vector<BucketShard>> tables(usableBands);
+    for (auto &t : tables)
+      t = std::vector<BucketShard>(BUCKET_SHARDS);
+
+    ParallelFor::run(n, threads, [&](size_t i) {
+      uint32_t *sig = signatures.data() + i * width;
+      hasher.sign(docs[i].text, sig);
+      for (int b = 0; b < usableBands; ++b) {
+        uint64_t key = hashBand(sig, b);
+        BucketShard &shard = tables[b][(key >> 32) % BUCKET_SHARDS];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.buckets[key].push_back(static_cast<uint32_t>(i));
+      }
+    });
+
+    ConcurrentUnionFind clusters(n);
+    ParallelFor::run(usableBands * BUCKET_SHARDS, threads, [&](size_t task) {
+      BucketShard &shard = tables[task / BUCKET_SHARDS][task % BUCKET_SHARDS];
+      uint64_t verified = 0, rejected = 0;
+      for (auto &entry : shard.buckets) {
+        std::vector<uint32_t> &members = entry.second;
+        std::sort(members.begin(), members.end()); // Deterministic order
+        for (size_t j = 1; j < members.size(); ++j) {
+          size_t first = j > PROBE_WINDOW ? j - PROBE_WINDOW : 0;
+          for (size_t i = first; i < j; ++i) {
+            uint32_t x = members[i];
+            uint32_t y = members[j];
+            // Already joined through another pair; y may still match a
+            // later window member that is not, so keep probing.
+            if (clusters.find(x) == clusters.find(y))
+              continue;
+            ++verified;
+            if (calculateSimilarity(signatures.data() + x * width,
+                                    signatures.data() + y * width,
+                                    width) >= threshold)
+              clusters.unite(x, y);
+            else
+              ++rejected;
+          }
+        }
+      }
+      RCA_COUNT(DEDUP_PAIRS_VERIFIED, verified);
+      RCA_COUNT(DEDUP_FALSE_POSITIVES, rejected);
+      (void)verified;
+      (void)rejected;
+    });
+
+    std::unordered_map<uint32_t, std::vector<int>> byRoot;
+    for (size_t i = 0; i < n; ++i)
+      byRoot[clusters.find(static_cast<uint32_t>(i))].push_back(
+          docs[i].docId);
+    std::vector<std::vector<int>> result;
+    for (auto &entry : byRoot) {
+      if (entry.second.size() < 2)
+        continue;
+      std::sort(entry.second.begin(), entry.second.end());
+      result.push_back(std::move(entry.second));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  const std::vector<uint64_t> &getSignature(int docId) {
+    return allSignatures[docId];
+  }
+
+private:
+  int numHashes, shingleSize, bands, rows;
+  uint64_t seed;
+  MinHasher hasher;
+
+  struct alignas(64) BucketShard {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> buckets;
+  };
+
+  // LSH Index: Band Index -> (Band Hash -> List of Doc IDs). Bands are a
+  // dense 0..bands-1 range, so the outer level is a plain vector.
+  std::vector<std::unordered_map<uint64_t, std::vector<int>>> lshBuckets;
+  std::unordered_map<int, std::vector<uint64_t>> allSignatures;
+
+  static std::vector<uint32_t> &signatureScratch() {
+    static thread_local std::vector<uint32_t> lanes;
+    return lanes;
+  }
+};
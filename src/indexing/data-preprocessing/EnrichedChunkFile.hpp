@@ -0,0 +1,367 @@
+#pragma once
+
+#include "MetadataEnricher.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class EnrichedChunkFile
+ * @brief Flat binary form of enriched chunks, the structured alternative
+ * to MetadataEnricher::enrich's text header.
+ *
+ * FILE LAYOUT (native byte order, every section 64-byte aligned):
+ * - Header: magic, format version, endianness tag, counts and a table of
+ *   (offset, bytes) per Section.
+ * - CHUNKS: one ChunkRecord per chunk, pointing at its text in TEXT and
+ *   at its source in SOURCES.
+ * - SOURCES: one SourceRecord per distinct source name, with the type
+ *   enum, DomainTag bits and authority; the name lives in SOURCE_CHARS.
+ * - TEXT: the chunk texts back to back, exactly as given.
+ *
+ * The writer keeps string_views of the caller's chunk texts instead of
+ * copying them; they must stay alive until write(). Each source name is
+ * classified once, however many chunks it has.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: A reader maps the file and indexes records; no text is parsed
+ *   or copied, and the metadata reads as integers.
+ * - CON: Binary and versioned: a layout change needs a FORMAT_VERSION
+ *   bump, and the file is not human-readable (use enrich() to inspect).
+ */
+class EnrichedChunkFile {
+public:
+  static constexpr char MAGIC[8] = {'R', 'C', 'A', 'C', 'H', 'U', 'N', 'K'};
+  static constexpr uint32_t FORMAT_VERSION = 1;
+  static constexpr uint32_t ENDIAN_TAG = 0x01020304;
+  static constexpr uint64_t ALIGN = 64;
+
+  enum Section : uint32_t {
+    CHUNKS,
+    SOURCES,
+    SOURCE_CHARS,
+    TEXT,
+    SECTION_COUNT
+  };
+
+  struct SectionEntry {
+    uint64_t offset;
+    uint64_t bytes;
+  };
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianTag;
+    uint64_t chunkCount;
+    uint64_t sourceCount;
+    uint64_t fileBytes;
+    SectionEntry sections[SECTION_COUNT];
+  };
+
+  struct ChunkRecord {
+    uint64_t textOffset; // Into TEXT
+    uint32_t textLength;
+    uint32_t source; // Index into SOURCES
+  };
+
+  struct SourceRecord {
+    uint32_t nameOffset; // Into SOURCE_CHARS
+    uint32_t nameLength;
+    uint32_t tags; // MetadataEnricher::DomainTag bits
+    float authority;
+    MetadataEnricher::SourceType type;
+    uint8_t reserved[3];
+  };
+
+  static_assert(std::is_trivially_copyable<Header>::value &&
+                    std::is_trivially_copyable<ChunkRecord>::value &&
+                    std::is_trivially_copyable<SourceRecord>::value,
+                "Records are written and mapped as raw bytes");
+  static_assert(sizeof(ChunkRecord) == 16 && sizeof(SourceRecord) == 20,
+                "Record layout is part of the file format");
+
+  /**
+   * @class Writer
+   * @brief Collects chunks in memory and writes the file in one go.
+   */
+  class Writer {
+  public:
+    explicit Writer(const MetadataEnricher &enricher) : enricher(enricher) {}
+
+    /**
+     * @brief Adds a chunk. text is referenced, not copied.
+     * @return The chunk's index in the file.
+     */
+    size_t add(std::string_view text, std::string_view sourceName) {
+      ChunkRecord r;
+      r.textOffset = textBytes;
+      r.textLength = static_cast<uint32_t>(text.size());
+      r.source = sourceIndex(sourceName);
+      chunks.push_back(r);
+      texts.push_back(text);
+      textBytes += text.size();
+      return chunks.size() - 1;
+    }
+
+    size_t size() const { return chunks.size(); }
+    const ChunkRecord &chunk(size_t i) const { return chunks[i]; }
+    const SourceRecord &source(size_t s) const { return sources[s]; }
+
+    void clear() {
+      chunks.clear();
+      texts.clear();
+      sources.clear();
+      sourceChars.clear();
+      sourceIds.clear();
+      textBytes = 0;
+    }
+
+    /**
+     * @brief Writes the file next to path and renames it over path.
+     * @return false on I/O failure, with a reason in *error if given.
+     */
+    bool write(const std::string &path, std::string *error = nullptr) const {
+      Header h{};
+      std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+      h.version = FORMAT_VERSION;
+      h.endianTag = ENDIAN_TAG;
+      h.chunkCount = chunks.size();
+      h.sourceCount = sources.size();
+      const uint64_t bytes[SECTION_COUNT] = {
+          chunks.size() * sizeof(ChunkRecord),
+          sources.size() * sizeof(SourceRecord), sourceChars.size(),
+          textBytes};
+      uint64_t cursor = alignUp(sizeof(Header));
+      for (uint32_t s = 0; s < SECTION_COUNT; ++s) {
+        h.sections[s] = {cursor, bytes[s]};
+        cursor = alignUp(cursor + bytes[s]);
+      }
+      h.fileBytes = cursor;
+
+      const std::string tmp = path + ".tmp";
+      {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out)
+          return fail(error, "cannot create " + tmp);
+        static const char zeros[ALIGN] = {};
+        uint64_t written = 0;
+        auto put = [&](const void *data, size_t n) {
+          out.write(static_cast<const char *>(data), n);
+          written += n;
+        };
+        auto pad = [&](Section s) {
+          put(zeros, h.sections[s].offset - written);
+        };
+        put(&h, sizeof(h));
+        pad(CHUNKS);
+        put(chunks.data(), bytes[CHUNKS]);
+        pad(SOURCES);
+        put(sources.data(), bytes[SOURCES]);
+        pad(SOURCE_CHARS);
+        put(sourceChars.data(), bytes[SOURCE_CHARS]);
+        pad(TEXT);
+        for (std::string_view t : texts)
+          put(t.data(), t.size());
+        put(zeros, h.fileBytes - written);
+        out.flush();
+        if (!out) {
+          out.close();
+          std::remove(tmp.c_str());
+          return fail(error, "short write to " + tmp);
+        }
+      }
+      if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return fail(error, "cannot rename " + tmp + " to " + path);
+      }
+      return true;
+    }
+
+  private:
+    const MetadataEnricher &enricher;
+    std::vector<ChunkRecord> chunks;
+    std::vector<std::string_view> texts;
+    std::vector<SourceRecord> sources;
+    std::string sourceChars;
+    std::unordered_map<std::string, uint32_t> sourceIds;
+    uint64_t textBytes = 0;
+
+    uint32_t sourceIndex(std::string_view name) {
+      // Consecutive chunks usually come from the same document.
+      if (!sources.empty()) {
+        const SourceRecord &last = sources.back();
+        if (name == std::string_view(sourceChars).substr(last.nameOffset))
+          return static_cast<uint32_t>(sources.size() - 1);
+      }
+      auto [it, inserted] = sourceIds.try_emplace(
+          std::string(name), static_cast<uint32_t>(sources.size()));
+      if (inserted) {
+        MetadataEnricher::Classification c = enricher.classify(name);
+        SourceRecord s{};
+        s.nameOffset = static_cast<uint32_t>(sourceChars.size());
+        s.nameLength = static_cast<uint32_t>(name.size());
+        s.tags = c.tags;
+        s.authority = c.authority;
+        s.type = c.type;
+        sources.push_back(s);
+        sourceChars.append(name);
+      }
+      return it->second;
+    }
+  };
+
+  static uint64_t alignUp(uint64_t v) { return (v + ALIGN - 1) & ~(ALIGN - 1); }
+
+  static bool fail(std::string *error, const std::string &why) {
+    if (error)
+      *error = why;
+    return false;
+  }
+};
+
+/**
+ * @class MappedChunks
+ * @brief Read-only view of an EnrichedChunkFile, served from the mapping.
+ *
+ * open() validates the header and that every record points inside its
+ * section, so accessors need no further checks. Immutable and safe to
+ * read from many threads.
+ */
+class MappedChunks {
+public:
+  using ChunkRecord = EnrichedChunkFile::ChunkRecord;
+  using SourceRecord = EnrichedChunkFile::SourceRecord;
+
+  ~MappedChunks() {
+    if (base)
+      ::munmap(base, bytes);
+  }
+
+  MappedChunks(const MappedChunks &) = delete;
+  MappedChunks &operator=(const MappedChunks &) = delete;
+
+  /**
+   * @return nullptr if the file is missing, truncated, corrupt or from an
+   * incompatible format version or byte order (reason in *error).
+   */
+  static std::shared_ptr<const MappedChunks>
+  open(const std::string &path, std::string *error = nullptr) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return fail(error, "cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 ||
+        static_cast<uint64_t>(st.st_size) < sizeof(EnrichedChunkFile::Header)) {
+      ::close(fd);
+      return fail(error, path + " is too small to be a chunk file");
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void *addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps its own reference to the file
+    if (addr == MAP_FAILED)
+      return fail(error, "cannot mmap " + path);
+    std::shared_ptr<MappedChunks> view(new MappedChunks(addr, size));
+    std::string why = view->bind();
+    if (!why.empty())
+      return fail(error, path + ": " + why);
+    return view;
+  }
+
+  size_t size() const { return header->chunkCount; }
+  size_t sourceCount() const { return header->sourceCount; }
+  const ChunkRecord &chunk(size_t i) const { return chunks[i]; }
+  const SourceRecord &source(size_t s) const { return sources[s]; }
+  const SourceRecord &sourceOf(size_t i) const {
+    return sources[chunks[i].source];
+  }
+
+  std::string_view text(size_t i) const {
+    return {text0 + chunks[i].textOffset, chunks[i].textLength};
+  }
+
+  std::string_view sourceName(size_t s) const {
+    return {names + sources[s].nameOffset, sources[s].nameLength};
+  }
+
+private:
+  void *base;
+  size_t bytes;
+  const EnrichedChunkFile::Header *header = nullptr;
+  const ChunkRecord *chunks = nullptr;
+  const SourceRecord *sources = nullptr;
+  const char *names = nullptr;
+  const char *text0 = nullptr;
+
+  MappedChunks(void *base, size_t bytes) : base(base), bytes(bytes) {}
+
+  static std::shared_ptr<const MappedChunks> fail(std::string *error,
+                                                  const std::string &why) {
+    if (error)
+      *error = why;
+    return nullptr;
+  }
+
+  template <typename Record>
+  static bool holds(const EnrichedChunkFile::SectionEntry &s, uint64_t count) {
+    return s.bytes % sizeof(Record) == 0 && s.bytes / sizeof(Record) == count;
+  }
+
+  std::string bind() {
+    using File = EnrichedChunkFile;
+    const char *p = static_cast<const char *>(base);
+    header = reinterpret_cast<const File::Header *>(p);
+    if (std::memcmp(header->magic, File::MAGIC, sizeof(File::MAGIC)) != 0)
+      return "not a chunk file";
+    if (header->endianTag != File::ENDIAN_TAG)
+      return "written with a different byte order";
+    if (header->version != File::FORMAT_VERSION)
+      return "format version " + std::to_string(header->version) +
+             ", expected " + std::to_string(File::FORMAT_VERSION);
+    if (header->fileBytes != bytes)
+      return "truncated";
+    for (const File::SectionEntry &s : header->sections)
+      if (s.offset % File::ALIGN != 0 || s.offset > bytes ||
+          s.bytes > bytes - s.offset)
+        return "section out of bounds";
+    const File::SectionEntry *sec = header->sections;
+    if (!holds<ChunkRecord>(sec[File::CHUNKS], header->chunkCount) ||
+        !holds<SourceRecord>(sec[File::SOURCES], header->sourceCount))
+      return "record count does not match section size";
+    chunks =
+        reinterpret_cast<const ChunkRecord *>(p + sec[File::CHUNKS].offset);
+    sources =
+        reinterpret_cast<const SourceRecord *>(p + sec[File::SOURCES].offset);
+    names = p + sec[File::SOURCE_CHARS].offset;
+    text0 = p + sec[File::TEXT].offset;
+
+    const uint64_t nameBytes = sec[File::SOURCE_CHARS].bytes;
+    for (size_t s = 0; s < header->sourceCount; ++s) {
+      const SourceRecord &r = sources[s];
+      if (uint64_t(r.nameOffset) + r.nameLength > nameBytes ||
+          r.type > MetadataEnricher::SourceType::UNKNOWN)
+        return "bad source record " + std::to_string(s);
+    }
+    for (size_t i = 0; i < header->chunkCount; ++i) {
+      const ChunkRecord &r = chunks[i];
+      if (r.source >= header->sourceCount ||
+          r.textOffset > sec[File::TEXT].bytes ||
+          r.textLength > sec[File::TEXT].bytes - r.textOffset)
+        return "bad chunk record " + std::to_string(i);
+    }
+    return "";
+  }
+};
@@ -0,0 +1,403 @@
+#pragma once
+
+#include "LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Build with -DRCA_INSTRUMENTATION=0 to compile every RCA_COUNT,
+// RCA_OBSERVE and RCA_SPAN down to nothing. The Instrumentation class
+// stays available either way, so reporting code builds unchanged and
+// just sees zeros.
+#ifndef RCA_INSTRUMENTATION
+#define RCA_INSTRUMENTATION 1
+#endif
+
+/**
+ * @class Instrumentation
+ * @brief Process-wide counters, value distributions and trace spans for
+ * the hot paths (extraction, dedupe, path search, preprocessing stages).
+ *
+ * Every thread writes to its own cache-line aligned block, so recording
+ * never contends and never shares a line with another writer. A counter
+ * bump is a relaxed load and store on that block; a distribution sample
+ * adds one bucket (LatencyHistogram's log-linear layout), the sum and the
+ * peak. Nothing is aggregated until snapshot() walks the blocks, which is
+ * the only place that pays for the totals.
+ *
+ * Spans record only between startTrace() and stopTrace(). Outside that
+ * window a span costs one relaxed atomic load. Recorded spans go to the
+ * thread's own buffer (capped per thread) and are exported by
+ * writeChromeTrace() in the Trace Event Format that chrome://tracing and
+ * Perfetto load.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: No locks, no allocation and no shared writes on the recording
+ *   path; zero code at all when compiled out.
+ * - CON: The metric set is a fixed enum, not registered at runtime.
+ *   Adding a metric means adding an enumerator and its name.
+ * - CON: Totals are cumulative for the life of the process. Diff two
+ *   snapshots with since() to see one window; distribution peaks cannot
+ *   be diffed and stay cumulative.
+ * - CON: Blocks of exited threads are recycled, not freed, so memory is
+ *   bounded by the peak thread count (about 20KB per thread).
+ */
+class Instrumentation {
+public:
+  enum class Counter : uint8_t {
+    EXTRACT_CALLS,
+    EXTRACT_BYTES,
+    EXTRACT_MATCHES,
+    DISAMBIGUATE_MENTIONS,
+    DEDUP_QUERIES,
+    DEDUP_CANDIDATES,
+    DEDUP_PAIRS_VERIFIED,
+    DEDUP_FALSE_POSITIVES,
+    FIND_PATH_QUERIES,
+    FIND_PATH_NODES_EXPANDED,
+    PREPROCESS_DOCUMENTS,
+    PREPROCESS_STAGE_RUNS,
+    PREPROCESS_BYTES_IN,
+    PREPROCESS_BYTES_OUT,
+    COUNT
+  };
+
+  enum class Distribution : uint8_t {
+    EXTRACT_MATCHES_PER_CALL,
+    DEDUP_CANDIDATES_PER_QUERY,
+    FIND_PATH_EXPANDED_PER_QUERY,
+    FIND_PATH_PEAK_FRONTIER,
+    PREPROCESS_STAGE_NS,
+    COUNT
+  };
+
+  static constexpr size_t COUNTERS = size_t(Counter::COUNT);
+  static constexpr size_t DISTRIBUTIONS = size_t(Distribution::COUNT);
+
+  static const char *counterName(Counter c) {
+    static const char *names[COUNTERS] = {
+        "extract.calls",           "extract.bytes",
+        "extract.matches",         "disambiguate.mentions",
+        "dedup.queries",           "dedup.candidates",
+        "dedup.pairs_verified",    "dedup.false_positives",
+        "find_path.queries",       "find_path.nodes_expanded",
+        "preprocess.documents",    "preprocess.stage_runs",
+        "preprocess.bytes_in",     "preprocess.bytes_out"};
+    return names[size_t(c)];
+  }
+
+  static const char *distributionName(Distribution d) {
+    static const char *names[DISTRIBUTIONS] = {
+        "extract.matches_per_call", "dedup.candidates_per_query",
+        "find_path.expanded_per_query", "find_path.peak_frontier",
+        "preprocess.stage_ns"};
+    return names[size_t(d)];
+  }
+
+  static void add(Counter c, uint64_t n = 1) {
+    bump(local().counters[size_t(c)], n);
+  }
+
+  static void observe(Distribution d, uint64_t v) {
+    Cells &cells = local().distributions[size_t(d)];
+    bump(cells.buckets[LatencyHistogram::bucketOf(v)], 1);
+    bump(cells.sum, v);
+    if (v > cells.peak.load(std::memory_order_relaxed))
+      cells.peak.store(v, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Totals across all threads at one moment. Each value is exact
+   * for its own block; the set is not an atomic cut across threads.
+   */
+  struct Snapshot {
+    std::array<uint64_t, COUNTERS> counters{};
+    std::array<std::array<uint64_t, LatencyHistogram::BUCKETS>,
+               DISTRIBUTIONS>
+        buckets{};
+    std::array<uint64_t, DISTRIBUTIONS> sums{};
+    std::array<uint64_t, DISTRIBUTIONS> peaks{};
+
+    uint64_t count(Counter c) const { return counters[size_t(c)]; }
+
+    LatencyHistogram distribution(Distribution d) const {
+      size_t i = size_t(d);
+      return LatencyHistogram::fromBuckets(buckets[i].data(), sums[i],
+                                           peaks[i]);
+    }
+
+    /**
+     * @brief What happened between `earlier` and this snapshot.
+     */
+    Snapshot since(const Snapshot &earlier) const {
+      Snapshot delta = *this;
+      for (size_t i = 0; i < COUNTERS; ++i)
+        delta.counters[i] -= earlier.counters[i];
+      for (size_t d = 0; d < DISTRIBUTIONS; ++d) {
+        for (int b = 0; b < LatencyHistogram::BUCKETS; ++b)
+          delta.buckets[d][b] -= earlier.buckets[d][b];
+        delta.sums[d] -= earlier.sums[d];
+      }
+      return delta;
+    }
+  };
+
+  static Snapshot snapshot() {
+    Snapshot out;
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto &block : reg.blocks) {
+      for (size_t i = 0; i < COUNTERS; ++i)
+        out.counters[i] += read(block->counters[i]);
+      for (size_t d = 0; d < DISTRIBUTIONS; ++d) {
+        const Cells &cells = block->distributions[d];
+        for (int b = 0; b < LatencyHistogram::BUCKETS; ++b)
+          out.buckets[d][b] += read(cells.buckets[b]);
+        out.sums[d] += read(cells.sum);
+        out.peaks[d] = std::max(out.peaks[d], read(cells.peak));
+      }
+    }
+    return out;
+  }
+
+  /**
+   * @brief Starts recording spans, discarding any earlier trace. Each
+   * thread keeps at most `maxEventsPerThread`; later spans are dropped.
+   */
+  static void startTrace(size_t maxEventsPerThread = 1 << 16) {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto &block : reg.blocks) {
+      std::lock_guard<std::mutex> events(block->traceMutex);
+      block->events.clear();
+      block->dropped = 0;
+    }
+    reg.maxEvents.store(maxEventsPerThread, std::memory_order_relaxed);
+    reg.epochNs.store(nowNs(), std::memory_order_relaxed);
+    reg.tracing.store(true, std::memory_order_release);
+  }
+
+  static void stopTrace() {
+    registry().tracing.store(false, std::memory_order_release);
+  }
+
+  static bool tracing() {
+    return registry().tracing.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Spans dropped because a thread's buffer was full.
+   */
+  static size_t droppedSpans() {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    size_t dropped = 0;
+    for (const auto &block : reg.blocks) {
+      std::lock_guard<std::mutex> events(block->traceMutex);
+      dropped += block->dropped;
+    }
+    return dropped;
+  }
+
+  /**
+   * @brief Writes the recorded spans as Trace Event Format JSON, one
+   * complete ("X") event per span with one track per thread, followed by
+   * a counter ("C") event per counter carrying its current total.
+   */
+  static void writeChromeTrace(std::ostream &out) {
+    Snapshot totals = snapshot();
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    uint64_t last = 0;
+    for (const auto &block : reg.blocks) {
+      std::lock_guard<std::mutex> events(block->traceMutex);
+      for (const TraceEvent &e : block->events) {
+        out << (first ? "\n" : ",\n") << "{\"name\":\"";
+        writeEscaped(out, e.name);
+        out << "\",\"cat\":\"rca\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+            << block->tid << ",\"ts\":";
+        writeMicros(out, e.startNs);
+        out << ",\"dur\":";
+        writeMicros(out, e.durationNs);
+        out << '}';
+        first = false;
+        last = std::max(last, e.startNs + e.durationNs);
+      }
+    }
+    for (size_t i = 0; i < COUNTERS; ++i) {
+      out << (first ? "\n" : ",\n") << "{\"name\":\""
+          << counterName(Counter(i))
+          << "\",\"cat\":\"rca\",\"ph\":\"C\",\"pid\":1,\"ts\":";
+      writeMicros(out, last);
+      out << ",\"args\":{\"value\":" << totals.counters[i] << "}}";
+      first = false;
+    }
+    out << "\n]}\n";
+  }
+
+  /**
+   * @class Instrumentation::Span
+   * @brief Times a scope and records it when tracing is on. `name` must
+   * outlive the trace (a string literal or a static table entry).
+   */
+  class Span {
+  public:
+    explicit Span(const char *name)
+        : name(tracing() ? name : nullptr),
+          startNs(this->name ? nowNs() : 0) {}
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+    ~Span() {
+      if (name)
+        record(name, startNs, nowNs());
+    }
+
+  private:
+    const char *name;
+    uint64_t startNs;
+  };
+
+private:
+  struct Cells {
+    std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS> buckets{};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> peak{0};
+  };
+
+  struct TraceEvent {
+    const char *name;
+    uint64_t startNs;
+    uint64_t durationNs;
+  };
+
+  // alignas(64) keeps each thread's block off its neighbours' cache
+  // lines. The atomics are single-writer: only the owning thread stores,
+  // and they are atomic only so snapshot() can read them without a race.
+  struct alignas(64) Block {
+    std::array<std::atomic<uint64_t>, COUNTERS> counters{};
+    std::array<Cells, DISTRIBUTIONS> distributions{};
+    uint32_t tid = 0;
+    std::mutex traceMutex;
+    std::vector<TraceEvent> events;
+    size_t dropped = 0;
+  };
+
+  struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Block>> blocks;
+    std::vector<Block *> idle; // Blocks of exited threads, for reuse
+    std::atomic<bool> tracing{false};
+    std::atomic<size_t> maxEvents{0};
+    std::atomic<uint64_t> epochNs{0};
+  };
+
+  /**
+   * @brief Returns the thread's block to the idle list on thread exit.
+   * Its totals stay in the block and keep counting toward snapshots.
+   */
+  struct Lease {
+    Block *block = nullptr;
+    ~Lease() {
+      if (!block)
+        return;
+      Registry &reg = registry();
+      std::lock_guard<std::mutex> lock(reg.mutex);
+      reg.idle.push_back(block);
+    }
+  };
+
+  static Registry &registry() {
+    static Registry reg;
+    return reg;
+  }
+
+  static Block &local() {
+    thread_local Lease lease;
+    if (!lease.block)
+      lease.block = acquire();
+    return *lease.block;
+  }
+
+  static Block *acquire() {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    if (!reg.idle.empty()) {
+      Block *block = reg.idle.back();
+      reg.idle.pop_back();
+      return block;
+    }
+    reg.blocks.push_back(std::make_unique<Block>());
+    reg.blocks.back()->tid = static_cast<uint32_t>(reg.blocks.size());
+    return reg.blocks.back().get();
+  }
+
+  static void bump(std::atomic<uint64_t> &cell, uint64_t n) {
+    cell.store(cell.load(std::memory_order_relaxed) + n,
+               std::memory_order_relaxed);
+  }
+
+  static uint64_t read(const std::atomic<uint64_t> &cell) {
+    return cell.load(std::memory_order_relaxed);
+  }
+
+  static uint64_t nowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+
+  static void record(const char *name, uint64_t startNs, uint64_t endNs) {
+    Registry &reg = registry();
+    uint64_t epoch = reg.epochNs.load(std::memory_order_relaxed);
+    // A span that straddles startTrace() began before the epoch.
+    if (startNs < epoch)
+      return;
+    Block &block = local();
+    std::lock_guard<std::mutex> lock(block.traceMutex);
+    if (block.events.size() >= reg.maxEvents.load(std::memory_order_relaxed)) {
+      ++block.dropped;
+      return;
+    }
+    block.events.push_back({name, startNs - epoch, endNs - startNs});
+  }
+
+  static void writeMicros(std::ostream &out, uint64_t ns) {
+    out << ns / 1000 << '.' << char('0' + ns / 100 % 10)
+        << char('0' + ns / 10 % 10) << char('0' + ns % 10);
+  }
+
+  static void writeEscaped(std::ostream &out, const char *s) {
+    for (; *s; ++s) {
+      if (*s == '"' || *s == '\\')
+        out << '\\';
+      out << *s;
+    }
+  }
+};
+
+#if RCA_INSTRUMENTATION
+#define RCA_CONCAT_INNER(a, b) a##b
+#define RCA_CONCAT(a, b) RCA_CONCAT_INNER(a, b)
+#define RCA_COUNT(counter, n)                                                 \
+  Instrumentation::add(Instrumentation::Counter::counter, (n))
+#define RCA_OBSERVE(distribution, v)                                          \
+  Instrumentation::observe(Instrumentation::Distribution::distribution, (v))
+#define RCA_SPAN(name)                                                        \
+  Instrumentation::Span RCA_CONCAT(rcaSpan, __LINE__)(name)
+#else
+#define RCA_COUNT(counter, n) ((void)0)
+#define RCA_OBSERVE(distribution, v) ((void)0)
+#define RCA_SPAN(name) ((void)0)
+#endif
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+/**
+ * @class LatencyHistogram
+ * @brief Fixed-size log-linear histogram of nanosecond latencies.
+ *
+ * Values are bucketed by power of two, and each power of two is split
+ * into SUB_BUCKETS linear steps, so a percentile is within 1/SUB_BUCKETS
+ * (12.5%) of the true value. Recording is a few shifts and one increment
+ * with no allocation. Give each thread its own histogram and merge() them
+ * when reporting.
+ */
+class LatencyHistogram {
+public:
+  static constexpr int SUB_BITS = 3;
+  static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+  static constexpr int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+  void record(uint64_t ns) {
+    ++counts[indexOf(ns)];
+    ++samples;
+    sum += ns;
+    peak = std::max(peak, ns);
+  }
+
+  void merge(const LatencyHistogram &other) {
+    for (int i = 0; i < BUCKETS; ++i)
+      counts[i] += other.counts[i];
+    samples += other.samples;
+    sum += other.sum;
+    peak = std::max(peak, other.peak);
+  }
+
+  /**
+   * @brief Bucket index of a value, for callers that keep their own
+   * bucket counts (e.g. Instrumentation's per-thread atomic copies).
+   */
+  static int bucketOf(uint64_t v) { return indexOf(v); }
+
+  /**
+   * @brief Rebuilds a histogram from BUCKETS raw counts kept that way.
+   */
+  static LatencyHistogram fromBuckets(const uint64_t *bucketCounts,
+                                      uint64_t sum, uint64_t peak) {
+    LatencyHistogram h;
+    for (int i = 0; i < BUCKETS; ++i) {
+      h.counts[i] = bucketCounts[i];
+      h.samples += bucketCounts[i];
+    }
+    h.sum = sum;
+    h.peak = peak;
+    return h;
+  }
+
+  uint64_t count() const { return samples; }
+  uint64_t totalNs() const { return sum; }
+  uint64_t maxNs() const { return peak; }
+  double meanNs() const { return samples ? double(sum) / samples : 0.0; }
+
+  /**
+   * @brief Upper bound of the bucket holding quantile q (0..1), clamped to
+   * the largest recorded value.
+   */
+  uint64_t percentileNs(double q) const {
+    if (!samples)
+      return 0;
+    uint64_t rank = static_cast<uint64_t>(q * (samples - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+      seen += counts[i];
+      if (seen >= rank)
+        return std::min(upperBound(i), peak);
+    }
+    return peak;
+  }
+
+private:
+  std::array<uint64_t, BUCKETS> counts{};
+  uint64_t samples = 0;
+  uint64_t sum = 0;
+  uint64_t peak = 0;
+
+  // Values below SUB_BUCKETS map to themselves; above that, the top
+  // SUB_BITS + 1 bits select the bucket.
+  static int indexOf(uint64_t v) {
+    if (v < SUB_BUCKETS)
+      return static_cast<int>(v);
+    int msb = 63 - __builtin_clzll(v);
+    int shift = msb - SUB_BITS;
+    return (shift + 1) * SUB_BUCKETS +
+           static_cast<int>((v >> shift) & (SUB_BUCKETS - 1));
+  }
+
+  static uint64_t upperBound(int index) {
+    if (index < SUB_BUCKETS)
+      return static_cast<uint64_t>(index);
+    int shift = index / SUB_BUCKETS - 1;
+    uint64_t base = uint64_t(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return base + ((uint64_t(1) << shift) - 1);
+  }
+};
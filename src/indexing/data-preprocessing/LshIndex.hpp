@@ -0,0 +1,552 @@
+#pragma once
+
+#include "Deduplicator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @class LshIndex
+ * @brief Persistent, incremental near-duplicate index over b-bit MinHash
+ * signatures.
+ *
+ * STORAGE:
+ * - Only the low b bits (8 or 16) of each MinHash value are kept. Two
+ *   unrelated values still agree with probability 2^-b, so similarity() maps
+ *   the raw agreement rate f back to J = (f - 2^-b) / (1 - 2^-b). At 200
+ *   hashes and b = 16 a signature is 400 bytes instead of 1.6 KB.
+ * - Band keys are hashed from the packed values, so reopening the index
+ *   rebuilds its buckets without re-signing any document.
+ * - The file is a header (magic, version, hash seed and geometry) followed by
+ *   an append-only log of ADD and DELETE records. Re-adding a docId
+ *   supersedes the previous version; compact() rewrites the log with only
+ *   the live documents once tombstones pile up.
+ * - Each ADD also stores a 64-bit content hash of the text, so upsert() and
+ *   sync() recognize an unchanged chunk without shingling it again and
+ *   report only new and changed ones downstream. Version 1 files, which
+ *   lack the hash, are rewritten as version 2 when opened.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: New vendor releases are appended in O(new documents).
+ * - CON: b-bit values add 2^-b noise per row to band collisions and to the
+ *   similarity estimate; b = 8 is only advisable for short bands.
+ * - CON: Appends are buffered; call flush() at batch boundaries. A torn
+ *   trailing record is discarded on the next open().
+ */
+class LshIndex {
+public:
+  static constexpr char MAGIC[8] = {'R', 'C', 'A', 'L', 'S', 'H', 'I', 'X'};
+  static constexpr uint32_t FORMAT_VERSION = 2;
+  static constexpr int MAX_HASHES = 1 << 16; // Bounds a corrupt header
+
+  /**
+   * @struct Params
+   * @brief Everything a reopened index must agree on; stored in the header.
+   */
+  struct Params {
+    int numHashes = 200;
+    int shingleSize = 5;
+    int bands = 20;
+    int rows = 10;
+    int bits = 16; // 8 or 16
+    uint64_t seed = Deduplicator::DEFAULT_SEED;
+  };
+
+  struct Match {
+    int docId;
+    double similarity; // Estimated Jaccard similarity
+  };
+
+  /**
+   * @brief What upsert() did with a document. FAILED: the log write
+   * failed, so the change holds in memory only and is lost on reopen.
+   * Appends are buffered; a write the buffer absorbed fails at flush().
+   */
+  enum class Change { UNCHANGED, ADDED, MODIFIED, FAILED };
+
+  /**
+   * @struct Delta
+   * @brief The outcome of sync(): docIds the later stages must (re)process
+   * or retract, in release order.
+   */
+  struct Delta {
+    std::vector<int> added;
+    std::vector<int> modified;
+    std::vector<int> removed;
+    std::vector<int> failed; // Not logged: lost on reopen, sync them again
+    size_t unchanged = 0;
+  };
+
+  /**
+   * @brief Creates an empty index at path, replacing any existing file.
+   * @return nullptr on invalid parameters or I/O failure (reason in *error).
+   */
+  static std::unique_ptr<LshIndex> create(const std::string &path,
+                                          const Params &params,
+                                          std::string *error = nullptr) {
+    if (const char *why = checkParams(params))
+      return fail(error, why);
+    std::unique_ptr<LshIndex> index(new LshIndex(path, params));
+    if (!index->writeHeader(path, std::ios::trunc))
+      return fail(error, "cannot create " + path);
+    if (!index->openLog())
+      return fail(error, "cannot append to " + path);
+    return index;
+  }
+
+  /**
+   * @brief Reopens an index and replays its log. A partial record at the
+   * end (a crash mid-append) is truncated away.
+   */
+  static std::unique_ptr<LshIndex> open(const std::string &path,
+                                        std::string *error = nullptr) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+      return fail(error, "cannot open " + path);
+    FileHeader h;
+    if (!in.read(reinterpret_cast<char *>(&h), sizeof(h)) ||
+        std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0)
+      return fail(error, path + " is not an LSH index");
+    if (h.version != FORMAT_VERSION && h.version != 1)
+      return fail(error, path + ": unsupported format version " +
+                             std::to_string(h.version));
+
+    Params params;
+    params.numHashes = h.numHashes;
+    params.shingleSize = h.shingleSize;
+    params.bands = h.bands;
+    params.rows = h.rows;
+    params.bits = h.bits;
+    params.seed = h.seed;
+    if (const char *why = checkParams(params))
+      return fail(error, path + ": corrupt header (" + why + ")");
+    std::unique_ptr<LshIndex> index(new LshIndex(path, params));
+
+    uint64_t validEnd = sizeof(FileHeader);
+    std::vector<uint8_t> packed(index->sigBytes);
+    RecordHeader rec;
+    while (in.read(reinterpret_cast<char *>(&rec), sizeof(rec))) {
+      if (rec.kind == ADD) {
+        uint64_t hash = UNKNOWN_HASH; // Version 1 stores none
+        if ((h.version > 1 &&
+             !in.read(reinterpret_cast<char *>(&hash), sizeof(hash))) ||
+            !in.read(reinterpret_cast<char *>(packed.data()), packed.size()))
+          break;
+        index->insert(rec.docId, hash, packed.data());
+      } else if (rec.kind == DELETE) {
+        index->erase(rec.docId);
+      } else {
+        break;
+      }
+      index->logRecords++;
+      validEnd = static_cast<uint64_t>(in.tellg());
+    }
+    in.close();
+
+    std::error_code ec;
+    if (std::filesystem::file_size(path, ec) != validEnd)
+      std::filesystem::resize_file(path, validEnd, ec);
+    if (ec || !index->openLog())
+      return fail(error, "cannot append to " + path);
+    if (h.version != FORMAT_VERSION && !index->compact(error))
+      return nullptr;
+    return index;
+  }
+
+  ~LshIndex() { flush(); }
+
+  LshIndex(const LshIndex &) = delete;
+  LshIndex &operator=(const LshIndex &) = delete;
+
+  /**
+   * @brief Signs and indexes a document, superseding any earlier version
+   * with the same docId.
+   */
+  bool add(int docId, std::string_view text) {
+    std::vector<uint8_t> &packed = packedScratch();
+    sign(text, packed);
+    return append(docId, contentHash(text), packed.data());
+  }
+
+  /**
+   * @brief add() unless the stored version has the same content hash, in
+   * which case nothing is signed or logged.
+   */
+  Change upsert(int docId, std::string_view text) {
+    const uint64_t hash = contentHash(text);
+    auto it = slotOf.find(docId);
+    if (it == slotOf.end()) {
+      std::vector<uint8_t> &packed = packedScratch();
+      sign(text, packed);
+      return append(docId, hash, packed.data()) ? Change::ADDED
+                                                 : Change::FAILED;
+    }
+    if (slotHash[it->second] == hash)
+      return Change::UNCHANGED;
+    std::vector<uint8_t> &packed = packedScratch();
+    sign(text, packed);
+    // Without a stored hash (a version 1 record) an identical signature is
+    // the best evidence of an unchanged text; log it to record the hash.
+    const bool same =
+        slotHash[it->second] == UNKNOWN_HASH &&
+        std::memcmp(packed.data(), slotData(it->second), sigBytes) == 0;
+    if (!append(docId, hash, packed.data()))
+      return Change::FAILED;
+    return same ? Change::UNCHANGED : Change::MODIFIED;
+  }
+
+  /**
+   * @brief Upserts a whole release and, if `removeMissing`, removes the
+   * live documents it no longer contains. The returned docIds are exactly
+   * the chunks entity extraction has to see again.
+   */
+  Delta sync(const std::vector<Deduplicator::Document> &release,
+             bool removeMissing = true) {
+    Delta d;
+    std::unordered_set<int> present;
+    for (const Deduplicator::Document &doc : release) {
+      present.insert(doc.docId);
+      switch (upsert(doc.docId, doc.text)) {
+      case Change::ADDED:
+        d.added.push_back(doc.docId);
+        break;
+      case Change::MODIFIED:
+        d.modified.push_back(doc.docId);
+        break;
+      case Change::UNCHANGED:
+        d.unchanged++;
+        break;
+      case Change::FAILED:
+        d.failed.push_back(doc.docId);
+        break;
+      }
+    }
+    if (removeMissing) {
+      for (const auto &entry : slotOf)
+        if (!present.count(entry.first))
+          d.removed.push_back(entry.first);
+      std::sort(d.removed.begin(), d.removed.end());
+      for (int docId : d.removed)
+        if (!remove(docId))
+          d.failed.push_back(docId);
+    }
+    return d;
+  }
+
+  /**
+   * @brief Tombstones a document. Its slot and bucket entries are freed at
+   * once; the log shrinks at the next compact().
+   */
+  bool remove(int docId) {
+    if (!slotOf.count(docId))
+      return false;
+    RecordHeader rec{DELETE, docId};
+    log.write(reinterpret_cast<const char *>(&rec), sizeof(rec));
+    logRecords++;
+    erase(docId);
+    return static_cast<bool>(log);
+  }
+
+  /**
+   * @brief Live documents whose estimated similarity reaches threshold,
+   * most similar first.
+   */
+  std::vector<Match> query(std::string_view text, double threshold) const {
+    std::vector<uint8_t> &packed = packedScratch();
+    sign(text, packed);
+
+    std::unordered_set<uint32_t> seen;
+    std::vector<Match> matches;
+    for (int b = 0; b < params.bands; ++b) {
+      auto it = buckets[b].find(bandKey(packed.data(), b));
+      if (it == buckets[b].end())
+        continue;
+      for (uint32_t slot : it->second) {
+        if (!seen.insert(slot).second)
+          continue;
+        double sim = similarity(packed.data(), slotData(slot));
+        if (sim >= threshold)
+          matches.push_back({slotDoc[slot], sim});
+      }
+    }
+    std::sort(matches.begin(), matches.end(),
+              [](const Match &x, const Match &y) {
+                return x.similarity > y.similarity ||
+                       (x.similarity == y.similarity && x.docId < y.docId);
+              });
+    return matches;
+  }
+
+  /**
+   * @brief Estimated Jaccard similarity of two packed signatures.
+   */
+  double similarity(const uint8_t *sig1, const uint8_t *sig2) const {
+    double f = params.bits == 16
+                   ? agreement(reinterpret_cast<const uint16_t *>(sig1),
+                               reinterpret_cast<const uint16_t *>(sig2))
+                   : agreement(sig1, sig2);
+    double chance = 1.0 / static_cast<double>(1u << params.bits);
+    return std::max(0.0, (f - chance) / (1.0 - chance));
+  }
+
+  bool contains(int docId) const { return slotOf.count(docId) != 0; }
+  size_t liveCount() const { return slotOf.size(); }
+  size_t logRecordCount() const { return logRecords; }
+  const Params &parameters() const { return params; }
+
+  bool flush() {
+    log.flush();
+    return static_cast<bool>(log);
+  }
+
+  /**
+   * @brief Rewrites the log with one ADD per live document and swaps it in
+   * with an atomic rename.
+   */
+  bool compact(std::string *error = nullptr) {
+    const std::string tmp = path + ".tmp";
+    std::error_code ec;
+    bool written = writeHeader(tmp, std::ios::trunc);
+    if (written) {
+      std::ofstream out(tmp, std::ios::binary | std::ios::app);
+      for (const auto &entry : slotOf) {
+        RecordHeader rec{ADD, entry.first};
+        out.write(reinterpret_cast<const char *>(&rec), sizeof(rec));
+        out.write(reinterpret_cast<const char *>(&slotHash[entry.second]),
+                  sizeof(uint64_t));
+        out.write(reinterpret_cast<const char *>(slotData(entry.second)),
+                  sigBytes);
+      }
+      out.flush();
+      written = static_cast<bool>(out);
+    }
+    if (!written) {
+      std::filesystem::remove(tmp, ec);
+      setError(error, "cannot write " + tmp);
+      return false;
+    }
+
+    log.close();
+    std::filesystem::rename(tmp, path, ec);
+    bool reopened = openLog();
+    if (ec || !reopened) {
+      setError(error, ec ? "cannot rename " + tmp + " to " + path
+                         : "cannot append to " + path);
+      return false;
+    }
+    logRecords = slotOf.size();
+    return true;
+  }
+
+private:
+  enum RecordKind : uint32_t { ADD = 1, DELETE = 2 };
+
+  struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t bits;
+    int32_t numHashes;
+    int32_t shingleSize;
+    int32_t bands;
+    int32_t rows;
+    uint64_t seed;
+  };
+
+  // An ADD record is followed by the content hash of the text (since
+  // version 2) and the packed signature.
+  struct RecordHeader {
+    uint32_t kind;
+    int32_t docId;
+  };
+
+  static constexpr uint64_t UNKNOWN_HASH = 0;
+
+  std::string path;
+  Params params;
+  Deduplicator signer; // Owns the seeded MinHasher
+  size_t sigBytes;
+  std::ofstream log;
+  size_t logRecords = 0;
+
+  // Packed signatures in fixed-size slots; freed slots are reused, so
+  // memory tracks the live corpus.
+  std::vector<uint8_t> slots;
+  std::vector<int> slotDoc;
+  std::vector<uint64_t> slotHash; // UNKNOWN_HASH if read from version 1
+  std::vector<uint32_t> freeSlots;
+  std::unordered_map<int, uint32_t> slotOf;
+  std::vector<std::unordered_map<uint64_t, std::vector<uint32_t>>> buckets;
+
+  LshIndex(const std::string &path, const Params &params)
+      : path(path), params(params),
+        signer(params.numHashes, params.shingleSize, params.bands,
+               params.rows, params.seed),
+        sigBytes(static_cast<size_t>(params.numHashes) * (params.bits / 8)),
+        buckets(params.bands) {}
+
+  static std::unique_ptr<LshIndex> fail(std::string *error,
+                                        const std::string &why) {
+    setError(error, why);
+    return nullptr;
+  }
+
+  static void setError(std::string *error, const std::string &why) {
+    if (error)
+      *error = why;
+  }
+
+  /**
+   * @brief Why params cannot describe an index, or nullptr if they can.
+   */
+  static const char *checkParams(const Params &params) {
+    if (params.bits != 8 && params.bits != 16)
+      return "bits must be 8 or 16";
+    if (params.numHashes <= 0 || params.numHashes > MAX_HASHES)
+      return "numHashes must be in 1..65536";
+    if (params.rows <= 0 || params.bands <= 0 ||
+        int64_t(params.bands) * params.rows > params.numHashes)
+      return "bands * rows must fit in numHashes";
+    return nullptr;
+  }
+
+  static std::vector<uint32_t> &fullScratch() {
+    static thread_local std::vector<uint32_t> full;
+    return full;
+  }
+
+  static std::vector<uint8_t> &packedScratch() {
+    static thread_local std::vector<uint8_t> packed;
+    return packed;
+  }
+
+  bool writeHeader(const std::string &file, std::ios::openmode mode) const {
+    FileHeader h{};
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = FORMAT_VERSION;
+    h.bits = static_cast<uint32_t>(params.bits);
+    h.numHashes = params.numHashes;
+    h.shingleSize = params.shingleSize;
+    h.bands = params.bands;
+    h.rows = params.rows;
+    h.seed = params.seed;
+    std::ofstream out(file, std::ios::binary | mode);
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    out.flush();
+    return static_cast<bool>(out);
+  }
+
+  bool openLog() {
+    log.open(path, std::ios::binary | std::ios::app);
+    return static_cast<bool>(log);
+  }
+
+  /**
+   * @brief FNV-1a over the text, never UNKNOWN_HASH. Fixed by the format,
+   * unlike std::hash, so any build can compare against any file.
+   */
+  static uint64_t contentHash(std::string_view text) {
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : text) {
+      h ^= c;
+      h *= 1099511628211ull;
+    }
+    return h == UNKNOWN_HASH ? 1 : h;
+  }
+
+  void sign(std::string_view text, std::vector<uint8_t> &packed) const {
+    std::vector<uint32_t> &full = fullScratch();
+    full.resize(params.numHashes);
+    signer.generateSignature(text, full.data());
+    packed.resize(sigBytes);
+    pack(full.data(), packed.data());
+  }
+
+  bool append(int docId, uint64_t hash, const uint8_t *packed) {
+    RecordHeader rec{ADD, docId}; // Replay supersedes an earlier ADD too
+    log.write(reinterpret_cast<const char *>(&rec), sizeof(rec));
+    log.write(reinterpret_cast<const char *>(&hash), sizeof(hash));
+    log.write(reinterpret_cast<const char *>(packed), sigBytes);
+    logRecords++;
+    insert(docId, hash, packed);
+    return static_cast<bool>(log);
+  }
+
+  void pack(const uint32_t *full, uint8_t *out) const {
+    if (params.bits == 16) {
+      for (int i = 0; i < params.numHashes; ++i) {
+        uint16_t v = static_cast<uint16_t>(full[i]);
+        std::memcpy(out + 2 * i, &v, sizeof(v));
+      }
+    } else {
+      for (int i = 0; i < params.numHashes; ++i)
+        out[i] = static_cast<uint8_t>(full[i]);
+    }
+  }
+
+  template <typename T> double agreement(const T *x, const T *y) const {
+    int matches = 0;
+    for (int i = 0; i < params.numHashes; ++i)
+      matches += x[i] == y[i];
+    return static_cast<double>(matches) / params.numHashes;
+  }
+
+  uint64_t bandKey(const uint8_t *packed, int b) const {
+    return params.bits == 16
+               ? signer.hashBand(reinterpret_cast<const uint16_t *>(packed), b)
+               : signer.hashBand(packed, b);
+  }
+
+  const uint8_t *slotData(uint32_t slot) const {
+    return slots.data() + static_cast<size_t>(slot) * sigBytes;
+  }
+
+  void insert(int docId, uint64_t hash, const uint8_t *packed) {
+    if (slotOf.count(docId))
+      erase(docId); // Replayed re-add of a superseded document
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+      slot = freeSlots.back();
+      freeSlots.pop_back();
+      slotDoc[slot] = docId;
+      slotHash[slot] = hash;
+    } else {
+      slot = static_cast<uint32_t>(slotDoc.size());
+      slotDoc.push_back(docId);
+      slotHash.push_back(hash);
+      slots.resize(slots.size() + sigBytes);
+    }
+    std::memcpy(slots.data() + static_cast<size_t>(slot) * sigBytes, packed,
+                sigBytes);
+    slotOf[docId] = slot;
+    for (int b = 0; b < params.bands; ++b)
+      buckets[b][bandKey(packed, b)].push_back(slot);
+  }
+
+  void erase(int docId) {
+    auto it = slotOf.find(docId);
+    if (it == slotOf.end())
+      return;
+    uint32_t slot = it->second;
+    for (int b = 0; b < params.bands; ++b) {
+      auto bucket = buckets[b].find(bandKey(slotData(slot), b));
+      if (bucket == buckets[b].end())
+        continue;
+      auto &members = bucket->second;
+      members.erase(std::remove(members.begin(), members.end(), slot),
+                    members.end());
+      if (members.empty())
+        buckets[b].erase(bucket);
+    }
+    slotOf.erase(it);
+    freeSlots.push_back(slot);
+  }
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "PatternRegistry.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <memory_resource>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Negative Knowledge & Exception Tagger.
+ * Identifies prohibitions (MUST NOT), deprecations, and exceptions in technical
+ * text. This acts as the "Safety Guardrail" for the RCA system.
+ *
+ * Patterns are compiled once through PatternRegistry and shared by every
+ * instance; scan() is const and safe to call from several threads.
+ */
+class NegationTagger {
+public:
+  struct Constraint {
+    std::string type;   // PROHIBITION, DEPRECATION, EXCEPTION
+    std::string phrase; // The actual text anchor
+    bool isCritical;    // True for MUST NOT/NOT SUPPORTED
+  };
+
+  enum class ConstraintType : uint8_t { PROHIBITION, DEPRECATION, EXCEPTION };
+
+  static const char *constraintTypeName(ConstraintType t) {
+    static const char *names[] = {"PROHIBITION", "DEPRECATION", "EXCEPTION"};
+    return names[static_cast<size_t>(t)];
+  }
+
+  /**
+   * @struct ArenaConstraint
+   * @brief Constraint with its phrase in a per-chunk arena (see
+   * ChunkArena).
+   */
+  struct ArenaConstraint {
+    ConstraintType type;
+    std::pmr::string phrase;
+    bool isCritical;
+  };
+
+  // All patterns are matched case-insensitively.
+  static constexpr const char *PROHIBITION_PATTERN =
+      R"(\b(MUST NOT|SHOULD NOT|NOT SUPPORTED|NEVER|DO NOT)\b)";
+  static constexpr const char *DEPRECATION_PATTERN =
+      R"(\b(DEPRECATED|OBSOLETE|LEGACY|DISCONTINUED)\b)";
+  static constexpr const char *EXCEPTION_PATTERN =
+      R"(\b(EXCEPT|UNLESS|NOT APPLICABLE|WITH THE EXCEPTION OF)\b)";
+
+  NegationTagger()
+      : prohib(&PatternRegistry::icase(PROHIBITION_PATTERN)),
+        deprec(&PatternRegistry::icase(DEPRECATION_PATTERN)),
+        except(&PatternRegistry::icase(EXCEPTION_PATTERN)) {}
+
+  /**
+   * @brief Scans text for negative constraints.
+   */
+  std::vector<Constraint> scan(const std::string &text) const {
+    std::vector<Constraint> constraints;
+
+    // 1. Detect Prohibitions (MUST NOT, SHOULD NOT, NOT SUPPORTED)
+    auto prohib_it = std::sregex_iterator(text.begin(), text.end(), *prohib);
+    while (prohib_it != std::sregex_iterator()) {
+      constraints.push_back({"PROHIBITION", prohib_it->str(), true});
+      prohib_it++;
+    }
+
+    // 2. Detect Deprecations
+    auto deprec_it = std::sregex_iterator(text.begin(), text.end(), *deprec);
+    while (deprec_it != std::sregex_iterator()) {
+      constraints.push_back({"DEPRECATION", deprec_it->str(), false});
+      deprec_it++;
+    }
+
+    // 3. Detect Exceptions/Exclusions
+    auto except_it = std::sregex_iterator(text.begin(), text.end(), *except);
+    while (except_it != std::sregex_iterator()) {
+      constraints.push_back({"EXCEPTION", except_it->str(), false});
+      except_it++;
+    }
+
+    return constraints;
+  }
+
+  /**
+   * @brief scan() with the result, the phrases and the regex match state
+   * allocated from arena. Same constraints in the same order.
+   */
+  std::pmr::vector<ArenaConstraint>
+  scan(const std::string &text, std::pmr::memory_resource *arena) const {
+    std::pmr::vector<ArenaConstraint> constraints(arena);
+    PatternRegistry::ArenaMatch match(arena);
+    const std::pair<const std::regex *, ConstraintType> passes[] = {
+        {prohib, ConstraintType::PROHIBITION},
+        {deprec, ConstraintType::DEPRECATION},
+        {except, ConstraintType::EXCEPTION}};
+    for (const auto &[pattern, type] : passes)
+      PatternRegistry::forEachMatch(text, *pattern, match, [&](auto &m) {
+        constraints.push_back(
+            {type, std::pmr::string(m[0].first, m[0].second, arena),
+             type == ConstraintType::PROHIBITION});
+      });
+    return constraints;
+  }
+
+  void printResults(const std::vector<Constraint> &constraints) const {
+    std::cout << "--- Safety Constraints Found ---" << std::endl;
+    if (constraints.empty()) {
+      std::cout << "No constraints detected (Positive knowledge)." << std::endl;
+      return;
+    }
+
+    for (const auto &c : constraints) {
+      std::cout << "[" << c.type << "] marker: \"" << c.phrase << "\""
+                << (c.isCritical ? " [CRITICAL]" : "") << std::endl;
+    }
+  }
+
+private:
+  const std::regex *prohib;
+  const std::regex *deprec;
+  const std::regex *except;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ParallelFor
+ * @brief The fork-join loop of the batch stages (dedupe, bulk load,
+ * projection, Leiden, HNSW build, sharded search, community diff).
+ *
+ * run(n, threads, fn) calls fn(i) once for every i in [0, n) on up to
+ * `threads` workers, the calling thread being one of them, and returns
+ * when all calls have. Workers pull chunks of consecutive indices from a
+ * shared counter, so uneven items balance out. A chunk holds at most
+ * maxChunk indices and shrinks for small n so that every worker gets a
+ * few; run<1> when every index is a coarse task (a shard, a partition, a
+ * pre-split range).
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: No pool to own, configure or shut down, and no state shared
+ *   between calls.
+ * - CON: Threads are started on every call, tens of microseconds each.
+ *   Callers run it over whole phases, never inside inner loops.
+ */
+class ParallelFor {
+public:
+  static constexpr size_t DEFAULT_CHUNK = 64;
+
+  template <size_t maxChunk = DEFAULT_CHUNK, typename Fn>
+  static void run(size_t n, size_t threads, const Fn &fn) {
+    threads = std::max<size_t>(1, threads);
+    const size_t chunk =
+        std::max<size_t>(1, std::min(maxChunk, n / (threads * 4)));
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+      for (;;) {
+        size_t begin = next.fetch_add(chunk, std::memory_order_relaxed);
+        if (begin >= n)
+          return;
+        for (size_t i = begin; i < std::min(n, begin + chunk); ++i)
+          fn(i);
+      }
+    };
+    threads = std::min(threads, (n + chunk - 1) / chunk);
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t)
+      pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+      t.join();
+  }
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <regex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @class PatternRegistry
+ * @brief Process-wide cache of compiled regexes, keyed by pattern + flags.
+ *
+ * Compiling a std::regex costs far more than searching a short chunk with
+ * it, so annotators fetch their patterns here once (typically in their
+ * constructor) and keep the reference. Lookups take a shared lock; only the
+ * first request for a pattern compiles it under the exclusive lock.
+ *
+ * A compiled std::regex is immutable, and searching through a const
+ * reference is safe from any number of threads at once.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: Each pattern is compiled once per process, however many
+ *   annotator instances or threads use it.
+ * - CON: Entries live until exit. That is fine for the fixed pattern sets
+ *   here; do not feed it user-supplied patterns.
+ */
+class PatternRegistry {
+public:
+  using Flags = std::regex_constants::syntax_option_type;
+
+  /**
+   * @brief The compiled regex for pattern. The reference stays valid for
+   * the life of the process.
+   */
+  static const std::regex &get(const std::string &pattern,
+                               Flags flags = std::regex_constants::ECMAScript) {
+    PatternRegistry &self = instance();
+    std::string key = std::to_string(static_cast<unsigned>(flags)) + ':';
+    key += pattern;
+    {
+      std::shared_lock<std::shared_mutex> lock(self.mutex);
+      auto it = self.patterns.find(key);
+      if (it != self.patterns.end())
+        return *it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(self.mutex);
+    auto &slot = self.patterns[key];
+    if (!slot) // Another thread may have compiled it meanwhile
+      slot = std::make_unique<const std::regex>(pattern, flags);
+    return *slot;
+  }
+
+  static const std::regex &icase(const std::string &pattern) {
+    return get(pattern,
+               std::regex_constants::ECMAScript | std::regex_constants::icase);
+  }
+
+  /**
+   * @brief Match results for std::string text whose sub-match storage,
+   * and the regex engine's working copies of it, come from an arena.
+   */
+  using ArenaMatch =
+      std::match_results<std::string::const_iterator,
+                         std::pmr::polymorphic_allocator<std::ssub_match>>;
+
+  /**
+   * @brief Calls onMatch(match) for each match sregex_iterator would
+   * visit, reusing one caller-supplied match_results. The pattern must
+   * not match the empty string.
+   */
+  template <typename Match, typename OnMatch>
+  static void forEachMatch(const std::string &text, const std::regex &pattern,
+                           Match &match, const OnMatch &onMatch) {
+    auto begin = text.begin();
+    auto flags = std::regex_constants::match_default;
+    while (std::regex_search(begin, text.end(), match, pattern, flags)) {
+      onMatch(match);
+      begin = match[0].second;
+      flags |= std::regex_constants::match_prev_avail;
+    }
+  }
+
+  static size_t size() {
+    PatternRegistry &self = instance();
+    std::shared_lock<std::shared_mutex> lock(self.mutex);
+    return self.patterns.size();
+  }
+
+private:
+  std::shared_mutex mutex;
+  std::unordered_map<std::string, std::unique_ptr<const std::regex>> patterns;
+
+  static PatternRegistry &instance() {
+    static PatternRegistry registry;
+    return registry;
+  }
+};
@@ -0,0 +1,201 @@
+#include "PreprocessPipeline.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief Writes a synthetic corpus of RFC-style documents into dir. Every
+ * tenth document is a copy of an earlier one with one sentence changed,
+ * so the SIGNATURE stage has near-duplicates to find.
+ */
+static std::vector<std::string> makeCorpus(const std::string &dir,
+                                           size_t documents, uint64_t seed) {
+  static const char *sentences[] = {
+      "Each BGP message has a fixed-size header. ",
+      "The BGP FSM moves from Idle to Active when the TCP connection fails. ",
+      "A BGP-4 speaker MUST NOT advertise routes learned from an iBGP peer. ",
+      "If the session is Established, the RIB is updated with the route. ",
+      "An MTU mismatch on Gi0/1 keeps OSPFv2 neighbors Down. ",
+      "Te1/0/1 and Po12 carry the BGPv4 sessions on Cisco IOS-XR 7.3.2. ",
+      "See RFC 4271 Section 8 for the Border Gateway Protocol state rules. ",
+      "This option is deprecated unless the Jericho2 ASIC is present. ",
+      "Updates: 1771, 1772 for the Proposed Standard published June 2006. ",
+      "The interface is Shut by the operator and stays down. "};
+  const size_t count = sizeof(sentences) / sizeof(sentences[0]);
+  std::mt19937_64 gen(seed);
+  std::vector<std::string> texts;
+  std::vector<std::string> paths;
+  std::filesystem::create_directories(dir);
+  for (size_t d = 0; d < documents; ++d) {
+    std::string text;
+    if (d % 10 == 9) {
+      text = texts[gen() % texts.size()];
+      text.insert(text.size() / 2, sentences[gen() % count]);
+    } else {
+      size_t pages = 1 + gen() % 8;
+      for (size_t page = 1; page <= pages; ++page) {
+        text += "RFC 4271                 BGP-4                January 2006"
+                "\n\n   ";
+        for (size_t line = 0; line < 24; ++line) {
+          text += sentences[gen() % count];
+          text += "Peer 10." + std::to_string(gen() % 256) + '.' +
+                  std::to_string(gen() % 256) + " id " +
+                  std::to_string(gen() % 100000) + ". ";
+          if (line % 2)
+            text += "\n   ";
+        }
+        text += "\n\nRekhter, et al.       Standards Track       [Page " +
+                std::to_string(page) + "]\n\f\n";
+      }
+    }
+    char name[40];
+    std::snprintf(name, sizeof(name), "IETF-RFC-%05zu.txt", d);
+    paths.push_back(dir + "/" + name);
+    std::ofstream(paths.back(), std::ios::binary) << text;
+    texts.push_back(std::move(text));
+  }
+  return paths;
+}
+
+static void printReport(const PipelineReport &r) {
+  double mb = r.bytesOut / 1e6;
+  std::printf("%zu documents (%zu unreadable), %.1f MB out, %.3f s: "
+              "%.0f docs/s\n",
+              r.documents, r.failed, mb, r.wallSeconds,
+              r.wallSeconds > 0 ? r.documents / r.wallSeconds : 0.0);
+  std::printf("%-10s %8s %10s %10s %10s %10s %10s %7s\n", "stage", "count",
+              "p50 us", "p90 us", "p99 us", "max us", "total ms", "queued");
+  for (const PipelineReport::Stage &s : r.stages) {
+    const LatencyHistogram &h = s.latency;
+    std::printf("%-10s %8llu %10.1f %10.1f %10.1f %10.1f %10.1f %7zu\n",
+                s.name.c_str(), static_cast<unsigned long long>(h.count()),
+                h.percentileNs(0.50) / 1e3, h.percentileNs(0.90) / 1e3,
+                h.percentileNs(0.99) / 1e3, h.maxNs() / 1e3,
+                h.totalNs() / 1e6, s.maxQueued);
+  }
+  std::printf("%zu near-duplicates\n", r.duplicates.size());
+}
+
+static void printInstrumentation(const Instrumentation::Snapshot &snap) {
+  for (size_t c = 0; c < Instrumentation::COUNTERS; ++c) {
+    auto counter = static_cast<Instrumentation::Counter>(c);
+    if (snap.count(counter))
+      std::printf("%-28s %14llu\n", Instrumentation::counterName(counter),
+                  static_cast<unsigned long long>(snap.count(counter)));
+  }
+  for (size_t d = 0; d < Instrumentation::DISTRIBUTIONS; ++d) {
+    auto dist = static_cast<Instrumentation::Distribution>(d);
+    LatencyHistogram h = snap.distribution(dist);
+    if (h.count())
+      std::printf("%-28s p50 %llu  p99 %llu  max %llu\n",
+                  Instrumentation::distributionName(dist),
+                  static_cast<unsigned long long>(h.percentileNs(0.50)),
+                  static_cast<unsigned long long>(h.percentileNs(0.99)),
+                  static_cast<unsigned long long>(h.maxNs()));
+  }
+}
+
+static int usage(const char *argv0) {
+  std::cerr << "usage: " << argv0
+            << " [DIR] [--threads N] [--queue N] [--stages a,b,...]"
+               " [--out DIR] [--docs N] [--trace FILE]\n"
+               "stages: clean normalize fused version temporal negation "
+               "annotate enrich signature\n"
+               "Without DIR a synthetic corpus of N (2000) documents is "
+               "generated and removed. --trace writes the run's spans as "
+               "Chrome trace JSON."
+            << std::endl;
+  return 2;
+}
+
+int main(int argc, char **argv) {
+  PipelineConfig config;
+  std::string inputDir, outputDir, tracePath;
+  size_t syntheticDocs = 2000;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--threads" && hasValue) {
+      config.threads = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--queue" && hasValue) {
+      config.queueCapacity = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--stages" && hasValue) {
+      std::string error;
+      if (!parsePipelineStages(argv[++i], config.stages, &error)) {
+        std::cerr << error << std::endl;
+        return usage(argv[0]);
+      }
+    } else if (arg == "--docs" && hasValue) {
+      syntheticDocs = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--out" && hasValue) {
+      outputDir = argv[++i];
+    } else if (arg == "--trace" && hasValue) {
+      tracePath = argv[++i];
+    } else if (arg[0] != '-' && inputDir.empty()) {
+      inputDir = arg;
+    } else {
+      return usage(argv[0]);
+    }
+  }
+
+  std::vector<std::string> paths;
+  std::string tempDir;
+  if (inputDir.empty()) {
+    tempDir = (std::filesystem::temp_directory_path() /
+               ("preprocess_corpus_" + std::to_string(::getpid())))
+                  .string();
+    paths = makeCorpus(tempDir, syntheticDocs, 42);
+  } else {
+    std::string error;
+    paths = PreprocessPipeline::listDirectory(inputDir, &error);
+    if (!error.empty()) {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+  }
+
+  PreprocessPipeline pipeline(config);
+  std::cout << "--- Preprocess Pipeline: " << paths.size() << " files, "
+            << pipeline.config().threads << " threads, queue "
+            << pipeline.config().queueCapacity << " ---" << std::endl;
+  std::cout << "stages:";
+  for (PipelineStage s : pipeline.config().stages)
+    std::cout << ' ' << pipelineStageName(s);
+  std::cout << std::endl;
+
+  PreprocessPipeline::Sink sink;
+  if (!outputDir.empty()) {
+    std::filesystem::create_directories(outputDir);
+    sink = [&outputDir](const PipelineDocument &doc) {
+      std::ofstream(outputDir + "/" + doc.name, std::ios::binary) << doc.text;
+    };
+  }
+  if (!tracePath.empty())
+    Instrumentation::startTrace();
+  Instrumentation::Snapshot before = Instrumentation::snapshot();
+  PipelineReport report = pipeline.run(paths, sink);
+  Instrumentation::stopTrace();
+  printReport(report);
+  for (size_t k = 0; k < report.duplicates.size() && k < 5; ++k)
+    std::cout << "  " << paths[report.duplicates[k].first] << " ~ "
+              << paths[report.duplicates[k].second] << std::endl;
+  printInstrumentation(Instrumentation::snapshot().since(before));
+  if (!tracePath.empty()) {
+    std::ofstream trace(tracePath);
+    Instrumentation::writeChromeTrace(trace);
+    std::cout << "trace written to " << tracePath << " ("
+              << Instrumentation::droppedSpans() << " spans dropped)"
+              << std::endl;
+  }
+
+  if (!tempDir.empty())
+    std::filesystem::remove_all(tempDir);
+  return 0;
+}
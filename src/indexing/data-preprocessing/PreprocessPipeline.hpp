@@ -0,0 +1,528 @@
+#pragma once
+
+#include "ChunkAnnotator.hpp"
+#include "DataCleaner.hpp"
+#include "Deduplicator.hpp"
+#include "DomainNormalizer.hpp"
+#include "Instrumentation.hpp"
+#include "LatencyHistogram.hpp"
+#include "MetadataEnricher.hpp"
+#include "NegationTagger.hpp"
+#include "TemporalAnnotator.hpp"
+#include "TextNormalizer.hpp"
+#include "VersionResolver.hpp"
+#include "WorkStealingDeque.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @enum PipelineStage
+ * @brief The per-document stages the pipeline can chain, in any order.
+ */
+enum class PipelineStage : uint8_t {
+  CLEAN,           // DataCleaner::clean
+  NORMALIZE,       // DomainNormalizer::normalize
+  FUSED_NORMALIZE, // TextNormalizer: clean + normalize in one engine
+  VERSION,         // VersionResolver::resolve
+  TEMPORAL,        // TemporalAnnotator::annotate
+  NEGATION,        // NegationTagger::scan
+  ANNOTATE,        // ChunkAnnotator: version + temporal + negation
+  ENRICH,          // MetadataEnricher::enrich
+  SIGNATURE,       // MinHash signature, then near-duplicate check
+  COUNT
+};
+
+inline const char *pipelineStageName(PipelineStage s) {
+  static const char *names[] = {"clean",    "normalize", "fused",
+                                "version",  "temporal",  "negation",
+                                "annotate", "enrich",    "signature"};
+  return names[static_cast<size_t>(s)];
+}
+
+/**
+ * @brief Parses a comma-separated stage list such as "fused,annotate".
+ * @return False on an unknown or empty name, with the reason in error.
+ */
+inline bool parsePipelineStages(const std::string &csv,
+                                std::vector<PipelineStage> &out,
+                                std::string *error = nullptr) {
+  out.clear();
+  size_t start = 0;
+  while (start <= csv.size()) {
+    size_t comma = std::min(csv.find(',', start), csv.size());
+    std::string_view name(csv.data() + start, comma - start);
+    size_t s = 0;
+    while (s < static_cast<size_t>(PipelineStage::COUNT) &&
+           name != pipelineStageName(static_cast<PipelineStage>(s)))
+      ++s;
+    if (s == static_cast<size_t>(PipelineStage::COUNT)) {
+      if (error)
+        *error = "unknown stage '" + std::string(name) + "'";
+      return false;
+    }
+    out.push_back(static_cast<PipelineStage>(s));
+    start = comma + 1;
+  }
+  return true;
+}
+
+/**
+ * @struct PipelineDocument
+ * @brief One document in flight. Objects are recycled between documents,
+ * so their strings and vectors keep their capacity.
+ */
+struct PipelineDocument {
+  size_t index = 0; // Position in the input list
+  std::string path;
+  std::string name; // File name, used as the MetadataEnricher source name
+  std::string text; // Rewritten in place by the text stages
+  VersionResolver::ApplicabilityContext version;
+  TemporalAnnotator::TemporalSignal temporal;
+  std::vector<NegationTagger::Constraint> constraints;
+  std::vector<uint32_t> signature;
+};
+
+struct PipelineConfig {
+  std::vector<PipelineStage> stages = {
+      PipelineStage::FUSED_NORMALIZE, PipelineStage::ANNOTATE,
+      PipelineStage::SIGNATURE, PipelineStage::ENRICH};
+  size_t threads = 0;        // 0 = hardware concurrency
+  size_t queueCapacity = 64; // Queued documents allowed per stage
+  double duplicateThreshold = 0.8;
+};
+
+struct PipelineReport {
+  struct Stage {
+    std::string name;
+    LatencyHistogram latency;
+    size_t maxQueued = 0; // High-water mark of the stage's input queue
+  };
+
+  size_t documents = 0;
+  size_t failed = 0; // Files that could not be read
+  uint64_t bytesOut = 0; // Final text, after all stages
+  double wallSeconds = 0;
+  std::vector<Stage> stages; // "load" first, then config order
+  // (later, earlier) input indices of near-duplicate pairs, sorted.
+  std::vector<std::pair<size_t, size_t>> duplicates;
+};
+
+/**
+ * @class PreprocessPipeline
+ * @brief Runs a corpus through the preprocessing stages on all cores.
+ *
+ * SCHEDULING:
+ * - A task is (document, stage). Each worker owns a WorkStealingDeque;
+ *   after finishing a stage it pushes the document's next stage onto its
+ *   own deque, so a document tends to stay on one core, and idle workers
+ *   steal the oldest tasks from others.
+ * - Every stage's input queue is bounded by queueCapacity (a slot count
+ *   across all deques). When the next stage is full the worker runs it
+ *   inline instead of queueing, and new files are only read while the
+ *   first stage has room. Together that caps the documents in memory
+ *   and pushes back on the reader rather than letting queues grow.
+ * - Stage objects that are not thread-safe (DataCleaner, TextNormalizer,
+ *   MetadataEnricher ...) live in a per-worker Scratch with the reusable
+ *   buffers and the per-stage latency histograms, merged at the end.
+ * - SIGNATURE computes MinHash in parallel; the LSH lookup and insert into
+ *   the shared Deduplicator index run under one mutex when a document
+ *   completes.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: No per-stage thread pools to size; whichever stage is the
+ *   bottleneck gets all idle workers, and the histograms name it.
+ * - CON: The Deduplicator index keeps every signature in memory (about
+ *   1.6 KB per document at 200 hashes) and its lock serializes the
+ *   near-duplicate check, which is cheap next to the text stages.
+ */
+class PreprocessPipeline {
+public:
+  using Sink = std::function<void(const PipelineDocument &)>;
+
+  explicit PreprocessPipeline(PipelineConfig config = PipelineConfig())
+      : cfg(std::move(config)) {
+    if (!cfg.threads)
+      cfg.threads = std::max(1u, std::thread::hardware_concurrency());
+    if (!cfg.queueCapacity)
+      cfg.queueCapacity = 1;
+  }
+
+  const PipelineConfig &config() const { return cfg; }
+
+  /**
+   * @brief Regular files under dir, recursively, sorted by path.
+   */
+  static std::vector<std::string> listDirectory(const std::string &dir,
+                                                std::string *error = nullptr) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    namespace fs = std::filesystem;
+    for (fs::recursive_directory_iterator it(dir, ec), end; !ec && it != end;
+         it.increment(ec))
+      if (it->is_regular_file(ec))
+        paths.push_back(it->path().string());
+    if (ec && error)
+      *error = dir + ": " + ec.message();
+    std::sort(paths.begin(), paths.end());
+    return paths;
+  }
+
+  /**
+   * @brief Processes every file in paths. sink, if given, sees each
+   * finished document; it is called from worker threads concurrently.
+   */
+  PipelineReport run(const std::vector<std::string> &paths,
+                     const Sink &sink = nullptr) {
+    Run state(cfg, paths, sink);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t w = 1; w < cfg.threads; ++w)
+      workers.emplace_back([&state, w] { state.work(w); });
+    state.work(0);
+    for (std::thread &t : workers)
+      t.join();
+    std::chrono::duration<double> wall =
+        std::chrono::steady_clock::now() - start;
+    return state.report(wall.count());
+  }
+
+private:
+  PipelineConfig cfg;
+
+  struct Task {
+    PipelineDocument *doc = nullptr;
+    size_t step = 0; // Index into PipelineConfig::stages
+  };
+
+  struct Scratch {
+    DataCleaner cleaner;
+    DomainNormalizer normalizer;
+    TextNormalizer fused{cleaner, normalizer};
+    VersionResolver version;
+    TemporalAnnotator temporal;
+    NegationTagger negation;
+    ChunkAnnotator annotator;
+    MetadataEnricher enricher;
+    std::string buffer;
+    std::vector<uint64_t> wideSignature;
+    std::vector<LatencyHistogram> latency; // [0] = load, then per step
+  };
+
+  /**
+   * @brief State of one run(), shared by its workers.
+   */
+  class Run {
+  public:
+    Run(const PipelineConfig &cfg, const std::vector<std::string> &paths,
+        const Sink &sink)
+        : cfg(cfg), paths(paths), sink(sink), deques(cfg.threads),
+          scratch(cfg.threads), queued(cfg.stages.size()),
+          maxQueued(cfg.stages.size()) {
+      for (auto &s : scratch) {
+        s = std::make_unique<Scratch>();
+        s->latency.resize(cfg.stages.size() + 1);
+      }
+    }
+
+    void work(size_t w) {
+      Task task;
+      for (;;) {
+        if (deques[w].pop(task) || steal(w, task)) {
+          execute(w, task);
+          continue;
+        }
+        if (admit(w))
+          continue;
+        if (exhausted.load() && inFlight.load() == 0)
+          break;
+        std::unique_lock<std::mutex> lock(idleMutex);
+        idle.wait_for(lock, std::chrono::microseconds(200));
+      }
+      idle.notify_all(); // Let the others see the end promptly
+    }
+
+    PipelineReport report(double wallSeconds) {
+      PipelineReport r;
+      r.documents = completed;
+      r.failed = failed;
+      r.bytesOut = bytesOut;
+      r.wallSeconds = wallSeconds;
+      r.stages.resize(cfg.stages.size() + 1);
+      r.stages[0].name = "load";
+      for (size_t s = 0; s < cfg.stages.size(); ++s) {
+        r.stages[s + 1].name = pipelineStageName(cfg.stages[s]);
+        r.stages[s + 1].maxQueued = maxQueued[s].load();
+      }
+      for (auto &sc : scratch)
+        for (size_t s = 0; s < sc->latency.size(); ++s)
+          r.stages[s].latency.merge(sc->latency[s]);
+      r.duplicates = std::move(duplicates);
+      std::sort(r.duplicates.begin(), r.duplicates.end());
+      return r;
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    const PipelineConfig &cfg;
+    const std::vector<std::string> &paths;
+    const Sink &sink;
+    std::vector<WorkStealingDeque<Task>> deques;
+    std::vector<std::unique_ptr<Scratch>> scratch;
+    std::vector<std::atomic<size_t>> queued;
+    std::vector<std::atomic<size_t>> maxQueued;
+
+    std::atomic<size_t> nextPath{0};
+    std::atomic<bool> exhausted{false};
+    std::atomic<size_t> inFlight{0};
+    std::mutex idleMutex;
+    std::condition_variable idle;
+
+    std::mutex freeMutex;
+    std::vector<std::unique_ptr<PipelineDocument>> allDocs;
+    std::vector<PipelineDocument *> freeDocs; // Recycled, owned by allDocs
+
+    Deduplicator dedup;
+    std::mutex finishMutex; // Guards dedup and the totals below
+    std::vector<std::pair<size_t, size_t>> duplicates;
+    size_t completed = 0;
+    size_t failed = 0;
+    uint64_t bytesOut = 0;
+
+    static uint64_t since(Clock::time_point start) {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 Clock::now() - start)
+          .count();
+    }
+
+    bool reserve(size_t step) {
+      size_t n = queued[step].load();
+      do {
+        if (n >= cfg.queueCapacity)
+          return false;
+      } while (!queued[step].compare_exchange_weak(n, n + 1));
+      std::atomic<size_t> &peak = maxQueued[step];
+      size_t seen = peak.load();
+      while (seen < n + 1 && !peak.compare_exchange_weak(seen, n + 1))
+        ;
+      return true;
+    }
+
+    bool steal(size_t w, Task &task) {
+      for (size_t k = 1; k < deques.size(); ++k)
+        if (deques[(w + k) % deques.size()].steal(task))
+          return true;
+      return false;
+    }
+
+    PipelineDocument *acquireDoc() {
+      std::lock_guard<std::mutex> lock(freeMutex);
+      if (freeDocs.empty()) {
+        allDocs.push_back(std::make_unique<PipelineDocument>());
+        return allDocs.back().get();
+      }
+      PipelineDocument *doc = freeDocs.back();
+      freeDocs.pop_back();
+      return doc;
+    }
+
+    void releaseDoc(PipelineDocument *doc) {
+      std::lock_guard<std::mutex> lock(freeMutex);
+      freeDocs.push_back(doc);
+    }
+
+    /**
+     * @brief Reads the next file into a recycled document and queues its
+     * first stage, if that stage has room.
+     * @return False if nothing was admitted.
+     */
+    bool admit(size_t w) {
+      if (exhausted.load())
+        return false;
+      bool hasStages = !cfg.stages.empty();
+      if (hasStages && !reserve(0))
+        return false;
+      size_t i = nextPath.fetch_add(1);
+      if (i >= paths.size()) {
+        exhausted.store(true);
+        if (hasStages)
+          --queued[0];
+        return false;
+      }
+      inFlight.fetch_add(1);
+      PipelineDocument *doc = acquireDoc();
+      auto start = Clock::now();
+      bool ok;
+      {
+        RCA_SPAN("load");
+        ok = load(paths[i], i, *doc);
+      }
+      scratch[w]->latency[0].record(since(start));
+      RCA_COUNT(PREPROCESS_BYTES_IN, doc->text.size());
+      if (!ok) {
+        if (hasStages)
+          --queued[0];
+        {
+          std::lock_guard<std::mutex> lock(finishMutex);
+          ++failed;
+        }
+        recycle(doc);
+        return true;
+      }
+      if (!hasStages) {
+        finish(w, *doc);
+        return true;
+      }
+      deques[w].push({doc, 0});
+      idle.notify_one();
+      return true;
+    }
+
+    static bool load(const std::string &path, size_t index,
+                     PipelineDocument &doc) {
+      doc.index = index;
+      doc.path = path;
+      doc.name = std::filesystem::path(path).filename().string();
+      std::ifstream in(path, std::ios::binary | std::ios::ate);
+      if (!in)
+        return false;
+      std::streamoff size = in.tellg();
+      if (size < 0)
+        return false;
+      doc.text.resize(static_cast<size_t>(size));
+      in.seekg(0);
+      return static_cast<bool>(
+          in.read(&doc.text[0], static_cast<std::streamsize>(size)));
+    }
+
+    /**
+     * @brief Runs task's stage, then either queues the next stage or, if
+     * that stage is full, keeps going inline.
+     */
+    void execute(size_t w, Task task) {
+      --queued[task.step];
+      Scratch &s = *scratch[w];
+      for (;;) {
+        auto start = Clock::now();
+        {
+          RCA_SPAN(pipelineStageName(cfg.stages[task.step]));
+          runStage(s, cfg.stages[task.step], *task.doc);
+        }
+        uint64_t ns = since(start);
+        s.latency[task.step + 1].record(ns);
+        RCA_COUNT(PREPROCESS_STAGE_RUNS, 1);
+        RCA_OBSERVE(PREPROCESS_STAGE_NS, ns);
+        if (++task.step == cfg.stages.size())
+          return finish(w, *task.doc);
+        if (reserve(task.step)) {
+          deques[w].push(task);
+          idle.notify_one();
+          return;
+        }
+      }
+    }
+
+    void runStage(Scratch &s, PipelineStage stage, PipelineDocument &doc) {
+      switch (stage) {
+      case PipelineStage::CLEAN:
+        doc.text = s.cleaner.clean(doc.text);
+        break;
+      case PipelineStage::NORMALIZE:
+        doc.text = s.normalizer.normalize(doc.text);
+        break;
+      case PipelineStage::FUSED_NORMALIZE:
+        s.fused.process(doc.text, s.buffer);
+        doc.text.swap(s.buffer);
+        break;
+      case PipelineStage::VERSION:
+        doc.version = s.version.resolve(doc.text);
+        break;
+      case PipelineStage::TEMPORAL:
+        doc.temporal = s.temporal.annotate(doc.text);
+        break;
+      case PipelineStage::NEGATION:
+        doc.constraints = s.negation.scan(doc.text);
+        break;
+      case PipelineStage::ANNOTATE: {
+        ChunkAnnotator::Annotation a = s.annotator.annotate(doc.text);
+        doc.version = std::move(a.version);
+        doc.temporal = std::move(a.temporal);
+        doc.constraints = std::move(a.constraints);
+        break;
+      }
+      case PipelineStage::ENRICH:
+        doc.text = s.enricher.enrich(doc.text, doc.name);
+        break;
+      case PipelineStage::SIGNATURE:
+        doc.signature.resize(static_cast<size_t>(dedup.hashCount()));
+        dedup.generateSignature(doc.text, doc.signature.data());
+        break;
+      default:
+        break;
+      }
+    }
+
+    void finish(size_t w, PipelineDocument &doc) {
+      RCA_COUNT(PREPROCESS_DOCUMENTS, 1);
+      RCA_COUNT(PREPROCESS_BYTES_OUT, doc.text.size());
+      if (sink)
+        sink(doc);
+      Scratch &s = *scratch[w];
+      {
+        std::lock_guard<std::mutex> lock(finishMutex);
+        ++completed;
+        bytesOut += doc.text.size();
+        if (!doc.signature.empty()) {
+          s.wideSignature.assign(doc.signature.begin(), doc.signature.end());
+          checkDuplicate(doc.index, s.wideSignature);
+        }
+      }
+      recycle(&doc);
+    }
+
+    // Caller holds finishMutex.
+    void checkDuplicate(size_t index, const std::vector<uint64_t> &sig) {
+      int id = static_cast<int>(index);
+      int best = -1;
+      double bestSim = cfg.duplicateThreshold;
+      for (int cand : dedup.findCandidates(sig)) {
+        double sim = dedup.calculateSimilarity(sig, dedup.getSignature(cand));
+        if (sim >= bestSim && (best < 0 || sim > bestSim || cand < best)) {
+          best = cand;
+          bestSim = sim;
+        }
+      }
+      // Completion order varies between runs; report the later input as
+      // the duplicate of the earlier one either way.
+      if (best >= 0)
+        duplicates.emplace_back(std::max(index, size_t(best)),
+                                std::min(index, size_t(best)));
+      dedup.indexDocument(id, sig);
+    }
+
+    void recycle(PipelineDocument *doc) {
+      doc->text.clear();
+      doc->version = {};
+      doc->temporal = {};
+      doc->constraints.clear();
+      doc->signature.clear();
+      releaseDoc(doc);
+      if (inFlight.fetch_sub(1) == 1 && exhausted.load())
+        idle.notify_all();
+    }
+  };
+};
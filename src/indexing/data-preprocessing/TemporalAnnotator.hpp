@@ -0,0 +1,120 @@
+#pragma once
+
+#include "PatternRegistry.hpp"
+
+#include <iostream>
+#include <regex>
+#include <string>
+#include <utility>
+
+/**
+ * @brief Temporal & Stability Signal Annotator.
+ * Extracts dates, document status (Proposed, Draft, Standard), and
+ * calculates the 'Knowledge Decay' factor.
+ *
+ * Patterns are compiled once through PatternRegistry and shared by every
+ * instance; annotate() is const and safe to call from several threads.
+ */
+class TemporalAnnotator {
+public:
+  struct TemporalSignal {
+    std::string dateStr;
+    std::string status;    // Draft, Proposed Standard, Internet Standard
+    double stabilityScore; // 0.0 (unstable/draft) to 1.0 (long-term stable)
+    int yearsOld = 0;
+  };
+
+  // All patterns are matched case-insensitively.
+  static constexpr const char *DATE_PATTERN =
+      R"(\b(January|February|March|April|May|June|July|August|September|October|November|December)\s+\d{4}\b)";
+  static constexpr const char *INTERNET_STANDARD_PATTERN =
+      R"(\bInternet Standard\b)";
+  static constexpr const char *PROPOSED_STANDARD_PATTERN =
+      R"(\bProposed Standard\b)";
+  static constexpr const char *DRAFT_PATTERN = R"(\b(Draft|Internet-Draft)\b)";
+
+  TemporalAnnotator()
+      : date(&PatternRegistry::icase(DATE_PATTERN)),
+        internetStandard(&PatternRegistry::icase(INTERNET_STANDARD_PATTERN)),
+        proposedStandard(&PatternRegistry::icase(PROPOSED_STANDARD_PATTERN)),
+        draft(&PatternRegistry::icase(DRAFT_PATTERN)) {}
+
+  /**
+   * @brief Extracts time-based signals and determines knowledge stability.
+   */
+  TemporalSignal annotate(const std::string &text) const {
+    return fromMatches(extractPattern(text, *date),
+                       std::regex_search(text, *internetStandard),
+                       std::regex_search(text, *proposedStandard),
+                       std::regex_search(text, *draft));
+  }
+
+  /**
+   * @brief Builds the signal from what the patterns found: the first date
+   * match and whether each status pattern occurs. Shared with
+   * ChunkAnnotator, which finds these in a combined scan.
+   */
+  static TemporalSignal fromMatches(std::string dateStr, bool internetStd,
+                                    bool proposedStd, bool isDraft) {
+    TemporalSignal signal;
+    signal.dateStr = std::move(dateStr);
+
+    // Determine status
+    if (internetStd) {
+      signal.status = "Internet Standard";
+      signal.stabilityScore = 1.0;
+    } else if (proposedStd) {
+      signal.status = "Proposed Standard";
+      signal.stabilityScore = 0.8;
+    } else if (isDraft) {
+      signal.status = "Draft";
+      signal.stabilityScore = 0.3;
+    } else {
+      signal.status = "Informational / Unknown";
+      signal.stabilityScore = 0.5;
+    }
+
+    // Calculate age (Simplified)
+    if (!signal.dateStr.empty()) {
+      std::smatch m;
+      if (std::regex_search(signal.dateStr, m,
+                            PatternRegistry::get(R"(\d{4})"))) {
+        int pubYear = std::stoi(m[0].str());
+        int currentYear = 2026; // Simulated current year based on context
+        signal.yearsOld = currentYear - pubYear;
+
+        // Decay stability for extremely old documents unless they are Internet
+        // Standards
+        if (signal.yearsOld > 15 && signal.status != "Internet Standard") {
+          signal.stabilityScore *= 0.7;
+        }
+      }
+    }
+
+    return signal;
+  }
+
+  void printResults(const TemporalSignal &s) const {
+    std::cout << "--- Temporal Intelligence ---" << std::endl;
+    std::cout << "[Publication Date]: "
+              << (s.dateStr.empty() ? "Unknown" : s.dateStr) << std::endl;
+    std::cout << "[Document Status]:   " << s.status << std::endl;
+    std::cout << "[Stability Score]:   " << s.stabilityScore << " (Scale 0-1)"
+              << std::endl;
+    std::cout << "[Knowledge Age]:     " << s.yearsOld << " years" << std::endl;
+  }
+
+private:
+  const std::regex *date;
+  const std::regex *internetStandard;
+  const std::regex *proposedStandard;
+  const std::regex *draft;
+
+  static std::string extractPattern(const std::string &text,
+                                    const std::regex &pattern) {
+    std::smatch match;
+    if (std::regex_search(text, match, pattern))
+      return match[0].str();
+    return "";
+  }
+};
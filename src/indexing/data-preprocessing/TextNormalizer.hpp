@@ -0,0 +1,398 @@
+#pragma once
+
+#include "DataCleaner.hpp"
+#include "DomainNormalizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class TextNormalizer
+ * @brief Fused DataCleaner::clean + DomainNormalizer::normalize.
+ *
+ * The chained implementation makes about 20 regex passes per document and
+ * compiles a regex per rule per call. Here every rule is compiled once, at
+ * construction, and a document takes three linear passes over reusable
+ * buffers:
+ * 1. Page markers ("[Page 12]") are dropped.
+ * 2. RFC header/footer lines are dropped, and the kept bytes go through a
+ *    whitespace-collapsing sink, which also trims.
+ * 3. One trie walk at each word start applies the acronym, interface,
+ *    protocol and state rules together.
+ * Passes 1 and 2 stay separate from 3 because the boilerplate rules are
+ * defined on line structure that whitespace collapsing destroys.
+ *
+ * Every dictionary rule is anchored by \b at a word start, so a trie
+ * entered only at word starts finds all matches; Aho-Corasick failure links
+ * would only add matches that start mid-word and can never be used.
+ *
+ * CHAINING: in the chained version a rule sees the output of every rule
+ * before it, e.g. BGP-4 -> "Border Gateway Protocol-4" (acronym) -> "BGP-4"
+ * -> "BGP" (protocol rules, in map order). Rules are stored in that same
+ * order, and at each word start they are applied one after another to the
+ * spliced result, so such interactions come out the same. A rule cannot
+ * affect a different word start, which holds for the shipped tables.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: No regex compilation per document and no intermediate string per
+ *   rule; the output buffer is reused across calls.
+ * - CON: The RFC boilerplate patterns are hand-coded; a change to
+ *   DataCleaner's line regex needs the matching change here.
+ * - CON: Not thread-safe; use one instance per worker.
+ */
+class TextNormalizer {
+public:
+  TextNormalizer() : TextNormalizer(DataCleaner(), DomainNormalizer()) {}
+
+  TextNormalizer(const DataCleaner &cleaner,
+                 const DomainNormalizer &normalizer) {
+    nodes.emplace_back();
+    addRules(cleaner.acronyms(), ACRONYM, WORD, true);
+    addRules(normalizer.interfaceAliases(), INTERFACE, ALIAS, true);
+    addRules(normalizer.protocolVariants(), PROTOCOL, WORD, false);
+    addRules(normalizer.stateTerms(), STATE, WORD, false);
+  }
+
+  /**
+   * @brief Equivalent to normalizer.normalize(cleaner.clean(raw)).
+   * @return A view of an internal buffer, valid until the next call.
+   */
+  std::string_view process(std::string_view raw) {
+    process(raw, output);
+    return output;
+  }
+
+  /**
+   * @brief As above, writing into out (cleared first).
+   */
+  void process(std::string_view raw, std::string &out) {
+    stripPageMarkers(raw, pages);
+    collapsed.clear();
+    stripBoilerplate(pages, collapsed);
+    out.clear();
+    rewrite(collapsed, out);
+  }
+
+private:
+  enum Stage : uint8_t { ACRONYM, INTERFACE, PROTOCOL, STATE };
+  enum Kind : uint8_t {
+    WORD, // \bTERM\b
+    ALIAS // \bALIAS(\d+[\/\d+]*)\b, the tail is kept
+  };
+
+  struct Rule {
+    std::string pattern;
+    std::string replacement;
+    Stage stage;
+    Kind kind;
+    bool caseSensitive;
+  };
+
+  struct Node {
+    std::array<int32_t, 128> next; // Indexed by lower-cased ASCII byte
+    std::vector<uint32_t> accepts; // Rules ending here
+    Node() { next.fill(-1); }
+  };
+
+  std::vector<Rule> rules;
+  std::vector<Node> nodes;
+  std::string pages;
+  std::string collapsed;
+  std::string output;
+  std::string head;    // Rewritten text at the current word start
+  std::string spliced; // Scratch for building the next head
+
+  static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+  static bool isWord(char c) {
+    return isDigit(c) || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+           c == '_';
+  }
+  // std::regex \s in the "C" locale.
+  static bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+  }
+  // ECMAScript '.' stops at these.
+  static bool isLineBreak(char c) { return c == '\n' || c == '\r'; }
+  static char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+  }
+
+  void addRules(const std::unordered_map<std::string, std::string> &table,
+                Stage stage, Kind kind, bool caseSensitive) {
+    for (const auto &[pattern, replacement] : table) {
+      // The trie is over folded ASCII; other rules are not supported.
+      auto nonAscii = [](char c) {
+        return static_cast<unsigned char>(c) >= 128;
+      };
+      if (pattern.empty() ||
+          std::any_of(pattern.begin(), pattern.end(), nonAscii))
+        continue;
+      int32_t node = 0;
+      for (char c : pattern) {
+        unsigned char k = static_cast<unsigned char>(lower(c));
+        if (nodes[node].next[k] < 0) {
+          nodes[node].next[k] = static_cast<int32_t>(nodes.size());
+          nodes.emplace_back();
+        }
+        node = nodes[node].next[k];
+      }
+      nodes[node].accepts.push_back(static_cast<uint32_t>(rules.size()));
+      rules.push_back({pattern, replacement, stage, kind, caseSensitive});
+    }
+  }
+
+  /**
+   * @brief The text at a word start as the chain would see it: what earlier
+   * rules wrote there (head) followed by the untouched input (tail).
+   */
+  struct Spliced {
+    std::string_view head;
+    std::string_view tail;
+    bool wordBefore;
+
+    size_t size() const { return head.size() + tail.size(); }
+    char operator[](size_t k) const {
+      return k < head.size() ? head[k] : tail[k - head.size()];
+    }
+    bool boundaryAt(size_t k) const {
+      bool before = k ? isWord((*this)[k - 1]) : wordBefore;
+      bool after = k < size() && isWord((*this)[k]);
+      return before != after;
+    }
+  };
+
+  /**
+   * @brief End of an ALIAS match whose alias ends at k, or npos. This is
+   * the last position in the [0-9/+] run that is a \b, which is where the
+   * regex `(\d+[\/\d+]*)\b` ends after backtracking.
+   */
+  static size_t aliasTailEnd(const Spliced &s, size_t k) {
+    if (k >= s.size() || !isDigit(s[k]))
+      return std::string_view::npos;
+    size_t run = k + 1;
+    while (run < s.size() &&
+           (isDigit(s[run]) || s[run] == '/' || s[run] == '+'))
+      ++run;
+    for (size_t e = run; e > k; --e)
+      if (s.boundaryAt(e))
+        return e;
+    return std::string_view::npos;
+  }
+
+  /**
+   * @brief First rule after `after` in chain order that matches at the
+   * start of s. Rules are stored in chain order, so that is the lowest id.
+   * @return Whether one matched; its id and match length are set.
+   */
+  bool firstMatch(const Spliced &s, int64_t after, uint32_t &id,
+                  size_t &length) const {
+    bool found = false;
+    int32_t node = 0;
+    for (size_t j = 0; j < s.size(); ++j) {
+      unsigned char k = static_cast<unsigned char>(lower(s[j]));
+      if (k >= 128 || (node = nodes[node].next[k]) < 0)
+        break;
+      for (uint32_t candidate : nodes[node].accepts) {
+        if (candidate <= after || (found && candidate >= id))
+          continue;
+        const Rule &r = rules[candidate];
+        bool exact = true;
+        for (size_t c = 0; r.caseSensitive && exact && c <= j; ++c)
+          exact = s[c] == r.pattern[c];
+        size_t end = j + 1;
+        if (r.kind == ALIAS)
+          end = aliasTailEnd(s, end);
+        else if (!s.boundaryAt(end))
+          end = std::string_view::npos;
+        if (!exact || end == std::string_view::npos)
+          continue;
+        found = true;
+        id = candidate;
+        length = end;
+      }
+    }
+    return found;
+  }
+
+  /**
+   * @brief Applies the dictionary rules in one left-to-right walk.
+   *
+   * At each word start the rules are applied in chain order, each to the
+   * result of the previous one, as the sequential regex_replace calls
+   * would. That keeps interactions such as BGP-4 -> "Border Gateway
+   * Protocol-4" -> "BGP-4" -> "BGP" exact without a pass per rule.
+   */
+  void rewrite(std::string_view text, std::string &out) {
+    const size_t n = text.size();
+    size_t copied = 0;
+    size_t i = 0;
+    while (i < n) {
+      if (!isWord(text[i])) {
+        ++i;
+        continue;
+      }
+      // After a replacement the previous byte is the one written last.
+      bool wordBefore = copied == i && !out.empty()
+                            ? isWord(out.back())
+                            : i > 0 && isWord(text[i - 1]);
+      if (wordBefore) {
+        while (++i < n && isWord(text[i])) {
+        }
+        continue;
+      }
+      size_t tailPos = i;
+      int64_t last = -1;
+      uint32_t id;
+      size_t length;
+      head.clear();
+      while (firstMatch({head, text.substr(tailPos), false}, last, id,
+                        length)) {
+        // The new view is the replacement followed by what the match did
+        // not consume; an ALIAS keeps its digits.
+        const Rule &r = rules[id];
+        size_t keep = r.kind == ALIAS ? r.pattern.size() : length;
+        spliced.assign(r.replacement);
+        if (keep <= head.size())
+          spliced.append(head, keep, std::string::npos);
+        else
+          tailPos += keep - head.size();
+        head.swap(spliced);
+        last = id;
+      }
+      if (last >= 0) {
+        out.append(text, copied, i - copied);
+        out += head;
+        i = copied = tailPos;
+        continue;
+      }
+      while (++i < n && isWord(text[i])) {
+      }
+    }
+    out.append(text, copied, n - copied);
+  }
+
+  /**
+   * @brief Removes \[Page\s+\d+\].
+   */
+  static void stripPageMarkers(std::string_view in, std::string &out) {
+    out.clear();
+    size_t copied = 0;
+    size_t i = in.find('[');
+    while (i != std::string_view::npos) {
+      size_t j = i + 5;
+      if (in.compare(i + 1, 4, "Page") == 0) {
+        size_t digits = j;
+        while (digits < in.size() && isSpace(in[digits]))
+          ++digits;
+        size_t close = digits;
+        while (close < in.size() && isDigit(in[close]))
+          ++close;
+        if (digits > j && close > digits && close < in.size() &&
+            in[close] == ']') {
+          out.append(in, copied, i - copied);
+          copied = j = close + 1;
+        }
+      }
+      i = in.find('[', std::min(j, i + 1));
+    }
+    out.append(in, copied, in.size() - copied);
+  }
+
+  /**
+   * @brief Appends bytes with runs of \s collapsed to one space and both
+   * ends trimmed, like DataCleaner::normalizeWhitespace.
+   */
+  struct SpaceSink {
+    std::string &out;
+    bool pending = false;
+
+    void put(std::string_view s) {
+      for (char c : s) {
+        if (isSpace(c)) {
+          pending = !out.empty();
+          continue;
+        }
+        if (pending)
+          out += ' ';
+        pending = false;
+        out += c;
+      }
+    }
+  };
+
+  /**
+   * @brief End of an `RFC\s+\d+.*[12][0-9]{3}` match at p, or npos. The
+   * greedy .* backtracks to the last year-like token on the digits' line.
+   */
+  static size_t rfcLineEnd(std::string_view s, size_t p) {
+    if (s.compare(p, 3, "RFC") != 0)
+      return std::string_view::npos;
+    size_t w = p + 3;
+    while (w < s.size() && isSpace(s[w]))
+      ++w;
+    if (w == p + 3 || w >= s.size() || !isDigit(s[w]))
+      return std::string_view::npos;
+    size_t lineEnd = w;
+    while (lineEnd < s.size() && !isLineBreak(s[lineEnd]))
+      ++lineEnd;
+    for (size_t q = lineEnd >= 4 ? lineEnd - 4 : 0; q >= w + 1; --q) {
+      if ((s[q] == '1' || s[q] == '2') && isDigit(s[q + 1]) &&
+          isDigit(s[q + 2]) && isDigit(s[q + 3]))
+        return q + 4;
+    }
+    return std::string_view::npos;
+  }
+
+  /**
+   * @brief Replays DataCleaner's boilerplate regex
+   * `RFC\s+\d+.*[12][0-9]{3}|.*Standards Track.*|.*Category:.*|
+   * .*Informational.*` as regex_replace would, feeding kept text to sink.
+   */
+  static void stripBoilerplate(std::string_view s, std::string &out) {
+    static constexpr std::string_view phrases[] = {
+        "Standards Track", "Category:", "Informational"};
+    SpaceSink sink{out};
+    size_t pos = 0;
+    while (pos < s.size()) {
+      size_t lineEnd = pos;
+      while (lineEnd < s.size() && !isLineBreak(s[lineEnd]))
+        ++lineEnd;
+      std::string_view rest = s.substr(pos, lineEnd - pos);
+      bool phrase = false;
+      for (std::string_view ph : phrases)
+        phrase = phrase || rest.find(ph) != std::string_view::npos;
+      // Leftmost start: a phrase line matches from pos already, unless the
+      // first alternative matches at pos too.
+      size_t start = std::string_view::npos, end = 0;
+      if (phrase) {
+        start = pos;
+        end = rfcLineEnd(s, pos);
+        if (end == std::string_view::npos)
+          end = lineEnd;
+      } else {
+        for (size_t p = rest.find("RFC"); p != std::string_view::npos;
+             p = rest.find("RFC", p + 1)) {
+          end = rfcLineEnd(s, pos + p);
+          if (end != std::string_view::npos) {
+            start = pos + p;
+            break;
+          }
+        }
+      }
+      if (start == std::string_view::npos) {
+        // Nothing on this line; keep it and its line break.
+        size_t next = lineEnd < s.size() ? lineEnd + 1 : lineEnd;
+        sink.put(s.substr(pos, next - pos));
+        pos = next;
+        continue;
+      }
+      sink.put(s.substr(pos, start - pos));
+      pos = end;
+    }
+  }
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "PatternRegistry.hpp"
+
+#include <iostream>
+#include <memory_resource>
+#include <regex>
+#include <set>
+#include <string>
+
+/**
+ * @brief Version & Applicability Resolver for Networking Docs.
+ * Responsible for extracting RFC numbers, Obsoletes/Updates links,
+ * software versions (IOS-XR, JunOS), and hardware signatures.
+ *
+ * Patterns are compiled once through PatternRegistry and shared by every
+ * instance; resolve() is const and safe to call from several threads.
+ */
+class VersionResolver {
+public:
+  struct ApplicabilityContext {
+    std::string rfcNumber;
+    std::string obsoletes;
+    std::string updates;
+    std::set<std::string> osVersions;
+    std::set<std::string> hardwarePlatforms;
+  };
+
+  /**
+   * @struct ArenaContext
+   * @brief ApplicabilityContext with every string and set node in a
+   * per-chunk arena (see ChunkArena).
+   */
+  struct ArenaContext {
+    std::pmr::string rfcNumber;
+    std::pmr::string obsoletes;
+    std::pmr::string updates;
+    std::pmr::set<std::pmr::string> osVersions;
+    std::pmr::set<std::pmr::string> hardwarePlatforms;
+
+    explicit ArenaContext(std::pmr::memory_resource *arena)
+        : rfcNumber(arena), obsoletes(arena), updates(arena),
+          osVersions(arena), hardwarePlatforms(arena) {}
+  };
+
+  // All patterns are matched case-insensitively.
+  static constexpr const char *RFC_PATTERN = R"(RFC\s*(\d+))";
+  static constexpr const char *OBSOLETES_PATTERN =
+      R"(Obsoletes:\s*RFC\s*(\d+))";
+  static constexpr const char *UPDATES_PATTERN = R"(Updates:\s*RFC\s*(\d+))";
+  static constexpr const char *OS_PATTERN =
+      R"((IOS-XR|JunOS|Cisco\s*IOS|NX-OS)\s*(\d+\.\d+[\.\d+]*))";
+  static constexpr const char *HARDWARE_PATTERN =
+      R"(\b(Jericho\d*|Trident[+\d]*|NCS-\d+|ASR-\d+|Linecard|ASIC)\b)";
+
+  VersionResolver()
+      : rfc(&PatternRegistry::icase(RFC_PATTERN)),
+        obsoletesRe(&PatternRegistry::icase(OBSOLETES_PATTERN)),
+        updatesRe(&PatternRegistry::icase(UPDATES_PATTERN)),
+        os(&PatternRegistry::icase(OS_PATTERN)),
+        hardware(&PatternRegistry::icase(HARDWARE_PATTERN)) {}
+
+  /**
+   * @brief Scans technical text to extract versioning and compatibility
+   * context.
+   */
+  ApplicabilityContext resolve(const std::string &text) const {
+    ApplicabilityContext ctx;
+
+    ctx.rfcNumber = extractPattern(text, *rfc);
+    ctx.obsoletes = extractPattern(text, *obsoletesRe);
+    ctx.updates = extractPattern(text, *updatesRe);
+
+    // Extract OS Versions (e.g., IOS-XR 7.1, JunOS 21.4)
+    ctx.osVersions = extractAll(text, *os);
+
+    // Extract Hardware signatures (e.g., Jericho2, Trident+, ASIC, NCS-5500)
+    ctx.hardwarePlatforms = extractAll(text, *hardware);
+
+    return ctx;
+  }
+
+  /**
+   * @brief resolve() with the result and the regex match state allocated
+   * from arena.
+   */
+  ArenaContext resolve(const std::string &text,
+                       std::pmr::memory_resource *arena) const {
+    ArenaContext ctx(arena);
+    PatternRegistry::ArenaMatch match(arena);
+    extractPattern(text, *rfc, match, ctx.rfcNumber);
+    extractPattern(text, *obsoletesRe, match, ctx.obsoletes);
+    extractPattern(text, *updatesRe, match, ctx.updates);
+    PatternRegistry::forEachMatch(text, *os, match, [&](const auto &m) {
+      ctx.osVersions.emplace(m[0].first, m[0].second);
+    });
+    PatternRegistry::forEachMatch(text, *hardware, match, [&](const auto &m) {
+      ctx.hardwarePlatforms.emplace(m[0].first, m[0].second);
+    });
+    return ctx;
+  }
+
+  /**
+   * @brief Pretty prints the context for verification.
+   */
+  void printContext(const ApplicabilityContext &ctx) const {
+    std::cout << "--- Version Applicability Matrix ---" << std::endl;
+    if (!ctx.rfcNumber.empty())
+      std::cout << "[RFC ID]:   " << ctx.rfcNumber << std::endl;
+    if (!ctx.obsoletes.empty())
+      std::cout << "[OBSOLETES]: " << ctx.obsoletes << std::endl;
+    if (!ctx.updates.empty())
+      std::cout << "[UPDATES]:   " << ctx.updates << std::endl;
+
+    if (!ctx.osVersions.empty()) {
+      std::cout << "[SOFTWARE]:  ";
+      for (const auto &v : ctx.osVersions)
+        std::cout << v << " ";
+      std::cout << std::endl;
+    }
+
+    if (!ctx.hardwarePlatforms.empty()) {
+      std::cout << "[HARDWARE]:  ";
+      for (const auto &hw : ctx.hardwarePlatforms)
+        std::cout << hw << " ";
+      std::cout << std::endl;
+    }
+  }
+
+private:
+  const std::regex *rfc;
+  const std::regex *obsoletesRe;
+  const std::regex *updatesRe;
+  const std::regex *os;
+  const std::regex *hardware;
+
+  /**
+   * @brief Extracts first match of a captured group.
+   */
+  static std::string extractPattern(const std::string &text,
+                                    const std::regex &pattern) {
+    std::smatch match;
+    if (std::regex_search(text, match, pattern) && match.size() > 1) {
+      return match[1].str();
+    }
+    return "";
+  }
+
+  /**
+   * @brief Extracts all occurrences of a pattern.
+   */
+  static std::set<std::string> extractAll(const std::string &text,
+                                          const std::regex &pattern) {
+    std::set<std::string> results;
+    auto words_begin = std::sregex_iterator(text.begin(), text.end(), pattern);
+    auto words_end = std::sregex_iterator();
+
+    for (std::sregex_iterator i = words_begin; i != words_end; ++i) {
+      results.insert(i->str());
+    }
+    return results;
+  }
+
+  static void extractPattern(const std::string &text,
+                             const std::regex &pattern,
+                             PatternRegistry::ArenaMatch &match,
+                             std::pmr::string &out) {
+    if (std::regex_search(text, match, pattern) && match.size() > 1)
+      out.assign(match[1].first, match[1].second);
+  }
+};
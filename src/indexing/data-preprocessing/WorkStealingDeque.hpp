@@ -0,0 +1,46 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+
+/**
+ * @class WorkStealingDeque
+ * @brief Per-worker task deque: the owner pushes and pops at the back
+ * (LIFO, so a document's next stage runs while its text is still in
+ * cache), thieves take from the front (the oldest, coldest work).
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: Simple and obviously correct; contention is rare because each
+ *   worker mostly touches its own deque.
+ * - CON: A mutex per operation. A Chase-Lev deque avoids it, but pipeline
+ *   tasks run for microseconds to milliseconds, so the lock is noise.
+ */
+template <typename Task> class WorkStealingDeque {
+public:
+  void push(Task task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+  }
+
+  bool pop(Task &out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tasks.empty())
+      return false;
+    out = std::move(tasks.back());
+    tasks.pop_back();
+    return true;
+  }
+
+  bool steal(Task &out) {
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock() || tasks.empty())
+      return false;
+    out = std::move(tasks.front());
+    tasks.pop_front();
+    return true;
+  }
+
+private:
+  alignas(64) std::mutex mutex;
+  std::deque<Task> tasks;
+};
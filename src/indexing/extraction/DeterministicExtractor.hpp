@@ -0,0 +1,122 @@
+#pragma once
+
+#include "../data-preprocessing/Instrumentation.hpp"
+#include "EntityScanner.hpp"
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @struct Entity
+ * @brief Represents a technical entity extracted from networking text.
+ */
+struct Entity {
+  std::string type;  // e.g., "IP_ADDRESS", "INTERFACE", "ERROR_CODE"
+  std::string value; // The actual extracted string
+  double confidence; // 1.0 for deterministic extraction
+};
+
+/**
+ * @struct ArenaEntity
+ * @brief An extracted entity whose value lives in a per-chunk arena (see
+ * ChunkArena), so it outlives the chunk text but not the arena reset.
+ */
+struct ArenaEntity {
+  EntityType type;
+  std::pmr::string value;
+};
+
+/**
+ * @class DeterministicExtractor
+ * @brief A high-performance, rule-based engine for extracting structured
+ * networking entities.
+ *
+ * LEAD DEVELOPER NOTE:
+ * The entities (IPs, MACs, ASNs) follow strict, non-ambiguous patterns, so
+ * a hand-written single-pass scanner (EntityScanner) matches them with the
+ * same semantics the original std::regex patterns had, without a regex
+ * engine or a pass per pattern.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: Zero "Hallucination" risk. Deterministic rules ensure 100% precision.
+ * - PRO: Extreme speed. Sub-microsecond extraction per log line, and
+ * extractSpans() returns views into the input without copying.
+ * - CON: Brittle. Does not handle semantically similar but structurally
+ * different terms (e.g., "The first port" vs "Eth1/1").
+ * - CON: Maintenance overhead. If a vendor changes their log format, the
+ * scanner must be updated manually.
+ */
+class DeterministicExtractor {
+public:
+  /**
+   * @brief Extracts all recognized entities as spans into text, ordered by
+   * position. The spans are valid as long as text is.
+   */
+  std::vector<EntitySpan> extractSpans(std::string_view text) const {
+    std::vector<EntitySpan> out;
+    scan(text, out);
+    return out;
+  }
+
+  /**
+   * @brief Appends spans to out, so a caller can reuse one buffer per line.
+   */
+  void extractSpans(std::string_view text,
+                    std::vector<EntitySpan> &out) const {
+    scan(text, out);
+  }
+
+  /**
+   * @brief Extracts all recognized entities from a given text chunk.
+   * @param text The cleaned/normalized networking text.
+   * @return A vector of extracted Entity objects owning their values.
+   */
+  std::vector<Entity> extract(const std::string &text) const {
+    std::vector<Entity> results;
+    for (const EntitySpan &s : extractSpans(text))
+      results.push_back(
+          {entityTypeName(s.type), std::string(s.value), 1.0});
+    return results;
+  }
+
+  /**
+   * @brief extractSpans() with the span vector allocated from arena.
+   */
+  std::pmr::vector<EntitySpan>
+  extractSpans(std::string_view text, std::pmr::memory_resource *arena) const {
+    std::pmr::vector<EntitySpan> out(arena);
+    scan(text, out);
+    return out;
+  }
+
+  /**
+   * @brief extract() with the result vector and every value copied into
+   * arena: no heap traffic per entity.
+   */
+  std::pmr::vector<ArenaEntity>
+  extract(std::string_view text, std::pmr::memory_resource *arena) const {
+    std::pmr::vector<EntitySpan> spans = extractSpans(text, arena);
+    std::pmr::vector<ArenaEntity> results(arena);
+    results.reserve(spans.size());
+    for (const EntitySpan &s : spans)
+      results.push_back({s.type, std::pmr::string(s.value, arena)});
+    return results;
+  }
+
+private:
+  EntityScanner scanner;
+
+  // Every entry point funnels through here, so they all count toward
+  // extract.calls, extract.bytes and extract.matches.
+  template <typename Spans> void scan(std::string_view text, Spans &out) const {
+    size_t before = out.size();
+    scanner.scan(text, out);
+    RCA_COUNT(EXTRACT_CALLS, 1);
+    RCA_COUNT(EXTRACT_BYTES, text.size());
+    RCA_COUNT(EXTRACT_MATCHES, out.size() - before);
+    RCA_OBSERVE(EXTRACT_MATCHES_PER_CALL, out.size() - before);
+    (void)before;
+  }
+};
@@ -1,124 +1,72 @@
-#include <algorithm>
+#include "Disambiguator.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
-#include <sstream>
+#include <random>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 /**
- * @struct ResolvedEntity
- * @brief Represents an entity after disambiguation.
+ * @brief Syslog-like chunk with mentions of the ambiguous terms scattered
+ * among sense keywords and filler.
  */
-struct ResolvedEntity {
-  std::string originalTerm;
-  std::string resolvedSense;
-  double confidence;
-};
+static std::string makeChunk(std::mt19937_64 &gen, size_t words) {
+  static const char *vocabulary[] = {
+      "Session", "session", "Interface", "interface", "RESET", "reset",
+      "BGP", "ospf", "Established", "neighbor", "keepalive", "holdtime",
+      "terminal", "SSH", "telnet", "login", "vty", "console", "gigabit",
+      "TenGig", "optic", "cable", "plugged", "slot", "vlan", "tunnel",
+      "loopback", "subinterface", "virtual", "notification", "peer",
+      "collision", "FSM", "state", "button", "power", "reload", "chassis",
+      "voltage", "the", "on", "was", "after", "router", "link", "%LINK-3",
+      "10.0.0.1", "Gi0/1", "changed", "down", "up", "sessions", "resets"};
+  const size_t count = sizeof(vocabulary) / sizeof(vocabulary[0]);
+  std::string chunk;
+  for (size_t w = 0; w < words; ++w) {
+    if (w)
+      chunk += (gen() % 9) ? " " : ". ";
+    chunk += vocabulary[gen() % count];
+  }
+  return chunk;
+}
 
 /**
- * @class Disambiguator
- * @brief Context-aware entity disambiguation for networking terms.
- *
- * Disambiguation is the art of distinguishing "BGP" (the protocol standard)
- * from "BGP" (a specific process instance on a router).
- *
- * TRADE-OFF ANALYSIS:
- * ------------------
- * 1. METHOD: Context Window vs. Global Embedding
- *    - PRO: Context windows (this implementation) are O(W) where W is window
- * size. Extremely fast and requires no GPU.
- *    - CON: Can be fooled by complex sentences where the 'Sense' marker is far
- *      from the term.
- *
- * 2. KNOWLEDGE BASE: Rigid Dictionary vs. LLM
- *    - PRO: Expert-defined keyword maps ensure zero 'hallucination' in
- *      critical infrastructure.
- *    - CON: Needs manual updates for new technologies.
+ * @brief Mentions found the slow, obvious way: every whole-word,
+ * case-insensitive occurrence of a profile term, in order.
  */
-class Disambiguator {
-public:
-  struct SenseProfile {
-    std::string label;
-    std::vector<std::string> keywords;
-    double weight;
+static std::vector<Disambiguator::Mention>
+referenceMentions(const std::string &text, size_t radius) {
+  auto isWord = [&text](size_t i) {
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    return std::isalnum(c) || c == '_';
   };
-
-  Disambiguator() {
-    // Define common ambiguous networking terms and their 'Sense Profiles'
-
-    // Term: "Session"
-    profiles["session"] = {
-        {"PROTOCOL_INSTANCE",
-         {"bgp", "ospf", "established", "neighbor", "keepalive", "holdtime"},
-         1.0},
-        {"USER_ACCESS",
-         {"terminal", "ssh", "telnet", "login", "vty", "console"},
-         0.8}};
-
-    // Term: "Interface"
-    profiles["interface"] = {
-        {"PHYSICAL_PORT",
-         {"gigabit", "tengig", "optic", "cable", "plugged", "slot"},
-         1.0},
-        {"LOGICAL_CONFIG",
-         {"vlan", "tunnel", "loopback", "subinterface", "virtual"},
-         0.9}};
-
-    // Term: "Reset"
-    profiles["reset"] = {{"PROTOCOL_EVENT",
-                          {"notification", "peer", "collision", "fsm", "state"},
-                          1.0},
-                         {"HARDWARE_ACTION",
-                          {"button", "power", "reload", "chassis", "voltage"},
-                          1.1}};
-  }
-
-  /**
-   * @brief Resolves the specific sense of a term based on its surrounding
-   * context.
-   * @param term The ambiguous term to resolve.
-   * @param contextWindow The words surrounding the term.
-   */
-  ResolvedEntity resolve(const std::string &term,
-                         const std::string &contextWindow) {
-    std::string lowerTerm = term;
-    std::transform(lowerTerm.begin(), lowerTerm.end(), lowerTerm.begin(),
-                   ::tolower);
-
-    if (profiles.find(lowerTerm) == profiles.end()) {
-      return {term, "UNKNOWN", 0.0};
-    }
-
-    std::string lowerContext = contextWindow;
-    std::transform(lowerContext.begin(), lowerContext.end(),
-                   lowerContext.begin(), ::tolower);
-
-    std::string bestSense = "AMBIGUOUS";
-    double maxScore = 0.0;
-
-    for (const auto &profile : profiles[lowerTerm]) {
-      double currentScore = 0.0;
-      for (const auto &kw : profile.keywords) {
-        if (lowerContext.find(kw) != std::string::npos) {
-          currentScore += profile.weight;
-        }
-      }
-
-      if (currentScore > maxScore) {
-        maxScore = currentScore;
-        bestSense = profile.label;
-      }
+  std::vector<Disambiguator::Mention> out;
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (i > 0 && isWord(i - 1))
+      continue;
+    for (std::string_view term : {"session", "interface", "reset"}) {
+      size_t end = i + term.size();
+      if (end > text.size() || (end < text.size() && isWord(end)))
+        continue;
+      size_t k = 0;
+      while (k < term.size() &&
+             std::tolower(static_cast<unsigned char>(text[i + k])) == term[k])
+        ++k;
+      if (k == term.size())
+        out.push_back({std::string_view(text).substr(i, term.size()),
+                       i > radius ? i - radius : 0,
+                       std::min(text.size(), end + radius)});
     }
-
-    // Normalize confidence (Max score relative to total possible weights found)
-    double confidence = (maxScore > 0) ? std::min(1.0, maxScore / 2.0) : 0.0;
-
-    return {term, bestSense, confidence};
   }
+  return out;
+}
 
-private:
-  std::unordered_map<std::string, std::vector<SenseProfile>> profiles;
-};
+static bool same(const ResolvedEntity &a, const ResolvedEntity &b) {
+  return a.originalTerm == b.originalTerm &&
+         a.resolvedSense == b.resolvedSense && a.confidence == b.confidence;
+}
 
 int main() {
   Disambiguator disambiguator;
@@ -154,5 +102,61 @@ int main() {
             << " | [Conf]: " << res3.confidence << std::endl;
   std::cout << "  Context: \"" << context3 << "\"\n" << std::endl;
 
+  std::cout << "--- Batched Chunk Resolution ---" << std::endl;
+  std::string chunk = "Operator reloaded the chassis; the interface Gi0/1 "
+                      "came up and the BGP session went Established. A "
+                      "later SSH login opened a second session.";
+  for (const auto &r : disambiguator.resolveChunk(chunk, 48))
+    std::cout << "[Term]: " << r.originalTerm << " | [Sense]: "
+              << r.resolvedSense << " | [Conf]: " << r.confidence
+              << std::endl;
+
+  // Every mention must resolve exactly as resolve() does on its window.
+  const size_t radius = 64;
+  std::mt19937_64 gen(7);
+  std::vector<std::string> chunks;
+  for (int c = 0; c < 2000; ++c)
+    chunks.push_back(makeChunk(gen, 20 + gen() % 200));
+  size_t mentions = 0, mismatches = 0;
+  for (const std::string &text : chunks) {
+    auto expected = referenceMentions(text, radius);
+    auto batch = disambiguator.resolveChunk(text, radius);
+    auto given = disambiguator.resolveMentions(text, expected);
+    mentions += expected.size();
+    if (batch.size() != expected.size() || given.size() != expected.size()) {
+      mismatches++;
+      continue;
+    }
+    for (size_t m = 0; m < expected.size(); ++m) {
+      const auto &e = expected[m];
+      ResolvedEntity ref =
+          disambiguator.resolve(std::string(e.term),
+                                text.substr(e.begin, e.end - e.begin));
+      mismatches += !same(batch[m], ref) + !same(given[m], ref);
+    }
+  }
+  std::cout << "\n" << mentions << " mentions checked against resolve(): "
+            << mismatches << " mismatches" << std::endl;
+
+  double checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const std::string &text : chunks)
+    for (const auto &e : referenceMentions(text, radius))
+      checksum += disambiguator
+                      .resolve(std::string(e.term),
+                               text.substr(e.begin, e.end - e.begin))
+                      .confidence;
+  std::chrono::duration<double, std::milli> perMention =
+      std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  for (const std::string &text : chunks)
+    for (const auto &r : disambiguator.resolveChunk(text, radius))
+      checksum -= r.confidence;
+  std::chrono::duration<double, std::milli> batched =
+      std::chrono::steady_clock::now() - start;
+  std::printf("resolve() per mention: %.1f ms | resolveChunk(): %.1f ms "
+              "(checksum %.3f)\n",
+              perMention.count(), batched.count(), checksum);
+
   return 0;
 }
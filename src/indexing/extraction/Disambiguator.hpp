@@ -0,0 +1,531 @@
+#pragma once
+
+#include "../data-preprocessing/Instrumentation.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct ResolvedEntity
+ * @brief Represents an entity after disambiguation.
+ */
+struct ResolvedEntity {
+  std::string originalTerm;
+  std::string resolvedSense;
+  double confidence;
+};
+
+/**
+ * @struct ArenaResolvedEntity
+ * @brief ResolvedEntity with the term copied into a per-chunk arena (see
+ * ChunkArena). The sense points at a label owned by the Disambiguator.
+ */
+struct ArenaResolvedEntity {
+  std::pmr::string originalTerm;
+  std::string_view resolvedSense;
+  double confidence;
+};
+
+/**
+ * @class Disambiguator
+ * @brief Context-aware entity disambiguation for networking terms.
+ *
+ * Disambiguation is the art of distinguishing "BGP" (the protocol standard)
+ * from "BGP" (a specific process instance on a router).
+ *
+ * TRADE-OFF ANALYSIS:
+ * ------------------
+ * 1. METHOD: Context Window vs. Global Embedding
+ *    - PRO: Context windows (this implementation) are O(W) where W is window
+ * size. Extremely fast and requires no GPU.
+ *    - CON: Can be fooled by complex sentences where the 'Sense' marker is far
+ *      from the term.
+ *
+ * 2. KNOWLEDGE BASE: Rigid Dictionary vs. LLM
+ *    - PRO: Expert-defined keyword maps ensure zero 'hallucination' in
+ *      critical infrastructure.
+ *    - CON: Needs manual updates for new technologies.
+ *
+ * 3. MATCHING: Per-keyword find() vs. Compiled Automaton
+ *    - resolve() lowercases the window and runs one find() per keyword of
+ *      every profile of the term: O(keywords x window) per mention.
+ *    - The constructor also compiles every keyword, and every ambiguous
+ *      term, into one case-insensitive Aho-Corasick automaton. One pass
+ *      over a chunk reports all keyword hits and all term mentions, and
+ *      each mention is scored from the hits inside its window. The
+ *      results are exactly resolve()'s.
+ *    - CON: Profiles are fixed at construction; the automaton is rebuilt
+ *      only there.
+ */
+class Disambiguator {
+public:
+  struct SenseProfile {
+    std::string label;
+    std::vector<std::string> keywords;
+    double weight;
+  };
+
+  /**
+   * @struct Mention
+   * @brief An ambiguous term and its context window, as offsets into the
+   * chunk: the window is chunk[begin, end).
+   */
+  struct Mention {
+    std::string_view term;
+    size_t begin;
+    size_t end;
+  };
+
+  Disambiguator() {
+    // Define common ambiguous networking terms and their 'Sense Profiles'
+
+    // Term: "Session"
+    profiles["session"] = {
+        {"PROTOCOL_INSTANCE",
+         {"bgp", "ospf", "established", "neighbor", "keepalive", "holdtime"},
+         1.0},
+        {"USER_ACCESS",
+         {"terminal", "ssh", "telnet", "login", "vty", "console"},
+         0.8}};
+
+    // Term: "Interface"
+    profiles["interface"] = {
+        {"PHYSICAL_PORT",
+         {"gigabit", "tengig", "optic", "cable", "plugged", "slot"},
+         1.0},
+        {"LOGICAL_CONFIG",
+         {"vlan", "tunnel", "loopback", "subinterface", "virtual"},
+         0.9}};
+
+    // Term: "Reset"
+    profiles["reset"] = {{"PROTOCOL_EVENT",
+                          {"notification", "peer", "collision", "fsm", "state"},
+                          1.0},
+                         {"HARDWARE_ACTION",
+                          {"button", "power", "reload", "chassis", "voltage"},
+                          1.1}};
+
+    compile();
+  }
+
+  /**
+   * @brief Resolves the specific sense of a term based on its surrounding
+   * context.
+   * @param term The ambiguous term to resolve.
+   * @param contextWindow The words surrounding the term.
+   */
+  ResolvedEntity resolve(const std::string &term,
+                         const std::string &contextWindow) {
+    std::string lowerTerm = term;
+    std::transform(lowerTerm.begin(), lowerTerm.end(), lowerTerm.begin(),
+                   ::tolower);
+
+    if (profiles.find(lowerTerm) == profiles.end()) {
+      return {term, "UNKNOWN", 0.0};
+    }
+
+    std::string lowerContext = contextWindow;
+    std::transform(lowerContext.begin(), lowerContext.end(),
+                   lowerContext.begin(), ::tolower);
+
+    std::string bestSense = "AMBIGUOUS";
+    double maxScore = 0.0;
+
+    for (const auto &profile : profiles[lowerTerm]) {
+      double currentScore = 0.0;
+      for (const auto &kw : profile.keywords) {
+        if (lowerContext.find(kw) != std::string::npos) {
+          currentScore += profile.weight;
+        }
+      }
+
+      if (currentScore > maxScore) {
+        maxScore = currentScore;
+        bestSense = profile.label;
+      }
+    }
+
+    // Normalize confidence (Max score relative to total possible weights found)
+    double confidence = (maxScore > 0) ? std::min(1.0, maxScore / 2.0) : 0.0;
+
+    return {term, bestSense, confidence};
+  }
+
+  /**
+   * @brief Resolves several terms that share one context window, scanning
+   * the window once. out[i] is resolve(terms[i], contextWindow).
+   */
+  std::vector<ResolvedEntity>
+  resolveAll(const std::vector<std::string_view> &terms,
+             std::string_view contextWindow) const {
+    std::vector<uint8_t> seen(keywords.size(), 0);
+    scan(contextWindow, [&](uint32_t pattern, size_t) {
+      if (pattern < keywords.size())
+        seen[pattern] = 1;
+    });
+    std::vector<ResolvedEntity> out;
+    out.reserve(terms.size());
+    for (std::string_view term : terms)
+      out.push_back(Owned()(term, judge(findTerm(term), [&](uint32_t k) {
+        return seen[k] != 0;
+      })));
+    return out;
+  }
+
+  /**
+   * @brief Resolves caller-supplied mentions of one chunk (e.g. from the
+   * extractor) with a single scan of the chunk. out[i] equals
+   * resolve(mentions[i].term, chunk.substr(begin, end - begin)).
+   */
+  std::vector<ResolvedEntity>
+  resolveMentions(std::string_view chunk,
+                  const std::vector<Mention> &mentions) const {
+    std::vector<Hit> hits;
+    std::vector<uint32_t> stamp;
+    std::vector<ResolvedEntity> out;
+    collectHits(chunk, hits);
+    scoreMentions(hits, mentions, stamp, out, Owned());
+    return out;
+  }
+
+  /**
+   * @brief resolveMentions() with the results and all scratch allocated
+   * from arena.
+   */
+  template <typename Mentions>
+  std::pmr::vector<ArenaResolvedEntity>
+  resolveMentions(std::string_view chunk, const Mentions &mentions,
+                  std::pmr::memory_resource *arena) const {
+    std::pmr::vector<Hit> hits(arena);
+    std::pmr::vector<uint32_t> stamp(arena);
+    std::pmr::vector<ArenaResolvedEntity> out(arena);
+    collectHits(chunk, hits);
+    scoreMentions(hits, mentions, stamp, out, InArena{arena});
+    return out;
+  }
+
+  /**
+   * @brief Finds every ambiguous term in chunk (whole words, any case) and
+   * resolves each against the radius bytes on either side of it, all from
+   * one scan of the chunk.
+   */
+  std::vector<ResolvedEntity> resolveChunk(std::string_view chunk,
+                                           size_t radius) const {
+    RCA_SPAN("Disambiguator::resolveChunk");
+    std::vector<Hit> hits;
+    std::vector<Mention> mentions;
+    std::vector<uint32_t> stamp;
+    std::vector<ResolvedEntity> out;
+    collectMentions(chunk, radius, hits, mentions);
+    scoreMentions(hits, mentions, stamp, out, Owned());
+    return out;
+  }
+
+  /**
+   * @brief resolveChunk() with the results and all scratch allocated from
+   * arena.
+   */
+  std::pmr::vector<ArenaResolvedEntity>
+  resolveChunk(std::string_view chunk, size_t radius,
+               std::pmr::memory_resource *arena) const {
+    RCA_SPAN("Disambiguator::resolveChunk");
+    std::pmr::vector<Hit> hits(arena);
+    std::pmr::vector<Mention> mentions(arena);
+    std::pmr::vector<uint32_t> stamp(arena);
+    std::pmr::vector<ArenaResolvedEntity> out(arena);
+    collectMentions(chunk, radius, hits, mentions);
+    scoreMentions(hits, mentions, stamp, out, InArena{arena});
+    return out;
+  }
+
+private:
+  std::unordered_map<std::string, std::vector<SenseProfile>> profiles;
+
+  static constexpr uint32_t NO_TERM = UINT32_MAX;
+
+  struct Hit {
+    size_t start;
+    size_t end;
+    uint32_t keyword;
+  };
+
+  struct CompiledSense {
+    const SenseProfile *profile;
+    std::vector<uint32_t> keywordIds; // Repeats kept: each one scores
+  };
+
+  // Patterns 0..keywords.size()-1 are the distinct keywords; any further
+  // patterns are terms that are not also keywords.
+  std::vector<std::string> keywords;
+  std::vector<size_t> patternLength;
+  std::vector<uint32_t> patternTerm; // Term ID a pattern spells, or NO_TERM
+  std::vector<std::string> terms;    // Lowercase, by term ID
+  std::vector<std::vector<CompiledSense>> senses; // By term ID
+
+  // Dense DFA over a compact alphabet: class 0 is every byte that occurs
+  // in no pattern, and both cases of a letter share a class.
+  std::array<uint8_t, 256> charClass{};
+  uint32_t classes = 1;
+  std::vector<int32_t> delta;      // state * classes + class
+  std::vector<uint32_t> outBegin;  // Per state, into outputs
+  std::vector<uint32_t> outputs;   // Patterns ending at a state
+
+  static char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+  }
+
+  static bool isWordChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_';
+  }
+
+  static bool isWordBoundary(std::string_view s, size_t i) {
+    bool before = i > 0 && isWordChar(s[i - 1]);
+    bool after = i < s.size() && isWordChar(s[i]);
+    return before != after;
+  }
+
+  /**
+   * @brief Term ID of term, ignoring case, or NO_TERM. There are only a
+   * handful of terms, so a linear scan with a length check is cheaper
+   * than lowercasing into a string to hash it.
+   */
+  uint32_t findTerm(std::string_view term) const {
+    for (uint32_t t = 0; t < terms.size(); ++t) {
+      if (terms[t].size() != term.size())
+        continue;
+      size_t i = 0;
+      while (i < term.size() && lower(term[i]) == terms[t][i])
+        ++i;
+      if (i == term.size())
+        return t;
+    }
+    return NO_TERM;
+  }
+
+  struct Verdict {
+    std::string_view sense;
+    double confidence;
+  };
+
+  /**
+   * @brief resolve()'s scoring, with keyword presence supplied by
+   * present(keywordId) instead of find().
+   */
+  template <typename Present>
+  Verdict judge(uint32_t termId, const Present &present) const {
+    if (termId == NO_TERM)
+      return {"UNKNOWN", 0.0};
+    const SenseProfile *best = nullptr;
+    double maxScore = 0.0;
+    for (const CompiledSense &sense : senses[termId]) {
+      double currentScore = 0.0;
+      for (uint32_t k : sense.keywordIds)
+        if (present(k))
+          currentScore += sense.profile->weight;
+      if (currentScore > maxScore) {
+        maxScore = currentScore;
+        best = sense.profile;
+      }
+    }
+    double confidence = (maxScore > 0) ? std::min(1.0, maxScore / 2.0) : 0.0;
+    return {best ? std::string_view(best->label) : "AMBIGUOUS", confidence};
+  }
+
+  // Result makers for scoreMentions().
+  struct Owned {
+    ResolvedEntity operator()(std::string_view term, Verdict v) const {
+      return {std::string(term), std::string(v.sense), v.confidence};
+    }
+  };
+  struct InArena {
+    std::pmr::memory_resource *arena;
+    ArenaResolvedEntity operator()(std::string_view term, Verdict v) const {
+      return {std::pmr::string(term, arena), v.sense, v.confidence};
+    }
+  };
+
+  template <typename Hits>
+  void collectHits(std::string_view chunk, Hits &hits) const {
+    hits.reserve(chunk.size() / 8);
+    scan(chunk, [&](uint32_t pattern, size_t start) {
+      if (pattern < keywords.size())
+        hits.push_back({start, start + patternLength[pattern], pattern});
+    });
+  }
+
+  template <typename Hits, typename Mentions>
+  void collectMentions(std::string_view chunk, size_t radius, Hits &hits,
+                       Mentions &mentions) const {
+    hits.reserve(chunk.size() / 8);
+    scan(chunk, [&](uint32_t pattern, size_t start) {
+      size_t end = start + patternLength[pattern];
+      if (pattern < keywords.size())
+        hits.push_back({start, end, pattern});
+      if (patternTerm[pattern] != NO_TERM && isWordBoundary(chunk, start) &&
+          isWordBoundary(chunk, end))
+        mentions.push_back({chunk.substr(start, end - start),
+                            start > radius ? start - radius : 0,
+                            std::min(chunk.size(), end + radius)});
+    });
+  }
+
+  /**
+   * @brief Scores each mention from the hits lying wholly inside its
+   * window and appends make(term, verdict) to out. hits are in end order,
+   * as scan() reports them.
+   */
+  template <typename Hits, typename Mentions, typename Stamps, typename Out,
+            typename Make>
+  void scoreMentions(const Hits &hits, const Mentions &mentions,
+                     Stamps &stamp, Out &out, const Make &make) const {
+    RCA_COUNT(DISAMBIGUATE_MENTIONS, mentions.size());
+    stamp.assign(keywords.size(), 0);
+    out.reserve(mentions.size());
+    for (uint32_t m = 0; m < mentions.size(); ++m) {
+      const Mention &mention = mentions[m];
+      auto first = std::lower_bound(
+          hits.begin(), hits.end(), mention.begin + 1,
+          [](const Hit &h, size_t end) { return h.end < end; });
+      for (auto it = first; it != hits.end() && it->end <= mention.end; ++it)
+        if (it->start >= mention.begin)
+          stamp[it->keyword] = m + 1;
+      out.push_back(make(mention.term,
+                         judge(findTerm(mention.term), [&](uint32_t k) {
+                           return stamp[k] == m + 1;
+                         })));
+    }
+  }
+
+  /**
+   * @brief Runs the automaton over text, calling onMatch(pattern, start)
+   * for every occurrence of every pattern, in order of match end.
+   */
+  template <typename OnMatch>
+  void scan(std::string_view text, const OnMatch &onMatch) const {
+    int32_t state = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+      uint8_t cls = charClass[static_cast<unsigned char>(text[i])];
+      state = delta[static_cast<size_t>(state) * classes + cls];
+      for (uint32_t o = outBegin[state]; o < outBegin[state + 1]; ++o)
+        onMatch(outputs[o], i + 1 - patternLength[outputs[o]]);
+    }
+  }
+
+  uint32_t addPattern(std::unordered_map<std::string, uint32_t> &ids,
+                      const std::string &pattern) {
+    auto [it, inserted] =
+        ids.try_emplace(pattern, static_cast<uint32_t>(patternLength.size()));
+    if (inserted) {
+      patternLength.push_back(pattern.size());
+      patternTerm.push_back(NO_TERM);
+    }
+    return it->second;
+  }
+
+  void compile() {
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<std::string> names; // Sorted, so term IDs are stable
+    for (const auto &entry : profiles)
+      names.push_back(entry.first);
+    std::sort(names.begin(), names.end());
+
+    for (const std::string &name : names)
+      for (const SenseProfile &profile : profiles.at(name))
+        for (const std::string &kw : profile.keywords)
+          if (addPattern(ids, kw) == keywords.size())
+            keywords.push_back(kw);
+    for (const std::string &name : names) {
+      uint32_t termId = static_cast<uint32_t>(terms.size());
+      terms.push_back(name);
+      patternTerm[addPattern(ids, name)] = termId;
+      senses.emplace_back();
+      for (const SenseProfile &profile : profiles.at(name)) {
+        CompiledSense sense{&profile, {}};
+        for (const std::string &kw : profile.keywords)
+          sense.keywordIds.push_back(ids.at(kw));
+        senses.back().push_back(std::move(sense));
+      }
+    }
+
+    std::vector<const std::string *> patterns(patternLength.size());
+    for (const auto &[text, id] : ids)
+      patterns[id] = &text;
+    for (const std::string *p : patterns)
+      for (char c : *p) {
+        char l = lower(c);
+        if (!charClass[static_cast<unsigned char>(l)]) {
+          uint8_t cls = static_cast<uint8_t>(classes++);
+          charClass[static_cast<unsigned char>(l)] = cls;
+          if (l >= 'a' && l <= 'z')
+            charClass[static_cast<unsigned char>(l - 'a' + 'A')] = cls;
+        }
+      }
+
+    // Trie, with -1 for missing edges.
+    std::vector<int32_t> trie(classes, -1);
+    std::vector<std::vector<uint32_t>> ends(1);
+    for (uint32_t id = 0; id < patterns.size(); ++id) {
+      int32_t node = 0;
+      for (char c : *patterns[id]) {
+        size_t slot = static_cast<size_t>(node) * classes +
+                      charClass[static_cast<unsigned char>(c)];
+        if (trie[slot] < 0) {
+          trie[slot] = static_cast<int32_t>(ends.size());
+          ends.emplace_back();
+          trie.resize(trie.size() + classes, -1);
+        }
+        node = trie[slot];
+      }
+      ends[node].push_back(id);
+    }
+
+    // Breadth-first: failure links, then full transitions and merged
+    // outputs, so scan() never follows a failure link.
+    const size_t states = ends.size();
+    delta.assign(states * classes, 0);
+    std::vector<int32_t> fail(states, 0);
+    std::vector<std::vector<uint32_t>> out(states);
+    std::queue<int32_t> order;
+    out[0] = ends[0];
+    for (uint32_t c = 0; c < classes; ++c) {
+      int32_t child = c ? trie[c] : -1; // Class 0 always returns to root
+      if (child > 0) {
+        delta[c] = child;
+        order.push(child);
+      }
+    }
+    while (!order.empty()) {
+      int32_t node = order.front();
+      order.pop();
+      out[node] = ends[node];
+      out[node].insert(out[node].end(), out[fail[node]].begin(),
+                       out[fail[node]].end());
+      for (uint32_t c = 0; c < classes; ++c) {
+        size_t slot = static_cast<size_t>(node) * classes + c;
+        int32_t child = c ? trie[slot] : -1;
+        int32_t via = delta[static_cast<size_t>(fail[node]) * classes + c];
+        if (child > 0) {
+          fail[child] = via;
+          delta[slot] = child;
+          order.push(child);
+        } else {
+          delta[slot] = via;
+        }
+      }
+    }
+
+    outBegin.assign(1, 0);
+    for (const auto &o : out) {
+      outputs.insert(outputs.end(), o.begin(), o.end());
+      outBegin.push_back(static_cast<uint32_t>(outputs.size()));
+    }
+  }
+};
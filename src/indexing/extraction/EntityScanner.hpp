@@ -0,0 +1,315 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @enum EntityType
+ * @brief The structural entities recognized by the deterministic stage.
+ */
+enum class EntityType : uint8_t {
+  IP_ADDRESS,
+  ASN,
+  INTERFACE,
+  ERROR_CODE,
+  MAC_ADDRESS,
+  COUNT
+};
+
+inline const char *entityTypeName(EntityType t) {
+  static const char *names[] = {"IP_ADDRESS", "ASN", "INTERFACE",
+                                "ERROR_CODE", "MAC_ADDRESS"};
+  return names[static_cast<size_t>(t)];
+}
+
+/**
+ * @struct EntitySpan
+ * @brief A match as a view into the scanned text; valid while it lives.
+ */
+struct EntitySpan {
+  EntityType type;
+  std::string_view value;
+};
+
+/**
+ * @class EntityScanner
+ * @brief Hand-written single-pass matcher for all deterministic patterns.
+ *
+ * Reproduces the ECMAScript semantics of the original std::regex patterns,
+ * including backtracking, word boundaries and per-pattern non-overlapping
+ * search:
+ *   IP_ADDRESS  \b(?:OCTET\.){3}OCTET\b,
+ *               OCTET = 25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?
+ *   ASN         \bAS\d{1,10}\b (case-insensitive)
+ *   INTERFACE   \b(?:GigabitEthernet|TenGigabitEthernet|FastEthernet|
+ *               Ethernet|Loopback|Port-Channel)\d+(?:\/\d+)*\b
+ *   ERROR_CODE  %[A-Z0-9_\-]+-\d+-[A-Z0-9_\-]+
+ *   MAC_ADDRESS \b(?:[0-9A-Fa-f]{2}[:-]){5}[0-9A-Fa-f]{2}\b
+ *
+ * The text is walked once. Apart from ERROR_CODE every pattern begins at a
+ * word start, so the interior of each word is skipped and a 256-entry
+ * table picks the matchers worth trying from the word's first byte. Each
+ * pattern keeps its own resume offset, so matches of different types may
+ * overlap exactly as five independent regex searches would.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: No allocation per match, no backtracking engine, no std::string
+ *   copies; results are string_views into the caller's buffer.
+ * - CON: Patterns are code, not data. Adding a vendor format means a new
+ *   match function here rather than a new regex string.
+ */
+class EntityScanner {
+public:
+  static constexpr size_t TYPES = static_cast<size_t>(EntityType::COUNT);
+
+  EntityScanner() {
+    auto allow = [this](unsigned char c, EntityType t) {
+      starts[c] |= static_cast<uint8_t>(1u << static_cast<unsigned>(t));
+    };
+    for (unsigned char c = '0'; c <= '9'; ++c) {
+      allow(c, EntityType::IP_ADDRESS);
+      allow(c, EntityType::MAC_ADDRESS);
+    }
+    for (unsigned char c = 'A'; c <= 'F'; ++c) {
+      allow(c, EntityType::MAC_ADDRESS);
+      allow(c + ('a' - 'A'), EntityType::MAC_ADDRESS);
+    }
+    allow('A', EntityType::ASN);
+    allow('a', EntityType::ASN);
+    for (unsigned char c : {'G', 'T', 'F', 'E', 'L', 'P'})
+      allow(c, EntityType::INTERFACE);
+    allow('%', EntityType::ERROR_CODE);
+  }
+
+  /**
+   * @brief Appends every match in text to out, ordered by start offset
+   * (ties in EntityType order). Spans is any vector of EntitySpan,
+   * e.g. a std::pmr::vector in a per-chunk arena.
+   */
+  template <typename Spans>
+  void scan(std::string_view text, Spans &out) const {
+    const char *s = text.data();
+    const size_t n = text.size();
+    std::array<size_t, TYPES> resume{};
+    size_t i = 0;
+    while (i < n) {
+      unsigned char c = static_cast<unsigned char>(s[i]);
+      if (!isWord(s[i])) {
+        if (c == '%')
+          tryMatch(EntityType::ERROR_CODE, s, n, i, resume, out);
+        ++i;
+        continue;
+      }
+      // Every other pattern starts with \b before a word char, so only the
+      // first byte of each word run can begin a match.
+      if (uint8_t mask = starts[c])
+        for (unsigned t = 0; t < TYPES; ++t)
+          if (mask & (1u << t))
+            tryMatch(static_cast<EntityType>(t), s, n, i, resume, out);
+      while (++i < n && isWord(s[i])) {
+      }
+    }
+  }
+
+  std::vector<EntitySpan> scan(std::string_view text) const {
+    std::vector<EntitySpan> out;
+    scan(text, out);
+    return out;
+  }
+
+  /**
+   * @brief Regex-equivalent match of one pattern anchored at i.
+   * @return The exclusive end offset, or NO_MATCH.
+   */
+  static size_t matchAt(EntityType type, const char *s, size_t n, size_t i) {
+    switch (type) {
+    case EntityType::IP_ADDRESS:
+      return matchIpv4(s, n, i, 0);
+    case EntityType::ASN:
+      return matchAsn(s, n, i);
+    case EntityType::INTERFACE:
+      return matchInterface(s, n, i);
+    case EntityType::ERROR_CODE:
+      return matchErrorCode(s, n, i);
+    case EntityType::MAC_ADDRESS:
+      return matchMac(s, n, i);
+    default:
+      return NO_MATCH;
+    }
+  }
+
+  static constexpr size_t NO_MATCH = static_cast<size_t>(-1);
+
+private:
+  std::array<uint8_t, 256> starts{};
+
+  template <typename Spans>
+  static void tryMatch(EntityType type, const char *s, size_t n, size_t i,
+                       std::array<size_t, TYPES> &resume, Spans &out) {
+    size_t t = static_cast<size_t>(type);
+    if (i < resume[t])
+      return;
+    size_t end = matchAt(type, s, n, i);
+    if (end == NO_MATCH)
+      return;
+    out.push_back({type, std::string_view(s + i, end - i)});
+    resume[t] = end;
+  }
+
+  static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+  static bool isUpper(char c) { return c >= 'A' && c <= 'Z'; }
+  static bool isHex(char c) {
+    return isDigit(c) || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+  }
+  // ECMAScript \w, which is what \b tests against.
+  static bool isWord(char c) {
+    return isDigit(c) || isUpper(c) || (c >= 'a' && c <= 'z') || c == '_';
+  }
+  static bool boundaryAt(const char *s, size_t n, size_t i) {
+    bool before = i > 0 && isWord(s[i - 1]);
+    bool after = i < n && isWord(s[i]);
+    return before != after;
+  }
+  // [A-Z0-9_\-]
+  static bool isCodeChar(char c) {
+    return isUpper(c) || isDigit(c) || c == '_' || c == '-';
+  }
+
+  /**
+   * @brief OCTET alternatives at i, in the order the regex tries them.
+   * @return Number of candidate lengths written to len.
+   */
+  static int octetCandidates(const char *s, size_t n, size_t i, int len[5]) {
+    auto d = [&](size_t k) { return i + k < n && isDigit(s[i + k]); };
+    auto at = [&](size_t k) { return i + k < n ? s[i + k] : '\0'; };
+    int c = 0;
+    if (at(0) == '2' && at(1) == '5' && at(2) >= '0' && at(2) <= '5')
+      len[c++] = 3;
+    if (at(0) == '2' && at(1) >= '0' && at(1) <= '4' && d(2))
+      len[c++] = 3;
+    if ((at(0) == '0' || at(0) == '1') && d(1)) { // [01] taken
+      if (d(2))
+        len[c++] = 3;
+      len[c++] = 2;
+    }
+    if (d(0)) { // [01]? skipped
+      if (d(1))
+        len[c++] = 2;
+      len[c++] = 1;
+    }
+    return c;
+  }
+
+  /**
+   * @brief Backtracking over the four octets; octet k starts at i.
+   */
+  static size_t matchIpv4(const char *s, size_t n, size_t i, int k) {
+    int len[5];
+    int c = octetCandidates(s, n, i, len);
+    for (int j = 0; j < c; ++j) {
+      size_t e = i + len[j];
+      if (k == 3) {
+        if (boundaryAt(s, n, e))
+          return e;
+      } else if (e < n && s[e] == '.') {
+        size_t end = matchIpv4(s, n, e + 1, k + 1);
+        if (end != NO_MATCH)
+          return end;
+      }
+    }
+    return NO_MATCH;
+  }
+
+  static size_t matchAsn(const char *s, size_t n, size_t i) {
+    if (i + 2 >= n || (s[i + 1] != 'S' && s[i + 1] != 's'))
+      return NO_MATCH;
+    size_t e = i + 2;
+    while (e < n && e - (i + 2) < 10 && isDigit(s[e]))
+      ++e;
+    // Fewer digits would leave a digit next, which can never be \b.
+    return (e > i + 2 && boundaryAt(s, n, e)) ? e : NO_MATCH;
+  }
+
+  static size_t matchInterface(const char *s, size_t n, size_t i) {
+    std::string_view prefix;
+    switch (s[i]) { // The alternatives have distinct first letters
+    case 'G':
+      prefix = "GigabitEthernet";
+      break;
+    case 'T':
+      prefix = "TenGigabitEthernet";
+      break;
+    case 'F':
+      prefix = "FastEthernet";
+      break;
+    case 'E':
+      prefix = "Ethernet";
+      break;
+    case 'L':
+      prefix = "Loopback";
+      break;
+    case 'P':
+      prefix = "Port-Channel";
+      break;
+    default:
+      return NO_MATCH;
+    }
+    if (std::string_view(s + i, n - i).substr(0, prefix.size()) != prefix)
+      return NO_MATCH;
+    size_t e = i + prefix.size();
+    if (e >= n || !isDigit(s[e]))
+      return NO_MATCH;
+    while (e < n && isDigit(s[e]))
+      ++e;
+    // Backtracking can only end after a complete digit run, and an end
+    // before a '/' is always a boundary: the answer is the last group end
+    // if the greedy end is not a boundary.
+    size_t previous = NO_MATCH;
+    while (e + 1 < n && s[e] == '/' && isDigit(s[e + 1])) {
+      previous = e;
+      e += 1;
+      while (e < n && isDigit(s[e]))
+        ++e;
+    }
+    if (boundaryAt(s, n, e))
+      return e;
+    return previous;
+  }
+
+  /**
+   * @brief The class [A-Z0-9_\-] contains every other token, so the final
+   * greedy run always extends to the end of the maximal class run; a match
+   * exists iff some '-' splits the run as <code>-<digits>-<code>.
+   */
+  static size_t matchErrorCode(const char *s, size_t n, size_t i) {
+    size_t end = i + 1;
+    while (end < n && isCodeChar(s[end]))
+      ++end;
+    for (size_t j = i + 2; j < end; ++j) {
+      if (s[j] != '-')
+        continue;
+      size_t k = j + 1;
+      while (k < end && isDigit(s[k]))
+        ++k;
+      if (k > j + 1 && k + 1 < end && s[k] == '-')
+        return end;
+    }
+    return NO_MATCH;
+  }
+
+  static size_t matchMac(const char *s, size_t n, size_t i) {
+    if (i + 17 > n || (s[i + 2] != ':' && s[i + 2] != '-'))
+      return NO_MATCH;
+    for (size_t g = 0; g < 6; ++g) {
+      size_t p = i + 3 * g;
+      if (!isHex(s[p]) || !isHex(s[p + 1]))
+        return NO_MATCH;
+      if (g < 5 && s[p + 2] != ':' && s[p + 2] != '-')
+        return NO_MATCH;
+    }
+    return boundaryAt(s, n, i + 17) ? i + 17 : NO_MATCH;
+  }
+};
@@ -0,0 +1,141 @@
+#include "DeterministicExtractor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <regex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class RegexExtractor
+ * @brief The original std::regex implementation, kept verbatim as the
+ * baseline and as the oracle the scanner is checked against.
+ */
+class RegexExtractor {
+public:
+  RegexExtractor() {
+    patterns["IP_ADDRESS"] = std::regex(
+        R"(\b(?:(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\.){3}(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\b)");
+    patterns["ASN"] =
+        std::regex(R"(\bAS\d{1,10}\b)", std::regex_constants::icase);
+    patterns["INTERFACE"] = std::regex(
+        R"(\b(?:GigabitEthernet|TenGigabitEthernet|FastEthernet|Ethernet|Loopback|Port-Channel)\d+(?:\/\d+)*\b)");
+    patterns["ERROR_CODE"] = std::regex(R"(%[A-Z0-9_\-]+-\d+-[A-Z0-9_\-]+)");
+    patterns["MAC_ADDRESS"] =
+        std::regex(R"(\b(?:[0-9A-Fa-f]{2}[:-]){5}(?:[0-9A-Fa-f]{2})\b)");
+  }
+
+  std::vector<Entity> extract(const std::string &text) {
+    std::vector<Entity> results;
+    for (const auto &[type, pattern] : patterns) {
+      auto words_begin =
+          std::sregex_iterator(text.begin(), text.end(), pattern);
+      auto words_end = std::sregex_iterator();
+      for (std::sregex_iterator i = words_begin; i != words_end; ++i) {
+        std::smatch match = *i;
+        results.push_back({type, match.str(), 1.0});
+      }
+    }
+    return results;
+  }
+
+private:
+  std::unordered_map<std::string, std::regex> patterns;
+};
+
+/**
+ * @brief Synthetic syslog lines mixing every entity type with near-misses
+ * (bad octets, glued suffixes, truncated codes) that exercise backtracking.
+ */
+static std::vector<std::string> makeCorpus(size_t lines, uint64_t seed) {
+  static const char *fragments[] = {
+      "BGP Neighbor ", "192.168.1.10", " in ", "AS65001", " reported ",
+      "%BGP-3-NOTIFICATION", " on ", "GigabitEthernet1/0/2", ". ",
+      "Source MAC: ", "00:1A:2B:3C:4D:5E", "TenGigabitEthernet0/1/0",
+      " is flaps", "256.1.1.1", "10.0.0.255.7", "as4200000000",
+      "AS12345678901", "Ethernet1/2x", "%LINEPROTO-5-UPDOWN:", "%SYS-X-Y",
+      "Port-Channel12", "Loopback0", "aa-bb-cc-dd-ee-ff", "01.02.003.4",
+      "FastEthernet0/1/", "%AS10-2-", "1.2.3.456", "_AS100", " line ",
+      "changed state to down", ", ", "Interface ", "OSPF ", "\t"};
+  const size_t count = sizeof(fragments) / sizeof(fragments[0]);
+  std::mt19937_64 gen(seed);
+  std::vector<std::string> corpus(lines);
+  for (std::string &line : corpus) {
+    size_t parts = 8 + gen() % 16;
+    for (size_t p = 0; p < parts; ++p)
+      line += fragments[gen() % count];
+  }
+  return corpus;
+}
+
+using Key = std::tuple<std::string, std::string>;
+
+static std::vector<Key> normalize(const std::vector<Entity> &entities) {
+  std::vector<Key> keys;
+  for (const Entity &e : entities)
+    keys.emplace_back(e.type, e.value);
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+template <typename Fn> static double millis(Fn &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  std::chrono::duration<double, std::milli> d =
+      std::chrono::steady_clock::now() - start;
+  return d.count();
+}
+
+int main(int argc, char **argv) {
+  size_t lines = argc > 1 ? std::stoul(argv[1]) : 20000;
+  std::vector<std::string> corpus = makeCorpus(lines, 42);
+  size_t bytes = 0;
+  for (const std::string &line : corpus)
+    bytes += line.size();
+
+  RegexExtractor legacy;
+  DeterministicExtractor scanner;
+
+  // 1. Equivalence: the same multiset of (type, value) on every line.
+  // Regex output is grouped by pattern in hash-map order, the scanner's is
+  // by position, so compare sorted.
+  size_t mismatches = 0;
+  for (const std::string &line : corpus)
+    if (normalize(legacy.extract(line)) != normalize(scanner.extract(line)))
+      ++mismatches;
+  std::printf("Equivalence: %zu/%zu lines differ\n", mismatches, lines);
+
+  // 2. Throughput.
+  size_t regexHits = 0, copyHits = 0, spanHits = 0;
+  double regexMs = millis([&] {
+    for (const std::string &line : corpus)
+      regexHits += legacy.extract(line).size();
+  });
+  double copyMs = millis([&] {
+    for (const std::string &line : corpus)
+      copyHits += scanner.extract(line).size();
+  });
+  std::vector<EntitySpan> spans;
+  double spanMs = millis([&] {
+    for (const std::string &line : corpus) {
+      spans.clear();
+      scanner.extractSpans(line, spans);
+      spanHits += spans.size();
+    }
+  });
+
+  double mb = bytes / 1e6;
+  std::printf("%zu lines, %.1f MB\n", lines, mb);
+  std::printf("  std::regex (5 passes) : %8.1f ms  %7.1f MB/s  %zu hits\n",
+              regexMs, mb / (regexMs / 1e3), regexHits);
+  std::printf("  scanner, Entity copy  : %8.1f ms  %7.1f MB/s  %zu hits\n",
+              copyMs, mb / (copyMs / 1e3), copyHits);
+  std::printf("  scanner, string_view  : %8.1f ms  %7.1f MB/s  %zu hits\n",
+              spanMs, mb / (spanMs / 1e3), spanHits);
+  std::printf("  speedup (views)       : %8.1fx\n", regexMs / spanMs);
+  return mismatches == 0 ? 0 : 1;
+}
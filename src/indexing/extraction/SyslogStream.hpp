@@ -0,0 +1,297 @@
+#pragma once
+
+#include "DeterministicExtractor.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @struct EntityRecord
+ * @brief One extracted entity. The value lives in the owning batch's arena.
+ */
+struct EntityRecord {
+  uint64_t line;       // Stream-wide line number, from 0
+  uint32_t offset;     // Byte offset of the value within its line
+  uint32_t arenaPos;   // Start of the value in EntityBatch::arena
+  uint32_t length;     // Value length in bytes
+  EntityType type;
+};
+
+/**
+ * @struct EntityBatch
+ * @brief Entities of a run of consecutive lines, with all values packed in
+ * one arena. clear() keeps capacity, so a reused batch stops allocating
+ * once it has seen its largest run.
+ */
+struct EntityBatch {
+  uint64_t firstLine = 0;
+  uint64_t lineCount = 0;
+  std::vector<EntityRecord> records;
+  std::vector<char> arena;
+
+  std::string_view value(const EntityRecord &r) const {
+    return std::string_view(arena.data() + r.arenaPos, r.length);
+  }
+
+  void clear() {
+    lineCount = 0;
+    records.clear();
+    arena.clear();
+  }
+};
+
+/**
+ * @struct StreamCounters
+ * @brief Per-stage totals. Stages are timed per block, not per line, so
+ * the clock reads stay off the hot path.
+ */
+struct StreamCounters {
+  uint64_t readCalls = 0;
+  uint64_t bytesRead = 0;
+  uint64_t readNs = 0; // Includes time blocked waiting for data
+  uint64_t linesSplit = 0;
+  uint64_t bufferGrowths = 0;  // Buffer doublings for long lines
+  uint64_t oversizedLines = 0; // Lines cut at Options::maxLineBytes
+  uint64_t splitNs = 0;
+  uint64_t bytesScanned = 0;
+  uint64_t entities = 0;
+  uint64_t extractNs = 0;
+  uint64_t batches = 0;
+
+  static double perSecond(uint64_t count, uint64_t ns) {
+    return ns ? count * 1e9 / ns : 0.0;
+  }
+};
+
+/**
+ * @class SyslogStream
+ * @brief Streaming front end: fd -> buffer -> lines -> entity batches.
+ *
+ * PIPELINE:
+ * 1. read(2) fills one large buffer from a file, pipe or connected socket.
+ * 2. Lines are split in place with memchr ('\n', with an optional '\r'
+ *    stripped) into string_views; nothing is copied.
+ * 3. Each line goes through the DeterministicExtractor scanner and only the
+ *    matched bytes are appended to the batch arena.
+ *
+ * The unconsumed tail (a partial line) is slid to the front before the
+ * next read, so a line is always contiguous and an entity that straddles
+ * two reads is seen whole. A line longer than the buffer doubles it, up
+ * to maxLineBytes; only a line longer than that is cut, counted in
+ * oversizedLines, and can split an entity.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: One syscall per megabyte, no per-line or per-entity allocation.
+ * - CON: Sliding the tail copies at most one partial line per refill, which
+ *   a mirrored (double-mapped) ring would avoid at the cost of mmap tricks.
+ * - CON: A buffer grown for one long line stays grown for the life of the
+ *   stream.
+ * - CON: Newline framing only; octet-counted syslog (RFC 6587) needs a
+ *   different splitter.
+ */
+class SyslogStream {
+public:
+  struct Options {
+    size_t bufferBytes = 1 << 20;
+    size_t maxLineBytes = 64 << 20; // The buffer grows up to this
+    size_t batchLines = 4096;
+  };
+
+  /**
+   * @brief Streams from fd. The stream closes fd only if ownsFd is set.
+   */
+  SyslogStream(int fd, Options options, bool ownsFd = false)
+      : fd(fd), ownsFd(ownsFd), opts(options),
+        capacity(options.bufferBytes ? options.bufferBytes : 1),
+        buffer(new char[capacity]) {
+    if (!opts.batchLines)
+      opts.batchLines = 1;
+    opts.maxLineBytes = std::max(opts.maxLineBytes, capacity);
+    lines.reserve(opts.batchLines);
+  }
+
+  explicit SyslogStream(int fd) : SyslogStream(fd, Options()) {}
+
+  ~SyslogStream() {
+    if (ownsFd && fd >= 0)
+      ::close(fd);
+  }
+
+  SyslogStream(const SyslogStream &) = delete;
+  SyslogStream &operator=(const SyslogStream &) = delete;
+
+  /**
+   * @brief Opens a file for streaming.
+   * @return nullptr on failure, with the reason in error if given.
+   */
+  static std::unique_ptr<SyslogStream>
+  openFile(const std::string &path, Options options,
+           std::string *error = nullptr) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      if (error)
+        *error = "open " + path + ": " + std::strerror(errno);
+      return nullptr;
+    }
+    return std::make_unique<SyslogStream>(fd, options, true);
+  }
+
+  /**
+   * @brief Fills batch with the entities of up to batchLines lines.
+   * @return False when no line was available: at end of stream, on a read
+   * error, or when a non-blocking fd has no data yet (see finished()).
+   */
+  bool next(EntityBatch &batch) {
+    batch.clear();
+    batch.firstLine = lineNo;
+    while (batch.lineCount < opts.batchLines) {
+      if (!splitLines(opts.batchLines - batch.lineCount) && !refill())
+        break;
+      extractLines(batch);
+    }
+    if (batch.lineCount)
+      ++stats.batches;
+    return batch.lineCount > 0;
+  }
+
+  bool finished() const { return eof && head == filled; }
+  const std::string &error() const { return lastError; }
+  const StreamCounters &counters() const { return stats; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  int fd;
+  bool ownsFd;
+  Options opts;
+  size_t capacity;
+  std::unique_ptr<char[]> buffer;
+  size_t head = 0;   // First unconsumed byte
+  size_t filled = 0; // End of valid data
+  bool eof = false;
+  uint64_t lineNo = 0;
+  std::string lastError;
+  StreamCounters stats;
+
+  DeterministicExtractor extractor;
+  std::vector<std::string_view> lines; // Views into buffer, reused
+  std::vector<EntitySpan> spans;       // Scanner output, reused
+
+  static uint64_t since(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now() - start)
+        .count();
+  }
+
+  /**
+   * @brief Moves the partial line to the front and reads once. A partial
+   * line that fills the whole buffer doubles it first.
+   * @return False if no new bytes arrived.
+   */
+  bool refill() {
+    if (eof)
+      return false;
+    if (head > 0) {
+      std::memmove(buffer.get(), buffer.get() + head, filled - head);
+      filled -= head;
+      head = 0;
+    }
+    if (filled == capacity && capacity < opts.maxLineBytes) {
+      const size_t grown = std::min(capacity * 2, opts.maxLineBytes);
+      std::unique_ptr<char[]> larger(new char[grown]);
+      std::memcpy(larger.get(), buffer.get(), filled);
+      buffer = std::move(larger);
+      capacity = grown;
+      ++stats.bufferGrowths;
+    }
+    auto start = Clock::now();
+    ssize_t got;
+    do {
+      got = ::read(fd, buffer.get() + filled, capacity - filled);
+    } while (got < 0 && errno == EINTR);
+    stats.readNs += since(start);
+    ++stats.readCalls;
+    if (got < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        lastError = std::string("read: ") + std::strerror(errno);
+        eof = true;
+      }
+      return false;
+    }
+    if (got == 0) {
+      eof = true;
+      return head < filled; // The unterminated last line is still pending
+    }
+    filled += static_cast<size_t>(got);
+    stats.bytesRead += static_cast<uint64_t>(got);
+    return true;
+  }
+
+  /**
+   * @brief Splits up to quota complete lines starting at head into lines.
+   * @return False if not even one complete line is buffered.
+   */
+  bool splitLines(uint64_t quota) {
+    auto start = Clock::now();
+    lines.clear();
+    const char *base = buffer.get();
+    while (lines.size() < quota && head < filled) {
+      const char *begin = base + head;
+      size_t avail = filled - head;
+      const char *nl =
+          static_cast<const char *>(std::memchr(begin, '\n', avail));
+      size_t len;
+      if (nl) {
+        len = static_cast<size_t>(nl - begin);
+        head += len + 1;
+      } else if (eof || (head == 0 && filled == opts.maxLineBytes)) {
+        // Final unterminated line, or one past maxLineBytes: cut it here.
+        if (!eof)
+          ++stats.oversizedLines;
+        len = avail;
+        head = filled;
+      } else {
+        break;
+      }
+      if (len && begin[len - 1] == '\r')
+        --len;
+      lines.emplace_back(begin, len);
+    }
+    stats.linesSplit += lines.size();
+    stats.splitNs += since(start);
+    return !lines.empty();
+  }
+
+  void extractLines(EntityBatch &batch) {
+    auto start = Clock::now();
+    for (std::string_view line : lines) {
+      spans.clear();
+      extractor.extractSpans(line, spans);
+      stats.bytesScanned += line.size();
+      for (const EntitySpan &s : spans) {
+        EntityRecord r;
+        r.line = lineNo;
+        r.offset = static_cast<uint32_t>(s.value.data() - line.data());
+        r.arenaPos = static_cast<uint32_t>(batch.arena.size());
+        r.length = static_cast<uint32_t>(s.value.size());
+        r.type = s.type;
+        batch.arena.insert(batch.arena.end(), s.value.begin(), s.value.end());
+        batch.records.push_back(r);
+      }
+      stats.entities += spans.size();
+      ++lineNo;
+      ++batch.lineCount;
+    }
+    lines.clear();
+    stats.extractNs += since(start);
+  }
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class ArrayRef
+ * @brief Non-owning, read-only view of a contiguous array.
+ *
+ * Frozen structures (CsrGraph, MappedGraph) address their columns through
+ * ArrayRef so the same accessors work whether the bytes live in a heap
+ * vector or in a memory-mapped file. Whoever creates the view keeps the
+ * backing storage alive.
+ */
+template <typename T> class ArrayRef {
+public:
+  ArrayRef() = default;
+  ArrayRef(const T *data, size_t size) : ptr(data), count(size) {}
+  ArrayRef(const std::vector<T> &v) : ptr(v.data()), count(v.size()) {}
+
+  const T &operator[](size_t i) const { return ptr[i]; }
+  const T *data() const { return ptr; }
+  const T *begin() const { return ptr; }
+  const T *end() const { return ptr + count; }
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+
+private:
+  const T *ptr = nullptr;
+  size_t count = 0;
+};
@@ -0,0 +1,526 @@
+#pragma once
+
+#include "../data-preprocessing/ParallelFor.hpp"
+#include "CsrGraph.hpp"
+#include "GraphEngine.hpp"
+#include "StringPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @class BulkLoader
+ * @brief Builds a GraphEngine from columnar batches of extracted triples
+ * in a few parallel passes instead of one resolveNode/addEdge per entity.
+ *
+ * INPUT: NodeBatch rows are entity mentions (label ID, canonical name),
+ * repeated as often as the extractor saw them. EdgeBatch rows are
+ * (src mention row, tgt mention row, label ID, confidence), counted over
+ * every addNodes() call so far.
+ *
+ * load() runs these passes, each parallel over coarse tasks:
+ * 1. Hash every mention and scatter the rows into 256 partitions by the
+ *    top hash byte. The scatter is stable.
+ * 2. Dedupe each partition with its own open-addressing table. Node IDs
+ *    are 1..N in partition order, then first mention within a partition.
+ *    So the IDs depend on the input only, not on the thread count.
+ * 3. Copy the representative names into one arena buffer.
+ * 4. Map edge rows to nodes, then counting-sort the edges into the
+ *    forward and reverse CSR arrays. Edges are bucketed by source range
+ *    first, so every bucket sorts independently. Order is kept stable,
+ *    making the result identical to GraphEngine::snapshot() after the
+ *    same addEdge calls: edge IDs are 1..M in input order.
+ *
+ * No "label::name" keys are built and no GNode/GEdge is allocated. The
+ * dedupe tables stay queryable through find() after the load, and
+ * seedRegistry() hands the nodes to an EntityRegistry.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: Linear work with no locks; every pass streams its columns.
+ * - CON: Holds every mention in memory until load(). Roughly 20 bytes
+ *   plus the name per mention, and 40 bytes per edge while sorting.
+ * - CON: Only fills an empty engine. Later updates go through addEdge
+ *   as usual; resolve further entities through an EntityRegistry seeded
+ *   by seedRegistry(), or its IDs collide with the loaded ones. Mention
+ *   rows and edges are capped at 2^32 - 1.
+ */
+class BulkLoader {
+public:
+  /**
+   * @struct NodeBatch
+   * @brief Entity mentions; name i is names[nameEnd[i - 1], nameEnd[i]).
+   */
+  struct NodeBatch {
+    std::vector<uint32_t> label; // From BulkLoader::labelId()
+    std::vector<uint64_t> nameEnd;
+    std::string names;
+
+    void add(uint32_t labelId, std::string_view name) {
+      label.push_back(labelId);
+      names.append(name);
+      nameEnd.push_back(names.size());
+    }
+    size_t size() const { return label.size(); }
+  };
+
+  /**
+   * @struct EdgeBatch
+   * @brief Relations between mention rows.
+   */
+  struct EdgeBatch {
+    std::vector<uint64_t> src;
+    std::vector<uint64_t> tgt;
+    std::vector<uint32_t> label;
+    std::vector<float> confidence; // NaN when unknown
+
+    void add(uint64_t srcRow, uint64_t tgtRow, uint32_t labelId,
+             float conf = std::nanf("")) {
+      src.push_back(srcRow);
+      tgt.push_back(tgtRow);
+      label.push_back(labelId);
+      confidence.push_back(conf);
+    }
+    size_t size() const { return src.size(); }
+  };
+
+  struct Stats {
+    size_t mentions = 0;
+    size_t nodes = 0;
+    size_t edges = 0;
+    double dedupeSeconds = 0;
+    double columnSeconds = 0;
+    double csrSeconds = 0;
+  };
+
+  explicit BulkLoader(size_t threads = 0)
+      : threads(threads ? threads
+                        : std::max(1u, std::thread::hardware_concurrency())) {
+    labels.intern(""); // Same reserved label 0 as GraphEngine
+  }
+
+  uint32_t labelId(std::string_view label) { return labels.intern(label); }
+
+  /**
+   * @return The mention row of the batch's first entry.
+   */
+  uint64_t addNodes(const NodeBatch &batch) {
+    uint64_t first = mentionLabel.size();
+    uint64_t base = mentionNames.size();
+    mentionLabel.insert(mentionLabel.end(), batch.label.begin(),
+                        batch.label.end());
+    mentionNames.append(batch.names);
+    for (uint64_t end : batch.nameEnd)
+      mentionEnd.push_back(base + end);
+    return first;
+  }
+
+  void addEdges(const EdgeBatch &batch) {
+    edgeSrc.insert(edgeSrc.end(), batch.src.begin(), batch.src.end());
+    edgeTgt.insert(edgeTgt.end(), batch.tgt.begin(), batch.tgt.end());
+    edgeLabel.insert(edgeLabel.end(), batch.label.begin(), batch.label.end());
+    edgeConf.insert(edgeConf.end(), batch.confidence.begin(),
+                    batch.confidence.end());
+  }
+
+  /**
+   * @brief Dedupes the mentions and fills `engine`, which must be empty.
+   * The staged edges are released; mention names stay for find().
+   * @return false, leaving the engine untouched, on invalid input.
+   */
+  bool load(GraphEngine &engine, std::string *error = nullptr) {
+    auto fail = [&](const char *message) {
+      if (error)
+        *error = message;
+      return false;
+    };
+    if (!engine.nodeIds.empty() || !engine.edgeRecords.empty())
+      return fail("bulk load needs an empty engine");
+    if (mentionEnd.size() != mentionLabel.size() ||
+        edgeTgt.size() != edgeSrc.size() ||
+        edgeLabel.size() != edgeSrc.size() ||
+        edgeConf.size() != edgeSrc.size())
+      return fail("batch columns differ in length");
+    if (mentionLabel.size() >= NONE || edgeSrc.size() >= NONE)
+      return fail("too many mention rows or edges");
+    for (uint32_t l : mentionLabel)
+      if (l == 0 || l >= labels.size())
+        return fail("node mention without a valid label");
+    for (size_t e = 0; e < edgeSrc.size(); ++e)
+      if (edgeSrc[e] >= mentionLabel.size() ||
+          edgeTgt[e] >= mentionLabel.size() || edgeLabel[e] >= labels.size())
+        return fail("edge references an unknown mention row or label");
+
+    auto t0 = Clock::now();
+    dedupe();
+    auto t1 = Clock::now();
+    std::vector<uint32_t> labelMap(labels.size());
+    for (uint32_t l = 0; l < labels.size(); ++l)
+      labelMap[l] = engine.labelPool.intern(labels.str(l));
+    fillNodes(engine, labelMap);
+    auto t2 = Clock::now();
+    fillEdges(engine, labelMap);
+    auto t3 = Clock::now();
+
+    stats.mentions = mentionLabel.size();
+    stats.nodes = nodeRep.size();
+    stats.edges = engine.edgeRecords.size();
+    stats.dedupeSeconds = seconds(t0, t1);
+    stats.columnSeconds = seconds(t1, t2);
+    stats.csrSeconds = seconds(t2, t3);
+    return true;
+  }
+
+  /**
+   * @brief Node ID a mention row was merged into (valid after load()).
+   */
+  uint64_t nodeIdOfRow(uint64_t row) const { return rowNode[row] + 1; }
+
+  /**
+   * @brief (label, name) -> node ID, answered from the dedupe tables.
+   */
+  std::optional<uint64_t> find(std::string_view label,
+                               std::string_view name) const {
+    uint32_t l = labels.find(label);
+    if (l == StringInterner::NO_ID || tables.empty())
+      return std::nullopt;
+    uint64_t h = hashKey(l, name.data(), name.size());
+    const std::vector<uint32_t> &table = tables[h >> PARTITION_SHIFT];
+    for (size_t i = h & (table.size() - 1);; i = (i + 1) & (table.size() - 1)) {
+      if (table[i] == 0)
+        return std::nullopt;
+      uint32_t node = partBase[h >> PARTITION_SHIFT] + table[i] - 1;
+      uint32_t rep = nodeRep[node];
+      if (mentionLabel[rep] == l && mentionName(rep) == name)
+        return uint64_t(node) + 1;
+    }
+  }
+
+  /**
+   * @brief Adopts every loaded node into `registry` (valid after load()),
+   * so resolveNode() finds them and issues new IDs after the last one.
+   */
+  void seedRegistry(EntityRegistry &registry) const {
+    registry.reserve(nodeRep.size());
+    for (uint32_t v = 0; v < nodeRep.size(); ++v)
+      registry.adopt(labels.str(mentionLabel[nodeRep[v]]),
+                     mentionName(nodeRep[v]), uint64_t(v) + 1);
+  }
+
+  const Stats &lastStats() const { return stats; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+  static constexpr uint32_t NONE = CsrGraph::NO_NODE;
+  static constexpr unsigned PARTITION_SHIFT = 56;
+  static constexpr size_t PARTITIONS = size_t(1) << (64 - PARTITION_SHIFT);
+
+  /**
+   * @brief Owner of the CSR columns built by fillEdges().
+   */
+  struct CsrColumns {
+    std::vector<uint64_t> offsets, edgeIds, inOffsets, inEdgePos, nodeIds;
+    std::vector<uint32_t> neighbors, edgeLabels, inNeighbors, idDirect;
+    std::vector<CsrGraph::SparseId> idSparse;
+  };
+
+  size_t threads;
+  StringInterner labels;
+  Stats stats;
+
+  // Staged mentions (kept after load for find()) and edges.
+  std::vector<uint32_t> mentionLabel;
+  std::vector<uint64_t> mentionEnd;
+  std::string mentionNames;
+  std::vector<uint64_t> edgeSrc, edgeTgt;
+  std::vector<uint32_t> edgeLabel;
+  std::vector<float> edgeConf;
+
+  // Dedupe results.
+  std::vector<uint64_t> hashes;  // Per mention, during dedupe()
+  std::vector<uint32_t> rowNode; // Mention -> dense node index
+  std::vector<uint32_t> nodeRep; // Node -> first mention row
+  std::vector<uint32_t> partBase;
+  std::vector<std::vector<uint32_t>> tables; // Slot -> local node + 1
+
+  static double seconds(Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration<double>(b - a).count();
+  }
+
+  static uint64_t mix(uint64_t x) {
+    x ^= x >> 31;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+  }
+
+  static uint64_t hashKey(uint32_t label, const char *s, size_t n) {
+    uint64_t h = mix((uint64_t(label) << 32) ^ n);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+      uint64_t w;
+      std::memcpy(&w, s + i, 8);
+      h = mix(h ^ w);
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, s + i, n - i);
+    return mix(h ^ tail);
+  }
+
+  std::string_view mentionName(uint32_t row) const {
+    uint64_t begin = row ? mentionEnd[row - 1] : 0;
+    return std::string_view(mentionNames.data() + begin,
+                            mentionEnd[row] - begin);
+  }
+
+  /**
+   * @brief Splits [0, n) into one contiguous range per task.
+   */
+  static std::pair<size_t, size_t> chunk(size_t n, size_t tasks, size_t t) {
+    return {n * t / tasks, n * (t + 1) / tasks};
+  }
+
+  void dedupe() {
+    const size_t rows = mentionLabel.size();
+    const size_t chunks = std::max<size_t>(1, std::min(rows / 4096 + 1,
+                                                       threads * 4));
+    hashes.resize(rows);
+    std::vector<size_t> counts(chunks * PARTITIONS, 0);
+    ParallelFor::run<1>(chunks, threads, [&](size_t c) {
+      auto [begin, end] = chunk(rows, chunks, c);
+      size_t *mine = counts.data() + c * PARTITIONS;
+      for (size_t r = begin; r < end; ++r) {
+        std::string_view name = mentionName(static_cast<uint32_t>(r));
+        hashes[r] = hashKey(mentionLabel[r], name.data(), name.size());
+        mine[hashes[r] >> PARTITION_SHIFT]++;
+      }
+    });
+
+    // Partition-major prefix sums: partition p, chunk c starts at cursor.
+    std::vector<size_t> partStart(PARTITIONS + 1, 0);
+    size_t total = 0;
+    for (size_t p = 0; p < PARTITIONS; ++p) {
+      partStart[p] = total;
+      for (size_t c = 0; c < chunks; ++c) {
+        size_t n = counts[c * PARTITIONS + p];
+        counts[c * PARTITIONS + p] = total;
+        total += n;
+      }
+    }
+    partStart[PARTITIONS] = total;
+    std::vector<uint32_t> order(rows);
+    ParallelFor::run<1>(chunks, threads, [&](size_t c) {
+      auto [begin, end] = chunk(rows, chunks, c);
+      size_t *cursor = counts.data() + c * PARTITIONS;
+      for (size_t r = begin; r < end; ++r)
+        order[cursor[hashes[r] >> PARTITION_SHIFT]++] =
+            static_cast<uint32_t>(r);
+    });
+
+    // Each partition dedupes alone; rowNode holds local ordinals for now.
+    rowNode.assign(rows, 0);
+    tables.assign(PARTITIONS, {});
+    std::vector<std::vector<uint32_t>> reps(PARTITIONS);
+    ParallelFor::run<1>(PARTITIONS, threads, [&](size_t p) {
+      size_t n = partStart[p + 1] - partStart[p];
+      size_t size = 16;
+      while (size < 2 * n)
+        size *= 2;
+      std::vector<uint32_t> &table = tables[p];
+      table.assign(size, 0);
+      for (size_t k = partStart[p]; k < partStart[p + 1]; ++k) {
+        uint32_t r = order[k];
+        size_t i = hashes[r] & (size - 1);
+        for (;; i = (i + 1) & (size - 1)) {
+          if (table[i] == 0) {
+            reps[p].push_back(r);
+            table[i] = static_cast<uint32_t>(reps[p].size());
+            break;
+          }
+          uint32_t rep = reps[p][table[i] - 1];
+          if (hashes[rep] == hashes[r] &&
+              mentionLabel[rep] == mentionLabel[r] &&
+              mentionName(rep) == mentionName(r))
+            break;
+        }
+        rowNode[r] = table[i] - 1;
+      }
+    });
+
+    partBase.assign(PARTITIONS + 1, 0);
+    for (size_t p = 0; p < PARTITIONS; ++p)
+      partBase[p + 1] = partBase[p] + static_cast<uint32_t>(reps[p].size());
+    nodeRep.resize(partBase[PARTITIONS]);
+    ParallelFor::run<1>(PARTITIONS, threads, [&](size_t p) {
+      std::copy(reps[p].begin(), reps[p].end(), nodeRep.begin() + partBase[p]);
+    });
+    ParallelFor::run<1>(chunks, threads, [&](size_t c) {
+      auto [begin, end] = chunk(rows, chunks, c);
+      for (size_t r = begin; r < end; ++r)
+        rowNode[r] += partBase[hashes[r] >> PARTITION_SHIFT];
+    });
+    std::vector<uint64_t>().swap(hashes);
+  }
+
+  void fillNodes(GraphEngine &engine, const std::vector<uint32_t> &labelMap) {
+    const uint32_t n = static_cast<uint32_t>(nodeRep.size());
+    std::vector<uint64_t> ends(size_t(n) + 1, 0);
+    for (uint32_t v = 0; v < n; ++v)
+      ends[v + 1] = ends[v] + mentionName(nodeRep[v]).size();
+    std::string buffer(ends[n], '\0');
+    engine.nodeIds.resize(n);
+    engine.nodeLabel.resize(n);
+    engine.nodeName.resize(n);
+    const size_t tasks = std::min<size_t>(threads * 4, n / 4096 + 1);
+    ParallelFor::run<1>(tasks, threads, [&](size_t t) {
+      auto [begin, end] = chunk(n, tasks, t);
+      for (size_t v = begin; v < end; ++v) {
+        std::string_view name = mentionName(nodeRep[v]);
+        std::memcpy(&buffer[ends[v]], name.data(), name.size());
+        engine.nodeIds[v] = v + 1;
+        engine.nodeLabel[v] = labelMap[mentionLabel[nodeRep[v]]];
+        engine.nodeName[v] = static_cast<uint32_t>(v);
+      }
+    });
+    engine.namePool.assign(std::move(buffer), std::move(ends));
+    engine.nodeAuthority.assign(n, std::nanf(""));
+    engine.nodeStability.assign(n, std::nanf(""));
+    engine.nodeIndex.assignSequential(n);
+    engine.declaredNodes = n;
+  }
+
+  /**
+   * @brief Stable counting sort of items [0, m) by key(i) < n, in
+   * parallel: items are first bucketed by key range, then every bucket
+   * counts and places its own keys. Fills offsets (n + 1) and calls
+   * place(i, position) once per item.
+   */
+  template <typename Key, typename Place>
+  void countingSort(size_t m, uint32_t n, const Key &key,
+                    std::vector<uint64_t> &offsets, const Place &place) const {
+    offsets.assign(size_t(n) + 1, 0);
+    if (n == 0)
+      return;
+    const size_t buckets = std::min<size_t>(n, threads * 8);
+    const size_t chunks = std::max<size_t>(1, std::min(m / 4096 + 1,
+                                                       threads * 4));
+    auto bucketOf = [&](uint32_t k) { return size_t(k) * buckets / n; };
+    std::vector<size_t> counts(chunks * buckets, 0);
+    ParallelFor::run<1>(chunks, threads, [&](size_t c) {
+      auto [begin, end] = chunk(m, chunks, c);
+      for (size_t i = begin; i < end; ++i)
+        counts[c * buckets + bucketOf(key(i))]++;
+    });
+    std::vector<size_t> bucketStart(buckets + 1, 0);
+    size_t total = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+      bucketStart[b] = total;
+      for (size_t c = 0; c < chunks; ++c) {
+        size_t k = counts[c * buckets + b];
+        counts[c * buckets + b] = total;
+        total += k;
+      }
+    }
+    bucketStart[buckets] = total;
+    std::vector<uint32_t> order(m);
+    ParallelFor::run<1>(chunks, threads, [&](size_t c) {
+      auto [begin, end] = chunk(m, chunks, c);
+      size_t *cursor = counts.data() + c * buckets;
+      for (size_t i = begin; i < end; ++i)
+        order[cursor[bucketOf(key(i))]++] = static_cast<uint32_t>(i);
+    });
+
+    ParallelFor::run<1>(buckets, threads, [&](size_t b) {
+      // Keys of bucket b are the k with k * buckets / n == b.
+      uint32_t lo = static_cast<uint32_t>((b * n + buckets - 1) / buckets);
+      uint32_t hi =
+          static_cast<uint32_t>(((b + 1) * n + buckets - 1) / buckets);
+      std::vector<uint64_t> cursor(hi - lo, 0);
+      for (size_t j = bucketStart[b]; j < bucketStart[b + 1]; ++j)
+        cursor[key(order[j]) - lo]++;
+      uint64_t pos = bucketStart[b];
+      for (uint32_t k = lo; k < hi; ++k) {
+        offsets[k] = pos;
+        pos += cursor[k - lo];
+        cursor[k - lo] = offsets[k];
+      }
+      for (size_t j = bucketStart[b]; j < bucketStart[b + 1]; ++j) {
+        uint32_t i = order[j];
+        place(i, cursor[key(i) - lo]++);
+      }
+    });
+    offsets[n] = m;
+  }
+
+  void fillEdges(GraphEngine &engine, const std::vector<uint32_t> &labelMap) {
+    const size_t m = edgeSrc.size();
+    const uint32_t n = static_cast<uint32_t>(nodeRep.size());
+    engine.edgeRecords.resize(m);
+    engine.edgeConfidence = std::move(edgeConf);
+    engine.edgeConfidence.resize(m, std::nanf(""));
+    const size_t tasks = std::min<size_t>(threads * 4, m / 4096 + 1);
+    ParallelFor::run<1>(tasks, threads, [&](size_t t) {
+      auto [begin, end] = chunk(m, tasks, t);
+      for (size_t e = begin; e < end; ++e)
+        engine.edgeRecords[e] = {e + 1, rowNode[edgeSrc[e]],
+                                 rowNode[edgeTgt[e]], labelMap[edgeLabel[e]]};
+    });
+    engine.edgeIndex.assignSequential(static_cast<uint32_t>(m));
+    std::vector<uint64_t>().swap(edgeSrc);
+    std::vector<uint64_t>().swap(edgeTgt);
+    std::vector<uint32_t>().swap(edgeLabel);
+    edgeConf.clear();
+
+    auto s = std::make_shared<CsrColumns>();
+    const auto &records = engine.edgeRecords;
+    s->neighbors.resize(m);
+    s->edgeLabels.resize(m);
+    s->edgeIds.resize(m);
+    std::vector<uint32_t> srcAt(m);
+    countingSort(
+        m, n, [&](size_t e) { return records[e].src; }, s->offsets,
+        [&](size_t e, uint64_t pos) {
+          s->neighbors[pos] = records[e].tgt;
+          s->edgeLabels[pos] = records[e].label;
+          s->edgeIds[pos] = records[e].id;
+          srcAt[pos] = records[e].src;
+        });
+    s->inNeighbors.resize(m);
+    s->inEdgePos.resize(m);
+    countingSort(
+        m, n, [&](size_t pos) { return s->neighbors[pos]; }, s->inOffsets,
+        [&](size_t pos, uint64_t rpos) {
+          s->inNeighbors[rpos] = srcAt[pos];
+          s->inEdgePos[rpos] = pos;
+        });
+    s->nodeIds = engine.nodeIds;
+    if (n) { // IDs 1..n are all direct-mapped, as in CsrGraph::fromDense
+      s->idDirect.resize(size_t(n) + 1);
+      s->idDirect[0] = NONE;
+      for (uint32_t v = 0; v < n; ++v)
+        s->idDirect[v + 1] = v;
+    }
+
+    std::vector<std::string> csrLabels;
+    for (uint32_t i = 0; i < engine.labelPool.size(); ++i)
+      csrLabels.push_back(engine.labelPool.str(i));
+    CsrGraph::Arrays a{s->offsets,   s->neighbors,   s->edgeLabels,
+                       s->edgeIds,   s->inOffsets,   s->inNeighbors,
+                       s->inEdgePos, s->nodeIds,     s->idDirect,
+                       s->idSparse};
+    engine.csr = std::make_shared<const CsrGraph>(
+        CsrGraph::fromArrays(a, std::move(csrLabels), std::move(s)));
+    engine.csrDirty = false;
+    engine.weightsDirty = true;
+    engine.reach.reset();
+  }
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../data-preprocessing/EnrichedChunkFile.hpp"
+#include "GraphEngine.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class ChunkLoader
+ * @brief Adds the chunks of an EnrichedChunkFile to the Knowledge Graph.
+ *
+ * Each source becomes one SOURCE_DOCUMENT node whose authority_score is
+ * the enricher's, so RankedPathSearch weighs evidence by where it came
+ * from. Each chunk becomes a TEXT_CHUNK node ("<source>#<n>") with a
+ * DERIVED_FROM edge to its source. Type and tags are read as integers
+ * from the mapped records; nothing is re-parsed.
+ */
+class ChunkLoader {
+public:
+  static constexpr const char *SOURCE_LABEL = "SOURCE_DOCUMENT";
+  static constexpr const char *CHUNK_LABEL = "TEXT_CHUNK";
+  static constexpr const char *DERIVED_FROM = "DERIVED_FROM";
+  static constexpr const char *SOURCE_TYPE = "source_type"; // SourceType
+  static constexpr const char *DOMAIN_TAGS = "domain_tags"; // DomainTag bits
+
+  struct Result {
+    std::vector<uint64_t> sourceNodes; // Per source index
+    std::vector<uint64_t> chunkNodes;  // Per chunk index
+    uint64_t nextEdgeId = 0; // First edge ID not used by the loader
+  };
+
+  /**
+   * @param firstEdgeId DERIVED_FROM edges take consecutive IDs from here.
+   */
+  static Result load(const MappedChunks &chunks, GraphEngine &engine,
+                     EntityRegistry &registry, uint64_t firstEdgeId) {
+    Result r;
+    r.sourceNodes.reserve(chunks.sourceCount());
+    for (size_t s = 0; s < chunks.sourceCount(); ++s) {
+      const MappedChunks::SourceRecord &src = chunks.source(s);
+      uint64_t id = registry.resolveNode(
+          SOURCE_LABEL, std::string(chunks.sourceName(s)), engine);
+      engine.setNodeProperty(id, GraphEngine::AUTHORITY_SCORE,
+                             static_cast<double>(src.authority));
+      engine.setNodeProperty(id, SOURCE_TYPE, static_cast<int>(src.type));
+      engine.setNodeProperty(id, DOMAIN_TAGS, static_cast<int>(src.tags));
+      r.sourceNodes.push_back(id);
+    }
+
+    std::vector<uint32_t> ordinal(chunks.sourceCount(), 0);
+    std::string name;
+    r.chunkNodes.reserve(chunks.size());
+    r.nextEdgeId = firstEdgeId;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      uint32_t s = chunks.chunk(i).source;
+      name.assign(chunks.sourceName(s));
+      name += '#';
+      name += std::to_string(ordinal[s]++);
+      uint64_t id = registry.resolveNode(CHUNK_LABEL, name, engine);
+      engine.addEdge(r.nextEdgeId++, id, r.sourceNodes[s], DERIVED_FROM, 1.0f);
+      r.chunkNodes.push_back(id);
+    }
+    return r;
+  }
+};
@@ -0,0 +1,498 @@
+#pragma once
+
+#include "GraphEngine.hpp"
+#include "ShardedRegistry.hpp"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @class NodeDirectory
+ * @brief Frozen labels and canonical names, split into fixed-size chunks.
+ *
+ * A publish only rebuilds the chunks whose nodes changed; untouched chunks
+ * are shared by pointer with the previous snapshot, so freezing names costs
+ * O(changed nodes) rather than O(N).
+ */
+class NodeDirectory {
+public:
+  static constexpr size_t CHUNK = 4096;
+
+  struct Chunk {
+    std::vector<uint32_t> label;
+    std::vector<uint32_t> nameEnd; // Exclusive end offset into names
+    std::string names;
+  };
+
+  /**
+   * @brief Builds a directory from the engine, reusing clean chunks of prev.
+   * @param dirty Chunk indices touched since prev was built.
+   */
+  static std::shared_ptr<const NodeDirectory>
+  rebuild(const GraphEngine &engine, const NodeDirectory *prev,
+          const std::vector<uint8_t> &dirty) {
+    auto dir = std::make_shared<NodeDirectory>();
+    const size_t n = engine.nodeSlots();
+    const size_t chunkCount = (n + CHUNK - 1) / CHUNK;
+    dir->slots = n;
+    dir->chunks.resize(chunkCount);
+    for (size_t c = 0; c < chunkCount; ++c) {
+      bool reusable = prev && c < prev->chunks.size() &&
+                      (c >= dirty.size() || !dirty[c]) &&
+                      prev->chunks[c]->label.size() ==
+                          std::min(CHUNK, n - c * CHUNK);
+      dir->chunks[c] = reusable ? prev->chunks[c] : freezeChunk(engine, c);
+    }
+    if (prev && prev->labels->size() == engine.labelCount()) {
+      dir->labels = prev->labels;
+    } else {
+      auto labels = std::make_shared<std::vector<std::string>>();
+      for (uint32_t i = 0; i < engine.labelCount(); ++i)
+        labels->push_back(engine.labelString(i));
+      dir->labels = std::move(labels);
+    }
+    return dir;
+  }
+
+  size_t size() const { return slots; }
+
+  uint32_t labelIdAt(uint32_t idx) const {
+    return chunks[idx / CHUNK]->label[idx % CHUNK];
+  }
+
+  std::string_view labelAt(uint32_t idx) const {
+    return (*labels)[labelIdAt(idx)];
+  }
+
+  uint32_t labelCount() const {
+    return static_cast<uint32_t>(labels->size());
+  }
+  std::string_view labelName(uint32_t labelId) const {
+    return (*labels)[labelId];
+  }
+
+  std::string_view nameAt(uint32_t idx) const {
+    const Chunk &c = *chunks[idx / CHUNK];
+    size_t i = idx % CHUNK;
+    size_t begin = i ? c.nameEnd[i - 1] : 0;
+    return std::string_view(c.names.data() + begin, c.nameEnd[i] - begin);
+  }
+
+private:
+  size_t slots = 0;
+  std::vector<std::shared_ptr<const Chunk>> chunks;
+  std::shared_ptr<const std::vector<std::string>> labels;
+
+  static std::shared_ptr<const Chunk> freezeChunk(const GraphEngine &engine,
+                                                  size_t c) {
+    auto chunk = std::make_shared<Chunk>();
+    size_t end = std::min(engine.nodeSlots(), (c + 1) * CHUNK);
+    for (size_t i = c * CHUNK; i < end; ++i) {
+      uint32_t idx = static_cast<uint32_t>(i);
+      chunk->label.push_back(engine.labelIdAt(idx));
+      chunk->names.append(engine.nameAt(idx));
+      chunk->nameEnd.push_back(static_cast<uint32_t>(chunk->names.size()));
+    }
+    return chunk;
+  }
+};
+
+/**
+ * @struct GraphSnapshot
+ * @brief One immutable, published version of the Knowledge Graph.
+ */
+struct GraphSnapshot {
+  uint64_t version = 0;
+  std::shared_ptr<const CsrGraph> csr;
+  std::shared_ptr<const std::vector<float>> weights;
+  std::shared_ptr<const NodeDirectory> directory;
+
+  bool hasNode(uint64_t id) const {
+    uint32_t idx = csr->indexOfNode(id);
+    return idx != CsrGraph::NO_NODE && directory->labelIdAt(idx) != 0;
+  }
+};
+
+/**
+ * @class ConcurrentGraph
+ * @brief RCU-style Knowledge Graph: lock-free readers, batched writers.
+ *
+ * CONCURRENCY MODEL:
+ * - Writers (resolveNode/addEdge) append to striped delta buffers and never
+ *   touch what readers see. publish() drains the deltas into the private
+ *   GraphEngine, freezes a new GraphSnapshot and swaps it in atomically.
+ * - Readers call pin(), which announces the current epoch in a free reader
+ *   slot and loads the snapshot pointer. No mutex, no reference-count
+ *   traffic on a shared cache line; a pinned snapshot never changes.
+ * - Retired snapshots are freed by publish() once every pinned reader slot
+ *   shows an epoch newer than the retirement (epoch-based reclamation).
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: Queries scale with cores while ingestion continues.
+ * - CON: Readers see writes only after the next publish(); batch deltas and
+ *   publish on a timer or size threshold.
+ * - CON: Each publish still copies CSR and weights (O(N + E)), but only
+ *   re-sorts the rows a small batch changed (GraphEngine::snapshot()); the
+ *   node directory is incremental.
+ */
+class ConcurrentGraph {
+public:
+  static constexpr size_t MAX_READERS = 256;
+  static constexpr size_t CHANGE_LOG = 64; // Versions kept by changesSince()
+
+  /**
+   * @struct ChangeSet
+   * @brief What one publish() changed, so result caches can invalidate
+   * selectively instead of flushing.
+   */
+  struct ChangeSet {
+    uint64_t version = 0;
+    std::vector<uint64_t> declaredNodes;
+    std::vector<std::pair<uint64_t, uint64_t>> addedEdges; // (src, tgt)
+    // Old endpoints of edges that an addEdge with the same ID replaced.
+    std::vector<std::pair<uint64_t, uint64_t>> replacedEdges;
+    bool rewritten = false; // withWriter() ran: assume anything changed
+  };
+
+  /**
+   * @class ReadView
+   * @brief RAII pin on one snapshot. Keep it short-lived and on one thread.
+   */
+  class ReadView {
+  public:
+    ReadView(ReadView &&o) noexcept : slot(o.slot), snap(o.snap) {
+      o.slot = nullptr;
+    }
+    ReadView(const ReadView &) = delete;
+    ReadView &operator=(const ReadView &) = delete;
+    ~ReadView() {
+      if (slot)
+        slot->store(IDLE, std::memory_order_release);
+    }
+
+    const GraphSnapshot &snapshot() const { return *snap; }
+    uint64_t version() const { return snap->version; }
+
+    std::string_view labelOf(uint64_t id) const {
+      uint32_t idx = snap->csr->indexOfNode(id);
+      return idx != CsrGraph::NO_NODE ? snap->directory->labelAt(idx)
+                                      : std::string_view();
+    }
+
+    std::string_view canonicalNameOf(uint64_t id) const {
+      uint32_t idx = snap->csr->indexOfNode(id);
+      return idx != CsrGraph::NO_NODE ? snap->directory->nameAt(idx)
+                                      : std::string_view();
+    }
+
+    std::vector<uint64_t> findPath(uint64_t startId, uint64_t endId) const {
+      if (!snap->hasNode(startId) || !snap->hasNode(endId))
+        return {};
+      const CsrGraph &g = *snap->csr;
+      return pathScratch().bidirectional(g, g.indexOfNode(startId),
+                                         g.indexOfNode(endId));
+    }
+
+    std::vector<PathSearch::CausalChain>
+    explainSymptoms(const std::vector<uint64_t> &causeIds,
+                    const std::vector<uint64_t> &symptomIds) const {
+      const CsrGraph &g = *snap->csr;
+      auto toDense = [&](const std::vector<uint64_t> &ids) {
+        std::vector<uint32_t> dense;
+        dense.reserve(ids.size());
+        for (uint64_t id : ids)
+          dense.push_back(snap->hasNode(id) ? g.indexOfNode(id)
+                                            : CsrGraph::NO_NODE);
+        return dense;
+      };
+      auto chains =
+          pathScratch().explainAll(g, toDense(causeIds), toDense(symptomIds));
+      for (size_t i = 0; i < chains.size(); ++i)
+        chains[i].symptomId = symptomIds[i];
+      return chains;
+    }
+
+    std::vector<RankedPathSearch::CredibleChain>
+    rankCausalPaths(uint64_t causeId, uint64_t symptomId, size_t k,
+                    const std::vector<std::string> &labels = {}) const {
+      if (!snap->hasNode(causeId) || !snap->hasNode(symptomId))
+        return {};
+      const CsrGraph &g = *snap->csr;
+      auto filter = RankedPathSearch::makeFilter(g, labels);
+      auto paths = rankedScratch().topK(g, *snap->weights,
+                                        g.indexOfNode(causeId),
+                                        g.indexOfNode(symptomId), k, filter);
+      std::vector<RankedPathSearch::CredibleChain> chains;
+      chains.reserve(paths.size());
+      for (const auto &p : paths)
+        chains.push_back(RankedPathSearch::toChain(g, p));
+      return chains;
+    }
+
+  private:
+    friend class ConcurrentGraph;
+    ReadView(std::atomic<uint64_t> *slot, const GraphSnapshot *snap)
+        : slot(slot), snap(snap) {}
+
+    // Per-thread search scratch, so concurrent readers never share state.
+    static PathSearch &pathScratch() {
+      static thread_local PathSearch search;
+      return search;
+    }
+    static RankedPathSearch &rankedScratch() {
+      static thread_local RankedPathSearch ranked;
+      return ranked;
+    }
+
+    std::atomic<uint64_t> *slot;
+    const GraphSnapshot *snap;
+  };
+
+  ConcurrentGraph() { publish(); }
+
+  ~ConcurrentGraph() {
+    delete current.load();
+    for (auto &r : retired)
+      delete r.first;
+  }
+
+  ConcurrentGraph(const ConcurrentGraph &) = delete;
+  ConcurrentGraph &operator=(const ConcurrentGraph &) = delete;
+
+  /**
+   * @brief Pins the latest published snapshot. Lock-free; wait-free unless
+   * all MAX_READERS slots are busy.
+   */
+  ReadView pin() const {
+    size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    for (size_t i = 0;; ++i) {
+      auto &slot = readerSlots[(start + i) % MAX_READERS].epoch;
+      uint64_t expected = IDLE;
+      uint64_t now = globalEpoch.load();
+      if (slot.compare_exchange_strong(expected, now))
+        return ReadView(&slot, current.load());
+      if (i % MAX_READERS == MAX_READERS - 1)
+        std::this_thread::yield();
+    }
+  }
+
+  /**
+   * @brief Thread-safe record linkage. New nodes are buffered in the delta
+   * and become visible to readers at the next publish().
+   */
+  uint64_t resolveNode(const std::string &label,
+                       const std::string &canonicalName) {
+    bool created = false;
+    uint64_t id = registry.resolve(label, canonicalName, created);
+    if (created) {
+      DeltaShard &d = localShard();
+      std::lock_guard<std::mutex> lock(d.mutex);
+      d.nodes.push_back({id, label, canonicalName});
+    }
+    return id;
+  }
+
+  /**
+   * @brief Thread-safe lookup that never creates a node. A node found
+   * here is visible to readers only once it has been published.
+   */
+  bool findNode(const std::string &label, const std::string &canonicalName,
+                uint64_t &id) const {
+    return registry.find(label, canonicalName, id);
+  }
+
+  /**
+   * @brief Thread-safe edge insertion into the delta.
+   */
+  void addEdge(uint64_t id, uint64_t src, uint64_t tgt,
+               const std::string &label, float confidence = std::nanf("")) {
+    DeltaShard &d = localShard();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    d.edges.push_back({id, src, tgt, label, confidence});
+  }
+
+  /**
+   * @brief Applies all buffered deltas and atomically publishes a new
+   * immutable snapshot. Serialized against other publishers only.
+   * @return The new snapshot version.
+   */
+  uint64_t publish() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    const size_t slotsBefore = engine.nodeSlots();
+    std::vector<uint8_t> dirty((slotsBefore + NodeDirectory::CHUNK - 1) /
+                               NodeDirectory::CHUNK);
+    auto touch = [&](uint64_t id) {
+      size_t c = engine.nodeIndexOf(id) / NodeDirectory::CHUNK;
+      if (c < dirty.size())
+        dirty[c] = 1;
+    };
+
+    auto change = std::make_shared<ChangeSet>();
+    change->rewritten = rewritten;
+    rewritten = false;
+    for (auto &shard : deltas) {
+      std::vector<PendingNode> nodes;
+      std::vector<PendingEdge> edges;
+      {
+        std::lock_guard<std::mutex> shardLock(shard.mutex);
+        nodes.swap(shard.nodes);
+        edges.swap(shard.edges);
+      }
+      for (const auto &n : nodes) {
+        engine.addNode(n.id, n.label);
+        engine.setNodeProperty(n.id, GraphEngine::CANONICAL_NAME, n.name);
+        touch(n.id);
+        change->declaredNodes.push_back(n.id);
+      }
+      for (const auto &e : edges) {
+        uint64_t oldSrc, oldTgt;
+        if (engine.edgeEndpoints(e.id, oldSrc, oldTgt))
+          change->replacedEdges.push_back({oldSrc, oldTgt});
+        engine.addEdge(e.id, e.src, e.tgt, e.label, e.confidence);
+        change->addedEdges.push_back({e.src, e.tgt});
+      }
+    }
+
+    const GraphSnapshot *prev = current.load();
+    auto *next = new GraphSnapshot();
+    next->version = prev ? prev->version + 1 : 0;
+    next->csr = engine.snapshot();
+    next->weights = engine.edgeWeights();
+    const NodeDirectory *prevDir =
+        (prev && !directoryStale) ? prev->directory.get() : nullptr;
+    next->directory = NodeDirectory::rebuild(engine, prevDir, dirty);
+    directoryStale = false;
+
+    // Logged before the swap, so any reader of this version finds it.
+    change->version = next->version;
+    {
+      std::lock_guard<std::mutex> logLock(logMutex);
+      changeLog.push_back(std::move(change));
+      if (changeLog.size() > CHANGE_LOG)
+        changeLog.pop_front();
+    }
+
+    const GraphSnapshot *old = current.exchange(next);
+    uint64_t tag = globalEpoch.fetch_add(1);
+    if (old)
+      retired.emplace_back(old, tag);
+    reclaim();
+    return next->version;
+  }
+
+  /**
+   * @brief Appends the change sets of versions (after, upTo] to out, oldest
+   * first.
+   * @return false if some of them are no longer in the log.
+   */
+  bool changesSince(uint64_t after, uint64_t upTo,
+                    std::vector<std::shared_ptr<const ChangeSet>> &out) const {
+    std::lock_guard<std::mutex> lock(logMutex);
+    if (upTo <= after)
+      return true;
+    if (changeLog.empty() || changeLog.front()->version > after + 1 ||
+        changeLog.back()->version < upTo)
+      return false;
+    for (const auto &c : changeLog)
+      if (c->version > after && c->version <= upTo)
+        out.push_back(c);
+    return true;
+  }
+
+  /**
+   * @brief Direct writer-side access for bulk updates such as authority and
+   * stability scores. Call publish() afterwards to make them visible.
+   */
+  template <typename Fn> void withWriter(Fn &&fn) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    fn(engine);
+    directoryStale = true; // fn may have renamed nodes
+    rewritten = true;
+  }
+
+  size_t retiredCount() const {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    return retired.size();
+  }
+
+private:
+  static constexpr uint64_t IDLE = ~0ull;
+
+  struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> epoch{IDLE};
+  };
+
+  struct PendingNode {
+    uint64_t id;
+    std::string label;
+    std::string name;
+  };
+
+  struct PendingEdge {
+    uint64_t id;
+    uint64_t src;
+    uint64_t tgt;
+    std::string label;
+    float confidence;
+  };
+
+  struct alignas(64) DeltaShard {
+    std::mutex mutex;
+    std::vector<PendingNode> nodes;
+    std::vector<PendingEdge> edges;
+  };
+
+  static constexpr size_t DELTA_SHARDS = 16;
+
+  mutable std::array<ReaderSlot, MAX_READERS> readerSlots;
+  mutable std::atomic<uint64_t> globalEpoch{1};
+  std::atomic<const GraphSnapshot *> current{nullptr};
+
+  mutable std::mutex writerMutex;
+  GraphEngine engine; // Writer-private; guarded by writerMutex
+  bool directoryStale = false;
+  bool rewritten = false;
+  std::vector<std::pair<const GraphSnapshot *, uint64_t>> retired;
+
+  mutable std::mutex logMutex;
+  std::deque<std::shared_ptr<const ChangeSet>> changeLog;
+
+  ShardedEntityRegistry registry;
+  std::array<DeltaShard, DELTA_SHARDS> deltas;
+
+  DeltaShard &localShard() {
+    size_t h = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return deltas[h % DELTA_SHARDS];
+  }
+
+  /**
+   * @brief Frees retired snapshots that no pinned reader can still see: a
+   * reader pinned at epoch e loaded its pointer before any retirement
+   * tagged >= e, so a snapshot tagged t is safe once all pins are > t.
+   */
+  void reclaim() {
+    uint64_t oldestPin = IDLE;
+    for (const auto &slot : readerSlots)
+      oldestPin = std::min(oldestPin, slot.epoch.load());
+    auto keep = retired.begin();
+    for (auto it = retired.begin(); it != retired.end(); ++it) {
+      if (it->second < oldestPin)
+        delete it->first;
+      else
+        *keep++ = *it;
+    }
+    retired.erase(keep, retired.end());
+  }
+};
@@ -1,163 +1,18 @@
-#include <algorithm>
+#include "BulkLoader.hpp"
+#include "ChunkLoader.hpp"
+#include "ConcurrentGraph.hpp"
+#include "GraphEngine.hpp"
+#include "GraphFile.hpp"
+#include "IncrementalLoader.hpp"
+#include "PathCache.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
 #include <iostream>
-#include <memory>
-#include <string>
-#include <unordered_map>
-#include <variant>
-#include <vector>
-
-/**
- * @typedef PropertyValue
- * @brief Supports multiple types for node/edge properties.
- */
-using PropertyValue = std::variant<std::string, int, double, bool>;
-
-/**
- * @class GNode
- * @brief Represents a vertex in the Knowledge Graph.
- */
-class GNode {
-public:
-  uint64_t id;
-  std::string label;
-  std::unordered_map<std::string, PropertyValue> properties;
-
-  GNode(uint64_t id, const std::string &label) : id(id), label(label) {}
-
-  void setProperty(const std::string &key, PropertyValue value) {
-    properties[key] = value;
-  }
-};
-
-/**
- * @class GEdge
- * @brief Represents a directed relationship between two GNodes.
- */
-class GEdge {
-public:
-  uint64_t id;
-  uint64_t sourceId;
-  uint64_t targetId;
-  std::string label;
-  std::unordered_map<std::string, PropertyValue> properties;
-
-  GEdge(uint64_t id, uint64_t src, uint64_t tgt, const std::string &lbl)
-      : id(id), sourceId(src), targetId(tgt), label(lbl) {}
-
-  void setProperty(const std::string &key, PropertyValue value) {
-    properties[key] = value;
-  }
-};
-
-/**
- * @class GraphEngine
- * @brief The core storage and management unit for the Knowledge Graph.
- */
-class GraphEngine {
-public:
-  void addNode(std::shared_ptr<GNode> node) { nodes[node->id] = node; }
-
-  void addEdge(std::shared_ptr<GEdge> edge) {
-    edges[edge->id] = edge;
-    outEdges[edge->sourceId].push_back(edge->id);
-    inEdges[edge->targetId].push_back(edge->id);
-  }
-
-  std::shared_ptr<GNode> getNode(uint64_t id) const {
-    auto it = nodes.find(id);
-    return (it != nodes.end()) ? it->second : nullptr;
-  }
-
-  /**
-   * @brief Performs a multi-hop traversal to find a causal path using BFS.
-   */
-  std::vector<uint64_t> findPath(uint64_t startId, uint64_t endId) {
-    if (nodes.find(startId) == nodes.end() || nodes.find(endId) == nodes.end())
-      return {};
-
-    std::unordered_map<uint64_t, uint64_t> parent;
-    std::vector<uint64_t> queue;
-    queue.push_back(startId);
-
-    std::unordered_map<uint64_t, bool> visited;
-    visited[startId] = true;
-
-    size_t head = 0;
-    bool found = false;
-
-    while (head < queue.size()) {
-      uint64_t curr = queue[head++];
-      if (curr == endId) {
-        found = true;
-        break;
-      }
-
-      auto it = outEdges.find(curr);
-      if (it != outEdges.end()) {
-        for (uint64_t edgeId : it->second) {
-          auto edge_it = edges.find(edgeId);
-          if (edge_it != edges.end()) {
-            uint64_t neighbor = edge_it->second->targetId;
-            if (visited.find(neighbor) == visited.end()) {
-              visited[neighbor] = true;
-              parent[neighbor] = curr;
-              queue.push_back(neighbor);
-            }
-          }
-        }
-      }
-    }
-
-    std::vector<uint64_t> path;
-    if (found) {
-      uint64_t curr = endId;
-      while (curr != startId) {
-        path.push_back(curr);
-        curr = parent[curr];
-      }
-      path.push_back(startId);
-      std::reverse(path.begin(), path.end());
-    }
-    return path;
-  }
-
-  void debugPrint() const {
-    std::cout << "--- Graph Engine State ---" << std::endl;
-    std::cout << "Nodes: " << nodes.size() << " | Edges: " << edges.size()
-              << std::endl;
-  }
-
-private:
-  std::unordered_map<uint64_t, std::shared_ptr<GNode>> nodes;
-  std::unordered_map<uint64_t, std::shared_ptr<GEdge>> edges;
-  std::unordered_map<uint64_t, std::vector<uint64_t>> outEdges;
-  std::unordered_map<uint64_t, std::vector<uint64_t>> inEdges;
-};
-
-/**
- * @class EntityRegistry
- * @brief Manages unique node resolution (Record Linkage).
- */
-class EntityRegistry {
-public:
-  uint64_t resolveNode(const std::string &label,
-                       const std::string &canonicalName, GraphEngine &engine) {
-    std::string key = label + "::" + canonicalName;
-    if (registry.count(key))
-      return registry[key];
-
-    uint64_t newId = ++nextId;
-    auto newNode = std::make_shared<GNode>(newId, label);
-    newNode->setProperty("canonical_name", canonicalName);
-    engine.addNode(newNode);
-    registry[key] = newId;
-    return newId;
-  }
-
-private:
-  uint64_t nextId = 0;
-  std::unordered_map<std::string, uint64_t> registry;
-};
+#include <random>
+#include <sstream>
+#include <tuple>
 
 int main() {
   GraphEngine engine;
@@ -178,8 +33,8 @@ int main() {
       registry.resolveNode("PROTOCOL_EVENT", "BGP_SESSION_RESET", engine);
 
   // Link them
-  engine.addEdge(std::make_shared<GEdge>(1, linkId, intfId, "CAUSES"));
-  engine.addEdge(std::make_shared<GEdge>(2, intfId, bgpId, "CAUSES"));
+  engine.addEdge(1, linkId, intfId, "CAUSES");
+  engine.addEdge(2, intfId, bgpId, "CAUSES");
 
   std::cout << "Graph built with 2-hop causal chain.\n" << std::endl;
 
@@ -193,10 +48,8 @@ int main() {
   if (!path.empty()) {
     std::cout << "Path Found (Reasoning Chain):" << std::endl;
     for (size_t i = 0; i < path.size(); ++i) {
-      auto node = engine.getNode(path[i]);
-      std::cout << "  Step " << i + 1 << ": [" << node->label << "] "
-                << std::get<std::string>(node->properties["canonical_name"])
-                << std::endl;
+      std::cout << "  Step " << i + 1 << ": [" << engine.labelOf(path[i])
+                << "] " << engine.canonicalNameOf(path[i]) << std::endl;
       if (i < path.size() - 1)
         std::cout << "      | (CAUSES) -> " << std::endl;
     }
@@ -215,8 +68,8 @@ int main() {
                                            "HIGH_TCP_RETRANSMISSIONS", engine);
 
   // Link them (Edges 3 and 4)
-  engine.addEdge(std::make_shared<GEdge>(3, mtuId, pmtuId, "CAUSES"));
-  engine.addEdge(std::make_shared<GEdge>(4, pmtuId, tcpRetId, "CAUSES"));
+  engine.addEdge(3, mtuId, pmtuId, "CAUSES");
+  engine.addEdge(4, pmtuId, tcpRetId, "CAUSES");
 
   std::cout << "Query: Find RCA for HIGH_TCP_RETRANSMISSIONS..." << std::endl;
   std::vector<uint64_t> rcaPath = engine.findPath(mtuId, tcpRetId);
@@ -224,12 +77,540 @@ int main() {
   if (!rcaPath.empty()) {
     std::cout << "Path Found (Reasoning Chain):" << std::endl;
     for (size_t i = 0; i < rcaPath.size(); ++i) {
-      auto node = engine.getNode(rcaPath[i]);
-      std::cout << "  Step " << i + 1 << ": [" << node->label << "] "
-                << std::get<std::string>(node->properties["canonical_name"])
-                << std::endl;
+      std::cout << "  Step " << i + 1 << ": [" << engine.labelOf(rcaPath[i])
+                << "] " << engine.canonicalNameOf(rcaPath[i]) << std::endl;
+    }
+  }
+
+  std::cout << "\n--- Scenario 3: Alarm Storm (Batch Explanation) ---"
+            << std::endl;
+  // Every symptom is explained by whichever candidate cause reaches it first.
+  std::vector<uint64_t> candidateCauses = {linkId, mtuId};
+  std::vector<uint64_t> symptoms = {bgpId, tcpRetId, intfId};
+  for (const auto &chain :
+       engine.explainSymptoms(candidateCauses, symptoms)) {
+    std::cout << "Symptom " << engine.canonicalNameOf(chain.symptomId)
+              << " <- Root Cause "
+              << (chain.path.empty()
+                      ? std::string_view("UNEXPLAINED")
+                      : engine.canonicalNameOf(chain.rootCauseId))
+              << " (" << chain.path.size() << " nodes)" << std::endl;
+  }
+
+  std::cout << "\n--- Scenario 4: Ranking Competing Causal Chains ---"
+            << std::endl;
+  // A weaker, blog-sourced shortcut competes with the RFC-backed chain.
+  uint64_t blogId =
+      registry.resolveNode("FORUM_CLAIM", "MTU_BLACKHOLE_THEORY", engine);
+  engine.setNodeProperty(mtuId, GraphEngine::AUTHORITY_SCORE, 1.0);
+  engine.setNodeProperty(blogId, GraphEngine::AUTHORITY_SCORE, 0.3);
+  engine.setEdgeProperty(3, GraphEngine::CONFIDENCE, 0.9);
+  engine.setEdgeProperty(4, GraphEngine::CONFIDENCE, 0.95);
+  engine.addEdge(5, mtuId, blogId, "CAUSES", 0.9f);
+  engine.addEdge(6, blogId, tcpRetId, "CAUSES", 0.8f);
+  engine.addEdge(7, mtuId, tcpRetId, "CORRELATES_WITH", 0.99f);
+
+  auto ranked = engine.rankCausalPaths(mtuId, tcpRetId, 3, {"CAUSES"});
+  for (size_t r = 0; r < ranked.size(); ++r) {
+    std::cout << "  #" << r + 1 << " (credibility " << ranked[r].credibility
+              << "): ";
+    for (size_t i = 0; i < ranked[r].nodeIds.size(); ++i)
+      std::cout << (i ? " -> " : "")
+                << engine.canonicalNameOf(ranked[r].nodeIds[i]);
+    std::cout << std::endl;
+  }
+
+  std::cout << "\n--- Scenario 5: Queries Pinned While Ingestion Continues ---"
+            << std::endl;
+  ConcurrentGraph live;
+  uint64_t flapId = live.resolveNode("INTERFACE_STATE", "LINK_FLAP");
+  uint64_t ospfId = live.resolveNode("PROTOCOL_EVENT", "OSPF_ADJ_DOWN");
+  live.addEdge(1, flapId, ospfId, "CAUSES", 0.9f);
+  live.publish();
+
+  auto pinned = live.pin(); // Readers never block on the writer below
+  uint64_t spfId = live.resolveNode("PROTOCOL_EVENT", "SPF_RECALCULATION");
+  live.addEdge(2, ospfId, spfId, "CAUSES", 0.8f);
+  live.publish();
+  auto fresh = live.pin();
+  std::cout << "Snapshot v" << pinned.version() << " path length: "
+            << pinned.findPath(flapId, spfId).size() << " | Snapshot v"
+            << fresh.version()
+            << " path length: " << fresh.findPath(flapId, spfId).size()
+            << std::endl;
+
+  std::cout << "\n--- Scenario 6: Cold Start From a Mapped Graph File ---"
+            << std::endl;
+  // A restarted query node maps the image instead of replaying ingestion.
+  const std::string imagePath = "rca_graph.kgimg";
+  std::string error;
+  if (!GraphFile::write(engine, imagePath, &error)) {
+    std::cout << "Write failed: " << error << std::endl;
+  } else if (auto mapped = MappedGraph::open(imagePath, &error)) {
+    auto cause = mapped->resolve("CONFIG_ERROR", "MTU_MISMATCH_ON_TRUNK");
+    auto symptom =
+        mapped->resolve("SAMPLED_METRIC", "HIGH_TCP_RETRANSMISSIONS");
+    std::cout << "Mapped " << mapped->mappedBytes() << " bytes, "
+              << mapped->nodeCount() << " nodes" << std::endl;
+    if (cause && symptom) {
+      auto best = mapped->rankCausalPaths(*cause, *symptom, 1, {"CAUSES"});
+      for (const auto &chain : best) {
+        std::cout << "  Best chain (credibility " << chain.credibility
+                  << "): ";
+        for (size_t i = 0; i < chain.nodeIds.size(); ++i)
+          std::cout << (i ? " -> " : "")
+                    << mapped->canonicalNameOf(chain.nodeIds[i]);
+        std::cout << std::endl;
+      }
+    }
+  } else {
+    std::cout << "Open failed: " << error << std::endl;
+  }
+  std::remove(imagePath.c_str());
+
+  std::cout << "\n--- Scenario 7: Loading Enriched Chunks Without Parsing ---"
+            << std::endl;
+  // The preprocessing side writes typed records; the graph maps them.
+  MetadataEnricher enricher;
+  EnrichedChunkFile::Writer chunkWriter(enricher);
+  std::string rfcText = "A BGP speaker MUST NOT advertise a route with MED.";
+  std::string blogText = "Just set the BGP hold timer to 3s, works great!";
+  chunkWriter.add(rfcText, "IETF-RFC-4271.txt");
+  chunkWriter.add(std::string_view(rfcText).substr(0, 13),
+                  "IETF-RFC-4271.txt");
+  chunkWriter.add(blogText, "FastBGP-Blog-Post.html");
+  const std::string chunkPath = "rca_chunks.bin";
+  if (!chunkWriter.write(chunkPath, &error)) {
+    std::cout << "Write failed: " << error << std::endl;
+  } else if (auto chunks = MappedChunks::open(chunkPath, &error)) {
+    auto loaded = ChunkLoader::load(*chunks, engine, registry, 100);
+    for (size_t i = 0; i < chunks->size(); ++i) {
+      const auto &src = chunks->sourceOf(i);
+      std::cout << "  " << engine.canonicalNameOf(loaded.chunkNodes[i])
+                << " (" << enricher.typeToString(src.type) << ", authority "
+                << src.authority << ", tags 0x" << std::hex << src.tags
+                << std::dec << "): \"" << chunks->text(i) << '"' << std::endl;
+    }
+  } else {
+    std::cout << "Open failed: " << error << std::endl;
+  }
+  std::remove(chunkPath.c_str());
+
+  std::cout << "\n--- Scenario 8: Runbooks Re-Asking the Same Pairs ---"
+            << std::endl;
+  // Hot (cause, symptom) pairs are queried over and over while ingestion
+  // keeps publishing small batches of edges elsewhere in the graph.
+  ConcurrentGraph outage;
+  std::mt19937_64 gen(8);
+  std::vector<uint64_t> nodes;
+  for (int i = 0; i < 20000; ++i)
+    nodes.push_back(outage.resolveNode("EVENT", "E" + std::to_string(i)));
+  uint64_t edgeId = 0;
+  auto randomEdge = [&] {
+    size_t a = gen() % nodes.size(), b = gen() % nodes.size();
+    if (a > b)
+      std::swap(a, b); // Keep the causal graph acyclic
+    if (a != b)
+      outage.addEdge(++edgeId, nodes[a], nodes[b], "CAUSES",
+                     0.5f + (gen() % 500) / 1000.0f);
+  };
+  for (int i = 0; i < 60000; ++i)
+    randomEdge();
+  outage.publish();
+  std::vector<std::pair<uint64_t, uint64_t>> hot;
+  for (int i = 0; i < 200; ++i)
+    hot.push_back({nodes[gen() % 2000], nodes[18000 + gen() % 2000]});
+
+  PathCache::Options flushAll;
+  flushAll.maxChanges = 0; // Baseline: any publish empties the cache
+  PathCache cache(outage), flushing(outage, flushAll);
+  size_t mismatches = 0;
+  double cachedMs = 0, directMs = 0;
+  auto msSince = [](std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - t)
+        .count();
+  };
+  for (int round = 0; round < 20; ++round) {
+    auto view = outage.pin();
+    for (int q = 0; q < 2000; ++q) {
+      auto [cause, symptom] = hot[std::min(gen() % hot.size(),
+                                           gen() % hot.size())];
+      auto t = std::chrono::steady_clock::now();
+      auto chains = cache.rankCausalPaths(view, cause, symptom, 3);
+      auto path = cache.findPath(view, cause, symptom);
+      cachedMs += msSince(t);
+      flushing.rankCausalPaths(view, cause, symptom, 3);
+      t = std::chrono::steady_clock::now();
+      auto fresh = view.rankCausalPaths(cause, symptom, 3);
+      auto freshPath = view.findPath(cause, symptom);
+      directMs += msSince(t);
+      bool same = path == freshPath && chains.size() == fresh.size();
+      for (size_t i = 0; same && i < chains.size(); ++i)
+        same = chains[i].nodeIds == fresh[i].nodeIds;
+      mismatches += !same;
+    }
+    for (int i = 0; i < 5; ++i)
+      randomEdge();
+    outage.publish();
+  }
+  auto stats = cache.stats();
+  std::cout << "Selective: hit rate " << stats.hitRate() * 100 << "%, "
+            << stats.invalidated << " entries invalidated, " << mismatches
+            << " answers differing from an uncached query" << std::endl;
+  std::cout << "Flush on publish: hit rate "
+            << flushing.stats().hitRate() * 100 << "%" << std::endl;
+  std::cout << "Query time: " << cachedMs << " ms cached vs " << directMs
+            << " ms uncached" << std::endl;
+
+  std::cout << "\n--- Scenario 9: \"Could X Cause Y?\" Without a Traversal ---"
+            << std::endl;
+  // A mostly downstream causal graph with a few feedback loops; most
+  // candidate causes cannot reach a given symptom.
+  GraphEngine causal;
+  const uint64_t causalNodes = 100000;
+  for (uint64_t i = 1; i <= causalNodes; ++i)
+    causal.addNode(i, "EVENT");
+  uint64_t causalEdge = 0;
+  for (uint64_t i = 0; i < 3 * causalNodes; ++i) {
+    uint64_t a = 1 + gen() % causalNodes, b = 1 + gen() % causalNodes;
+    if (a > b && gen() % 100 != 0)
+      std::swap(a, b);
+    causal.addEdge(++causalEdge, a, b, "CAUSES", 0.9f);
+  }
+  auto t = std::chrono::steady_clock::now();
+  causal.buildReachabilityIndex({"CAUSES"});
+  std::cout << "Index built in " << msSince(t) << " ms ("
+            << causal.reachability()->componentCount() << " components)"
+            << std::endl;
+  std::vector<std::pair<uint64_t, uint64_t>> pairs;
+  for (int i = 0; i < 2000; ++i)
+    pairs.push_back({1 + gen() % causalNodes, 1 + gen() % causalNodes});
+  size_t possible = 0, agree = 0;
+  t = std::chrono::steady_clock::now();
+  for (const auto &[cause, symptom] : pairs)
+    possible += causal.canCause(cause, symptom);
+  double indexedMs = msSince(t);
+  t = std::chrono::steady_clock::now();
+  for (const auto &[cause, symptom] : pairs) {
+    auto g = causal.snapshot();
+    PathSearch bfs;
+    agree += bfs.bidirectional(*g, g->indexOfNode(cause),
+                               g->indexOfNode(symptom))
+                 .empty() != causal.canCause(cause, symptom);
+  }
+  double bfsMs = msSince(t);
+  std::cout << possible << " of " << pairs.size() << " pairs possible, "
+            << agree << " agreeing with BFS | " << indexedMs * 1000 / 2000
+            << " us per index query vs " << bfsMs * 1000 / 2000
+            << " us per BFS" << std::endl;
+  auto [far, near] = pairs[0];
+  for (const auto &pair : pairs)
+    if (!causal.canCause(pair.first, pair.second)) {
+      std::tie(far, near) = pair;
+      break;
     }
+  causal.addEdge(++causalEdge, far, near, "CAUSES", 0.9f); // Incremental
+  std::cout << "After inserting " << far << " -> " << near
+            << ": canCause = " << causal.canCause(far, near)
+            << ", within 1 hop = " << causal.canCauseWithin(far, near, 1)
+            << ", pending overlay edges = "
+            << causal.reachability()->pendingEdges() << std::endl;
+
+  // A shortcut between connected nodes needs no overlay entry but still
+  // invalidates the landmark lower bounds.
+  GraphEngine shortcut;
+  for (uint64_t i = 0; i < 120; ++i)
+    if (i <= 10 || i >= 100)
+      shortcut.addNode(i, "EVENT");
+  for (uint64_t i = 0; i < 10; ++i)
+    shortcut.addEdge(i + 1, i, i + 1, "CAUSES", 0.9f);
+  for (uint64_t i = 100; i < 120; ++i) // Hub: node 0 becomes a landmark
+    shortcut.addEdge(i, 0, i, "CAUSES", 0.9f);
+  shortcut.buildReachabilityIndex({"CAUSES"});
+  shortcut.addEdge(200, 1, 10, "CAUSES", 0.9f);
+  const bool direct = shortcut.canCauseWithin(1, 10, 1);
+  std::cout << "After shortcut 1 -> 10 on a 10-hop chain: within 1 hop = "
+            << direct << std::endl;
+  if (!direct || shortcut.findPath(1, 10).size() != 2)
+    return 1;
+
+  std::cout << "\n--- Scenario 10: Bulk Loading Extracted Triples ---"
+            << std::endl;
+  // One million (interface, CAUSES, error code) triples over 200k
+  // entities, so every entity is mentioned about ten times.
+  const size_t triples = 1000000, entities = 200000;
+  std::vector<std::tuple<std::string, std::string, float>> extracted;
+  extracted.reserve(triples);
+  for (size_t i = 0; i < triples; ++i)
+    extracted.emplace_back(
+        "GigabitEthernet0/" + std::to_string(gen() % (entities / 2)),
+        "%ERR-" + std::to_string(gen() % (entities / 2)),
+        0.5f + (gen() % 500) / 1000.0f);
+
+  t = std::chrono::steady_clock::now();
+  GraphEngine perEntity;
+  EntityRegistry tripleRegistry;
+  uint64_t tripleEdge = 0;
+  for (const auto &[src, tgt, confidence] : extracted)
+    perEntity.addEdge(++tripleEdge,
+                      tripleRegistry.resolveNode("INTERFACE", src, perEntity),
+                      tripleRegistry.resolveNode("ERROR_CODE", tgt, perEntity),
+                      "CAUSES", confidence);
+  perEntity.snapshot();
+  double perEntityMs = msSince(t);
+
+  t = std::chrono::steady_clock::now();
+  BulkLoader loader;
+  uint32_t ifLabel = loader.labelId("INTERFACE");
+  uint32_t errLabel = loader.labelId("ERROR_CODE");
+  uint32_t causesLabel = loader.labelId("CAUSES");
+  BulkLoader::NodeBatch mentions;
+  BulkLoader::EdgeBatch relations;
+  for (const auto &[src, tgt, confidence] : extracted) {
+    relations.add(mentions.size(), mentions.size() + 1, causesLabel,
+                  confidence);
+    mentions.add(ifLabel, src);
+    mentions.add(errLabel, tgt);
+  }
+  loader.addNodes(mentions);
+  loader.addEdges(relations);
+  GraphEngine bulk;
+  std::string loadError;
+  if (!loader.load(bulk, &loadError))
+    std::cout << "Bulk load failed: " << loadError << std::endl;
+  double bulkMs = msSince(t);
+  const BulkLoader::Stats &load = loader.lastStats();
+  std::cout << load.mentions << " mentions -> " << load.nodes << " nodes, "
+            << load.edges << " edges (dedupe " << load.dedupeSeconds * 1000
+            << " ms, columns " << load.columnSeconds * 1000 << " ms, CSR "
+            << load.csrSeconds * 1000 << " ms)" << std::endl;
+  std::cout << "Bulk: " << triples / (bulkMs / 1000) << " triples/s vs "
+            << triples / (perEntityMs / 1000) << " triples/s per entity ("
+            << perEntity.snapshot()->nodeCount() << " nodes)" << std::endl;
+  if (auto id = loader.find("INTERFACE", "GigabitEthernet0/42")) {
+    auto g = bulk.snapshot();
+    uint32_t idx = g->indexOfNode(*id);
+    std::cout << "GigabitEthernet0/42 is node " << *id << " with "
+              << g->outEnd(idx) - g->outBegin(idx) << " CAUSES edges"
+              << std::endl;
+  }
+
+  // The loader must build what addNode/addEdge build. Checked on a small
+  // graph of one entity type, where chains are long enough to search.
+  BulkLoader sliceLoader;
+  const uint32_t eventLabel = sliceLoader.labelId("EVENT");
+  const uint32_t sliceCauses = sliceLoader.labelId("CAUSES");
+  BulkLoader::NodeBatch sliceMentions;
+  BulkLoader::EdgeBatch sliceRelations;
+  std::vector<std::pair<std::string, std::string>> sliceTriples;
+  for (size_t i = 0; i < 6000; ++i) {
+    sliceTriples.emplace_back("EVT-" + std::to_string(gen() % 2000),
+                              "EVT-" + std::to_string(gen() % 2000));
+    sliceRelations.add(2 * i, 2 * i + 1, sliceCauses, 0.9f);
+    sliceMentions.add(eventLabel, sliceTriples.back().first);
+    sliceMentions.add(eventLabel, sliceTriples.back().second);
+  }
+  sliceLoader.addNodes(sliceMentions);
+  sliceLoader.addEdges(sliceRelations);
+  GraphEngine sliceBulk, sliceIncremental;
+  bool equivalent = sliceLoader.load(sliceBulk, &loadError);
+  // Nodes in ID order, then edges in input order, as the loader numbers
+  // them; search tie-breaks follow insertion order.
+  std::vector<std::string> sliceNames(sliceBulk.nodeCount() + 1);
+  for (size_t i = 0; i < sliceTriples.size(); ++i) {
+    sliceNames[sliceLoader.nodeIdOfRow(2 * i)] = sliceTriples[i].first;
+    sliceNames[sliceLoader.nodeIdOfRow(2 * i + 1)] = sliceTriples[i].second;
+  }
+  for (uint64_t id = 1; id < sliceNames.size(); ++id) {
+    sliceIncremental.addNode(id, "EVENT");
+    sliceIncremental.setNodeProperty(id, GraphEngine::CANONICAL_NAME,
+                                     sliceNames[id]);
   }
+  for (size_t i = 0; i < sliceTriples.size(); ++i)
+    sliceIncremental.addEdge(i + 1, sliceLoader.nodeIdOfRow(2 * i),
+                             sliceLoader.nodeIdOfRow(2 * i + 1), "CAUSES",
+                             0.9f);
+  equivalent = equivalent &&
+               sliceBulk.nodeCount() == sliceIncremental.nodeCount() &&
+               sliceBulk.edgeCount() == sliceIncremental.edgeCount();
+  for (uint64_t id = 1; equivalent && id <= sliceBulk.nodeCount(); ++id)
+    equivalent = sliceBulk.canonicalNameOf(id) ==
+                 sliceIncremental.canonicalNameOf(id);
+  size_t slicePaths = 0;
+  for (int q = 0; equivalent && q < 500; ++q) {
+    const uint64_t a = 1 + gen() % sliceBulk.nodeCount();
+    const uint64_t b = 1 + gen() % sliceBulk.nodeCount();
+    const std::vector<uint64_t> path = sliceBulk.findPath(a, b);
+    equivalent = path == sliceIncremental.findPath(a, b);
+    slicePaths += !path.empty();
+  }
+  std::cout << "Bulk vs addNode/addEdge on " << sliceTriples.size()
+            << " triples: " << (equivalent ? "same" : "DIFFERENT")
+            << " nodes, edges, names and paths (" << slicePaths
+            << " of 500 paths found)" << std::endl;
+  if (!equivalent)
+    return 1;
+
+  // A registry used after the load must know the loaded nodes.
+  EntityRegistry seeded;
+  loader.seedRegistry(seeded);
+  const uint64_t known =
+      seeded.resolveNode("INTERFACE", "GigabitEthernet0/42", bulk);
+  const uint64_t unseen =
+      seeded.resolveNode("INTERFACE", "GigabitEthernet9/9", bulk);
+  std::cout << "Seeded registry: known interface is node " << known
+            << ", a new one gets node " << unseen << std::endl;
+  if (known != loader.find("INTERFACE", "GigabitEthernet0/42") ||
+      unseen != load.nodes + 1)
+    return 1;
+
+  std::cout << "\n--- Scenario 11: Where Path Queries Spend Their Time ---"
+            << std::endl;
+  // The Scenario 9 pairs again through findPath, which records its work
+  // when built with RCA_INSTRUMENTATION (the default).
+  Instrumentation::Snapshot before = Instrumentation::snapshot();
+  Instrumentation::startTrace();
+  size_t found = 0;
+  for (const auto &[cause, symptom] : pairs)
+    found += !causal.findPath(cause, symptom).empty();
+  Instrumentation::stopTrace();
+  Instrumentation::Snapshot work = Instrumentation::snapshot().since(before);
+  LatencyHistogram expanded = work.distribution(
+      Instrumentation::Distribution::FIND_PATH_EXPANDED_PER_QUERY);
+  LatencyHistogram frontier = work.distribution(
+      Instrumentation::Distribution::FIND_PATH_PEAK_FRONTIER);
+  std::cout << work.count(Instrumentation::Counter::FIND_PATH_QUERIES)
+            << " queries (" << found << " paths), " << expanded.count()
+            << " searched past the index, "
+            << work.count(Instrumentation::Counter::FIND_PATH_NODES_EXPANDED)
+            << " nodes expanded" << std::endl;
+  std::cout << "Expanded per search: p50 " << expanded.percentileNs(0.50)
+            << ", p99 " << expanded.percentileNs(0.99) << ", max "
+            << expanded.maxNs() << " | widest frontier " << frontier.maxNs()
+            << std::endl;
+  std::ostringstream trace;
+  Instrumentation::writeChromeTrace(trace);
+  std::cout << "Chrome trace: " << trace.str().size() << " bytes, "
+            << Instrumentation::droppedSpans() << " spans dropped"
+            << std::endl;
+
+  std::cout << "\n--- Scenario 12: Re-ingesting a Few Changed Chunks ---"
+            << std::endl;
+  // 50k chunks of four facts each; the nightly run re-extracts 200 of them,
+  // each with one fact changed. Both engines end up with the same edges,
+  // but only `nightly` had a snapshot before the delta.
+  const size_t chunkCount = 50000;
+  auto factsOf = [&](size_t chunk, size_t revision) {
+    std::vector<IncrementalLoader::Fact> facts;
+    std::mt19937_64 local(chunk * 31 + revision);
+    for (int f = 0; f < 4; ++f)
+      facts.push_back({"INTERFACE",
+                       "GigabitEthernet0/" + std::to_string(local() % 20000),
+                       "CAUSES", "ERROR_CODE",
+                       "%ERR-" + std::to_string(local() % 20000),
+                       f == 0 && revision ? 0.4f : 0.8f});
+    return facts;
+  };
+  GraphEngine nightly, replayed;
+  EntityRegistry nightlyRegistry, replayedRegistry;
+  IncrementalLoader nightlyLoader(1), replayedLoader(1);
+  for (size_t c = 0; c < chunkCount; ++c) {
+    const std::string doc = "chunk-" + std::to_string(c);
+    nightlyLoader.upsertChunk(doc, factsOf(c, 0), nightly, nightlyRegistry);
+    replayedLoader.upsertChunk(doc, factsOf(c, 0), replayed, replayedRegistry);
+  }
+  t = std::chrono::steady_clock::now();
+  nightly.snapshot();
+  double fullMs = msSince(t);
+  nightlyLoader.take();
+  for (size_t i = 0; i < 200; ++i) {
+    const size_t c = (i * 7919) % chunkCount;
+    const std::string doc = "chunk-" + std::to_string(c);
+    std::vector<IncrementalLoader::Fact> facts = factsOf(c, 0);
+    facts[3] = factsOf(c, 1)[3];
+    nightlyLoader.upsertChunk(doc, facts, nightly, nightlyRegistry);
+    replayedLoader.upsertChunk(doc, facts, replayed, replayedRegistry);
+  }
+  IncrementalLoader::Delta delta = nightlyLoader.take();
+  t = std::chrono::steady_clock::now();
+  auto patched = nightly.snapshot();
+  double patchMs = msSince(t);
+  auto rebuilt = replayed.snapshot();
+  const CsrGraph::Arrays &pa = patched->arrays(), &ra = rebuilt->arrays();
+  bool same = std::equal(pa.neighbors.begin(), pa.neighbors.end(),
+                         ra.neighbors.begin(), ra.neighbors.end()) &&
+              std::equal(pa.inEdgePos.begin(), pa.inEdgePos.end(),
+                         ra.inEdgePos.begin(), ra.inEdgePos.end());
+  std::cout << delta.edgesAdded << " edges added, " << delta.edgesRemoved
+            << " removed, " << delta.nodesAdded << " new nodes, "
+            << delta.touchedNodes.size() << " nodes touched" << std::endl;
+  std::cout << "Snapshot of " << patched->edgeCount() << " edges: patched in "
+            << patchMs << " ms vs " << fullMs << " ms built from scratch ("
+            << (same ? "identical" : "DIFFERENT") << " to a replay)"
+            << std::endl;
+
+  std::cout << "\n--- Scenario 13: Label-Filtered and Depth-Bounded Queries ---"
+            << std::endl;
+  // Three relation types over 100k events. Baseline: the same traversal
+  // kernel with the label compared as a string behind a std::function, as
+  // a hand-written variant of findPath would do per edge.
+  GraphEngine typed;
+  const char *kinds[] = {"CAUSES", "PRECEDES", "CORRELATES_WITH"};
+  for (uint64_t i = 1; i <= causalNodes; ++i)
+    typed.addNode(i, "EVENT");
+  for (uint64_t i = 0; i < 6 * causalNodes; ++i) { // Mostly to later events
+    uint64_t a = 1 + gen() % causalNodes;
+    uint64_t b = std::min(causalNodes, a + 1 + gen() % 100);
+    typed.addEdge(i + 1, a, b, kinds[gen() % 3]);
+  }
+  auto typedGraph = typed.snapshot();
+  const std::string wanted = "CAUSES";
+  std::function<bool(uint64_t)> byName = [&](uint64_t pos) {
+    return typedGraph->labelName(typedGraph->edgeLabelAt(pos)) == wanted;
+  };
+  Traversal generic;
+  auto stringBfs = [&](uint64_t from, uint64_t to) {
+    return generic
+        .shortestPath(*typedGraph, typedGraph->indexOfNode(from),
+                      typedGraph->indexOfNode(to), byName)
+        .size();
+  };
+  std::vector<std::pair<uint64_t, uint64_t>> typedPairs;
+  for (int i = 0; i < 500; ++i) {
+    uint64_t a = 1 + gen() % (causalNodes / 2);
+    typedPairs.push_back({a, a + gen() % 1000});
+  }
+  size_t matches = 0, bounded = 0;
+  t = std::chrono::steady_clock::now();
+  for (const auto &[cause, symptom] : typedPairs)
+    matches += stringBfs(cause, symptom);
+  double stringMs = msSince(t);
+  t = std::chrono::steady_clock::now();
+  for (const auto &[cause, symptom] : typedPairs)
+    matches -= typed.findPath(cause, symptom, {"CAUSES"}).size();
+  double maskMs = msSince(t);
+  t = std::chrono::steady_clock::now();
+  for (const auto &[cause, symptom] : typedPairs)
+    bounded += !typed.findPath(cause, symptom, {"CAUSES", "PRECEDES"}, 6)
+                    .empty();
+  double boundedMs = msSince(t);
+  std::cout << "Only CAUSES: " << stringMs * 1000 / typedPairs.size()
+            << " us per string-compare BFS vs "
+            << maskMs * 1000 / typedPairs.size() << " us per findPath ("
+            << (matches == 0 ? "same" : "DIFFERENT") << " path lengths)"
+            << std::endl;
+  std::cout << "CAUSES or PRECEDES within 6 hops: " << bounded << " of "
+            << typedPairs.size() << " pairs, "
+            << boundedMs * 1000 / typedPairs.size() << " us per query"
+            << std::endl;
+  const uint64_t sink = causalNodes - 10;
+  t = std::chrono::steady_clock::now();
+  std::vector<uint64_t> causes = typed.ancestors(sink, {"CAUSES"});
+  std::vector<uint64_t> nearby = typed.ancestors(sink, {"CAUSES"}, 3);
+  std::cout << "Ancestors of " << sink << " over CAUSES: " << causes.size()
+            << " (" << nearby.size() << " within 3 hops) in " << msSince(t)
+            << " ms" << std::endl;
 
   engine.debugPrint();
   return 0;
@@ -0,0 +1,987 @@
+#pragma once
+
+#include "../data-preprocessing/Instrumentation.hpp"
+#include "CsrGraph.hpp"
+#include "IdIndex.hpp"
+#include "PathSearch.hpp"
+#include "RankedPathSearch.hpp"
+#include "ReachabilityIndex.hpp"
+#include "StringPool.hpp"
+#include "Traversal.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+/**
+ * @typedef PropertyValue
+ * @brief Supports multiple types for node/edge properties.
+ */
+using PropertyValue = std::variant<std::string, int, double, bool>;
+
+/**
+ * @class GNode
+ * @brief Represents a vertex in the Knowledge Graph.
+ *
+ * Detached value object used for ingestion and inspection. GraphEngine
+ * decomposes it into columns on addNode and materializes it on getNode.
+ */
+class GNode {
+public:
+  uint64_t id;
+  std::string label;
+  std::unordered_map<std::string, PropertyValue> properties;
+
+  GNode(uint64_t id, const std::string &label) : id(id), label(label) {}
+
+  void setProperty(const std::string &key, PropertyValue value) {
+    properties[key] = value;
+  }
+};
+
+/**
+ * @class GEdge
+ * @brief Represents a directed relationship between two GNodes.
+ */
+class GEdge {
+public:
+  uint64_t id;
+  uint64_t sourceId;
+  uint64_t targetId;
+  std::string label;
+  std::unordered_map<std::string, PropertyValue> properties;
+
+  GEdge(uint64_t id, uint64_t src, uint64_t tgt, const std::string &lbl)
+      : id(id), sourceId(src), targetId(tgt), label(lbl) {}
+
+  void setProperty(const std::string &key, PropertyValue value) {
+    properties[key] = value;
+  }
+};
+
+/**
+ * @class GraphEngine
+ * @brief The core storage and management unit for the Knowledge Graph.
+ *
+ * STORAGE LAYOUT (columnar):
+ * - Node and edge records live in contiguous vectors addressed by dense
+ *   index; external IDs are resolved once through an IdIndex.
+ * - Labels and property keys are interned to uint32_t IDs.
+ * - Hot properties have typed columns: canonical_name (StringArena),
+ *   authority_score and stability_score (float) on nodes, confidence (float)
+ *   on edges. Unset floats are NaN.
+ * - Derived per-node results (community IDs) are installed as whole dense
+ *   uint32 columns by setNodeColumn.
+ * - Removed edges leave tombstones in the edge columns, compacted once
+ *   they make up half of them.
+ * - Everything else falls back to a sparse (index, key) -> PropertyValue map,
+ *   so an entity with only a canonical_name pays nothing for it.
+ *
+ * A node record costs ~24 bytes plus its name bytes, versus several hundred
+ * bytes for a shared_ptr<GNode> with its own std::string and property map.
+ */
+class GraphEngine {
+public:
+  static constexpr const char *CANONICAL_NAME = "canonical_name";
+  static constexpr const char *AUTHORITY_SCORE = "authority_score";
+  static constexpr const char *STABILITY_SCORE = "stability_score";
+  static constexpr const char *CONFIDENCE = "confidence";
+
+  // Unset entry of a dense node column (see setNodeColumn).
+  static constexpr uint32_t NO_VALUE = std::numeric_limits<uint32_t>::max();
+
+  // Added to every edge cost so that, among equally credible chains, the
+  // one with fewer hops ranks first.
+  static constexpr float HOP_PENALTY = 1e-3f;
+
+  GraphEngine() {
+    // Label 0 marks nodes that were only referenced as edge endpoints.
+    labelPool.intern("");
+  }
+
+  /**
+   * @brief Inserts (or relabels) a node without allocating a GNode.
+   * @return The node's dense index.
+   */
+  uint32_t addNode(uint64_t id, std::string_view label) {
+    uint32_t idx = ensureNode(id);
+    if (nodeLabel[idx] == UNDECLARED)
+      declaredNodes++;
+    nodeLabel[idx] = labelPool.intern(label);
+    csrDirty = true;
+    return idx;
+  }
+
+  /**
+   * @brief Compatibility path: decomposes a GNode into the columns.
+   */
+  void addNode(std::shared_ptr<GNode> node) {
+    addNode(node->id, node->label);
+    for (const auto &[key, value] : node->properties)
+      setNodeProperty(node->id, key, value);
+  }
+
+  /**
+   * @brief Inserts (or replaces) a directed edge.
+   * @param confidence Extraction confidence; NaN when unknown.
+   */
+  void addEdge(uint64_t id, uint64_t src, uint64_t tgt, std::string_view label,
+               float confidence = std::nanf("")) {
+    EdgeRecord rec{id, ensureNode(src), ensureNode(tgt),
+                   labelPool.intern(label)};
+    uint32_t existing = edgeIndex.find(id);
+    if (existing != IdIndex::NONE) {
+      const EdgeRecord &old = edgeRecords[existing];
+      if (old.src != rec.src || old.tgt != rec.tgt || old.label != rec.label)
+        reachStale = true; // The index cannot forget edges
+      markDirty(old.src, existing);
+      edgeRecords[existing] = rec;
+      edgeConfidence[existing] = confidence;
+    } else {
+      existing = static_cast<uint32_t>(edgeRecords.size());
+      edgeIndex.set(id, existing);
+      edgeRecords.push_back(rec);
+      edgeConfidence.push_back(confidence);
+      if (reach && !reachStale)
+        reach->insertEdge(rec.src, rec.tgt, label);
+    }
+    markDirty(rec.src, existing);
+    csrDirty = true;
+  }
+
+  /**
+   * @brief Deletes an edge and its properties.
+   * @return false if there is no edge with this ID.
+   */
+  bool removeEdge(uint64_t id) {
+    uint32_t idx = edgeIndex.find(id);
+    if (idx == IdIndex::NONE)
+      return false;
+    markDirty(edgeRecords[idx].src, idx);
+    edgeRecords[idx].label = REMOVED; // Tombstone until compactEdges()
+    edgeIndex.erase(id);
+    removedEdges++;
+    reachStale = true;
+    csrDirty = true;
+    if (removedEdges > 1024 && 2 * removedEdges > edgeRecords.size())
+      compactEdges();
+    return true;
+  }
+
+  /**
+   * @brief Compatibility path: decomposes a GEdge into the columns.
+   */
+  void addEdge(std::shared_ptr<GEdge> edge) {
+    addEdge(edge->id, edge->sourceId, edge->targetId, edge->label);
+    for (const auto &[key, value] : edge->properties)
+      setEdgeProperty(edge->id, key, value);
+  }
+
+  bool hasNode(uint64_t id) const {
+    uint32_t idx = nodeIndex.find(id);
+    return idx != IdIndex::NONE && nodeLabel[idx] != UNDECLARED;
+  }
+
+  void setNodeProperty(uint64_t id, const std::string &key,
+                       const PropertyValue &value) {
+    uint32_t idx = ensureNode(id);
+    if (key == CANONICAL_NAME && std::holds_alternative<std::string>(value)) {
+      nodeName[idx] =
+          namePool.replace(nodeName[idx], std::get<std::string>(value));
+      // Renames leave the old bytes behind; keep them below the live ones.
+      if (2 * namePool.garbageBytes() > namePool.usedBytes())
+        namePool.compact(nodeName);
+    } else if (key == AUTHORITY_SCORE && isNumber(value)) {
+      nodeAuthority[idx] = toFloat(value);
+      weightsDirty = true;
+    } else if (key == STABILITY_SCORE && isNumber(value)) {
+      nodeStability[idx] = toFloat(value);
+      weightsDirty = true;
+    } else if (uint32_t keyId = keyPool.find(key);
+               std::holds_alternative<int>(value) && nodeColumns.count(keyId)) {
+      std::vector<uint32_t> &column = nodeColumns[keyId];
+      if (column.size() <= idx)
+        column.resize(nodeIds.size(), NO_VALUE);
+      column[idx] = static_cast<uint32_t>(std::get<int>(value));
+    } else {
+      nodeExtra[packKey(idx, keyPool.intern(key))] = value;
+    }
+  }
+
+  /**
+   * @brief Installs a dense uint32 column under `key` (e.g. community IDs),
+   * indexed like snapshot() nodes. Replaces any previous column or sparse
+   * values of that key; NO_VALUE entries and nodes added later read as
+   * unset. getNodeProperty returns the values as int.
+   */
+  void setNodeColumn(const std::string &key, std::vector<uint32_t> values) {
+    uint32_t keyId = keyPool.intern(key);
+    for (auto it = nodeExtra.begin(); it != nodeExtra.end();)
+      it = static_cast<uint32_t>(it->first) == keyId ? nodeExtra.erase(it)
+                                                     : std::next(it);
+    values.resize(nodeIds.size(), NO_VALUE);
+    nodeColumns[keyId] = std::move(values);
+  }
+
+  /**
+   * @brief Zero-copy view of a dense column; nullptr if `key` has none.
+   * May be shorter than nodeCount() if nodes were added after it was set.
+   */
+  const std::vector<uint32_t> *nodeColumn(const std::string &key) const {
+    auto it = nodeColumns.find(keyPool.find(key));
+    return it == nodeColumns.end() ? nullptr : &it->second;
+  }
+
+  void setEdgeProperty(uint64_t id, const std::string &key,
+                       const PropertyValue &value) {
+    uint32_t idx = edgeIndex.find(id);
+    if (idx == IdIndex::NONE)
+      return;
+    if (key == CONFIDENCE && isNumber(value)) {
+      edgeConfidence[idx] = toFloat(value);
+      weightsDirty = true;
+    } else
+      edgeExtra[packKey(idx, keyPool.intern(key))] = value;
+  }
+
+  std::optional<PropertyValue> getNodeProperty(uint64_t id,
+                                               const std::string &key) const {
+    uint32_t idx = nodeIndex.find(id);
+    if (idx == IdIndex::NONE)
+      return std::nullopt;
+    if (key == CANONICAL_NAME)
+      return optionalName(nodeName[idx]);
+    if (key == AUTHORITY_SCORE)
+      return optionalFloat(nodeAuthority[idx]);
+    if (key == STABILITY_SCORE)
+      return optionalFloat(nodeStability[idx]);
+    if (const std::vector<uint32_t> *column = nodeColumn(key)) {
+      if (idx >= column->size() || (*column)[idx] == NO_VALUE)
+        return std::nullopt;
+      return PropertyValue(static_cast<int>((*column)[idx]));
+    }
+    return findExtra(nodeExtra, idx, key);
+  }
+
+  std::optional<PropertyValue> getEdgeProperty(uint64_t id,
+                                               const std::string &key) const {
+    uint32_t idx = edgeIndex.find(id);
+    if (idx == IdIndex::NONE)
+      return std::nullopt;
+    if (key == CONFIDENCE)
+      return optionalFloat(edgeConfidence[idx]);
+    return findExtra(edgeExtra, idx, key);
+  }
+
+  /**
+   * @brief Zero-copy accessors for the hot node columns.
+   */
+  std::string_view labelOf(uint64_t id) const {
+    uint32_t idx = nodeIndex.find(id);
+    return (idx != IdIndex::NONE) ? labelPool.str(nodeLabel[idx])
+                                  : std::string_view();
+  }
+
+  std::string_view canonicalNameOf(uint64_t id) const {
+    uint32_t idx = nodeIndex.find(id);
+    return (idx != IdIndex::NONE) ? namePool.view(nodeName[idx])
+                                  : std::string_view();
+  }
+
+  /**
+   * @brief Materializes a detached GNode. Slow path meant for inspection;
+   * traversals should use snapshot() and the column accessors.
+   */
+  std::shared_ptr<GNode> getNode(uint64_t id) const {
+    if (!hasNode(id))
+      return nullptr;
+    uint32_t idx = nodeIndex.find(id);
+    auto node = std::make_shared<GNode>(id, labelPool.str(nodeLabel[idx]));
+    if (nodeName[idx] != StringArena::NO_ID)
+      node->setProperty(CANONICAL_NAME,
+                        std::string(namePool.view(nodeName[idx])));
+    if (!std::isnan(nodeAuthority[idx]))
+      node->setProperty(AUTHORITY_SCORE, double(nodeAuthority[idx]));
+    if (!std::isnan(nodeStability[idx]))
+      node->setProperty(STABILITY_SCORE, double(nodeStability[idx]));
+    for (const auto &[packed, value] : nodeExtra)
+      if (static_cast<uint32_t>(packed >> 32) == idx)
+        node->setProperty(keyPool.str(static_cast<uint32_t>(packed)), value);
+    for (const auto &[keyId, column] : nodeColumns)
+      if (idx < column.size() && column[idx] != NO_VALUE)
+        node->setProperty(keyPool.str(keyId), static_cast<int>(column[idx]));
+    return node;
+  }
+
+  /**
+   * @brief Returns the frozen CSR view, updated first if the graph changed
+   * since the last call. Traversals should run against this snapshot.
+   *
+   * If at most 1/PATCH_DIVISOR of the rows have had an edge added, removed
+   * or replaced, the previous snapshot is patched (CsrGraph::patched) and
+   * edge weights are carried over for the untouched rows, so a small delta
+   * costs one sequential copy instead of a sort. Larger changes rebuild.
+   * Either way the result is the same graph.
+   */
+  std::shared_ptr<const CsrGraph> snapshot() const {
+    if (csr && !csrDirty)
+      return csr;
+    RCA_SPAN("GraphEngine::snapshot");
+    std::sort(dirtyRows.begin(), dirtyRows.end());
+    dirtyRows.erase(std::unique(dirtyRows.begin(), dirtyRows.end()),
+                    dirtyRows.end());
+    if (csr && !rebuildAll &&
+        dirtyRows.size() <= nodeIds.size() / PATCH_DIVISOR) {
+      patchSnapshot();
+    } else {
+      csr = std::make_shared<const CsrGraph>(buildCsr());
+      weightsDirty = true;
+    }
+    dirtyRows.clear();
+    dirtyRecords.clear();
+    rebuildAll = false;
+    csrDirty = false;
+    return csr;
+  }
+
+  /**
+   * @brief Performs a multi-hop traversal to find a causal path using
+   * bidirectional BFS (out-edges from startId, in-edges from endId).
+   */
+  std::vector<uint64_t> findPath(uint64_t startId, uint64_t endId) const {
+    RCA_SPAN("GraphEngine::findPath");
+    RCA_COUNT(FIND_PATH_QUERIES, 1);
+    if (!hasNode(startId) || !hasNode(endId))
+      return {};
+
+    auto g = snapshot();
+    uint32_t start = g->indexOfNode(startId), end = g->indexOfNode(endId);
+    const ReachabilityIndex *r = currentReach();
+    if (r && r->covers({}) && !r->reachable(start, end))
+      return {};
+    std::vector<uint64_t> path = search.bidirectional(*g, start, end);
+    RCA_COUNT(FIND_PATH_NODES_EXPANDED, search.lastStats().expanded);
+    RCA_OBSERVE(FIND_PATH_EXPANDED_PER_QUERY, search.lastStats().expanded);
+    RCA_OBSERVE(FIND_PATH_PEAK_FRONTIER, search.lastStats().peakFrontier);
+    return path;
+  }
+
+  /**
+   * @brief findPath restricted to edges with the given labels (empty: all)
+   * and at most maxDepth hops, e.g. {"CAUSES", "PRECEDES"} within 6.
+   */
+  std::vector<uint64_t>
+  findPath(uint64_t startId, uint64_t endId,
+           const std::vector<std::string> &labels,
+           uint32_t maxDepth = Traversal::UNBOUNDED) const {
+    RCA_SPAN("GraphEngine::findPathVia");
+    RCA_COUNT(FIND_PATH_QUERIES, 1);
+    if (!hasNode(startId) || !hasNode(endId))
+      return {};
+
+    auto g = snapshot();
+    uint32_t start = g->indexOfNode(startId), end = g->indexOfNode(endId);
+    const ReachabilityIndex *r = currentReach();
+    if (r && r->covers(labels) && !r->reachable(start, end))
+      return {};
+    std::vector<uint64_t> path =
+        withLabels(*g, labels, [&](const auto &accept) {
+          return traversal.shortestPath(*g, start, end, accept, maxDepth);
+        });
+    RCA_COUNT(FIND_PATH_NODES_EXPANDED, traversal.lastStats().expanded);
+    return path;
+  }
+
+  /**
+   * @brief Every possible cause of nodeId: the nodes reaching it over
+   * edges with the given labels (empty: all) within maxDepth hops,
+   * nearest first.
+   */
+  std::vector<uint64_t>
+  ancestors(uint64_t nodeId, const std::vector<std::string> &labels = {},
+            uint32_t maxDepth = Traversal::UNBOUNDED) const {
+    return closure<Traversal::Direction::IN>(nodeId, labels, maxDepth);
+  }
+
+  /**
+   * @brief Every possible effect of nodeId, as ancestors() downstream.
+   */
+  std::vector<uint64_t>
+  descendants(uint64_t nodeId, const std::vector<std::string> &labels = {},
+              uint32_t maxDepth = Traversal::UNBOUNDED) const {
+    return closure<Traversal::Direction::OUT>(nodeId, labels, maxDepth);
+  }
+
+  /**
+   * @brief Alarm-storm batch query: for every symptom, the shortest causal
+   * chain from any of the candidate root causes, found in one shared BFS.
+   * @return One chain per symptom, in input order (empty if unexplained).
+   */
+  std::vector<PathSearch::CausalChain>
+  explainSymptoms(const std::vector<uint64_t> &causeIds,
+                  const std::vector<uint64_t> &symptomIds) const {
+    auto g = snapshot();
+    auto toDense = [&](const std::vector<uint64_t> &ids) {
+      std::vector<uint32_t> dense;
+      dense.reserve(ids.size());
+      for (uint64_t id : ids)
+        dense.push_back(hasNode(id) ? g->indexOfNode(id) : CsrGraph::NO_NODE);
+      return dense;
+    };
+    std::vector<uint32_t> causes = toDense(causeIds);
+    std::vector<uint32_t> symptoms = toDense(symptomIds);
+    if (const ReachabilityIndex *r = currentReach(); r && r->covers({}))
+      pruneUnreachable(*r, causes, symptoms);
+
+    auto chains = search.explainAll(*g, causes, symptoms);
+    for (size_t i = 0; i < chains.size(); ++i)
+      chains[i].symptomId = symptomIds[i];
+    return chains;
+  }
+
+  /**
+   * @brief Packed per-edge costs aligned with snapshot() edge positions:
+   * -log(confidence * authority(src) * stability(src)) + HOP_PENALTY, with
+   * unset scores treated as 1.0. Cached until a score or edge changes.
+   */
+  std::shared_ptr<const std::vector<float>> edgeWeights() const {
+    auto g = snapshot();
+    if (weightsDirty || !weights) {
+      auto w = std::make_shared<std::vector<float>>(g->edgeCount());
+      for (uint32_t u = 0; u < g->nodeCount(); ++u)
+        costRow(*g, u, *w);
+      weights = std::move(w);
+      weightsDirty = false;
+    }
+    return weights;
+  }
+
+  /**
+   * @brief Ranks the k most credible loopless causal chains from causeId to
+   * symptomId, optionally following only the given edge labels (e.g.
+   * {"CAUSES"}).
+   */
+  std::vector<RankedPathSearch::CredibleChain>
+  rankCausalPaths(uint64_t causeId, uint64_t symptomId, size_t k,
+                  const std::vector<std::string> &labels = {}) const {
+    if (!hasNode(causeId) || !hasNode(symptomId))
+      return {};
+
+    auto g = snapshot();
+    uint32_t cause = g->indexOfNode(causeId);
+    uint32_t symptom = g->indexOfNode(symptomId);
+    const ReachabilityIndex *r = currentReach();
+    if (r && r->covers(labels) && !r->reachable(cause, symptom))
+      return {};
+    auto w = edgeWeights();
+    auto filter = RankedPathSearch::makeFilter(*g, labels);
+    auto paths = ranked.topK(*g, *w, cause, symptom, k, filter);
+    std::vector<RankedPathSearch::CredibleChain> chains;
+    chains.reserve(paths.size());
+    for (const auto &p : paths)
+      chains.push_back(RankedPathSearch::toChain(*g, p));
+    return chains;
+  }
+
+  /**
+   * @brief Indexes reachability over edges with the given labels. From then
+   * on addEdge keeps the index current, and findPath, explainSymptoms and
+   * rankCausalPaths skip work it rules out whenever their search stays on
+   * indexed labels.
+   */
+  void buildReachabilityIndex(
+      std::vector<std::string> labels = {"CAUSES"},
+      ReachabilityIndex::Options options = ReachabilityIndex::Options()) {
+    reachLabels = labels;
+    reachOptions = options;
+    reach = std::make_unique<ReachabilityIndex>(*snapshot(), std::move(labels),
+                                                options);
+    reachStale = false;
+  }
+
+  const ReachabilityIndex *reachability() const { return currentReach(); }
+
+  /**
+   * @brief "Is causeId a possible cause of symptomId" over the indexed
+   * labels, building the default CAUSES index on first use.
+   */
+  bool canCause(uint64_t causeId, uint64_t symptomId) const {
+    if (!hasNode(causeId) || !hasNode(symptomId))
+      return false;
+    return defaultReach().reachable(nodeIndex.find(causeId),
+                                    nodeIndex.find(symptomId));
+  }
+
+  /**
+   * @brief Like canCause, but only via at most maxHops indexed edges.
+   */
+  bool canCauseWithin(uint64_t causeId, uint64_t symptomId,
+                      uint32_t maxHops) const {
+    if (!hasNode(causeId) || !hasNode(symptomId))
+      return false;
+    const ReachabilityIndex &r = defaultReach();
+    return r.withinHops(*snapshot(), nodeIndex.find(causeId),
+                        nodeIndex.find(symptomId), maxHops);
+  }
+
+  size_t nodeCount() const { return declaredNodes; }
+  size_t edgeCount() const { return edgeRecords.size() - removedEdges; }
+
+  // Dense-index accessors. Index i here is also node i of snapshot().
+  uint32_t nodeIndexOf(uint64_t id) const { return nodeIndex.find(id); }
+  size_t nodeSlots() const { return nodeIds.size(); }
+  uint32_t labelIdAt(uint32_t idx) const { return nodeLabel[idx]; }
+  std::string_view nameAt(uint32_t idx) const {
+    return namePool.view(nodeName[idx]);
+  }
+  float authorityAt(uint32_t idx) const { return nodeAuthority[idx]; }
+  float stabilityAt(uint32_t idx) const { return nodeStability[idx]; }
+  float confidenceOfEdge(uint64_t edgeId) const {
+    uint32_t idx = edgeIndex.find(edgeId);
+    return (idx != IdIndex::NONE) ? edgeConfidence[idx] : std::nanf("");
+  }
+  bool edgeEndpoints(uint64_t edgeId, uint64_t &src, uint64_t &tgt) const {
+    uint32_t idx = edgeIndex.find(edgeId);
+    if (idx == IdIndex::NONE)
+      return false;
+    src = nodeIds[edgeRecords[idx].src];
+    tgt = nodeIds[edgeRecords[idx].tgt];
+    return true;
+  }
+  size_t labelCount() const { return labelPool.size(); }
+  const std::string &labelString(uint32_t labelId) const {
+    return labelPool.str(labelId);
+  }
+
+  /**
+   * @brief Approximate resident bytes of the columnar store.
+   */
+  size_t memoryUsage() const {
+    size_t bytes = nodeIds.capacity() * sizeof(uint64_t) +
+                   nodeLabel.capacity() * sizeof(uint32_t) +
+                   nodeName.capacity() * sizeof(uint32_t) +
+                   (nodeAuthority.capacity() + nodeStability.capacity() +
+                    edgeConfidence.capacity()) *
+                       sizeof(float) +
+                   edgeRecords.capacity() * sizeof(EdgeRecord) +
+                   namePool.bytes();
+    bytes += nodeIndex.bytes() + edgeIndex.bytes();
+    // Cold-property hash maps: one heap node per entry.
+    bytes += (nodeExtra.size() + edgeExtra.size()) *
+             (2 * sizeof(void *) + sizeof(uint64_t) + sizeof(PropertyValue));
+    for (const auto &entry : nodeColumns)
+      bytes += entry.second.capacity() * sizeof(uint32_t);
+    return bytes;
+  }
+
+  void debugPrint() const {
+    std::cout << "--- Graph Engine State ---" << std::endl;
+    std::cout << "Nodes: " << nodeCount() << " | Edges: " << edgeCount()
+              << " | Store: " << memoryUsage() << " bytes" << std::endl;
+  }
+
+private:
+  friend class BulkLoader; // Fills the columns and CSR directly
+
+  static constexpr uint32_t UNDECLARED = 0;
+  static constexpr uint32_t REMOVED = std::numeric_limits<uint32_t>::max();
+
+  // snapshot() patches while at most nodes / PATCH_DIVISOR rows changed.
+  static constexpr size_t PATCH_DIVISOR = 8;
+
+  struct EdgeRecord {
+    uint64_t id;
+    uint32_t src; // Dense node index
+    uint32_t tgt; // Dense node index
+    uint32_t label;
+  };
+
+  // Node columns, indexed by dense node index.
+  std::vector<uint64_t> nodeIds;
+  std::vector<uint32_t> nodeLabel;
+  std::vector<uint32_t> nodeName;
+  std::vector<float> nodeAuthority;
+  std::vector<float> nodeStability;
+  IdIndex nodeIndex;
+  size_t declaredNodes = 0;
+
+  // Edge columns, indexed by dense edge index (insertion order). Removed
+  // edges stay as REMOVED-label tombstones until compactEdges().
+  std::vector<EdgeRecord> edgeRecords;
+  std::vector<float> edgeConfidence;
+  IdIndex edgeIndex;
+  size_t removedEdges = 0;
+
+  // Interned vocabularies and cold properties.
+  StringInterner labelPool;
+  StringInterner keyPool;
+  StringArena namePool;
+  std::unordered_map<uint64_t, PropertyValue> nodeExtra;
+  std::unordered_map<uint64_t, PropertyValue> edgeExtra;
+  std::unordered_map<uint32_t, std::vector<uint32_t>> nodeColumns; // By key
+
+  mutable std::shared_ptr<const CsrGraph> csr;
+  mutable bool csrDirty = true;
+  // Changes since csr was built: source rows and edge records.
+  mutable std::vector<uint32_t> dirtyRows;
+  mutable std::vector<uint32_t> dirtyRecords;
+  mutable bool rebuildAll = false; // Too many changes to track
+  mutable PathSearch search; // Reused scratch; one query at a time
+  mutable Traversal traversal;
+  mutable RankedPathSearch ranked;
+  mutable std::shared_ptr<const std::vector<float>> weights;
+  mutable bool weightsDirty = true;
+  mutable std::unique_ptr<ReachabilityIndex> reach;
+  mutable bool reachStale = false;
+  std::vector<std::string> reachLabels{"CAUSES"};
+  ReachabilityIndex::Options reachOptions;
+
+  /**
+   * @brief The index if one was built, rebuilt first when an edge was
+   * rewired or the insert overlay grew too long.
+   */
+  const ReachabilityIndex *currentReach() const {
+    if (reach && (reachStale || reach->needsRebuild())) {
+      reach = std::make_unique<ReachabilityIndex>(*snapshot(), reachLabels,
+                                                  reachOptions);
+      reachStale = false;
+    }
+    return reach.get();
+  }
+
+  const ReachabilityIndex &defaultReach() const {
+    if (!reach)
+      reach = std::make_unique<ReachabilityIndex>(*snapshot(), reachLabels,
+                                                  reachOptions);
+    return *currentReach();
+  }
+
+  /**
+   * @brief Calls fn with the cheapest Traversal predicate for `labels`:
+   * AnyEdge, LabelIs for one label, LabelMask otherwise.
+   */
+  template <typename Fn>
+  static auto withLabels(const CsrGraph &g,
+                         const std::vector<std::string> &labels, Fn &&fn)
+      -> decltype(fn(Traversal::AnyEdge())) {
+    if (labels.empty())
+      return fn(Traversal::AnyEdge());
+    if (labels.size() == 1)
+      return fn(Traversal::LabelIs(g, labels[0]));
+    return fn(Traversal::LabelMask(g, labels));
+  }
+
+  /**
+   * @brief Shared body of ancestors() and descendants().
+   */
+  template <Traversal::Direction direction>
+  std::vector<uint64_t> closure(uint64_t nodeId,
+                                const std::vector<std::string> &labels,
+                                uint32_t maxDepth) const {
+    RCA_SPAN("GraphEngine::closure");
+    if (!hasNode(nodeId))
+      return {};
+    auto g = snapshot();
+    Traversal::Collect visitor;
+    visitor.maxDepth = maxDepth;
+    withLabels(*g, labels, [&](const auto &accept) {
+      return traversal.run<Traversal::Order::BREADTH, direction>(
+          *g, {g->indexOfNode(nodeId)}, accept, visitor);
+    });
+    std::vector<uint64_t> ids;
+    ids.reserve(visitor.nodes.size());
+    for (uint32_t v : visitor.nodes)
+      ids.push_back(g->nodeIdAt(v));
+    return ids;
+  }
+
+  /**
+   * @brief Drops causes that reach no symptom and symptoms no remaining
+   * cause reaches. Neither can contribute to a chain, and dropping the
+   * symptoms lets the batch BFS stop early.
+   */
+  static void pruneUnreachable(const ReachabilityIndex &r,
+                               std::vector<uint32_t> &causes,
+                               std::vector<uint32_t> &symptoms) {
+    auto reaches = [&](uint32_t c, uint32_t s) {
+      return c != CsrGraph::NO_NODE && s != CsrGraph::NO_NODE &&
+             r.mayReach(c, s);
+    };
+    for (uint32_t &c : causes)
+      if (std::none_of(symptoms.begin(), symptoms.end(),
+                       [&](uint32_t s) { return reaches(c, s); }))
+        c = CsrGraph::NO_NODE;
+    for (uint32_t &s : symptoms)
+      if (std::none_of(causes.begin(), causes.end(),
+                       [&](uint32_t c) { return reaches(c, s); }))
+        s = CsrGraph::NO_NODE;
+  }
+
+  /**
+   * @brief Notes that row `src` and record `record` changed since the last
+   * snapshot. Past the patch limit tracking stops and snapshot() rebuilds.
+   */
+  void markDirty(uint32_t src, uint32_t record) {
+    if (rebuildAll || !csr)
+      return;
+    if (dirtyRecords.size() >= edgeRecords.size() / PATCH_DIVISOR + 64) {
+      rebuildAll = true;
+      dirtyRows.clear();
+      dirtyRecords.clear();
+      return;
+    }
+    dirtyRows.push_back(src);
+    dirtyRecords.push_back(record);
+  }
+
+  /**
+   * @brief Drops tombstones from the edge columns, keeping the insertion
+   * order of the live edges.
+   */
+  void compactEdges() {
+    std::vector<uint32_t> moved(edgeRecords.size(), REMOVED);
+    size_t live = 0;
+    for (size_t i = 0; i < edgeRecords.size(); ++i) {
+      if (edgeRecords[i].label == REMOVED)
+        continue;
+      moved[i] = static_cast<uint32_t>(live);
+      edgeRecords[live] = edgeRecords[i];
+      edgeConfidence[live] = edgeConfidence[i];
+      edgeIndex.set(edgeRecords[live].id, static_cast<uint32_t>(live));
+      live++;
+    }
+    edgeRecords.resize(live);
+    edgeConfidence.resize(live);
+    std::unordered_map<uint64_t, PropertyValue> extra;
+    for (auto &[packed, value] : edgeExtra)
+      if (uint32_t idx = moved[packed >> 32]; idx != REMOVED)
+        extra.emplace(packKey(idx, static_cast<uint32_t>(packed)),
+                      std::move(value));
+    edgeExtra = std::move(extra);
+    removedEdges = 0;
+    rebuildAll = true; // Record indices moved
+  }
+
+  /**
+   * @brief Rebuilds the dirty rows from the edge records and patches the
+   * previous snapshot with them; edge weights too if they were current.
+   */
+  void patchSnapshot() const {
+    const CsrGraph &old = *csr;
+    std::sort(dirtyRecords.begin(), dirtyRecords.end());
+    std::vector<std::pair<uint32_t, uint32_t>> bySource; // (src, record)
+    for (uint32_t r : dirtyRecords)
+      if (edgeRecords[r].label != REMOVED)
+        bySource.push_back({edgeRecords[r].src, r});
+    std::sort(bySource.begin(), bySource.end());
+
+    // A dirty row holds the live records with that source in record order,
+    // as buildCsr would emit them: its previous edges that still start
+    // there, plus changed records that now do.
+    std::vector<CsrGraph::DenseEdge> rowEdges;
+    std::vector<uint32_t> records;
+    size_t k = 0;
+    for (uint32_t u : dirtyRows) {
+      records.clear();
+      if (u < old.nodeCount())
+        for (uint64_t p = old.outBegin(u); p < old.outEnd(u); ++p) {
+          uint32_t r = edgeIndex.find(old.edgeIdAt(p));
+          if (r != IdIndex::NONE && edgeRecords[r].src == u)
+            records.push_back(r);
+        }
+      for (; k < bySource.size() && bySource[k].first == u; ++k)
+        records.push_back(bySource[k].second);
+      std::sort(records.begin(), records.end());
+      records.erase(std::unique(records.begin(), records.end()),
+                    records.end());
+      for (uint32_t r : records) {
+        const EdgeRecord &e = edgeRecords[r];
+        rowEdges.push_back({e.src, e.tgt, e.label, e.id});
+      }
+    }
+    std::vector<std::string> labels;
+    labels.reserve(labelPool.size());
+    for (uint32_t i = 0; i < labelPool.size(); ++i)
+      labels.push_back(labelPool.str(i));
+    auto next = std::make_shared<const CsrGraph>(CsrGraph::patched(
+        old, nodeIds, dirtyRows, rowEdges, std::move(labels)));
+
+    if (weights && !weightsDirty) {
+      auto w = std::make_shared<std::vector<float>>(next->edgeCount());
+      size_t runStart = 0;
+      auto carryOver = [&](size_t from, size_t to) { // Untouched rows
+        to = std::min(to, old.nodeCount());
+        if (from < to)
+          std::copy(weights->begin() + old.outBegin(from),
+                    weights->begin() + old.outBegin(to),
+                    w->begin() + next->outBegin(from));
+      };
+      for (uint32_t u : dirtyRows) {
+        carryOver(runStart, u);
+        costRow(*next, u, *w);
+        runStart = u + 1;
+      }
+      carryOver(runStart, next->nodeCount());
+      weights = std::move(w);
+    } else {
+      weightsDirty = true;
+    }
+    csr = std::move(next);
+  }
+
+  /**
+   * @brief Fills the edgeWeights() entries of u's out-row in `g`.
+   */
+  void costRow(const CsrGraph &g, uint32_t u, std::vector<float> &w) const {
+    float srcScore = score(nodeAuthority[u]) * score(nodeStability[u]);
+    for (uint64_t p = g.outBegin(u); p < g.outEnd(u); ++p) {
+      float conf = score(edgeConfidence[edgeIndex.find(g.edgeIdAt(p))]);
+      float credibility = std::max(conf * srcScore, 1e-6f);
+      w[p] = -std::log(credibility) + HOP_PENALTY;
+    }
+  }
+
+  uint32_t ensureNode(uint64_t id) {
+    uint32_t existing = nodeIndex.find(id);
+    if (existing != IdIndex::NONE)
+      return existing;
+    uint32_t idx = static_cast<uint32_t>(nodeIds.size());
+    nodeIndex.set(id, idx);
+    nodeIds.push_back(id);
+    nodeLabel.push_back(UNDECLARED);
+    nodeName.push_back(StringArena::NO_ID);
+    nodeAuthority.push_back(std::nanf(""));
+    nodeStability.push_back(std::nanf(""));
+    return idx;
+  }
+
+  static uint64_t packKey(uint32_t idx, uint32_t keyId) {
+    return (static_cast<uint64_t>(idx) << 32) | keyId;
+  }
+
+  static bool isNumber(const PropertyValue &v) {
+    return std::holds_alternative<double>(v) || std::holds_alternative<int>(v);
+  }
+
+  static float toFloat(const PropertyValue &v) {
+    return std::holds_alternative<double>(v)
+               ? static_cast<float>(std::get<double>(v))
+               : static_cast<float>(std::get<int>(v));
+  }
+
+  static float score(float v) {
+    return std::isnan(v) ? 1.0f : std::min(std::max(v, 0.0f), 1.0f);
+  }
+
+  static std::optional<PropertyValue> optionalFloat(float v) {
+    if (std::isnan(v))
+      return std::nullopt;
+    return PropertyValue(static_cast<double>(v));
+  }
+
+  std::optional<PropertyValue> optionalName(uint32_t nameId) const {
+    if (nameId == StringArena::NO_ID)
+      return std::nullopt;
+    return PropertyValue(std::string(namePool.view(nameId)));
+  }
+
+  std::optional<PropertyValue>
+  findExtra(const std::unordered_map<uint64_t, PropertyValue> &extra,
+            uint32_t idx, const std::string &key) const {
+    uint32_t keyId = keyPool.find(key);
+    if (keyId == StringInterner::NO_ID)
+      return std::nullopt;
+    auto it = extra.find(packKey(idx, keyId));
+    if (it == extra.end())
+      return std::nullopt;
+    return it->second;
+  }
+
+  /**
+   * @brief Freezes the edge records into CSR form. Records are already dense
+   * and in insertion order, so this is a single counting sort.
+   */
+  CsrGraph buildCsr() const {
+    std::vector<CsrGraph::DenseEdge> dense;
+    dense.reserve(edgeCount());
+    for (const auto &e : edgeRecords)
+      if (e.label != REMOVED)
+        dense.push_back({e.src, e.tgt, e.label, e.id});
+    std::vector<std::string> labels;
+    labels.reserve(labelPool.size());
+    for (uint32_t i = 0; i < labelPool.size(); ++i)
+      labels.push_back(labelPool.str(i));
+    return CsrGraph::fromDense(nodeIds, dense, std::move(labels));
+  }
+};
+
+/**
+ * @class EntityRegistry
+ * @brief Manages unique node resolution (Record Linkage).
+ */
+class EntityRegistry {
+public:
+  /**
+   * @brief The node of (label, canonicalName), added to `engine` only the
+   * first time, so re-ingesting a chunk leaves existing nodes untouched.
+   * @param created If non-null, set to whether the node was new.
+   */
+  uint64_t resolveNode(const std::string &label,
+                       const std::string &canonicalName, GraphEngine &engine,
+                       bool *created = nullptr) {
+    std::string key = label + "::" + canonicalName;
+    auto it = registry.find(key);
+    if (created)
+      *created = it == registry.end();
+    if (it != registry.end())
+      return it->second;
+
+    uint64_t newId = ++nextId;
+    engine.addNode(newId, label);
+    engine.setNodeProperty(newId, GraphEngine::CANONICAL_NAME, canonicalName);
+    registry.emplace(std::move(key), newId);
+    return newId;
+  }
+
+  /**
+   * @brief Records a node created elsewhere (e.g. by BulkLoader) so that
+   * resolveNode() returns it and never issues its ID again. An already
+   * registered pair keeps its ID.
+   */
+  void adopt(std::string_view label, std::string_view canonicalName,
+             uint64_t id) {
+    std::string key;
+    key.reserve(label.size() + 2 + canonicalName.size());
+    key.append(label).append("::").append(canonicalName);
+    registry.emplace(std::move(key), id);
+    nextId = std::max(nextId, id);
+  }
+
+  void reserve(size_t entities) { registry.reserve(entities); }
+
+  /**
+   * @brief Looks (label, canonicalName) up without assigning an ID.
+   * @return false if the pair has never been resolved.
+   */
+  bool find(const std::string &label, const std::string &canonicalName,
+            uint64_t &id) const {
+    auto it = registry.find(label + "::" + canonicalName);
+    if (it == registry.end())
+      return false;
+    id = it->second;
+    return true;
+  }
+
+private:
+  uint64_t nextId = 0;
+  std::unordered_map<std::string, uint64_t> registry;
+};
@@ -0,0 +1,575 @@
+#pragma once
+
+#include "ArrayRef.hpp"
+#include "CsrGraph.hpp"
+#include "GraphEngine.hpp"
+#include "PathSearch.hpp"
+#include "RankedPathSearch.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class GraphFile
+ * @brief Versioned, memory-mappable binary image of a GraphEngine.
+ *
+ * FILE LAYOUT (native byte order, every section 64-byte aligned):
+ * - Header: magic, format version, endianness tag, counts and a table of
+ *   (offset, bytes) per Section.
+ * - CSR sections: exactly CsrGraph::Arrays, including the flattened
+ *   external ID index.
+ * - Directory sections: label strings, per-node label ID, canonical names
+ *   as one character blob plus exclusive end offsets.
+ * - Property columns: authority and stability per node, confidence and the
+ *   precomputed edge cost per CSR edge position.
+ * - Registry: open-addressing table of (dense index + 1) keyed by
+ *   registryHash(label, name), so record linkage needs no rebuild either.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: Loading is open + mmap + O(1) header checks. Pages fault in on
+ *   first touch and are shared through the page cache by every process
+ *   that maps the same file.
+ * - CON: Cold properties (the sparse PropertyValue maps) are not part of
+ *   the image; only the typed hot columns are.
+ * - CON: Section contents are trusted once the header validates. Files
+ *   are produced by write(), which publishes them with an atomic rename.
+ */
+class GraphFile {
+public:
+  static constexpr char MAGIC[8] = {'R', 'C', 'A', 'G', 'R', 'A', 'P', 'H'};
+  static constexpr uint32_t FORMAT_VERSION = 1;
+  static constexpr uint32_t ENDIAN_TAG = 0x01020304;
+  static constexpr uint64_t ALIGN = 64;
+
+  enum Section : uint32_t {
+    OFFSETS,
+    NEIGHBORS,
+    EDGE_LABELS,
+    EDGE_IDS,
+    IN_OFFSETS,
+    IN_NEIGHBORS,
+    IN_EDGE_POS,
+    NODE_IDS,
+    ID_DIRECT,
+    ID_SPARSE,
+    LABEL_ENDS,
+    LABEL_CHARS,
+    NODE_LABELS,
+    NAME_ENDS,
+    NAME_CHARS,
+    NODE_AUTHORITY,
+    NODE_STABILITY,
+    EDGE_CONFIDENCE,
+    EDGE_WEIGHTS,
+    REGISTRY,
+    SECTION_COUNT
+  };
+
+  struct SectionEntry {
+    uint64_t offset;
+    uint64_t bytes;
+  };
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianTag;
+    uint64_t nodeCount;     // Dense node slots, declared or not
+    uint64_t declaredNodes; // GraphEngine::nodeCount()
+    uint64_t edgeCount;
+    uint64_t labelCount;
+    uint64_t registrySlots; // Power of two
+    uint64_t fileBytes;
+    SectionEntry sections[SECTION_COUNT];
+  };
+
+  static_assert(std::is_trivially_copyable<Header>::value,
+                "Header is written and mapped as raw bytes");
+  static_assert(sizeof(CsrGraph::SparseId) == 16,
+                "SparseId layout is part of the file format");
+
+  /**
+   * @brief FNV-1a over "label::name". Fixed by the format, unlike
+   * std::hash, so any build can probe a file written by any other.
+   */
+  static uint64_t registryHash(std::string_view label, std::string_view name) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](std::string_view s) {
+      for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ull;
+      }
+    };
+    mix(label);
+    mix("::");
+    mix(name);
+    return h;
+  }
+
+  /**
+   * @brief Serializes the engine's current snapshot to path. The image is
+   * written next to path and renamed over it, so readers never map a
+   * half-written file.
+   * @return false on I/O failure, with a reason in *error if given.
+   */
+  static bool write(const GraphEngine &engine, const std::string &path,
+                    std::string *error = nullptr) {
+    auto g = engine.snapshot();
+    auto weights = engine.edgeWeights();
+    const CsrGraph::Arrays &a = g->arrays();
+    const size_t n = g->nodeCount();
+    const size_t m = g->edgeCount();
+
+    std::vector<uint32_t> labelEnds;
+    std::string labelChars;
+    for (const auto &l : g->labelTable()) {
+      labelChars += l;
+      labelEnds.push_back(static_cast<uint32_t>(labelChars.size()));
+    }
+
+    std::vector<uint32_t> nodeLabels(n);
+    std::vector<uint64_t> nameEnds(n);
+    std::vector<float> authority(n);
+    std::vector<float> stability(n);
+    std::string nameChars;
+    for (uint32_t i = 0; i < n; ++i) {
+      nodeLabels[i] = engine.labelIdAt(i);
+      nameChars.append(engine.nameAt(i));
+      nameEnds[i] = nameChars.size();
+      authority[i] = engine.authorityAt(i);
+      stability[i] = engine.stabilityAt(i);
+    }
+
+    std::vector<float> confidence(m);
+    for (uint64_t p = 0; p < m; ++p)
+      confidence[p] = engine.confidenceOfEdge(g->edgeIdAt(p));
+
+    std::vector<uint32_t> registry = buildRegistry(*g, engine, nodeLabels);
+
+    Header h{};
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = FORMAT_VERSION;
+    h.endianTag = ENDIAN_TAG;
+    h.nodeCount = n;
+    h.declaredNodes = engine.nodeCount();
+    h.edgeCount = m;
+    h.labelCount = labelEnds.size();
+    h.registrySlots = registry.size();
+
+    struct Blob {
+      const void *data;
+      size_t bytes;
+    };
+    auto blob = [](const auto &v) {
+      return Blob{v.data(), v.size() * sizeof(v[0])};
+    };
+    Blob blobs[SECTION_COUNT] = {
+        blob(a.offsets),     blob(a.neighbors),   blob(a.edgeLabels),
+        blob(a.edgeIds),     blob(a.inOffsets),   blob(a.inNeighbors),
+        blob(a.inEdgePos),   blob(a.nodeIds),     blob(a.idDirect),
+        blob(a.idSparse),    blob(labelEnds),     blob(labelChars),
+        blob(nodeLabels),    blob(nameEnds),      blob(nameChars),
+        blob(authority),     blob(stability),     blob(confidence),
+        blob(*weights),      blob(registry)};
+
+    uint64_t cursor = alignUp(sizeof(Header));
+    for (uint32_t s = 0; s < SECTION_COUNT; ++s) {
+      h.sections[s] = {cursor, blobs[s].bytes};
+      cursor = alignUp(cursor + blobs[s].bytes);
+    }
+    h.fileBytes = cursor;
+
+    const std::string tmp = path + ".tmp";
+    {
+      std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+      if (!out)
+        return fail(error, "cannot create " + tmp);
+      static const char zeros[ALIGN] = {};
+      uint64_t written = 0;
+      auto put = [&](const void *data, size_t bytes) {
+        out.write(static_cast<const char *>(data), bytes);
+        written += bytes;
+      };
+      put(&h, sizeof(h));
+      for (uint32_t s = 0; s < SECTION_COUNT; ++s) {
+        put(zeros, h.sections[s].offset - written);
+        put(blobs[s].data, blobs[s].bytes);
+      }
+      put(zeros, h.fileBytes - written);
+      out.flush();
+      if (!out) {
+        out.close();
+        std::remove(tmp.c_str());
+        return fail(error, "short write to " + tmp);
+      }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+      std::remove(tmp.c_str());
+      return fail(error, "cannot rename " + tmp + " to " + path);
+    }
+    return true;
+  }
+
+private:
+  static uint64_t alignUp(uint64_t v) { return (v + ALIGN - 1) & ~(ALIGN - 1); }
+
+  static bool fail(std::string *error, const std::string &why) {
+    if (error)
+      *error = why;
+    return false;
+  }
+
+  /**
+   * @brief Linear-probing table over every declared node, at most half
+   * full. The first node wins if two share a (label, name) key.
+   */
+  static std::vector<uint32_t>
+  buildRegistry(const CsrGraph &g, const GraphEngine &engine,
+                const std::vector<uint32_t> &nodeLabels) {
+    size_t slots = 16;
+    while (slots < 2 * engine.nodeCount())
+      slots <<= 1;
+    std::vector<uint32_t> table(slots, 0);
+    const size_t mask = slots - 1;
+    for (uint32_t i = 0; i < g.nodeCount(); ++i) {
+      if (nodeLabels[i] == 0)
+        continue;
+      std::string_view label = g.labelName(nodeLabels[i]);
+      std::string_view name = engine.nameAt(i);
+      size_t s = registryHash(label, name) & mask;
+      bool duplicate = false;
+      for (; table[s] != 0; s = (s + 1) & mask) {
+        uint32_t other = table[s] - 1;
+        if (nodeLabels[other] == nodeLabels[i] &&
+            engine.nameAt(other) == name) {
+          duplicate = true;
+          break;
+        }
+      }
+      if (!duplicate)
+        table[s] = i + 1;
+    }
+    return table;
+  }
+};
+
+/**
+ * @class MappedGraph
+ * @brief Read-only Knowledge Graph served directly from a GraphFile image.
+ *
+ * open() maps the file PROT_READ / MAP_SHARED and points a CsrGraph and the
+ * property columns at the mapped sections; nothing is parsed or copied
+ * except the handful of edge label strings. Instances are immutable and
+ * safe to query from many threads; each thread keeps its own search
+ * scratch, as in ConcurrentGraph::ReadView.
+ */
+class MappedGraph {
+public:
+  /**
+   * @brief Maps and validates a graph file.
+   * @return nullptr if the file is missing, truncated, or was written by an
+   * incompatible format version or byte order (reason in *error).
+   */
+  static std::shared_ptr<const MappedGraph>
+  open(const std::string &path, std::string *error = nullptr) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return fail(error, "cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 ||
+        static_cast<uint64_t>(st.st_size) < sizeof(GraphFile::Header)) {
+      ::close(fd);
+      return fail(error, path + " is too small to be a graph file");
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void *addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps its own reference to the file
+    if (addr == MAP_FAILED)
+      return fail(error, "cannot mmap " + path);
+    auto region = std::make_shared<const Region>(addr, size);
+
+    auto graph = std::shared_ptr<MappedGraph>(new MappedGraph());
+    std::string why = graph->bind(std::move(region));
+    if (!why.empty())
+      return fail(error, path + ": " + why);
+    return graph;
+  }
+
+  const CsrGraph &graph() const { return csr; }
+  ArrayRef<float> edgeWeights() const { return weights; }
+  ArrayRef<float> edgeConfidence() const { return confidence; }
+  size_t nodeCount() const { return header->declaredNodes; }
+  size_t edgeCount() const { return csr.edgeCount(); }
+  size_t mappedBytes() const { return region->size; }
+
+  bool hasNode(uint64_t id) const {
+    uint32_t idx = csr.indexOfNode(id);
+    return idx != CsrGraph::NO_NODE && nodeLabels[idx] != 0;
+  }
+
+  std::string_view labelOf(uint64_t id) const {
+    uint32_t idx = csr.indexOfNode(id);
+    return idx != CsrGraph::NO_NODE ? csr.labelName(nodeLabels[idx])
+                                    : std::string_view();
+  }
+
+  std::string_view canonicalNameOf(uint64_t id) const {
+    uint32_t idx = csr.indexOfNode(id);
+    return idx != CsrGraph::NO_NODE ? nameAt(idx) : std::string_view();
+  }
+
+  /**
+   * @brief Typed hot node properties (canonical_name, authority_score,
+   * stability_score); cold properties are not stored in the image.
+   */
+  std::optional<PropertyValue> getNodeProperty(uint64_t id,
+                                               const std::string &key) const {
+    uint32_t idx = csr.indexOfNode(id);
+    if (idx == CsrGraph::NO_NODE)
+      return std::nullopt;
+    if (key == GraphEngine::CANONICAL_NAME && nodeLabels[idx] != 0)
+      return PropertyValue(std::string(nameAt(idx)));
+    float v = (key == GraphEngine::AUTHORITY_SCORE)   ? authority[idx]
+              : (key == GraphEngine::STABILITY_SCORE) ? stability[idx]
+                                                      : std::nanf("");
+    if (std::isnan(v))
+      return std::nullopt;
+    return PropertyValue(static_cast<double>(v));
+  }
+
+  /**
+   * @brief Record linkage against the persisted registry table: the node
+   * ID EntityRegistry assigned to (label, canonicalName), if any.
+   */
+  std::optional<uint64_t> resolve(std::string_view label,
+                                  std::string_view canonicalName) const {
+    const size_t mask = registry.size() - 1;
+    size_t s = GraphFile::registryHash(label, canonicalName) & mask;
+    for (; registry[s] != 0; s = (s + 1) & mask) {
+      uint32_t idx = registry[s] - 1;
+      if (nameAt(idx) == canonicalName &&
+          csr.labelName(nodeLabels[idx]) == label)
+        return csr.nodeIdAt(idx);
+    }
+    return std::nullopt;
+  }
+
+  std::vector<uint64_t> findPath(uint64_t startId, uint64_t endId) const {
+    if (!hasNode(startId) || !hasNode(endId))
+      return {};
+    return pathScratch().bidirectional(csr, csr.indexOfNode(startId),
+                                       csr.indexOfNode(endId));
+  }
+
+  std::vector<PathSearch::CausalChain>
+  explainSymptoms(const std::vector<uint64_t> &causeIds,
+                  const std::vector<uint64_t> &symptomIds) const {
+    auto toDense = [&](const std::vector<uint64_t> &ids) {
+      std::vector<uint32_t> dense;
+      dense.reserve(ids.size());
+      for (uint64_t id : ids)
+        dense.push_back(hasNode(id) ? csr.indexOfNode(id) : CsrGraph::NO_NODE);
+      return dense;
+    };
+    auto chains =
+        pathScratch().explainAll(csr, toDense(causeIds), toDense(symptomIds));
+    for (size_t i = 0; i < chains.size(); ++i)
+      chains[i].symptomId = symptomIds[i];
+    return chains;
+  }
+
+  std::vector<RankedPathSearch::CredibleChain>
+  rankCausalPaths(uint64_t causeId, uint64_t symptomId, size_t k,
+                  const std::vector<std::string> &labels = {}) const {
+    if (!hasNode(causeId) || !hasNode(symptomId))
+      return {};
+    auto filter = RankedPathSearch::makeFilter(csr, labels);
+    auto paths =
+        rankedScratch().topK(csr, weights, csr.indexOfNode(causeId),
+                             csr.indexOfNode(symptomId), k, filter);
+    std::vector<RankedPathSearch::CredibleChain> chains;
+    chains.reserve(paths.size());
+    for (const auto &p : paths)
+      chains.push_back(RankedPathSearch::toChain(csr, p));
+    return chains;
+  }
+
+private:
+  /**
+   * @brief Owns the mapping; unmapped when the last view goes away.
+   */
+  struct Region {
+    void *addr;
+    size_t size;
+    Region(void *addr, size_t size) : addr(addr), size(size) {}
+    ~Region() { ::munmap(addr, size); }
+    Region(const Region &) = delete;
+    Region &operator=(const Region &) = delete;
+  };
+
+  std::shared_ptr<const Region> region;
+  const GraphFile::Header *header = nullptr;
+  CsrGraph csr;
+  ArrayRef<uint32_t> nodeLabels;
+  ArrayRef<uint64_t> nameEnds;
+  const char *nameChars = nullptr;
+  ArrayRef<float> authority;
+  ArrayRef<float> stability;
+  ArrayRef<float> confidence;
+  ArrayRef<float> weights;
+  ArrayRef<uint32_t> registry;
+
+  MappedGraph() = default;
+
+  static std::shared_ptr<const MappedGraph> fail(std::string *error,
+                                                 const std::string &why) {
+    if (error)
+      *error = why;
+    return nullptr;
+  }
+
+  static PathSearch &pathScratch() {
+    static thread_local PathSearch search;
+    return search;
+  }
+  static RankedPathSearch &rankedScratch() {
+    static thread_local RankedPathSearch ranked;
+    return ranked;
+  }
+
+  std::string_view nameAt(uint32_t idx) const {
+    uint64_t begin = idx ? nameEnds[idx - 1] : 0;
+    return std::string_view(nameChars + begin, nameEnds[idx] - begin);
+  }
+
+  template <typename T> ArrayRef<T> sectionAt(uint32_t s) const {
+    const GraphFile::SectionEntry &e = header->sections[s];
+    const char *base = static_cast<const char *>(region->addr);
+    return ArrayRef<T>(reinterpret_cast<const T *>(base + e.offset),
+                       e.bytes / sizeof(T));
+  }
+
+  /**
+   * @brief Byte size each section must have for the header's counts.
+   */
+  static bool sectionSizeValid(const GraphFile::Header &h, uint32_t s,
+                               uint64_t bytes) {
+    const uint64_t n = h.nodeCount;
+    const uint64_t m = h.edgeCount;
+    switch (s) {
+    case GraphFile::OFFSETS:
+    case GraphFile::IN_OFFSETS:
+      return bytes == (n + 1) * sizeof(uint64_t);
+    case GraphFile::NEIGHBORS:
+    case GraphFile::EDGE_LABELS:
+    case GraphFile::IN_NEIGHBORS:
+    case GraphFile::EDGE_CONFIDENCE:
+    case GraphFile::EDGE_WEIGHTS:
+      return bytes == m * sizeof(uint32_t);
+    case GraphFile::EDGE_IDS:
+    case GraphFile::IN_EDGE_POS:
+      return bytes == m * sizeof(uint64_t);
+    case GraphFile::NODE_IDS:
+    case GraphFile::NAME_ENDS:
+      return bytes == n * sizeof(uint64_t);
+    case GraphFile::NODE_LABELS:
+    case GraphFile::NODE_AUTHORITY:
+    case GraphFile::NODE_STABILITY:
+      return bytes == n * sizeof(uint32_t);
+    case GraphFile::ID_DIRECT:
+      return bytes % sizeof(uint32_t) == 0;
+    case GraphFile::ID_SPARSE:
+      return bytes % sizeof(CsrGraph::SparseId) == 0;
+    case GraphFile::LABEL_ENDS:
+      return bytes == h.labelCount * sizeof(uint32_t);
+    case GraphFile::REGISTRY:
+      return bytes == h.registrySlots * sizeof(uint32_t);
+    default: // Character blobs
+      return true;
+    }
+  }
+
+  /**
+   * @brief Checks the header and section table, then points every column
+   * at its section. O(labels), independent of graph size.
+   * @return An empty string on success, otherwise the reason for rejecting.
+   */
+  std::string bind(std::shared_ptr<const Region> r) {
+    region = std::move(r);
+    header = static_cast<const GraphFile::Header *>(region->addr);
+    const GraphFile::Header &h = *header;
+
+    if (std::memcmp(h.magic, GraphFile::MAGIC, sizeof(h.magic)) != 0)
+      return "bad magic";
+    if (h.version != GraphFile::FORMAT_VERSION)
+      return "unsupported format version " + std::to_string(h.version);
+    if (h.endianTag != GraphFile::ENDIAN_TAG)
+      return "written with a different byte order";
+    if (h.fileBytes != region->size)
+      return "truncated or padded file";
+    if (h.registrySlots == 0 || (h.registrySlots & (h.registrySlots - 1)))
+      return "registry size is not a power of two";
+    for (uint32_t s = 0; s < GraphFile::SECTION_COUNT; ++s) {
+      const GraphFile::SectionEntry &e = h.sections[s];
+      if (e.offset % GraphFile::ALIGN != 0 || e.offset > region->size ||
+          e.bytes > region->size - e.offset ||
+          !sectionSizeValid(h, s, e.bytes))
+        return "section " + std::to_string(s) + " is malformed";
+    }
+
+    const uint64_t n = h.nodeCount;
+    CsrGraph::Arrays a;
+    a.offsets = sectionAt<uint64_t>(GraphFile::OFFSETS);
+    a.neighbors = sectionAt<uint32_t>(GraphFile::NEIGHBORS);
+    a.edgeLabels = sectionAt<uint32_t>(GraphFile::EDGE_LABELS);
+    a.edgeIds = sectionAt<uint64_t>(GraphFile::EDGE_IDS);
+    a.inOffsets = sectionAt<uint64_t>(GraphFile::IN_OFFSETS);
+    a.inNeighbors = sectionAt<uint32_t>(GraphFile::IN_NEIGHBORS);
+    a.inEdgePos = sectionAt<uint64_t>(GraphFile::IN_EDGE_POS);
+    a.nodeIds = sectionAt<uint64_t>(GraphFile::NODE_IDS);
+    a.idDirect = sectionAt<uint32_t>(GraphFile::ID_DIRECT);
+    a.idSparse = sectionAt<CsrGraph::SparseId>(GraphFile::ID_SPARSE);
+    if (a.offsets[n] != h.edgeCount || a.inOffsets[n] != h.edgeCount)
+      return "row offsets do not match the edge count";
+
+    nodeLabels = sectionAt<uint32_t>(GraphFile::NODE_LABELS);
+    nameEnds = sectionAt<uint64_t>(GraphFile::NAME_ENDS);
+    ArrayRef<char> names = sectionAt<char>(GraphFile::NAME_CHARS);
+    nameChars = names.data();
+    if ((n ? nameEnds[n - 1] : 0) != names.size())
+      return "name offsets do not match the name blob";
+    authority = sectionAt<float>(GraphFile::NODE_AUTHORITY);
+    stability = sectionAt<float>(GraphFile::NODE_STABILITY);
+    confidence = sectionAt<float>(GraphFile::EDGE_CONFIDENCE);
+    weights = sectionAt<float>(GraphFile::EDGE_WEIGHTS);
+    registry = sectionAt<uint32_t>(GraphFile::REGISTRY);
+
+    // Edge labels are the only strings materialized; there are a handful.
+    ArrayRef<uint32_t> labelEnds = sectionAt<uint32_t>(GraphFile::LABEL_ENDS);
+    ArrayRef<char> labelChars = sectionAt<char>(GraphFile::LABEL_CHARS);
+    std::vector<std::string> labels;
+    uint32_t begin = 0;
+    for (uint32_t end : labelEnds) {
+      if (end < begin || end > labelChars.size())
+        return "label table is malformed";
+      labels.emplace_back(labelChars.data() + begin, end - begin);
+      begin = end;
+    }
+    csr = CsrGraph::fromArrays(a, std::move(labels), region);
+    return "";
+  }
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class IdIndex
+ * @brief External uint64_t ID -> dense uint32_t index.
+ *
+ * EntityRegistry hands out sequential IDs, so most keys are small and dense:
+ * those are stored in a direct-mapped array (4 bytes per ID, one load per
+ * lookup). Sparse outliers fall back to a hash map so arbitrary IDs still
+ * work without blowing up the array.
+ */
+class IdIndex {
+public:
+  static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+  uint32_t find(uint64_t id) const {
+    if (id < direct.size())
+      return direct[id];
+    auto it = sparse.find(id);
+    return (it != sparse.end()) ? it->second : NONE;
+  }
+
+  bool contains(uint64_t id) const { return find(id) != NONE; }
+
+  /**
+   * @brief Inserts or overwrites the mapping for id.
+   */
+  void set(uint64_t id, uint32_t idx) {
+    // Grow the direct array while it stays reasonably dense.
+    if (id >= direct.size() && id < 2 * (count + 1) + 1024) {
+      size_t oldSize = direct.size();
+      direct.resize(std::max<uint64_t>(id + 1, oldSize * 3 / 2), NONE);
+      for (auto it = sparse.begin(); it != sparse.end();) {
+        if (it->first < direct.size()) {
+          direct[it->first] = it->second;
+          it = sparse.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+    bool fresh = !contains(id);
+    if (id < direct.size())
+      direct[id] = idx;
+    else
+      sparse[id] = idx;
+    if (fresh)
+      count++;
+  }
+
+  /**
+   * @brief Forgets the mapping for id, if any.
+   */
+  void erase(uint64_t id) {
+    if (id < direct.size()) {
+      if (direct[id] == NONE)
+        return;
+      direct[id] = NONE;
+    } else if (sparse.erase(id) == 0) {
+      return;
+    }
+    count--;
+  }
+
+  /**
+   * @brief Replaces the contents with IDs 1..n mapped to 0..n-1, the
+   * layout bulk loads produce.
+   */
+  void assignSequential(uint32_t n) {
+    direct.resize(size_t(n) + 1);
+    direct[0] = NONE;
+    for (uint32_t i = 0; i < n; ++i)
+      direct[i + 1] = i;
+    sparse.clear();
+    count = n;
+  }
+
+  void reserve(size_t n) { direct.reserve(n + 1); }
+  size_t size() const { return count; }
+
+  size_t bytes() const {
+    return direct.capacity() * sizeof(uint32_t) +
+           sparse.size() * (2 * sizeof(void *) + 2 * sizeof(uint64_t)) +
+           sparse.bucket_count() * sizeof(void *);
+  }
+
+private:
+  std::vector<uint32_t> direct;
+  std::unordered_map<uint64_t, uint32_t> sparse;
+  size_t count = 0;
+};
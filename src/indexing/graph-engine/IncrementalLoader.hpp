@@ -0,0 +1,196 @@
+#pragma once
+
+#include "GraphEngine.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class IncrementalLoader
+ * @brief Applies re-extracted chunks to the Knowledge Graph as edge deltas.
+ *
+ * Every edge remembers the chunk (docId) it was extracted from. When a
+ * chunk comes back changed, upsertChunk diffs its facts against what the
+ * chunk contributed last time: unchanged (source, relation, target)
+ * triples keep their edge ID, stale ones are removed and new ones added.
+ * Nodes are resolved through the EntityRegistry, so only entities that
+ * were never seen before are created. take() then reports which nodes the
+ * delta touched, which is what Leiden::update, TopologyFilter.py and
+ * DriftDetector.py need to recompute only the affected communities, and
+ * the next GraphEngine::snapshot() patches just the changed rows.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: A re-ingest that changes a handful of chunks costs a handful of
+ *   edge operations instead of a full index rebuild, and edge IDs of
+ *   surviving facts stay stable for PathCache and external references.
+ * - CON: The provenance map lives in memory (~40 bytes plus the relation
+ *   string per edge) and is not part of the GraphFile; a restarted process
+ *   must replay its chunks once before deltas are meaningful.
+ * - CON: Nodes are never deleted, even when their last edge goes; an
+ *   orphan node is harmless to traversals and keeps its ID if it returns.
+ */
+class IncrementalLoader {
+public:
+  /**
+   * @struct Fact
+   * @brief One extracted relationship, as SemanticExtractor.py emits it.
+   */
+  struct Fact {
+    std::string srcLabel;
+    std::string srcName;
+    std::string relation;
+    std::string tgtLabel;
+    std::string tgtName;
+    float confidence = std::nanf("");
+  };
+
+  /**
+   * @struct Delta
+   * @brief What changed since the previous take().
+   */
+  struct Delta {
+    size_t chunksUpserted = 0;
+    size_t chunksRemoved = 0;
+    size_t edgesAdded = 0;
+    size_t edgesUpdated = 0; // Same triple, new confidence
+    size_t edgesRemoved = 0;
+    size_t nodesAdded = 0;
+    // Sorted, unique IDs of the endpoints of added and removed edges.
+    std::vector<uint64_t> touchedNodes;
+  };
+
+  /**
+   * @param firstEdgeId New edges take consecutive IDs from here (see
+   * ChunkLoader::Result::nextEdgeId).
+   */
+  explicit IncrementalLoader(uint64_t firstEdgeId) : nextEdge(firstEdgeId) {}
+
+  /**
+   * @brief Makes the edges of `docId` exactly `facts`. A fact repeated
+   * within the chunk yields one edge with the last confidence.
+   */
+  void upsertChunk(const std::string &docId, const std::vector<Fact> &facts,
+                   GraphEngine &engine, EntityRegistry &registry) {
+    std::vector<OwnedEdge> next;
+    next.reserve(facts.size());
+    for (const Fact &f : facts) {
+      OwnedEdge e;
+      e.src = resolve(f.srcLabel, f.srcName, engine, registry);
+      e.tgt = resolve(f.tgtLabel, f.tgtName, engine, registry);
+      e.relation = f.relation;
+      e.confidence = f.confidence;
+      next.push_back(std::move(e));
+    }
+    // Reversed and stably sorted, so unique keeps the last of repeats.
+    std::reverse(next.begin(), next.end());
+    std::stable_sort(next.begin(), next.end(), byTriple);
+    next.erase(std::unique(next.begin(), next.end(), sameTriple), next.end());
+
+    std::vector<OwnedEdge> &previous = chunks[docId];
+    auto old = previous.begin();
+    for (OwnedEdge &e : next) {
+      for (; old != previous.end() && byTriple(*old, e); ++old)
+        drop(*old, engine);
+      if (old != previous.end() && sameTriple(*old, e)) {
+        e.edgeId = old->edgeId;
+        if (!sameBits(old->confidence, e.confidence)) {
+          engine.addEdge(e.edgeId, e.src, e.tgt, e.relation, e.confidence);
+          pending.edgesUpdated++;
+        }
+        ++old;
+        continue;
+      }
+      e.edgeId = nextEdge++;
+      engine.addEdge(e.edgeId, e.src, e.tgt, e.relation, e.confidence);
+      touch(e);
+      pending.edgesAdded++;
+    }
+    for (; old != previous.end(); ++old)
+      drop(*old, engine);
+    previous = std::move(next);
+    pending.chunksUpserted++;
+  }
+
+  /**
+   * @brief Removes every edge extracted from `docId`.
+   * @return false if the chunk was never upserted.
+   */
+  bool removeChunk(const std::string &docId, GraphEngine &engine) {
+    auto it = chunks.find(docId);
+    if (it == chunks.end())
+      return false;
+    for (const OwnedEdge &e : it->second)
+      drop(e, engine);
+    chunks.erase(it);
+    pending.chunksRemoved++;
+    return true;
+  }
+
+  /**
+   * @brief Returns the accumulated delta and starts a new one.
+   */
+  Delta take() {
+    std::sort(pending.touchedNodes.begin(), pending.touchedNodes.end());
+    pending.touchedNodes.erase(std::unique(pending.touchedNodes.begin(),
+                                           pending.touchedNodes.end()),
+                               pending.touchedNodes.end());
+    Delta d = std::move(pending);
+    pending = Delta();
+    return d;
+  }
+
+  size_t chunkCount() const { return chunks.size(); }
+  uint64_t nextEdgeId() const { return nextEdge; }
+
+private:
+  struct OwnedEdge {
+    uint64_t src = 0;
+    uint64_t tgt = 0;
+    std::string relation;
+    uint64_t edgeId = 0;
+    float confidence = 0;
+  };
+
+  std::unordered_map<std::string, std::vector<OwnedEdge>> chunks;
+  Delta pending;
+  uint64_t nextEdge;
+
+  static bool byTriple(const OwnedEdge &a, const OwnedEdge &b) {
+    return std::tie(a.src, a.tgt, a.relation) <
+           std::tie(b.src, b.tgt, b.relation);
+  }
+
+  static bool sameTriple(const OwnedEdge &a, const OwnedEdge &b) {
+    return a.src == b.src && a.tgt == b.tgt && a.relation == b.relation;
+  }
+
+  // NaN-aware: an unknown confidence that stays unknown is no change.
+  static bool sameBits(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+  }
+
+  uint64_t resolve(const std::string &label, const std::string &name,
+                   GraphEngine &engine, EntityRegistry &registry) {
+    bool created = false;
+    uint64_t id = registry.resolveNode(label, name, engine, &created);
+    pending.nodesAdded += created;
+    return id;
+  }
+
+  void drop(const OwnedEdge &e, GraphEngine &engine) {
+    engine.removeEdge(e.edgeId);
+    touch(e);
+    pending.edgesRemoved++;
+  }
+
+  void touch(const OwnedEdge &e) {
+    pending.touchedNodes.push_back(e.src);
+    pending.touchedNodes.push_back(e.tgt);
+  }
+};
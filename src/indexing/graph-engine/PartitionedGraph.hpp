@@ -0,0 +1,520 @@
+#pragma once
+
+#include "../data-preprocessing/Instrumentation.hpp"
+#include "../data-preprocessing/ParallelFor.hpp"
+#include "CsrGraph.hpp"
+#include "IdIndex.hpp"
+#include "PathSearch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class PartitionedGraph
+ * @brief A CsrGraph snapshot split into shards, each holding only the
+ * out-rows of the nodes it owns, searched by exchanging frontiers.
+ *
+ * PLACEMENT:
+ * - assignByCommunity packs Leiden communities onto shards, largest first
+ *   onto the least loaded shard, so causal chains mostly stay on one
+ *   shard. A community that does not fit that shard's remaining room fills
+ *   it and spills, in node order, onto the next least loaded.
+ *   assignByHash is the random baseline.
+ * - Bridge nodes (BridgeIdentifier.py's inter-community connectors, or
+ *   bridgeNodes() here) are replicated: every shard that owns a neighbor of
+ *   a bridge also holds the bridge's out-row. A search reaching the bridge
+ *   keeps expanding locally instead of handing the bridge to its owner and
+ *   getting its neighbors handed back.
+ *
+ * SEARCH:
+ * Searches are level-synchronous BFS in supersteps. Each shard expands
+ * its part of the frontier; a neighbor it can resolve (owned or replicated)
+ * is marked locally, every other neighbor becomes a message to its owner.
+ * Messages are batched per (sender, receiver) pair and delivered once per
+ * superstep, where receivers mark and enqueue the new nodes. Every mark
+ * remembers the shard that expanded the parent, so paths are unwound
+ * across shards afterwards. A node reached first at level d is reported
+ * with depth d even if a replica saw it too, so results are fewest-hop
+ * paths like PathSearch::explainAll.
+ *
+ * The shards share nothing but the routing table (owner and shard-local
+ * index of every node, ~20 bytes per node) and the per-superstep batches,
+ * which are exactly what a process-per-shard deployment sends over its
+ * transport.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: A shard's memory is its rows plus the routing table, and with
+ *   community placement most expansions produce no message at all.
+ * - CON: The exchange here is in-process (shards are threads); the
+ *   batches are laid out for a socket or MPI transport, but none is wired.
+ * - CON: Searches are one-sided. Bidirectional meet detection would need
+ *   the owner to hear about every replica mark, which is the traffic
+ *   replication saves.
+ * - CON: A bridge reached on several shards in the same superstep is
+ *   expanded on each of them, so replicas trade fewer crossings on the
+ *   paths for some duplicate messages. Replicate the top bridges only.
+ * - CON: Partitioning is static; rebuild the shards after re-clustering.
+ */
+class PartitionedGraph {
+public:
+  static constexpr uint32_t NONE = CsrGraph::NO_NODE;
+
+  struct Options {
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  };
+
+  /**
+   * @struct Stats
+   * @brief Work done by the last search.
+   */
+  struct Stats {
+    uint64_t supersteps = 0; // Frontier exchanges
+    uint64_t messages = 0;   // Nodes handed to another shard
+    uint64_t batches = 0;    // Non-empty (sender, receiver) batches
+    uint64_t expanded = 0;   // Rows scanned, over all shards
+    uint64_t pathHops = 0;   // Edges on the returned paths
+    uint64_t crossHops = 0;  // ... whose endpoints sat on different shards
+  };
+
+  /**
+   * @brief Owner shard per dense node: communities of `membership` (e.g.
+   * Leiden's micro_community level), largest first, each onto the least
+   * loaded shard. A shard takes at most (1 + slack) times its share of the
+   * nodes; a community that overflows it spills onto the next least loaded.
+   */
+  static std::vector<uint16_t>
+  assignByCommunity(const std::vector<uint32_t> &membership, size_t shards,
+                    double slack = 0.05) {
+    shards = std::max<size_t>(1, std::min<size_t>(shards, MAX_SHARDS));
+    const size_t n = membership.size();
+    uint32_t bound = 0;
+    for (uint32_t c : membership)
+      bound = std::max(bound, c + 1);
+    std::vector<uint32_t> start(bound + 1, 0), members(n);
+    for (uint32_t c : membership)
+      start[c + 1]++;
+    for (uint32_t c = 0; c < bound; ++c)
+      start[c + 1] += start[c];
+    std::vector<uint32_t> cursor(start.begin(), start.end() - 1);
+    for (uint32_t v = 0; v < n; ++v)
+      members[cursor[membership[v]]++] = v;
+    std::vector<uint32_t> order(bound);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+      return start[a + 1] - start[a] > start[b + 1] - start[b];
+    });
+
+    const size_t capacity = static_cast<size_t>(
+        double(n) / double(shards) * (1.0 + slack)) + 1;
+    std::vector<size_t> load(shards, 0);
+    std::vector<uint16_t> owner(n, 0);
+    auto lightest = [&] {
+      return static_cast<uint16_t>(
+          std::min_element(load.begin(), load.end()) - load.begin());
+    };
+    for (uint32_t c : order) {
+      uint32_t i = start[c];
+      while (i < start[c + 1]) { // Fill the lightest, spill the rest
+        const uint16_t s = lightest();
+        const size_t room = capacity > load[s] ? capacity - load[s] : 1;
+        const uint32_t last = static_cast<uint32_t>(
+            std::min<size_t>(start[c + 1], i + room));
+        load[s] += last - i;
+        for (; i < last; ++i)
+          owner[members[i]] = s;
+      }
+    }
+    return owner;
+  }
+
+  /**
+   * @brief The random baseline: owner shard from a hash of the node ID.
+   */
+  static std::vector<uint16_t> assignByHash(const CsrGraph &g,
+                                            size_t shards) {
+    shards = std::max<size_t>(1, std::min<size_t>(shards, MAX_SHARDS));
+    std::vector<uint16_t> owner(g.nodeCount());
+    for (uint32_t v = 0; v < g.nodeCount(); ++v)
+      owner[v] = static_cast<uint16_t>(mix(g.nodeIdAt(v)) % shards);
+    return owner;
+  }
+
+  /**
+   * @brief BridgeIdentifier.py's score in C++: the `limit` nodes with the
+   * most edges into other communities of `membership`, best first.
+   */
+  static std::vector<uint32_t>
+  bridgeNodes(const CsrGraph &g, const std::vector<uint32_t> &membership,
+              size_t limit) {
+    std::vector<uint32_t> score(g.nodeCount(), 0);
+    for (uint32_t u = 0; u < g.nodeCount(); ++u)
+      for (uint64_t p = g.outBegin(u); p < g.outEnd(u); ++p) {
+        const uint32_t v = g.neighborAt(p);
+        if (membership[u] != membership[v]) {
+          score[u]++;
+          score[v]++;
+        }
+      }
+    std::vector<uint32_t> nodes;
+    for (uint32_t v = 0; v < g.nodeCount(); ++v)
+      if (score[v] > 0)
+        nodes.push_back(v);
+    limit = std::min(limit, nodes.size());
+    std::partial_sort(nodes.begin(), nodes.begin() + limit, nodes.end(),
+                      [&](uint32_t a, uint32_t b) {
+                        return score[a] != score[b] ? score[a] > score[b]
+                                                    : a < b;
+                      });
+    nodes.resize(limit);
+    return nodes;
+  }
+
+  /**
+   * @brief Splits `g` by `owner` (one shard ID per node) and replicates
+   * the `bridges` (dense indices) onto the shards of their neighbors.
+   */
+  PartitionedGraph(const CsrGraph &g, std::vector<uint16_t> owner,
+                   const std::vector<uint32_t> &bridges, Options options)
+      : opts(options), owner(std::move(owner)) {
+    opts.threads = std::max<size_t>(1, opts.threads);
+    const size_t n = g.nodeCount();
+    size_t count = 1;
+    for (uint16_t s : this->owner)
+      count = std::max<size_t>(count, s + 1u);
+    shards.resize(count);
+    nodeIds.resize(n);
+    localIndex.resize(n);
+    replicated.assign(n, 0);
+    for (uint32_t v = 0; v < n; ++v) {
+      Shard &s = shards[this->owner[v]];
+      localIndex[v] = static_cast<uint32_t>(s.global.size());
+      s.global.push_back(v);
+      nodeIds[v] = g.nodeIdAt(v);
+      index.set(g.nodeIdAt(v), v);
+    }
+    for (Shard &s : shards)
+      s.owned = static_cast<uint32_t>(s.global.size());
+
+    // A bridge goes to every shard owning one of its neighbors.
+    for (uint32_t b : bridges) {
+      if (b >= n || replicated[b])
+        continue;
+      replicated[b] = 1;
+      auto place = [&](uint32_t v) {
+        const uint16_t s = this->owner[v];
+        if (s == this->owner[b] || shards[s].replicaLocal.count(b))
+          return;
+        shards[s].replicaLocal.emplace(
+            b, static_cast<uint32_t>(shards[s].global.size()));
+        shards[s].global.push_back(b);
+      };
+      for (uint64_t p = g.outBegin(b); p < g.outEnd(b); ++p)
+        place(g.neighborAt(p));
+      for (uint64_t r = g.inBegin(b); r < g.inEnd(b); ++r)
+        place(g.inNeighborAt(r));
+    }
+
+    ParallelFor::run<1>(count, opts.threads, [&](size_t sid) {
+      Shard &s = shards[sid];
+      s.offsets.assign(s.global.size() + 1, 0);
+      for (size_t l = 0; l < s.global.size(); ++l)
+        s.offsets[l + 1] =
+            s.offsets[l] + g.outEnd(s.global[l]) - g.outBegin(s.global[l]);
+      s.neighbors.resize(s.offsets.back());
+      for (size_t l = 0; l < s.global.size(); ++l)
+        std::copy(g.neighborData() + g.outBegin(s.global[l]),
+                  g.neighborData() + g.outEnd(s.global[l]),
+                  s.neighbors.begin() + s.offsets[l]);
+      s.outbox.resize(shards.size());
+      for (uint32_t l = 0; l < s.owned; ++l)
+        for (uint64_t p = s.offsets[l]; p < s.offsets[l + 1]; ++p)
+          s.cut += resolve(static_cast<uint16_t>(sid), s.neighbors[p]) ==
+                   NONE;
+    });
+  }
+
+  PartitionedGraph(const CsrGraph &g, std::vector<uint16_t> owner,
+                   const std::vector<uint32_t> &bridges)
+      : PartitionedGraph(g, std::move(owner), bridges, Options()) {}
+
+  size_t shardCount() const { return shards.size(); }
+  size_t nodeCount() const { return owner.size(); }
+  uint16_t ownerOf(uint32_t v) const { return owner[v]; }
+
+  /**
+   * @brief Nodes held by shard s, replicas included.
+   */
+  size_t shardNodes(size_t s) const { return shards[s].global.size(); }
+  size_t shardReplicas(size_t s) const {
+    return shards[s].global.size() - shards[s].owned;
+  }
+  size_t shardEdges(size_t s) const { return shards[s].neighbors.size(); }
+
+  /**
+   * @brief Edges of owned rows whose target the shard cannot resolve
+   * itself, i.e. that cost a message when a search crosses them.
+   */
+  size_t crossShardEdges() const {
+    size_t total = 0;
+    for (const Shard &s : shards)
+      total += s.cut;
+    return total;
+  }
+
+  /**
+   * @brief Fewest-hop path from startId to endId (external IDs), or empty
+   * if unreachable.
+   */
+  std::vector<uint64_t> findPath(uint64_t startId, uint64_t endId) {
+    RCA_SPAN("PartitionedGraph::findPath");
+    auto chains = explainSymptoms({startId}, {endId});
+    return std::move(chains[0].path);
+  }
+
+  /**
+   * @brief GraphEngine::explainSymptoms over the shards: one shared
+   * multi-source BFS from every cause, stopping once every symptom has
+   * been reached.
+   * @return One chain per symptom, in input order (empty if unexplained).
+   */
+  std::vector<PathSearch::CausalChain>
+  explainSymptoms(const std::vector<uint64_t> &causeIds,
+                  const std::vector<uint64_t> &symptomIds) {
+    RCA_SPAN("PartitionedGraph::explainSymptoms");
+    stats = Stats();
+    std::vector<PathSearch::CausalChain> chains(symptomIds.size());
+    for (Shard &s : shards) {
+      s.marks.begin(s.global.size());
+      s.wanted.begin(s.global.size());
+      s.parentShard.resize(s.global.size());
+      s.frontier.clear();
+    }
+
+    // Symptoms are wanted on every shard that can mark them.
+    std::vector<uint32_t> symptoms;
+    size_t remaining = 0;
+    for (size_t i = 0; i < symptomIds.size(); ++i) {
+      chains[i].symptomId = symptomIds[i];
+      const uint32_t v = index.find(symptomIds[i]);
+      symptoms.push_back(v);
+      if (v == IdIndex::NONE)
+        continue;
+      bool fresh = false;
+      forEachCopy(v, [&](Shard &s, uint32_t l) {
+        fresh |= !s.wanted.seen(l);
+        s.wanted.mark(l, 0, 0);
+      });
+      remaining += fresh;
+    }
+    std::unordered_map<uint32_t, uint8_t> found; // Symptoms reached so far
+    for (uint64_t id : causeIds) {
+      const uint32_t v = index.find(id);
+      if (v == IdIndex::NONE)
+        continue;
+      Shard &s = shards[owner[v]];
+      const uint32_t l = localIndex[v];
+      if (s.marks.seen(l))
+        continue;
+      s.marks.mark(l, v, 0);
+      s.parentShard[l] = owner[v];
+      s.frontier.push_back(l);
+      if (s.wanted.seen(l) && found.emplace(v, 1).second)
+        remaining--;
+    }
+
+    for (uint32_t level = 0;; ++level) {
+      size_t active = 0;
+      for (const Shard &s : shards)
+        active += s.frontier.size();
+      if (active == 0 || remaining == 0)
+        break;
+      stats.supersteps++;
+      // Expand: local neighbors are marked at once, the rest are batched.
+      ParallelFor::run<1>(shards.size(), opts.threads,
+                          [&](size_t sid) { expand(sid); });
+      // Exchange: each shard drains the batches addressed to it.
+      ParallelFor::run<1>(shards.size(), opts.threads,
+                          [&](size_t sid) { deliver(sid, level); });
+      for (Shard &s : shards) {
+        stats.expanded += s.expanded;
+        stats.messages += s.received;
+        stats.batches += s.batches;
+        s.expanded = s.received = s.batches = 0;
+        for (uint32_t l : s.hits)
+          if (found.emplace(s.global[l], 1).second)
+            remaining--;
+        s.hits.clear();
+        s.frontier.swap(s.next);
+        s.next.clear();
+      }
+    }
+
+    for (size_t i = 0; i < symptoms.size(); ++i)
+      if (symptoms[i] != IdIndex::NONE)
+        unwind(symptoms[i], chains[i]);
+    return chains;
+  }
+
+  const Stats &lastStats() const { return stats; }
+
+private:
+  static constexpr size_t MAX_SHARDS = std::numeric_limits<uint16_t>::max();
+
+  /**
+   * @struct Message
+   * @brief "Node is reached from parent", sent to the node's owner.
+   */
+  struct Message {
+    uint32_t node;
+    uint32_t parent;
+  };
+
+  /**
+   * @struct Shard
+   * @brief One shard's rows and search state. Local index l is global[l];
+   * owned nodes come first, replicas after.
+   */
+  struct Shard {
+    std::vector<uint32_t> global;
+    uint32_t owned = 0;
+    std::unordered_map<uint32_t, uint32_t> replicaLocal;
+    std::vector<uint64_t> offsets{0};
+    std::vector<uint32_t> neighbors; // Global dense indices
+    size_t cut = 0;
+
+    VisitMarks marks;  // Parent as a global index
+    VisitMarks wanted; // Symptoms held here
+    std::vector<uint16_t> parentShard;
+    std::vector<uint32_t> frontier;
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> hits; // Wanted nodes marked this superstep
+    std::vector<std::vector<Message>> outbox; // Per receiver
+    uint64_t expanded = 0, received = 0, batches = 0;
+  };
+
+  Options opts;
+  std::vector<uint16_t> owner;      // Routing table: global -> shard
+  std::vector<uint32_t> localIndex; // ... and -> index on that shard
+  std::vector<uint8_t> replicated;
+  std::vector<uint64_t> nodeIds;
+  IdIndex index;
+  std::vector<Shard> shards;
+  Stats stats;
+
+  static uint64_t mix(uint64_t x) { // splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  /**
+   * @brief Local index of global node v on shard s, or NONE if s holds
+   * neither v nor a replica of it.
+   */
+  uint32_t resolve(uint16_t s, uint32_t v) const {
+    if (owner[v] == s)
+      return localIndex[v];
+    if (!replicated[v])
+      return NONE;
+    auto it = shards[s].replicaLocal.find(v);
+    return it != shards[s].replicaLocal.end() ? it->second : NONE;
+  }
+
+  template <typename Fn> void forEachCopy(uint32_t v, const Fn &fn) {
+    fn(shards[owner[v]], localIndex[v]);
+    if (replicated[v])
+      for (Shard &s : shards)
+        if (auto it = s.replicaLocal.find(v); it != s.replicaLocal.end())
+          fn(s, it->second);
+  }
+
+  void visit(Shard &s, uint32_t l, uint32_t parent, uint16_t from,
+             uint32_t depth) {
+    s.marks.mark(l, parent, depth);
+    s.parentShard[l] = from;
+    s.next.push_back(l);
+    if (s.wanted.seen(l))
+      s.hits.push_back(l);
+  }
+
+  void expand(size_t sid) {
+    Shard &s = shards[sid];
+    const uint16_t me = static_cast<uint16_t>(sid);
+    for (uint32_t l : s.frontier) {
+      const uint32_t u = s.global[l], d = s.marks.depthOf(l) + 1;
+      s.expanded++;
+      for (uint64_t p = s.offsets[l]; p < s.offsets[l + 1]; ++p) {
+        const uint32_t v = s.neighbors[p];
+        const uint32_t local = resolve(me, v);
+        if (local == NONE) {
+          s.outbox[owner[v]].push_back({v, u});
+          continue;
+        }
+        if (!s.marks.seen(local))
+          visit(s, local, u, me, d);
+      }
+    }
+  }
+
+  /**
+   * @brief Marks the nodes other shards sent to sid. They were found
+   * expanding `level`, so they sit one below it.
+   */
+  void deliver(size_t sid, uint32_t level) {
+    Shard &s = shards[sid];
+    for (size_t from = 0; from < shards.size(); ++from) {
+      std::vector<Message> &batch = shards[from].outbox[sid];
+      if (batch.empty())
+        continue;
+      s.batches++;
+      s.received += batch.size();
+      for (const Message &m : batch) {
+        const uint32_t l = localIndex[m.node];
+        if (!s.marks.seen(l))
+          visit(s, l, m.parent, static_cast<uint16_t>(from), level + 1);
+      }
+      batch.clear();
+    }
+  }
+
+  /**
+   * @brief Fills chain with the path to symptom v, following parents
+   * across shards from the shallowest copy of v that was reached.
+   */
+  void unwind(uint32_t v, PathSearch::CausalChain &chain) {
+    uint16_t at = owner[v];
+    uint32_t l = NONE, depth = std::numeric_limits<uint32_t>::max();
+    forEachCopy(v, [&](Shard &s, uint32_t local) {
+      if (s.marks.seen(local) && s.marks.depthOf(local) < depth) {
+        depth = s.marks.depthOf(local);
+        at = static_cast<uint16_t>(&s - shards.data());
+        l = local;
+      }
+    });
+    if (l == NONE)
+      return;
+    std::vector<uint64_t> &path = chain.path;
+    for (;;) {
+      const Shard &s = shards[at];
+      path.push_back(nodeIds[v]);
+      if (s.marks.depthOf(l) == 0)
+        break;
+      const uint16_t from = s.parentShard[l];
+      stats.pathHops++;
+      stats.crossHops += from != at;
+      v = s.marks.parentOf(l);
+      at = from;
+      l = resolve(at, v);
+    }
+    std::reverse(path.begin(), path.end());
+    chain.rootCauseId = path.front();
+  }
+};
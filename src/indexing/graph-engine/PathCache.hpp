@@ -0,0 +1,435 @@
+#pragma once
+
+#include "ConcurrentGraph.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class PathCache
+ * @brief Bounded, concurrent cache of findPath / rankCausalPaths results
+ * over a ConcurrentGraph.
+ *
+ * Entries are keyed by endpoints plus k and the label filter, and tagged
+ * with the snapshot version they were computed on. The first lookup that
+ * pins a newer version replays that version's ConcurrentGraph::ChangeSet
+ * and drops only the entries it could have changed:
+ * - a replaced edge that lies on a cached path;
+ * - a newly declared start or end node (it may now resolve);
+ * - an added edge u -> v whose best route s -> u -> v -> t costs no more
+ *   than the cached answer. One multi-source search back from all
+ *   changed u and one forward from all changed v give every entry's
+ *   route cost at once. That cost is in hops for findPath and in edge
+ *   weights for rankCausalPaths (up to the k-th path, or anything
+ *   reachable if fewer than k were found).
+ * - withWriter(), an oversized publish, or a gap longer than the change
+ *   log flushes everything.
+ *
+ * The distance test ignores label filters and pairs changed endpoints
+ * across edges, so it may drop an entry that was still valid but never
+ * keeps a stale one. Eviction is CLOCK per shard.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: Hot (cause, symptom) pairs survive ingestion that happens far
+ *   from their paths, which flushing on every publish would not allow.
+ * - CON: The first lookup after a publish does the invalidation pass
+ *   (two bounded searches per query kind plus a scan of the entries) and
+ *   holds lookups off meanwhile.
+ * - CON: Results computed on an older pinned snapshot than the cache has
+ *   seen are returned but not stored.
+ */
+class PathCache {
+public:
+  struct Options {
+    size_t capacity = 1 << 16;   // Entries over all shards
+    size_t shards = 16;
+    size_t maxChanges = 1 << 16; // A bigger publish flushes instead
+  };
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t invalidated = 0; // Dropped by a change that could affect them
+    uint64_t evicted = 0;
+    uint64_t flushes = 0;
+
+    double hitRate() const {
+      uint64_t lookups = hits + misses;
+      return lookups ? static_cast<double>(hits) / lookups : 0.0;
+    }
+  };
+
+  explicit PathCache(const ConcurrentGraph &graph)
+      : PathCache(graph, Options()) {}
+
+  PathCache(const ConcurrentGraph &graph, Options options)
+      : graph(graph), opts(options) {
+    opts.shards = std::max<size_t>(1, opts.shards);
+    shardCapacity = std::max<size_t>(1, opts.capacity / opts.shards);
+    shards.reset(new Shard[opts.shards]);
+  }
+
+  PathCache(const PathCache &) = delete;
+  PathCache &operator=(const PathCache &) = delete;
+
+  /**
+   * @brief Cached ConcurrentGraph::ReadView::findPath.
+   */
+  std::vector<uint64_t> findPath(const ConcurrentGraph::ReadView &view,
+                                 uint64_t startId, uint64_t endId) {
+    return lookup(view, Key{startId, endId, 0, {}}, &Entry::path,
+                  [&](double &bound) {
+                    std::vector<uint64_t> path = view.findPath(startId, endId);
+                    bound = path.empty() ? INF : double(path.size() - 1);
+                    return path;
+                  });
+  }
+
+  /**
+   * @brief Cached ConcurrentGraph::ReadView::rankCausalPaths.
+   */
+  std::vector<RankedPathSearch::CredibleChain>
+  rankCausalPaths(const ConcurrentGraph::ReadView &view, uint64_t causeId,
+                  uint64_t symptomId, size_t k,
+                  const std::vector<std::string> &labels = {}) {
+    if (k == 0)
+      return {};
+    Key key{causeId, symptomId, static_cast<uint32_t>(k), {}};
+    for (const std::string &label : labels)
+      key.labels.append(label).push_back('\n');
+    return lookup(view, std::move(key), &Entry::chains, [&](double &bound) {
+      auto chains = view.rankCausalPaths(causeId, symptomId, k, labels);
+      bound = chains.size() < k ? INF : -std::log(chains.back().credibility);
+      return chains;
+    });
+  }
+
+  Stats stats() const {
+    Stats s;
+    s.hits = hits.load(std::memory_order_relaxed);
+    s.misses = misses.load(std::memory_order_relaxed);
+    s.invalidated = invalidated.load(std::memory_order_relaxed);
+    s.evicted = evicted.load(std::memory_order_relaxed);
+    s.flushes = flushes.load(std::memory_order_relaxed);
+    return s;
+  }
+
+  size_t size() const {
+    std::shared_lock<std::shared_mutex> lock(syncMutex);
+    size_t n = 0;
+    for (size_t i = 0; i < opts.shards; ++i) {
+      std::lock_guard<std::mutex> shardLock(shards[i].mutex);
+      n += shards[i].index.size();
+    }
+    return n;
+  }
+
+private:
+  static constexpr double INF = std::numeric_limits<double>::infinity();
+  // Absorbs rounding between summed float weights and -log(credibility).
+  static constexpr double SLACK = 1e-6;
+
+  struct Key {
+    uint64_t start;
+    uint64_t end;
+    uint32_t k;         // 0 for findPath
+    std::string labels; // Filter labels, each followed by '\n'
+
+    bool operator==(const Key &o) const {
+      return start == o.start && end == o.end && k == o.k &&
+             labels == o.labels;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const {
+      uint64_t h = key.start * 0x9E3779B97F4A7C15ull;
+      h ^= key.end + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+      h ^= key.k + (h << 6) + (h >> 2);
+      return static_cast<size_t>(h ^ std::hash<std::string>{}(key.labels));
+    }
+  };
+
+  struct Entry {
+    Key key;
+    uint64_t version = 0; // Snapshot the result was computed on
+    double bound = 0.0;   // A new route costing at most this may change it
+    std::vector<uint64_t> path;
+    std::vector<RankedPathSearch::CredibleChain> chains;
+    bool referenced = false;
+    bool live = false;
+  };
+
+  struct alignas(64) Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<Key, uint32_t, KeyHash> index; // Key -> slot
+    std::vector<Entry> slots;
+    size_t hand = 0;
+  };
+
+  const ConcurrentGraph &graph;
+  Options opts;
+  size_t shardCapacity;
+  std::unique_ptr<Shard[]> shards;
+
+  // Lookups share it; an invalidation pass takes it exclusively.
+  mutable std::shared_mutex syncMutex;
+  std::atomic<uint64_t> synced{0}; // Every entry is valid up to here
+
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+  std::atomic<uint64_t> invalidated{0};
+  std::atomic<uint64_t> evicted{0};
+  std::atomic<uint64_t> flushes{0};
+
+  // Invalidation scratch, guarded by the exclusive syncMutex.
+  std::vector<std::shared_ptr<const ConcurrentGraph::ChangeSet>> changes;
+  std::vector<double> toChangedHops, fromChangedHops;
+  std::vector<double> toChangedCost, fromChangedCost;
+  std::vector<std::pair<double, uint32_t>> heap;
+
+  Shard &shardOf(const Key &key) {
+    return shards[KeyHash{}(key) % opts.shards];
+  }
+
+  template <typename T, typename Compute>
+  T lookup(const ConcurrentGraph::ReadView &view, Key key, T Entry::*field,
+           Compute &&compute) {
+    const uint64_t version = view.version();
+    if (version > synced.load(std::memory_order_acquire))
+      sync(view.snapshot());
+    Shard &shard = shardOf(key);
+    {
+      std::shared_lock<std::shared_mutex> lock(syncMutex);
+      std::lock_guard<std::mutex> shardLock(shard.mutex);
+      auto it = shard.index.find(key);
+      // Valid for [entry version, synced], and synced >= version here.
+      if (it != shard.index.end() &&
+          shard.slots[it->second].version <= version) {
+        Entry &e = shard.slots[it->second];
+        e.referenced = true;
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return e.*field;
+      }
+    }
+    misses.fetch_add(1, std::memory_order_relaxed);
+
+    double bound = 0.0;
+    T value = compute(bound);
+    std::shared_lock<std::shared_mutex> lock(syncMutex);
+    // Changes after `version` were replayed without this entry.
+    if (version == synced.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> shardLock(shard.mutex);
+      Entry &e = shard.slots[claimSlot(shard, key)];
+      e.version = version;
+      e.bound = bound;
+      e.*field = value;
+    }
+    return value;
+  }
+
+  /**
+   * @brief Returns the live slot for key, reusing an existing one or
+   * sweeping the CLOCK hand past recently referenced entries.
+   */
+  uint32_t claimSlot(Shard &s, const Key &key) {
+    auto it = s.index.find(key);
+    if (it != s.index.end())
+      return it->second;
+    uint32_t slot;
+    if (s.slots.size() < shardCapacity) {
+      slot = static_cast<uint32_t>(s.slots.size());
+      s.slots.emplace_back();
+    } else {
+      for (;; s.hand = (s.hand + 1) % s.slots.size()) {
+        Entry &e = s.slots[s.hand];
+        if (!e.live)
+          break;
+        if (!e.referenced) {
+          s.index.erase(e.key);
+          evicted.fetch_add(1, std::memory_order_relaxed);
+          break;
+        }
+        e.referenced = false;
+      }
+      slot = static_cast<uint32_t>(s.hand);
+      s.hand = (s.hand + 1) % s.slots.size();
+    }
+    Entry &e = s.slots[slot];
+    e = Entry();
+    e.key = key;
+    e.live = true;
+    s.index.emplace(key, slot);
+    return slot;
+  }
+
+  void drop(Shard &s, Entry &e) {
+    s.index.erase(e.key);
+    e = Entry();
+  }
+
+  void sync(const GraphSnapshot &snap) {
+    std::unique_lock<std::shared_mutex> lock(syncMutex);
+    const uint64_t from = synced.load(std::memory_order_relaxed);
+    if (snap.version <= from)
+      return; // Another lookup got here first
+    changes.clear();
+    bool flush = !graph.changesSince(from, snap.version, changes);
+    size_t total = 0;
+    for (const auto &c : changes) {
+      flush |= c->rewritten;
+      total += c->declaredNodes.size() + c->addedEdges.size() +
+               c->replacedEdges.size();
+    }
+    if (flush || total > opts.maxChanges) {
+      for (size_t i = 0; i < opts.shards; ++i) {
+        shards[i].index.clear();
+        shards[i].slots.clear();
+        shards[i].hand = 0;
+      }
+      flushes.fetch_add(1, std::memory_order_relaxed);
+    } else if (total > 0) {
+      invalidate(snap);
+    }
+    changes.clear();
+    synced.store(snap.version, std::memory_order_release);
+  }
+
+  void invalidate(const GraphSnapshot &snap) {
+    const CsrGraph &g = *snap.csr;
+    std::vector<uint64_t> declared;
+    std::vector<std::pair<uint64_t, uint64_t>> replaced;
+    std::vector<uint32_t> sources, targets;
+    for (const auto &c : changes) {
+      declared.insert(declared.end(), c->declaredNodes.begin(),
+                      c->declaredNodes.end());
+      replaced.insert(replaced.end(), c->replacedEdges.begin(),
+                      c->replacedEdges.end());
+      for (const auto &[src, tgt] : c->addedEdges) {
+        uint32_t u = g.indexOfNode(src), v = g.indexOfNode(tgt);
+        if (u != CsrGraph::NO_NODE && v != CsrGraph::NO_NODE) {
+          sources.push_back(u);
+          targets.push_back(v);
+        }
+      }
+    }
+    std::sort(declared.begin(), declared.end());
+    std::sort(replaced.begin(), replaced.end());
+
+    // Only search as far as the most expensive entry of each kind cares.
+    double hopReach = -1.0, costReach = -1.0;
+    forEachLive([&](Shard &, Entry &e) {
+      double &reach = e.key.k ? costReach : hopReach;
+      reach = std::max(reach, e.bound);
+    });
+    if (!sources.empty() && hopReach >= 0.0) {
+      nearest(g, nullptr, sources, true, hopReach, toChangedHops);
+      nearest(g, nullptr, targets, false, hopReach, fromChangedHops);
+    }
+    if (!sources.empty() && costReach >= 0.0) {
+      nearest(g, snap.weights->data(), sources, true, costReach + SLACK,
+              toChangedCost);
+      nearest(g, snap.weights->data(), targets, false, costReach + SLACK,
+              fromChangedCost);
+    }
+
+    forEachLive([&](Shard &s, Entry &e) {
+      if (std::binary_search(declared.begin(), declared.end(), e.key.start) ||
+          std::binary_search(declared.begin(), declared.end(), e.key.end) ||
+          usesReplaced(e, replaced) ||
+          (!sources.empty() && reroutable(g, e))) {
+        drop(s, e);
+        invalidated.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+
+  template <typename Fn> void forEachLive(Fn &&fn) {
+    for (size_t i = 0; i < opts.shards; ++i)
+      for (Entry &e : shards[i].slots)
+        if (e.live)
+          fn(shards[i], e);
+  }
+
+  static bool
+  usesReplaced(const Entry &e,
+               const std::vector<std::pair<uint64_t, uint64_t>> &replaced) {
+    if (replaced.empty())
+      return false;
+    auto onPath = [&](const std::vector<uint64_t> &nodes) {
+      for (size_t i = 0; i + 1 < nodes.size(); ++i)
+        if (std::binary_search(replaced.begin(), replaced.end(),
+                               std::make_pair(nodes[i], nodes[i + 1])))
+          return true;
+      return false;
+    };
+    if (onPath(e.path))
+      return true;
+    for (const auto &chain : e.chains)
+      if (onPath(chain.nodeIds))
+        return true;
+    return false;
+  }
+
+  /**
+   * @brief True if some added edge u -> v gives start -> u -> v -> end a
+   * cost within the entry's bound (hops count the edge itself; weighted
+   * routes assume it is free).
+   */
+  bool reroutable(const CsrGraph &g, const Entry &e) const {
+    uint32_t s = g.indexOfNode(e.key.start), t = g.indexOfNode(e.key.end);
+    if (s == CsrGraph::NO_NODE || t == CsrGraph::NO_NODE)
+      return false;
+    double route = e.key.k == 0
+                       ? toChangedHops[s] + 1.0 + fromChangedHops[t]
+                       : toChangedCost[s] + fromChangedCost[t] - SLACK;
+    return route != INF && route <= e.bound;
+  }
+
+  /**
+   * @brief Multi-source Dijkstra, cut off at `reach`. With reverse set,
+   * dist[x] is the cheapest x -> seed cost over in-edges; otherwise the
+   * cheapest seed -> x cost. A null weights array counts hops.
+   */
+  void nearest(const CsrGraph &g, const float *weights,
+               const std::vector<uint32_t> &seeds, bool reverse, double reach,
+               std::vector<double> &dist) {
+    dist.assign(g.nodeCount(), INF);
+    heap.clear();
+    auto push = [&](double d, uint32_t x) {
+      dist[x] = d;
+      heap.push_back({d, x});
+      std::push_heap(heap.begin(), heap.end(), std::greater<>());
+    };
+    for (uint32_t x : seeds)
+      if (dist[x] > 0.0)
+        push(0.0, x);
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+      auto [d, u] = heap.back();
+      heap.pop_back();
+      if (d > dist[u])
+        continue;
+      uint64_t begin = reverse ? g.inBegin(u) : g.outBegin(u);
+      uint64_t end = reverse ? g.inEnd(u) : g.outEnd(u);
+      for (uint64_t r = begin; r < end; ++r) {
+        uint64_t pos = reverse ? g.inEdgePosAt(r) : r;
+        uint32_t x = reverse ? g.inNeighborAt(r) : g.neighborAt(r);
+        double nd = d + (weights ? weights[pos] : 1.0);
+        if (nd <= reach && nd < dist[x])
+          push(nd, x);
+      }
+    }
+  }
+};
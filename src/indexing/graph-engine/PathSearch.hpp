@@ -0,0 +1,283 @@
+#pragma once
+
+#include "CsrGraph.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * @class VisitMarks
+ * @brief Epoch-stamped visited/parent/depth arrays, reused across searches.
+ *
+ * begin() bumps the epoch instead of clearing, so starting a new search is
+ * O(1) rather than O(N) or a fresh hash map per call. The arrays are only
+ * wiped when the 32-bit epoch wraps.
+ */
+class VisitMarks {
+public:
+  void begin(size_t nodeCount) {
+    if (stamp.size() < nodeCount) {
+      stamp.resize(nodeCount, 0);
+      parent.resize(nodeCount);
+      depth.resize(nodeCount);
+    }
+    if (++epoch == 0) {
+      std::fill(stamp.begin(), stamp.end(), 0);
+      epoch = 1;
+    }
+  }
+
+  bool seen(uint32_t idx) const { return stamp[idx] == epoch; }
+
+  void mark(uint32_t idx, uint32_t from, uint32_t d) {
+    stamp[idx] = epoch;
+    parent[idx] = from;
+    depth[idx] = d;
+  }
+
+  uint32_t parentOf(uint32_t idx) const { return parent[idx]; }
+  uint32_t depthOf(uint32_t idx) const { return depth[idx]; }
+
+private:
+  std::vector<uint32_t> stamp;
+  std::vector<uint32_t> parent;
+  std::vector<uint32_t> depth;
+  uint32_t epoch = 0;
+};
+
+/**
+ * @class PathSearch
+ * @brief Reusable fewest-hop causal path search over a CsrGraph.
+ *
+ * One instance owns its scratch space, so keep one per query thread and
+ * reuse it: repeated queries then allocate nothing beyond the result paths.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - Bidirectional BFS explores roughly 2 * b^(d/2) nodes instead of b^d, at
+ *   the cost of needing the reverse CSR.
+ * - The batch API answers "which of these causes explains each symptom" with
+ *   a single multi-source BFS, instead of |causes| x |symptoms| searches.
+ */
+class PathSearch {
+public:
+  static constexpr uint32_t NONE = CsrGraph::NO_NODE;
+
+  /**
+   * @struct CausalChain
+   * @brief Shortest explanation of one symptom (empty path if none).
+   */
+  struct CausalChain {
+    uint64_t symptomId = 0;
+    uint64_t rootCauseId = 0;
+    std::vector<uint64_t> path; // Root cause first, symptom last
+  };
+
+  /**
+   * @struct Stats
+   * @brief Work done by the last bfs() or bidirectional() call.
+   */
+  struct Stats {
+    uint64_t expanded = 0;     // Nodes whose edges were scanned
+    uint64_t peakFrontier = 0; // Largest single BFS level
+  };
+
+  const Stats &lastStats() const { return stats; }
+
+  /**
+   * @brief One-sided BFS from start, following out-edges.
+   */
+  std::vector<uint64_t> bfs(const CsrGraph &g, uint32_t start, uint32_t end) {
+    stats = Stats();
+    if (start >= g.nodeCount() || end >= g.nodeCount())
+      return {};
+
+    fwd.begin(g.nodeCount());
+    frontier.clear();
+    frontier.push_back(start);
+    fwd.mark(start, start, 0);
+
+    const uint64_t *offsets = g.outOffsetData();
+    const uint32_t *neighbors = g.neighborData();
+    for (size_t head = 0; head < frontier.size(); ++head) {
+      uint32_t curr = frontier[head];
+      stats.expanded = head + 1;
+      stats.peakFrontier = std::max<uint64_t>(stats.peakFrontier,
+                                              frontier.size() - head);
+      if (curr == end)
+        return unwind(g, start, end);
+      for (uint64_t p = offsets[curr]; p < offsets[curr + 1]; ++p) {
+        uint32_t neighbor = neighbors[p];
+        if (!fwd.seen(neighbor)) {
+          fwd.mark(neighbor, curr, fwd.depthOf(curr) + 1);
+          frontier.push_back(neighbor);
+        }
+      }
+    }
+    return {};
+  }
+
+  /**
+   * @brief Bidirectional BFS: forward over out-edges from start, backward
+   * over in-edges from end, always expanding the smaller frontier by one full
+   * level. Returns a fewest-hop path (external IDs) or empty if unreachable.
+   */
+  std::vector<uint64_t> bidirectional(const CsrGraph &g, uint32_t start,
+                                      uint32_t end) {
+    stats = Stats();
+    if (start >= g.nodeCount() || end >= g.nodeCount())
+      return {};
+    if (start == end)
+      return {g.nodeIdAt(start)};
+
+    fwd.begin(g.nodeCount());
+    bwd.begin(g.nodeCount());
+    fwd.mark(start, start, 0);
+    bwd.mark(end, end, 0);
+    frontier.assign(1, start);
+    backFrontier.assign(1, end);
+
+    uint32_t meet = NONE;
+    uint32_t bestLen = std::numeric_limits<uint32_t>::max();
+    while (!frontier.empty() && !backFrontier.empty() && meet == NONE) {
+      stats.peakFrontier = std::max<uint64_t>(
+          stats.peakFrontier, std::max(frontier.size(), backFrontier.size()));
+      if (frontier.size() <= backFrontier.size())
+        expandLevel(g.outOffsetData(), g.neighborData(), fwd, bwd, frontier,
+                    meet, bestLen);
+      else
+        expandLevel(g.inOffsetData(), g.inNeighborData(), bwd, fwd,
+                    backFrontier, meet, bestLen);
+    }
+    if (meet == NONE)
+      return {};
+
+    std::vector<uint64_t> path;
+    for (uint32_t v = meet; v != start; v = fwd.parentOf(v))
+      path.push_back(g.nodeIdAt(v));
+    path.push_back(g.nodeIdAt(start));
+    std::reverse(path.begin(), path.end());
+    for (uint32_t v = meet; v != end;) {
+      v = bwd.parentOf(v);
+      path.push_back(g.nodeIdAt(v));
+    }
+    return path;
+  }
+
+  /**
+   * @brief Multi-source / multi-target batch search.
+   *
+   * Runs one BFS seeded with every candidate root cause at depth 0, so all
+   * sources share a single frontier and each node is expanded at most once.
+   * The search stops as soon as every symptom has been reached.
+   *
+   * @return One CausalChain per entry of symptoms, in the same order. A
+   * symptom without any causal path gets rootCauseId 0 and an empty path.
+   */
+  std::vector<CausalChain> explainAll(const CsrGraph &g,
+                                      const std::vector<uint32_t> &causes,
+                                      const std::vector<uint32_t> &symptoms) {
+    std::vector<CausalChain> chains(symptoms.size());
+    for (size_t i = 0; i < symptoms.size(); ++i)
+      chains[i].symptomId =
+          symptoms[i] < g.nodeCount() ? g.nodeIdAt(symptoms[i]) : 0;
+
+    // bwd marks double as "is a wanted symptom" so the check is O(1).
+    fwd.begin(g.nodeCount());
+    bwd.begin(g.nodeCount());
+    size_t remaining = 0;
+    for (uint32_t s : symptoms) {
+      if (s < g.nodeCount() && !bwd.seen(s)) {
+        bwd.mark(s, s, 0);
+        remaining++;
+      }
+    }
+
+    frontier.clear();
+    for (uint32_t c : causes) {
+      if (c < g.nodeCount() && !fwd.seen(c)) {
+        fwd.mark(c, c, 0);
+        frontier.push_back(c);
+      }
+    }
+
+    const uint64_t *offsets = g.outOffsetData();
+    const uint32_t *neighbors = g.neighborData();
+    for (size_t head = 0; head < frontier.size() && remaining > 0; ++head) {
+      uint32_t curr = frontier[head];
+      if (bwd.seen(curr))
+        remaining--;
+      for (uint64_t p = offsets[curr]; p < offsets[curr + 1]; ++p) {
+        uint32_t neighbor = neighbors[p];
+        if (!fwd.seen(neighbor)) {
+          fwd.mark(neighbor, curr, fwd.depthOf(curr) + 1);
+          frontier.push_back(neighbor);
+        }
+      }
+    }
+
+    for (size_t i = 0; i < symptoms.size(); ++i) {
+      uint32_t s = symptoms[i];
+      if (s >= g.nodeCount() || !fwd.seen(s))
+        continue;
+      auto &path = chains[i].path;
+      uint32_t v = s;
+      for (; fwd.depthOf(v) > 0; v = fwd.parentOf(v))
+        path.push_back(g.nodeIdAt(v));
+      path.push_back(g.nodeIdAt(v));
+      std::reverse(path.begin(), path.end());
+      chains[i].rootCauseId = g.nodeIdAt(v);
+    }
+    return chains;
+  }
+
+private:
+  VisitMarks fwd;
+  VisitMarks bwd;
+  std::vector<uint32_t> frontier;
+  std::vector<uint32_t> backFrontier;
+  std::vector<uint32_t> next;
+  Stats stats;
+
+  std::vector<uint64_t> unwind(const CsrGraph &g, uint32_t start,
+                               uint32_t end) const {
+    std::vector<uint64_t> path;
+    for (uint32_t v = end; v != start; v = fwd.parentOf(v))
+      path.push_back(g.nodeIdAt(v));
+    path.push_back(g.nodeIdAt(start));
+    std::reverse(path.begin(), path.end());
+    return path;
+  }
+
+  /**
+   * @brief Expands one whole BFS level of `side`. Any edge landing on a node
+   * already reached by `other` is a meeting candidate; finishing the level
+   * before stopping guarantees the shortest meeting point wins.
+   */
+  void expandLevel(const uint64_t *offsets, const uint32_t *adjacency,
+                   VisitMarks &side, const VisitMarks &other,
+                   std::vector<uint32_t> &level, uint32_t &meet,
+                   uint32_t &bestLen) {
+    next.clear();
+    stats.expanded += level.size();
+    for (uint32_t curr : level) {
+      uint32_t d = side.depthOf(curr) + 1;
+      for (uint64_t p = offsets[curr]; p < offsets[curr + 1]; ++p) {
+        uint32_t neighbor = adjacency[p];
+        if (side.seen(neighbor))
+          continue;
+        side.mark(neighbor, curr, d);
+        if (other.seen(neighbor)) {
+          uint32_t len = d + other.depthOf(neighbor);
+          if (len < bestLen) {
+            bestLen = len;
+            meet = neighbor;
+          }
+        }
+        next.push_back(neighbor);
+      }
+    }
+    level.swap(next);
+  }
+};
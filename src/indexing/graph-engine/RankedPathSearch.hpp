@@ -0,0 +1,344 @@
+#pragma once
+
+#include "ArrayRef.hpp"
+#include "CsrGraph.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * @class RankedPathSearch
+ * @brief Top-k most credible causal chains (Yen's k-shortest loopless paths).
+ *
+ * Edge cost is -log(credibility), so the cheapest path is the one whose edge
+ * credibilities multiply to the highest value. Costs are read from a packed
+ * float array aligned with CSR edge positions (see GraphEngine::edgeWeights),
+ * never from property maps.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - Yen over Eppstein: Eppstein is asymptotically faster but may return
+ *   paths with cycles, which are meaningless as causal explanations.
+ * - Pruned candidate heap: only the best (k - found) spur candidates are
+ *   kept, so the heap never grows past k entries.
+ * - Banned edges in Yen always leave the spur node, so they are checked only
+ *   when that node is expanded instead of via a global hash set.
+ * - One reverse Dijkstra from the symptom gives exact remaining costs, which
+ *   turn every spur search into a tightly guided A* and prune nodes that
+ *   cannot reach the symptom at all.
+ */
+class RankedPathSearch {
+public:
+  static constexpr uint32_t NONE = CsrGraph::NO_NODE;
+
+  /**
+   * @struct RankedPath
+   * @brief One causal chain with its accumulated cost.
+   */
+  struct RankedPath {
+    std::vector<uint32_t> nodes;    // Dense node indices, cause first
+    std::vector<uint64_t> edgePos;  // CSR edge positions along the path
+    double cost = 0.0;              // Sum of edge weights
+  };
+
+  /**
+   * @struct CredibleChain
+   * @brief A RankedPath translated to external IDs for callers.
+   */
+  struct CredibleChain {
+    std::vector<uint64_t> nodeIds;
+    std::vector<uint64_t> edgeIds;
+    double credibility = 0.0; // exp(-cost), in (0, 1]
+  };
+
+  static CredibleChain toChain(const CsrGraph &g, const RankedPath &p) {
+    CredibleChain c;
+    c.nodeIds.reserve(p.nodes.size());
+    for (uint32_t n : p.nodes)
+      c.nodeIds.push_back(g.nodeIdAt(n));
+    c.edgeIds.reserve(p.edgePos.size());
+    for (uint64_t pos : p.edgePos)
+      c.edgeIds.push_back(g.edgeIdAt(pos));
+    c.credibility = std::exp(-p.cost);
+    return c;
+  }
+
+  /**
+   * @brief Restricts traversal to a set of interned edge labels.
+   * An empty filter admits every edge.
+   */
+  struct LabelFilter {
+    std::vector<uint8_t> allowed; // Indexed by label ID
+
+    bool admits(uint32_t label) const {
+      return allowed.empty() || (label < allowed.size() && allowed[label]);
+    }
+  };
+
+  static LabelFilter makeFilter(const CsrGraph &g,
+                                const std::vector<std::string> &labels) {
+    LabelFilter f;
+    if (labels.empty())
+      return f;
+    for (const auto &l : labels) {
+      uint32_t id = g.labelId(l);
+      if (id == NONE)
+        continue;
+      if (f.allowed.size() <= id)
+        f.allowed.resize(id + 1, 0);
+      f.allowed[id] = 1;
+    }
+    if (f.allowed.empty())
+      f.allowed.assign(1, 0); // No requested label exists: admit nothing
+    return f;
+  }
+
+  /**
+   * @brief Returns up to k loopless paths from start to end, cheapest first.
+   * @param weights Per-edge cost, indexed by CSR edge position.
+   */
+  std::vector<RankedPath> topK(const CsrGraph &g, ArrayRef<float> weights,
+                               uint32_t start, uint32_t end, size_t k,
+                               const LabelFilter &filter = {}) {
+    std::vector<RankedPath> found;
+    if (k == 0 || start >= g.nodeCount() || end >= g.nodeCount())
+      return found;
+
+    computeHeuristic(g, weights, filter, end);
+    banned.begin(g.nodeCount());
+    bannedEdges.clear();
+    RankedPath first;
+    if (!shortest(g, weights, filter, start, end, 0.0, first))
+      return found;
+    found.push_back(std::move(first));
+
+    candidates.clear();
+    while (found.size() < k) {
+      const RankedPath &prev = found.back();
+      double rootCost = 0.0;
+
+      for (size_t i = 0; i + 1 < prev.nodes.size(); ++i) {
+        uint32_t spur = prev.nodes[i];
+
+        // Ban the next edge of every accepted path sharing this root. Roots
+        // are compared by edge, not node, so parallel edges stay distinct.
+        bannedEdges.clear();
+        for (const auto &p : found)
+          if (p.edgePos.size() > i &&
+              std::equal(prev.edgePos.begin(), prev.edgePos.begin() + i,
+                         p.edgePos.begin()))
+            bannedEdges.push_back(p.edgePos[i]);
+
+        // Ban root nodes (except the spur) to keep paths loopless.
+        banned.begin(g.nodeCount());
+        for (size_t j = 0; j < i; ++j)
+          banned.mark(prev.nodes[j]);
+
+        RankedPath spurPath;
+        if (shortest(g, weights, filter, spur, end, rootCost, spurPath)) {
+          RankedPath total;
+          total.nodes.assign(prev.nodes.begin(), prev.nodes.begin() + i);
+          total.nodes.insert(total.nodes.end(), spurPath.nodes.begin(),
+                             spurPath.nodes.end());
+          total.edgePos.assign(prev.edgePos.begin(),
+                               prev.edgePos.begin() + i);
+          total.edgePos.insert(total.edgePos.end(), spurPath.edgePos.begin(),
+                               spurPath.edgePos.end());
+          total.cost = spurPath.cost;
+          offerCandidate(std::move(total), k - found.size());
+        }
+        rootCost += weights[prev.edgePos[i]];
+      }
+
+      if (candidates.empty())
+        break;
+      std::pop_heap(candidates.begin(), candidates.end(), cheaperFirst);
+      found.push_back(std::move(candidates.back()));
+      candidates.pop_back();
+    }
+    return found;
+  }
+
+private:
+  /**
+   * @brief Epoch-stamped per-node scratch for Dijkstra and node bans.
+   */
+  struct Marks {
+    std::vector<uint32_t> stamp;
+    uint32_t epoch = 0;
+
+    void begin(size_t n) {
+      if (stamp.size() < n)
+        stamp.resize(n, 0);
+      if (++epoch == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        epoch = 1;
+      }
+    }
+    bool has(uint32_t i) const { return stamp[i] == epoch; }
+    void mark(uint32_t i) { stamp[i] = epoch; }
+  };
+
+  struct HeapEntry {
+    double key; // g + h for A*, plain distance for the reverse pass
+    uint32_t node;
+    bool operator>(const HeapEntry &o) const { return key > o.key; }
+  };
+
+  Marks reached;
+  Marks settled;
+  Marks banned;
+  Marks hasHeuristic;
+  std::vector<double> toTarget; // Exact remaining cost to the target
+  std::vector<double> dist;
+  std::vector<uint64_t> viaEdge; // CSR position of the best incoming edge
+  std::vector<uint32_t> viaNode;
+  std::vector<HeapEntry> heap;
+  std::vector<uint64_t> bannedEdges;
+  std::vector<RankedPath> candidates; // Min-heap on cost, capped
+
+  static bool cheaperFirst(const RankedPath &a, const RankedPath &b) {
+    return a.cost > b.cost;
+  }
+
+  static bool byCost(const RankedPath &a, const RankedPath &b) {
+    return a.cost < b.cost;
+  }
+
+  /**
+   * @brief Keeps at most `room` candidates: once full, a new path is only
+   * admitted if it beats the current worst one. Duplicates are dropped.
+   */
+  void offerCandidate(RankedPath &&path, size_t room) {
+    for (const auto &c : candidates)
+      if (c.edgePos == path.edgePos)
+        return;
+    // The heap is ordered for popping the cheapest; the worst entry is found
+    // by a linear scan, which is fine for k-sized heaps.
+    if (candidates.size() >= room) {
+      auto worst =
+          std::max_element(candidates.begin(), candidates.end(), byCost);
+      if (worst->cost <= path.cost)
+        return;
+      *worst = std::move(path);
+      std::make_heap(candidates.begin(), candidates.end(), cheaperFirst);
+      return;
+    }
+    candidates.push_back(std::move(path));
+    std::push_heap(candidates.begin(), candidates.end(), cheaperFirst);
+  }
+
+  /**
+   * @brief Reverse Dijkstra from `to` over in-edges, giving the exact
+   * remaining cost h(v) from every ancestor of `to`. Nodes that cannot reach
+   * `to` are never marked and get pruned from every later search.
+   */
+  void computeHeuristic(const CsrGraph &g, ArrayRef<float> weights,
+                        const LabelFilter &filter, uint32_t to) {
+    if (toTarget.size() < g.nodeCount())
+      toTarget.resize(g.nodeCount());
+    hasHeuristic.begin(g.nodeCount());
+    settled.begin(g.nodeCount());
+    heap.clear();
+
+    hasHeuristic.mark(to);
+    toTarget[to] = 0.0;
+    heap.push_back({0.0, to});
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+      HeapEntry top = heap.back();
+      heap.pop_back();
+      uint32_t u = top.node;
+      if (settled.has(u))
+        continue;
+      settled.mark(u);
+      for (uint64_t r = g.inBegin(u); r < g.inEnd(u); ++r) {
+        uint64_t p = g.inEdgePosAt(r);
+        uint32_t v = g.inNeighborAt(r);
+        if (settled.has(v) || !filter.admits(g.edgeLabelAt(p)))
+          continue;
+        double nd = toTarget[u] + weights[p];
+        if (!hasHeuristic.has(v) || nd < toTarget[v]) {
+          hasHeuristic.mark(v);
+          toTarget[v] = nd;
+          heap.push_back({nd, v});
+          std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief A* from `from` to `to` guided by the reverse-Dijkstra distances,
+   * honouring node bans, the spur edge bans and the label filter. Bans only
+   * remove edges, so h stays admissible and consistent and the first time
+   * `to` is settled its cost is optimal.
+   */
+  bool shortest(const CsrGraph &g, ArrayRef<float> weights,
+                const LabelFilter &filter, uint32_t from, uint32_t to,
+                double baseCost, RankedPath &out) {
+    if (!hasHeuristic.has(from))
+      return false;
+    if (dist.size() < g.nodeCount()) {
+      dist.resize(g.nodeCount());
+      viaEdge.resize(g.nodeCount());
+      viaNode.resize(g.nodeCount());
+    }
+    reached.begin(g.nodeCount());
+    settled.begin(g.nodeCount());
+    heap.clear();
+
+    reached.mark(from);
+    dist[from] = baseCost;
+    viaNode[from] = NONE;
+    heap.push_back({baseCost + toTarget[from], from});
+
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+      uint32_t u = heap.back().node;
+      heap.pop_back();
+      if (settled.has(u))
+        continue;
+      settled.mark(u);
+      if (u == to)
+        break;
+
+      for (uint64_t p = g.outBegin(u); p < g.outEnd(u); ++p) {
+        uint32_t v = g.neighborAt(p);
+        if (!hasHeuristic.has(v) || banned.has(v) || settled.has(v) ||
+            !filter.admits(g.edgeLabelAt(p)))
+          continue;
+        if (u == from && std::find(bannedEdges.begin(), bannedEdges.end(),
+                                   p) != bannedEdges.end())
+          continue;
+        double nd = dist[u] + weights[p];
+        if (!reached.has(v) || nd < dist[v]) {
+          reached.mark(v);
+          dist[v] = nd;
+          viaEdge[v] = p;
+          viaNode[v] = u;
+          heap.push_back({nd + toTarget[v], v});
+          std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+        }
+      }
+    }
+
+    if (!settled.has(to))
+      return false;
+    out.nodes.clear();
+    out.edgePos.clear();
+    for (uint32_t v = to; v != from; v = viaNode[v]) {
+      out.nodes.push_back(v);
+      out.edgePos.push_back(viaEdge[v]);
+    }
+    out.nodes.push_back(from);
+    std::reverse(out.nodes.begin(), out.nodes.end());
+    std::reverse(out.edgePos.begin(), out.edgePos.end());
+    out.cost = dist[to];
+    return true;
+  }
+};
@@ -0,0 +1,533 @@
+#pragma once
+
+#include "CsrGraph.hpp"
+#include "PathSearch.hpp"
+#include "RankedPathSearch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @class ReachabilityIndex
+ * @brief Answers "can X cause Y" and "within h hops" over the subgraph of
+ * the given edge labels without running a traversal in most cases.
+ *
+ * LAYOUT (built once from a CsrGraph):
+ * - Strongly connected components are condensed into a DAG. Tarjan
+ *   numbers them sinks first, so an edge always goes from a higher
+ *   component ID to a lower one and a lower ID can never reach a higher.
+ * - Each component gets one [low, post] interval per randomized DFS of the
+ *   DAG (GRAIL labeling). If Y's interval is not inside X's in every
+ *   traversal, X cannot reach Y. The first traversal's spanning tree also
+ *   gives a positive cut: tree descendants are reachable.
+ * - Whatever survives both cuts goes to a DFS over the DAG that only
+ *   enters components whose intervals still contain Y's.
+ * - Hop distances to and from a few high-degree landmarks (saturated at
+ *   254) bound d(X, Y) from above and below.
+ *
+ * UPDATES: insertEdge() appends to a small overlay. An overlay route is a
+ * chain of base-reachable hops between inserted edges. Distances only
+ * shrink on insertion, so upper bounds stay valid and lower bounds are
+ * dropped until the next rebuild, including after a shortcut between
+ * already connected nodes that needs no overlay entry. needsRebuild() turns
+ * true once more than Options::maxPending edges were inserted. Removing or
+ * rewiring an edge invalidates the index; rebuild it.
+ *
+ * Queries reuse internal scratch: one query at a time per instance.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: Negative answers, the common case for "is this a possible cause",
+ *   cost a few integer compares.
+ * - PRO: About 8 * intervals + 2 * landmarks bytes per node, versus
+ *   O(N^2) for a transitive closure.
+ * - CON: Positive answers outside the spanning tree still pay a pruned
+ *   DFS, and each overlay hop costs extra base queries.
+ */
+class ReachabilityIndex {
+public:
+  static constexpr uint32_t NONE = CsrGraph::NO_NODE;
+  static constexpr uint32_t UNKNOWN = std::numeric_limits<uint32_t>::max();
+
+  struct Options {
+    size_t intervals = 3; // GRAIL traversals
+    size_t landmarks = 8;
+    size_t maxPending = 64; // Overlay edges before needsRebuild()
+    uint64_t seed = 1;
+  };
+
+  /**
+   * @param labels Edge labels to index; empty means every edge.
+   */
+  ReachabilityIndex(const CsrGraph &g, std::vector<std::string> labels,
+                    Options options)
+      : labelNames(std::move(labels)), opts(options) {
+    opts.intervals = std::max<size_t>(1, opts.intervals);
+    const RankedPathSearch::LabelFilter filter =
+        RankedPathSearch::makeFilter(g, labelNames);
+    baseNodes = static_cast<uint32_t>(g.nodeCount());
+    condense(g, filter);
+    label();
+    placeLandmarks(g, filter);
+  }
+
+  explicit ReachabilityIndex(const CsrGraph &g,
+                             std::vector<std::string> labels = {"CAUSES"})
+      : ReachabilityIndex(g, std::move(labels), Options()) {}
+
+  const std::vector<std::string> &labels() const { return labelNames; }
+
+  bool admits(std::string_view label) const {
+    return labelNames.empty() ||
+           std::find(labelNames.begin(), labelNames.end(), label) !=
+               labelNames.end();
+  }
+
+  /**
+   * @brief True while every edge of the graph, including later inserts,
+   * carries an indexed label, so unfiltered searches can be pruned too.
+   */
+  bool coversAllEdges() const { return allEdges; }
+
+  /**
+   * @brief True if a search following only `labels` (empty: all edges)
+   * never leaves the indexed subgraph, so the index may prune it.
+   */
+  bool covers(const std::vector<std::string> &searchLabels) const {
+    if (allEdges)
+      return true;
+    if (searchLabels.empty())
+      return false;
+    for (const std::string &l : searchLabels)
+      if (!admits(l))
+        return false;
+    return true;
+  }
+
+  /**
+   * @brief Records a new edge by dense endpoints; edges with other labels
+   * only clear coversAllEdges().
+   */
+  void insertEdge(uint32_t src, uint32_t tgt, std::string_view label) {
+    if (!admits(label)) {
+      allEdges = false;
+      return;
+    }
+    ++inserted; // Even a shortcut may shrink distances
+    if (!reachable(src, tgt))
+      pending.push_back({src, tgt});
+  }
+
+  size_t pendingEdges() const { return pending.size(); }
+  bool needsRebuild() const { return inserted > opts.maxPending; }
+  size_t componentCount() const { return components; }
+
+  /**
+   * @brief Exact reachability over the indexed labels.
+   */
+  bool reachable(uint32_t from, uint32_t to) const {
+    if (from == to || baseReach(from, to))
+      return true;
+    return viaOverlay(
+        from, to, [this](uint32_t a, uint32_t b) { return baseReach(a, b); });
+  }
+
+  /**
+   * @brief Cheap conservative test: false means definitely unreachable.
+   */
+  bool mayReach(uint32_t from, uint32_t to) const {
+    if (from == to || baseMay(from, to))
+      return true;
+    return viaOverlay(
+        from, to, [this](uint32_t a, uint32_t b) { return baseMay(a, b); });
+  }
+
+  /**
+   * @brief Hop-count upper bound from landmarks, or UNKNOWN.
+   */
+  uint32_t upperBound(uint32_t from, uint32_t to) const {
+    if (from == to)
+      return 0;
+    uint32_t best = UNKNOWN;
+    if (from >= baseNodes || to >= baseNodes)
+      return best;
+    for (size_t l = 0; l < landmarkCount; ++l) {
+      uint8_t a = toLandmark[l * baseNodes + from];
+      uint8_t b = fromLandmark[l * baseNodes + to];
+      if (a != FAR && b != FAR)
+        best = std::min<uint32_t>(best, uint32_t(a) + b);
+    }
+    return best;
+  }
+
+  /**
+   * @brief Hop-count lower bound: UNKNOWN if unreachable, at least 1 for
+   * distinct nodes, tightened by landmarks until the first insertEdge().
+   */
+  uint32_t lowerBound(uint32_t from, uint32_t to) const {
+    if (from == to)
+      return 0;
+    if (!reachable(from, to))
+      return UNKNOWN;
+    uint32_t best = 1;
+    if (inserted || from >= baseNodes || to >= baseNodes)
+      return best;
+    // d(l, to) <= d(l, from) + d(from, to) and
+    // d(from, l) <= d(from, to) + d(to, l).
+    for (size_t l = 0; l < landmarkCount; ++l) {
+      int fa = fromLandmark[l * baseNodes + from];
+      int fb = fromLandmark[l * baseNodes + to];
+      int ta = toLandmark[l * baseNodes + from];
+      int tb = toLandmark[l * baseNodes + to];
+      if (fa != FAR && fb != FAR && fb - fa > int(best))
+        best = fb - fa;
+      if (ta != FAR && tb != FAR && ta - tb > int(best))
+        best = ta - tb;
+    }
+    return best;
+  }
+
+  /**
+   * @brief Exact "is there a path of at most maxHops indexed edges".
+   * @param g The current snapshot, which must contain every inserted edge.
+   */
+  bool withinHops(const CsrGraph &g, uint32_t from, uint32_t to,
+                  uint32_t maxHops) const {
+    if (from == to)
+      return true;
+    if (!reachable(from, to))
+      return false;
+    if (upperBound(from, to) <= maxHops)
+      return true;
+    if (lowerBound(from, to) > maxHops)
+      return false;
+
+    // Bounded BFS, only entering nodes that may still reach the target.
+    const RankedPathSearch::LabelFilter filter =
+        RankedPathSearch::makeFilter(g, labelNames);
+    marks.begin(g.nodeCount());
+    marks.mark(from, from, 0);
+    frontier.assign(1, from);
+    for (size_t head = 0; head < frontier.size(); ++head) {
+      uint32_t u = frontier[head];
+      uint32_t d = marks.depthOf(u) + 1;
+      if (d > maxHops)
+        break;
+      for (uint64_t p = g.outBegin(u); p < g.outEnd(u); ++p) {
+        uint32_t v = g.neighborAt(p);
+        if (marks.seen(v) || !filter.admits(g.edgeLabelAt(p)))
+          continue;
+        if (v == to)
+          return true;
+        marks.mark(v, u, d);
+        if (mayReach(v, to))
+          frontier.push_back(v);
+      }
+    }
+    return false;
+  }
+
+private:
+  static constexpr uint8_t FAR = 255; // Unreached or >= 255 hops
+
+  std::vector<std::string> labelNames;
+  Options opts;
+  uint32_t baseNodes = 0;
+  bool allEdges = true;
+
+  // Condensation, indexed by component: Tarjan order, sinks first.
+  uint32_t components = 0;
+  std::vector<uint32_t> comp; // Node -> component
+  std::vector<uint32_t> dagOffsets;
+  std::vector<uint32_t> dagTargets;
+
+  // GRAIL intervals, [t * components + c], and the spanning-tree cut.
+  std::vector<uint32_t> low;
+  std::vector<uint32_t> post;
+  std::vector<uint32_t> pre;
+  std::vector<uint32_t> subtreeEnd;
+
+  // Landmark hop labels, [l * baseNodes + node].
+  size_t landmarkCount = 0;
+  std::vector<uint8_t> toLandmark;
+  std::vector<uint8_t> fromLandmark;
+
+  std::vector<std::pair<uint32_t, uint32_t>> pending; // Dense (src, tgt)
+  size_t inserted = 0; // Indexed edges since the build, shortcuts included
+
+  mutable std::vector<uint32_t> stamp; // Per component DFS marks
+  mutable uint32_t epoch = 0;
+  mutable std::vector<uint32_t> stack;
+  mutable std::vector<uint8_t> used; // Per pending edge
+  mutable std::vector<uint32_t> overlayQueue;
+  mutable VisitMarks marks;
+  mutable std::vector<uint32_t> frontier;
+
+  bool baseMay(uint32_t from, uint32_t to) const {
+    if (from >= baseNodes || to >= baseNodes)
+      return false; // Only overlay edges touch new nodes
+    return compMay(comp[from], comp[to]);
+  }
+
+  bool baseReach(uint32_t from, uint32_t to) const {
+    if (from >= baseNodes || to >= baseNodes)
+      return false;
+    return compReach(comp[from], comp[to]);
+  }
+
+  bool compMay(uint32_t a, uint32_t b) const {
+    if (a == b)
+      return true;
+    if (a < b)
+      return false;
+    for (size_t t = 0; t < opts.intervals; ++t) {
+      size_t ia = t * components + a, ib = t * components + b;
+      if (low[ib] < low[ia] || post[ib] > post[ia])
+        return false;
+    }
+    return true;
+  }
+
+  bool compReach(uint32_t a, uint32_t b) const {
+    if (!compMay(a, b))
+      return false;
+    if (a == b || (pre[a] <= pre[b] && pre[b] <= subtreeEnd[a]))
+      return true;
+    if (++epoch == 0) {
+      std::fill(stamp.begin(), stamp.end(), 0);
+      epoch = 1;
+    }
+    stack.assign(1, a);
+    stamp[a] = epoch;
+    while (!stack.empty()) {
+      uint32_t c = stack.back();
+      stack.pop_back();
+      for (uint32_t i = dagOffsets[c]; i < dagOffsets[c + 1]; ++i) {
+        uint32_t next = dagTargets[i];
+        if (next == b)
+          return true;
+        if (stamp[next] != epoch && compMay(next, b)) {
+          stamp[next] = epoch;
+          stack.push_back(next);
+        }
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Breadth-first over inserted edges: an edge is usable once its
+   * source is base-reachable from `from` or from an earlier edge's target.
+   */
+  template <typename Reach>
+  bool viaOverlay(uint32_t from, uint32_t to, Reach &&reach) const {
+    if (pending.empty())
+      return false;
+    used.assign(pending.size(), 0);
+    overlayQueue.assign(1, from);
+    for (size_t head = 0; head < overlayQueue.size(); ++head) {
+      uint32_t x = overlayQueue[head];
+      for (size_t e = 0; e < pending.size(); ++e) {
+        auto [src, tgt] = pending[e];
+        if (used[e] || (x != src && !reach(x, src)))
+          continue;
+        used[e] = 1;
+        if (tgt == to || reach(tgt, to))
+          return true;
+        overlayQueue.push_back(tgt);
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Iterative Tarjan over indexed edges, then the deduplicated DAG.
+   */
+  void condense(const CsrGraph &g, const RankedPathSearch::LabelFilter &f) {
+    const uint32_t n = baseNodes;
+    constexpr uint32_t UNSEEN = NONE;
+    std::vector<uint32_t> order(n, UNSEEN), lowLink(n, 0);
+    std::vector<uint8_t> onStack(n, 0);
+    std::vector<uint32_t> sccStack;
+    std::vector<std::pair<uint32_t, uint64_t>> calls; // (node, next edge)
+    comp.assign(n, NONE);
+    uint32_t counter = 0;
+
+    for (uint32_t root = 0; root < n; ++root) {
+      if (order[root] != UNSEEN)
+        continue;
+      calls.push_back({root, g.outBegin(root)});
+      order[root] = lowLink[root] = counter++;
+      sccStack.push_back(root);
+      onStack[root] = 1;
+      while (!calls.empty()) {
+        auto &[u, p] = calls.back();
+        if (p < g.outEnd(u)) {
+          uint64_t pos = p++;
+          if (!f.admits(g.edgeLabelAt(pos))) {
+            allEdges = false;
+            continue;
+          }
+          uint32_t v = g.neighborAt(pos);
+          if (order[v] == UNSEEN) {
+            order[v] = lowLink[v] = counter++;
+            sccStack.push_back(v);
+            onStack[v] = 1;
+            calls.push_back({v, g.outBegin(v)}); // Invalidates u, p
+          } else if (onStack[v]) {
+            lowLink[u] = std::min(lowLink[u], order[v]);
+          }
+          continue;
+        }
+        uint32_t done = u;
+        calls.pop_back();
+        if (!calls.empty())
+          lowLink[calls.back().first] =
+              std::min(lowLink[calls.back().first], lowLink[done]);
+        if (lowLink[done] == order[done]) {
+          uint32_t w;
+          do {
+            w = sccStack.back();
+            sccStack.pop_back();
+            onStack[w] = 0;
+            comp[w] = components;
+          } while (w != done);
+          components++;
+        }
+      }
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> dag;
+    for (uint32_t u = 0; u < n; ++u)
+      for (uint64_t p = g.outBegin(u); p < g.outEnd(u); ++p)
+        if (f.admits(g.edgeLabelAt(p)) && comp[u] != comp[g.neighborAt(p)])
+          dag.push_back({comp[u], comp[g.neighborAt(p)]});
+    std::sort(dag.begin(), dag.end());
+    dag.erase(std::unique(dag.begin(), dag.end()), dag.end());
+    dagOffsets.assign(components + 1, 0);
+    for (const auto &e : dag)
+      dagOffsets[e.first + 1]++;
+    for (uint32_t c = 0; c < components; ++c)
+      dagOffsets[c + 1] += dagOffsets[c];
+    dagTargets.resize(dag.size());
+    for (size_t i = 0; i < dag.size(); ++i)
+      dagTargets[i] = dag[i].second;
+    stamp.assign(components, 0);
+  }
+
+  /**
+   * @brief One post-order DFS of the DAG per interval set, visiting roots
+   * and children in a traversal-specific rotated order.
+   */
+  void label() {
+    const uint32_t c = components;
+    low.assign(opts.intervals * c, 0);
+    post.assign(opts.intervals * c, 0);
+    pre.assign(c, 0);
+    subtreeEnd.assign(c, 0);
+    std::vector<uint8_t> hasParent(c, 0);
+    for (uint32_t t : dagTargets)
+      hasParent[t] = 1;
+    std::vector<uint32_t> roots;
+    for (uint32_t i = c; i-- > 0;) // Higher IDs sit upstream
+      if (!hasParent[i])
+        roots.push_back(i);
+
+    std::vector<uint8_t> visited(c);
+    std::vector<std::pair<uint32_t, uint32_t>> calls; // (component, step)
+    uint64_t state = opts.seed * 0x9E3779B97F4A7C15ull + 1;
+    for (size_t t = 0; t < opts.intervals; ++t) {
+      std::fill(visited.begin(), visited.end(), 0);
+      uint32_t *lo = low.data() + t * c, *po = post.data() + t * c;
+      uint32_t nextPost = 0, nextPre = 0;
+      state = state * 6364136223846793005ull + 1442695040888963407ull;
+      const uint32_t spin = static_cast<uint32_t>(state >> 33);
+      for (size_t r = 0; r < roots.size(); ++r) {
+        uint32_t root = roots[t == 0 ? r : (r + spin) % roots.size()];
+        if (visited[root])
+          continue;
+        visited[root] = 1;
+        if (t == 0)
+          pre[root] = nextPre++;
+        calls.push_back({root, 0});
+        lo[root] = UNKNOWN;
+        while (!calls.empty()) {
+          auto &[u, step] = calls.back();
+          uint32_t begin = dagOffsets[u], deg = dagOffsets[u + 1] - begin;
+          if (step < deg) {
+            uint32_t shift = t == 0 ? 0 : (spin ^ u) % deg;
+            uint32_t v = dagTargets[begin + (step++ + shift) % deg];
+            if (!visited[v]) {
+              visited[v] = 1;
+              if (t == 0)
+                pre[v] = nextPre++;
+              lo[v] = UNKNOWN;
+              calls.push_back({v, 0}); // Invalidates u, step
+            }
+            continue;
+          }
+          uint32_t done = u;
+          calls.pop_back();
+          po[done] = nextPost++;
+          lo[done] = std::min(lo[done], po[done]);
+          for (uint32_t i = begin; i < begin + deg; ++i)
+            lo[done] = std::min(lo[done], lo[dagTargets[i]]);
+          if (t == 0)
+            subtreeEnd[done] = nextPre - 1;
+        }
+      }
+    }
+  }
+
+  void placeLandmarks(const CsrGraph &g,
+                      const RankedPathSearch::LabelFilter &f) {
+    const uint32_t n = baseNodes;
+    std::vector<std::pair<uint64_t, uint32_t>> degree;
+    degree.reserve(n);
+    for (uint32_t u = 0; u < n; ++u) {
+      uint64_t d = (g.outEnd(u) - g.outBegin(u)) + (g.inEnd(u) - g.inBegin(u));
+      if (d)
+        degree.push_back({d, u});
+    }
+    landmarkCount = std::min(opts.landmarks, degree.size());
+    std::partial_sort(degree.begin(), degree.begin() + landmarkCount,
+                      degree.end(), std::greater<>());
+    toLandmark.assign(landmarkCount * n, FAR);
+    fromLandmark.assign(landmarkCount * n, FAR);
+    for (size_t l = 0; l < landmarkCount; ++l) {
+      uint32_t mark = degree[l].second;
+      hopLabels(g, f, mark, false, fromLandmark.data() + l * n);
+      hopLabels(g, f, mark, true, toLandmark.data() + l * n);
+    }
+  }
+
+  /**
+   * @brief BFS from the landmark over out-edges (or in-edges if reverse),
+   * writing hop counts below FAR.
+   */
+  static void hopLabels(const CsrGraph &g,
+                        const RankedPathSearch::LabelFilter &f, uint32_t mark,
+                        bool reverse, uint8_t *dist) {
+    std::vector<uint32_t> queue(1, mark);
+    dist[mark] = 0;
+    for (size_t head = 0; head < queue.size(); ++head) {
+      uint32_t u = queue[head];
+      if (dist[u] + 1 >= FAR)
+        continue;
+      uint64_t begin = reverse ? g.inBegin(u) : g.outBegin(u);
+      uint64_t end = reverse ? g.inEnd(u) : g.outEnd(u);
+      for (uint64_t r = begin; r < end; ++r) {
+        uint64_t pos = reverse ? g.inEdgePosAt(r) : r;
+        uint32_t v = reverse ? g.inNeighborAt(r) : g.neighborAt(r);
+        if (dist[v] == FAR && f.admits(g.edgeLabelAt(pos))) {
+          dist[v] = dist[u] + 1;
+          queue.push_back(v);
+        }
+      }
+    }
+  }
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @class ShardedEntityRegistry
+ * @brief Concurrent (label, canonical name) -> node ID resolution.
+ *
+ * The key space is split across SHARDS independent hash maps, each behind
+ * its own cache-line-aligned mutex, so parallel extractors only contend when
+ * they hit the same shard. IDs come from one atomic counter and therefore
+ * stay dense and unique across shards, which keeps IdIndex direct-mapped.
+ */
+class ShardedEntityRegistry {
+public:
+  static constexpr size_t SHARDS = 64;
+
+  /**
+   * @brief Returns the node ID for (label, canonicalName), assigning a new
+   * one if the pair has not been seen.
+   * @param created Set to true only for the caller that assigned the ID.
+   */
+  uint64_t resolve(const std::string &label, const std::string &canonicalName,
+                   bool &created) {
+    std::string key;
+    key.reserve(label.size() + 2 + canonicalName.size());
+    key.append(label).append("::").append(canonicalName);
+
+    Shard &shard = shards[std::hash<std::string>{}(key) % SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.ids.find(key);
+    if (it != shard.ids.end()) {
+      created = false;
+      return it->second;
+    }
+    uint64_t id = nextId.fetch_add(1, std::memory_order_relaxed) + 1;
+    shard.ids.emplace(std::move(key), id);
+    created = true;
+    return id;
+  }
+
+  /**
+   * @brief Looks (label, canonicalName) up without assigning an ID.
+   * @return false if the pair has never been resolved.
+   */
+  bool find(const std::string &label, const std::string &canonicalName,
+            uint64_t &id) const {
+    std::string key;
+    key.reserve(label.size() + 2 + canonicalName.size());
+    key.append(label).append("::").append(canonicalName);
+
+    const Shard &shard = shards[std::hash<std::string>{}(key) % SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.ids.find(key);
+    if (it == shard.ids.end())
+      return false;
+    id = it->second;
+    return true;
+  }
+
+  size_t size() const {
+    return static_cast<size_t>(nextId.load(std::memory_order_relaxed));
+  }
+
+private:
+  struct alignas(64) Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, uint64_t> ids;
+  };
+
+  std::array<Shard, SHARDS> shards;
+  std::atomic<uint64_t> nextId{0};
+};
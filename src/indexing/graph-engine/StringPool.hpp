@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class StringInterner
+ * @brief Maps a small vocabulary (labels, property keys) to dense uint32_t IDs.
+ *
+ * Each distinct string is stored once; entities keep only the 4-byte ID.
+ */
+class StringInterner {
+public:
+  static constexpr uint32_t NO_ID = std::numeric_limits<uint32_t>::max();
+
+  uint32_t intern(std::string_view s) {
+    auto it = ids.find(std::string(s));
+    if (it != ids.end())
+      return it->second;
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    auto inserted = ids.emplace(std::string(s), id).first;
+    strings.push_back(&inserted->first); // Map keys never move
+    return id;
+  }
+
+  /**
+   * @brief Looks up an ID without inserting (NO_ID if unknown).
+   */
+  uint32_t find(std::string_view s) const {
+    auto it = ids.find(std::string(s));
+    return (it != ids.end()) ? it->second : NO_ID;
+  }
+
+  const std::string &str(uint32_t id) const { return *strings[id]; }
+  size_t size() const { return strings.size(); }
+
+private:
+  std::unordered_map<std::string, uint32_t> ids;
+  std::vector<const std::string *> strings;
+};
+
+/**
+ * @class StringArena
+ * @brief Append-mostly storage for high-cardinality strings (canonical
+ * names).
+ *
+ * All characters live in one contiguous buffer addressed by an offset table,
+ * so a name costs its bytes plus 8 bytes instead of a heap-allocated
+ * std::string. No deduplication: names are nearly unique per node.
+ * replace() leaves the old bytes behind unless the length is unchanged;
+ * the owner calls compact() once garbageBytes() is worth reclaiming.
+ */
+class StringArena {
+public:
+  static constexpr uint32_t NO_ID = std::numeric_limits<uint32_t>::max();
+
+  StringArena() : offsets{0} {}
+
+  uint32_t append(std::string_view s) {
+    buffer.append(s.data(), s.size());
+    offsets.push_back(buffer.size());
+    return static_cast<uint32_t>(offsets.size() - 2);
+  }
+
+  /**
+   * @brief Gives string `id` (or NO_ID, a new one) the value s: in place
+   * if the length is unchanged, else appended, with the old bytes counted
+   * as garbage.
+   * @return The ID now holding s.
+   */
+  uint32_t replace(uint32_t id, std::string_view s) {
+    if (id == NO_ID)
+      return append(s);
+    const uint64_t length = offsets[id + 1] - offsets[id];
+    if (length == s.size()) {
+      std::copy(s.begin(), s.end(), buffer.begin() + offsets[id]);
+      return id;
+    }
+    garbage += length + sizeof(uint64_t);
+    return append(s);
+  }
+
+  /**
+   * @brief Rewrites the arena with only the strings listed in ids (NO_ID
+   * entries skipped), in that order, and renumbers ids to match. ids must
+   * name every live string exactly once.
+   */
+  void compact(std::vector<uint32_t> &ids) {
+    std::string chars;
+    std::vector<uint64_t> ends{0};
+    chars.reserve(buffer.size() - std::min<size_t>(garbage, buffer.size()));
+    for (uint32_t &id : ids) {
+      if (id == NO_ID)
+        continue;
+      const std::string_view s = view(id);
+      chars.append(s.data(), s.size());
+      ends.push_back(chars.size());
+      id = static_cast<uint32_t>(ends.size() - 2);
+    }
+    assign(std::move(chars), std::move(ends));
+  }
+
+  /**
+   * @brief Replaces the contents with a prebuilt buffer; string i is
+   * buffer[ends[i], ends[i + 1]), and ends starts with 0.
+   */
+  void assign(std::string chars, std::vector<uint64_t> ends) {
+    buffer = std::move(chars);
+    offsets = std::move(ends);
+    garbage = 0;
+  }
+
+  std::string_view view(uint32_t id) const {
+    if (id == NO_ID)
+      return {};
+    return std::string_view(buffer.data() + offsets[id],
+                            offsets[id + 1] - offsets[id]);
+  }
+
+  size_t size() const { return offsets.size() - 1; }
+  size_t bytes() const {
+    return buffer.capacity() + offsets.capacity() * sizeof(uint64_t);
+  }
+  size_t usedBytes() const {
+    return buffer.size() + offsets.size() * sizeof(uint64_t);
+  }
+  size_t garbageBytes() const { return garbage; } // Replaced, not reclaimed
+
+private:
+  std::string buffer;
+  std::vector<uint64_t> offsets;
+  size_t garbage = 0;
+};
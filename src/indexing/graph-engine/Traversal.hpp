@@ -0,0 +1,337 @@
+#pragma once
+
+#include "CsrGraph.hpp"
+#include "PathSearch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * @class Traversal
+ * @brief Generic BFS / DFS over a CsrGraph, specialized at compile time by
+ * an edge predicate and a visitor.
+ *
+ * run<Order, Direction>(g, sources, accept, visitor) is the one kernel;
+ * shortestPath, anyPath, descendants and ancestors are instantiations of
+ * it. Both policies are template parameters, so the inner loop calls them
+ * directly and the compiler inlines them:
+ *
+ * - An edge predicate is `bool operator()(uint64_t pos) const`, pos being
+ *   the forward CSR edge position (also for in-edges). AnyEdge compiles to
+ *   nothing, LabelIs to one integer compare, LabelMask to a bit test;
+ *   label strings are resolved once, when the predicate is built.
+ * - A visitor derives from Visitor and may hide `discover`, called once
+ *   per newly reached node; returning false ends the traversal. Nodes at
+ *   maxDepth are reached but not expanded.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: A new query shape is a small struct, not another copy of the
+ *   search loop, and still has no virtual or std::function call per edge.
+ * - CON: Every (order, direction, predicate, visitor) combination is its
+ *   own instantiation, i.e. more code. std::function filters remain the
+ *   right tool outside hot loops.
+ * - CON: A depth-bounded DFS must re-enter a node it later reaches by a
+ *   shorter path, so its worst case is above BFS's; prefer BFS for
+ *   bounded reachability and DFS when any path will do.
+ */
+class Traversal {
+public:
+  static constexpr uint32_t NONE = CsrGraph::NO_NODE;
+  static constexpr uint32_t UNBOUNDED = std::numeric_limits<uint32_t>::max();
+
+  enum class Order { BREADTH, DEPTH };
+  enum class Direction { OUT, IN };
+
+  /**
+   * @struct Stats
+   * @brief Work done by the last run().
+   */
+  struct Stats {
+    uint64_t expanded = 0;   // Rows scanned
+    uint64_t discovered = 0; // Nodes reached, sources included
+  };
+
+  // --- Edge predicates ---
+
+  struct AnyEdge {
+    bool operator()(uint64_t) const { return true; }
+  };
+
+  /**
+   * @struct LabelIs
+   * @brief Edges with one label, e.g. only CAUSES.
+   */
+  struct LabelIs {
+    const uint32_t *labels;
+    uint32_t label;
+
+    LabelIs(const CsrGraph &g, const std::string &name)
+        : labels(g.edgeLabelData()), label(g.labelId(name)) {}
+
+    bool operator()(uint64_t pos) const { return labels[pos] == label; }
+  };
+
+  /**
+   * @struct LabelMask
+   * @brief Edges whose label is in a set, tested against a bitmask of
+   * interned label IDs. Labels the graph does not use are ignored.
+   */
+  struct LabelMask {
+    const uint32_t *labels;
+    std::vector<uint64_t> words;
+
+    LabelMask(const CsrGraph &g, const std::vector<std::string> &names)
+        : labels(g.edgeLabelData()) {
+      for (const std::string &name : names) {
+        const uint32_t id = g.labelId(name);
+        if (id == NONE)
+          continue;
+        if (words.size() <= id / 64)
+          words.resize(id / 64 + 1, 0);
+        words[id / 64] |= uint64_t(1) << (id % 64);
+      }
+    }
+
+    bool operator()(uint64_t pos) const {
+      const uint32_t l = labels[pos];
+      return l / 64 < words.size() && (words[l / 64] >> (l % 64) & 1);
+    }
+  };
+
+  // --- Visitors ---
+
+  /**
+   * @struct Visitor
+   * @brief Visits everything within maxDepth. Derive and hide discover()
+   * to act on nodes.
+   */
+  struct Visitor {
+    uint32_t maxDepth = UNBOUNDED;
+
+    bool discover(uint32_t /*node*/, uint32_t /*depth*/) { return true; }
+  };
+
+  /**
+   * @struct FindTarget
+   * @brief Stops as soon as `target` is reached.
+   */
+  struct FindTarget : Visitor {
+    uint32_t target = NONE;
+    bool found = false;
+
+    bool discover(uint32_t node, uint32_t) {
+      found = node == target;
+      return !found;
+    }
+  };
+
+  /**
+   * @struct Collect
+   * @brief Records every node reached below depth 0, in visit order.
+   */
+  struct Collect : Visitor {
+    std::vector<uint32_t> nodes;
+
+    bool discover(uint32_t node, uint32_t depth) {
+      if (depth > 0)
+        nodes.push_back(node);
+      return true;
+    }
+  };
+
+  /**
+   * @brief The kernel: traverses from every source (dense indices) in
+   * `order`, following `direction` edges that `accept` admits. Sources
+   * are discovered at depth 0. Parents and depths stay readable through
+   * lastMarks() until the next run.
+   * @return false if the visitor stopped the traversal.
+   */
+  template <Order order, Direction direction = Direction::OUT,
+            typename Predicate, typename V>
+  bool run(const CsrGraph &g, const std::vector<uint32_t> &sources,
+           const Predicate &accept, V &visitor) {
+    stats = Stats();
+    const size_t n = g.nodeCount();
+    marks.begin(n);
+    const bool out = direction == Direction::OUT;
+    const uint64_t *offsets = out ? g.outOffsetData() : g.inOffsetData();
+    const uint32_t *adjacency = out ? g.neighborData() : g.inNeighborData();
+    const uint64_t *edgePos = out ? nullptr : g.inEdgePosData();
+    auto admits = [&](uint64_t p) {
+      if constexpr (direction == Direction::OUT)
+        return accept(p);
+      else
+        return accept(edgePos[p]);
+    };
+    auto reach = [&](uint32_t v, uint32_t parent, uint32_t depth) {
+      marks.mark(v, parent, depth);
+      stats.discovered++;
+      return visitor.discover(v, depth);
+    };
+
+    if constexpr (order == Order::BREADTH) {
+      queue.clear();
+      for (uint32_t s : sources) {
+        if (s >= n || marks.seen(s))
+          continue;
+        if (!reach(s, s, 0))
+          return false;
+        queue.push_back(s);
+      }
+      for (size_t head = 0; head < queue.size(); ++head) {
+        const uint32_t u = queue[head], d = marks.depthOf(u);
+        if (d >= visitor.maxDepth)
+          continue;
+        stats.expanded++;
+        for (uint64_t p = offsets[u]; p < offsets[u + 1]; ++p) {
+          if (!admits(p)) // Sequential label read before the random mark
+            continue;
+          const uint32_t v = adjacency[p];
+          if (marks.seen(v))
+            continue;
+          if (!reach(v, u, d + 1))
+            return false;
+          queue.push_back(v);
+        }
+      }
+    } else {
+      const bool bounded = visitor.maxDepth != UNBOUNDED;
+      for (uint32_t s : sources) {
+        if (s >= n || marks.seen(s))
+          continue;
+        if (!reach(s, s, 0))
+          return false;
+        stack.push_back({s, offsets[s]});
+        while (!stack.empty()) {
+          Frame &f = stack.back();
+          const uint32_t u = f.node, d = marks.depthOf(u);
+          if (d >= visitor.maxDepth || f.pos == offsets[u + 1]) {
+            stack.pop_back();
+            continue;
+          }
+          if (f.pos == offsets[u])
+            stats.expanded++;
+          const uint64_t p = f.pos++;
+          if (!admits(p))
+            continue;
+          const uint32_t v = adjacency[p];
+          if (marks.seen(v)) {
+            // Bounded: a shallower arrival may reach further.
+            if (!bounded || marks.depthOf(v) <= d + 1)
+              continue;
+            marks.mark(v, u, d + 1);
+          } else if (!reach(v, u, d + 1)) {
+            stack.clear();
+            return false;
+          }
+          stack.push_back({v, offsets[v]});
+        }
+      }
+    }
+    return true;
+  }
+
+  // --- Instantiations ---
+
+  /**
+   * @brief Fewest-hop path over admitted out-edges (BFS), at most
+   * maxDepth hops; external IDs, empty if none.
+   */
+  template <typename Predicate = AnyEdge>
+  std::vector<uint64_t> shortestPath(const CsrGraph &g, uint32_t start,
+                                     uint32_t end,
+                                     const Predicate &accept = Predicate(),
+                                     uint32_t maxDepth = UNBOUNDED) {
+    return pathSearch<Order::BREADTH>(g, start, end, accept, maxDepth);
+  }
+
+  /**
+   * @brief Some path over admitted out-edges (DFS, first found), at most
+   * maxDepth hops. Cheaper than shortestPath when paths are plentiful.
+   */
+  template <typename Predicate = AnyEdge>
+  std::vector<uint64_t> anyPath(const CsrGraph &g, uint32_t start,
+                                uint32_t end,
+                                const Predicate &accept = Predicate(),
+                                uint32_t maxDepth = UNBOUNDED) {
+    return pathSearch<Order::DEPTH>(g, start, end, accept, maxDepth);
+  }
+
+  /**
+   * @brief Every node reachable from `sources` within maxDepth admitted
+   * out-edges, sources excluded. Dense indices in BFS order.
+   */
+  template <typename Predicate = AnyEdge>
+  std::vector<uint32_t> descendants(const CsrGraph &g,
+                                    const std::vector<uint32_t> &sources,
+                                    const Predicate &accept = Predicate(),
+                                    uint32_t maxDepth = UNBOUNDED) {
+    return closure<Direction::OUT>(g, sources, accept, maxDepth);
+  }
+
+  /**
+   * @brief Every node that reaches one of `sources` within maxDepth
+   * admitted edges (the possible causes). Dense indices in BFS order.
+   */
+  template <typename Predicate = AnyEdge>
+  std::vector<uint32_t> ancestors(const CsrGraph &g,
+                                  const std::vector<uint32_t> &sources,
+                                  const Predicate &accept = Predicate(),
+                                  uint32_t maxDepth = UNBOUNDED) {
+    return closure<Direction::IN>(g, sources, accept, maxDepth);
+  }
+
+  /**
+   * @brief External IDs from the source that reached `node` to `node`,
+   * empty if the last run missed it. After a Direction::IN run the path
+   * runs against the edges.
+   */
+  std::vector<uint64_t> pathTo(const CsrGraph &g, uint32_t node) const {
+    std::vector<uint64_t> path;
+    if (node >= g.nodeCount() || !marks.seen(node))
+      return path;
+    for (; marks.depthOf(node) > 0; node = marks.parentOf(node))
+      path.push_back(g.nodeIdAt(node));
+    path.push_back(g.nodeIdAt(node));
+    std::reverse(path.begin(), path.end());
+    return path;
+  }
+
+  const VisitMarks &lastMarks() const { return marks; }
+  const Stats &lastStats() const { return stats; }
+
+private:
+  struct Frame {
+    uint32_t node;
+    uint64_t pos; // Next edge to try
+  };
+
+  VisitMarks marks;
+  std::vector<uint32_t> queue;
+  std::vector<Frame> stack;
+  Stats stats;
+
+  template <Order order, typename Predicate>
+  std::vector<uint64_t> pathSearch(const CsrGraph &g, uint32_t start,
+                                   uint32_t end, const Predicate &accept,
+                                   uint32_t maxDepth) {
+    FindTarget visitor;
+    visitor.maxDepth = maxDepth;
+    visitor.target = end;
+    run<order>(g, {start}, accept, visitor);
+    return visitor.found ? pathTo(g, end) : std::vector<uint64_t>();
+  }
+
+  template <Direction direction, typename Predicate>
+  std::vector<uint32_t> closure(const CsrGraph &g,
+                                const std::vector<uint32_t> &sources,
+                                const Predicate &accept, uint32_t maxDepth) {
+    Collect visitor;
+    visitor.maxDepth = maxDepth;
+    run<Order::BREADTH, direction>(g, sources, accept, visitor);
+    return std::move(visitor.nodes);
+  }
+};
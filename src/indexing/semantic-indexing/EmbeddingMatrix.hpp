@@ -0,0 +1,220 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class EmbeddingMatrix
+ * @brief Read-only view of the float32 .npy matrices that Embedder.py and
+ * SummaryIndexer.py write (one row per chunk or community).
+ *
+ * The file is mapped, not read: open() checks the .npy header and hands
+ * out row pointers straight into the page cache, so a 10M x 384 matrix
+ * (15 GB) opens instantly and only the rows actually touched are paged
+ * in. Row i belongs to the i-th record of the sibling .json metadata,
+ * which readMetadataIds() turns into the node IDs GraphEngine uses.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: No copy and no parse; several processes share one set of pages.
+ * - CON: Only what np.save writes for a C-ordered 2-D float32 array is
+ *   accepted ('<f4', fortran_order False). Anything else is rejected, not
+ *   converted.
+ * - CON: The file must not be truncated while mapped (reads would fault).
+ */
+class EmbeddingMatrix {
+public:
+  /**
+   * @brief Maps and validates an .npy file.
+   * @return nullptr if the file is missing, not .npy, or not a 2-D
+   * little-endian float32 matrix (reason in *error).
+   */
+  static std::shared_ptr<const EmbeddingMatrix>
+  open(const std::string &path, std::string *error = nullptr) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return fail(error, "cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < 16) {
+      ::close(fd);
+      return fail(error, path + " is too small to be an .npy file");
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void *addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps its own reference to the file
+    if (addr == MAP_FAILED)
+      return fail(error, "cannot mmap " + path);
+
+    auto matrix = std::shared_ptr<EmbeddingMatrix>(new EmbeddingMatrix());
+    matrix->region = std::make_shared<const Region>(addr, size);
+    std::string why = matrix->bind();
+    if (!why.empty())
+      return fail(error, path + ": " + why);
+    return matrix;
+  }
+
+  /**
+   * @brief Writes rows x dim floats as a version 1.0 .npy file, the same
+   * bytes np.save would produce.
+   */
+  static bool write(const std::string &path, const float *data, size_t rows,
+                    size_t dim, std::string *error = nullptr) {
+    std::string header = "{'descr': '<f4', 'fortran_order': False, "
+                         "'shape': (" +
+                         std::to_string(rows) + ", " + std::to_string(dim) +
+                         "), }";
+    // Magic (6) + version (2) + length (2) + header + '\n', padded to 64.
+    size_t total = (10 + header.size() + 1 + 63) / 64 * 64;
+    header.append(total - 10 - header.size() - 1, ' ');
+    header += '\n';
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    const char magic[] = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0};
+    const uint16_t length = static_cast<uint16_t>(header.size());
+    const char len[] = {static_cast<char>(length & 0xff),
+                        static_cast<char>(length >> 8)};
+    out.write(magic, sizeof(magic));
+    out.write(len, sizeof(len));
+    out << header;
+    out.write(reinterpret_cast<const char *>(data),
+              static_cast<std::streamsize>(rows * dim * sizeof(float)));
+    if (!out) {
+      if (error)
+        *error = "cannot write " + path;
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Reads the integer value of `key` from each record of a
+   * metadata .json file, in file order ("id" for Embedder.py output,
+   * "community_id" for SummaryIndexer.py). Quoted numbers are accepted.
+   * @return false if the file is unreadable or a value is not a
+   * non-negative integer (reason in *error).
+   */
+  static bool readMetadataIds(const std::string &path, const std::string &key,
+                              std::vector<uint64_t> &ids,
+                              std::string *error = nullptr) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+      if (error)
+        *error = "cannot open " + path;
+      return false;
+    }
+    const std::string text((std::istreambuf_iterator<char>(in)),
+                           std::istreambuf_iterator<char>());
+    const std::string quoted = '"' + key + '"';
+    ids.clear();
+    for (size_t at = text.find(quoted); at != std::string::npos;
+         at = text.find(quoted, at)) {
+      at += quoted.size();
+      size_t p = text.find_first_not_of(" \t\r\n", at);
+      if (p == std::string::npos || text[p] != ':')
+        continue; // The key appeared as a value, not a field name
+      p = text.find_first_not_of(" \t\r\n\"", p + 1);
+      char *end = nullptr;
+      const char *digits = p == std::string::npos ? "" : text.c_str() + p;
+      unsigned long long v = std::strtoull(digits, &end, 10);
+      if (end == digits || *digits == '-') {
+        if (error)
+          *error = path + ": \"" + key + "\" #" + std::to_string(ids.size()) +
+                   " is not a non-negative integer";
+        return false;
+      }
+      ids.push_back(v);
+    }
+    return true;
+  }
+
+  size_t rows() const { return rowCount; }
+  size_t dimension() const { return dim; }
+  const float *data() const { return values; }
+  const float *row(size_t i) const { return values + i * dim; }
+  size_t mappedBytes() const { return region->size; }
+
+private:
+  /**
+   * @brief Owns the mapping; unmapped when the last view goes away.
+   */
+  struct Region {
+    void *addr;
+    size_t size;
+    Region(void *addr, size_t size) : addr(addr), size(size) {}
+    ~Region() { ::munmap(addr, size); }
+    Region(const Region &) = delete;
+    Region &operator=(const Region &) = delete;
+  };
+
+  std::shared_ptr<const Region> region;
+  const float *values = nullptr;
+  size_t rowCount = 0;
+  size_t dim = 0;
+
+  EmbeddingMatrix() = default;
+
+  static std::shared_ptr<const EmbeddingMatrix> fail(std::string *error,
+                                                     const std::string &why) {
+    if (error)
+      *error = why;
+    return nullptr;
+  }
+
+  /**
+   * @brief Parses the header dictionary and points values at the data.
+   * @return Empty on success, otherwise what is wrong with the file.
+   */
+  std::string bind() {
+    const auto *bytes = static_cast<const unsigned char *>(region->addr);
+    if (std::memcmp(bytes, "\x93NUMPY", 6) != 0)
+      return "not an .npy file";
+    size_t headerLen, offset;
+    if (bytes[6] == 1) {
+      headerLen = bytes[8] | size_t(bytes[9]) << 8;
+      offset = 10;
+    } else if (bytes[6] == 2 || bytes[6] == 3) {
+      headerLen = bytes[8] | size_t(bytes[9]) << 8 | size_t(bytes[10]) << 16 |
+                  size_t(bytes[11]) << 24;
+      offset = 12;
+    } else {
+      return "unsupported .npy version " + std::to_string(bytes[6]);
+    }
+    if (offset + headerLen > region->size)
+      return "truncated header";
+    const std::string header(reinterpret_cast<const char *>(bytes) + offset,
+                             headerLen);
+    if (header.find("'descr': '<f4'") == std::string::npos)
+      return "dtype is not little-endian float32";
+    if (header.find("'fortran_order': False") == std::string::npos)
+      return "matrix is not C-ordered";
+    size_t shape = header.find("'shape': (");
+    if (shape == std::string::npos)
+      return "missing shape";
+    char *end = nullptr;
+    const char *p = header.c_str() + shape + 10;
+    rowCount = std::strtoull(p, &end, 10);
+    if (end == p || *end != ',')
+      return "shape is not 2-D";
+    p = end + 1;
+    dim = std::strtoull(p, &end, 10);
+    if (end == p || *end != ')' || dim == 0)
+      return "shape is not 2-D";
+    offset += headerLen;
+    if (offset % alignof(float) != 0)
+      return "misaligned data";
+    if (region->size - offset < rowCount * dim * sizeof(float))
+      return "truncated data: shape needs " +
+             std::to_string(rowCount * dim * sizeof(float)) + " bytes";
+    values = reinterpret_cast<const float *>(bytes + offset);
+    return "";
+  }
+};
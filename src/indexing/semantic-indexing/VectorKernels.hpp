@@ -0,0 +1,466 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define VECTOR_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define VECTOR_NEON 1
+#endif
+
+/**
+ * @enum VectorEncoding
+ * @brief How VectorStore keeps each vector: 2 or 1 byte per dimension.
+ */
+enum class VectorEncoding : uint8_t {
+  FLOAT16, // IEEE half; ~3 significant digits, no per-vector state
+  INT8     // Symmetric per-vector scale: x ~= code * scale
+};
+
+/**
+ * @class VectorKernels
+ * @brief Dot products between two encoded vectors, plus the encoders, and
+ * the plain float32 products behind exact cosine scoring.
+ *
+ * Both operands are always in the same encoding, so a query is encoded
+ * once and then compared against stored vectors without decoding them
+ * element by element in scalar code.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - INT8 products are exact integer sums, widened to 16 bits and summed
+ *   pairwise (madd) into 32-bit lanes; the caller multiplies by the two
+ *   scales. Error comes only from quantization (under 1% on unit
+ *   vectors of a few hundred dimensions).
+ * - FLOAT16 is converted to float in registers (F16C / NEON fcvt) and
+ *   accumulated with FMA, so it costs about as much as float32 at half
+ *   the memory traffic.
+ * - float32x4x4 scores four consecutive rows against four others per
+ *   call, 16 accumulators fed by 8 loads per step, so it is bound by FMA
+ *   throughput rather than loads, as long as its fixed-size loops are
+ *   unrolled so the accumulators stay in registers. That is the inner
+ *   kernel of a tiled all-pairs pass.
+ * - x86 kernels are picked at runtime via CPUID (AVX-512BW, then
+ *   AVX2+F16C+FMA); NEON is used whenever the target has it.
+ */
+class VectorKernels {
+public:
+  using Dot = float (*)(const void *a, const void *b, size_t dim);
+  using Dot32 = float (*)(const float *a, const float *b, size_t dim);
+  using Dot32x4x4 = void (*)(const float *a, const float *b, size_t dim,
+                             float *out);
+
+  static size_t bytesPerDimension(VectorEncoding e) {
+    return e == VectorEncoding::INT8 ? 1 : 2;
+  }
+
+  /**
+   * @brief Raw dot product of two encoded vectors. For INT8 this is the
+   * integer sum; multiply by both scales to get the float product.
+   */
+  static Dot dot(VectorEncoding e) {
+    const Table &t = table();
+    return e == VectorEncoding::INT8 ? t.int8 : t.float16;
+  }
+
+  /**
+   * @brief float32 dot product.
+   */
+  static float dotFloat32(const float *a, const float *b, size_t dim) {
+    return table().float32(a, b, dim);
+  }
+
+  /**
+   * @brief out[4 * r + k] = a[r] . b[k] for the four rows starting at `a`
+   * and the four starting at `b`, each `dim` floats, stored back to back.
+   */
+  static void dotFloat32x4x4(const float *a, const float *b, size_t dim,
+                             float *out) {
+    table().float32x4x4(a, b, dim, out);
+  }
+
+  /**
+   * @brief Name of the kernels selected for this CPU, for logging.
+   */
+  static const char *kernelName() { return table().name; }
+
+  /**
+   * @brief Encodes dim floats into out (dim * bytesPerDimension bytes).
+   * @return The scale to multiply INT8 products by (1 for FLOAT16).
+   */
+  static float encode(VectorEncoding e, const float *x, size_t dim,
+                      void *out) {
+    if (e == VectorEncoding::FLOAT16) {
+      auto *h = static_cast<uint16_t *>(out);
+      for (size_t i = 0; i < dim; ++i)
+        h[i] = toHalf(x[i]);
+      return 1.0f;
+    }
+    auto *q = static_cast<int8_t *>(out);
+    float peak = 0;
+    for (size_t i = 0; i < dim; ++i)
+      peak = std::max(peak, std::fabs(x[i]));
+    if (peak == 0) {
+      std::memset(q, 0, dim);
+      return 0;
+    }
+    const float inv = 127.0f / peak;
+    for (size_t i = 0; i < dim; ++i)
+      q[i] = static_cast<int8_t>(std::lrint(x[i] * inv));
+    return peak / 127.0f;
+  }
+
+  /**
+   * @brief float -> IEEE half, rounding to nearest even.
+   */
+  static uint16_t toHalf(float f) {
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    const uint16_t sign = static_cast<uint16_t>((x >> 16) & 0x8000);
+    x &= 0x7fffffff;
+    if (x >= 0x7f800000) // Inf or NaN
+      return sign | (x > 0x7f800000 ? 0x7e00 : 0x7c00);
+    if (x >= 0x477ff000) // Rounds past 65504
+      return sign | 0x7c00;
+    if (x < 0x38800000) { // Below 2^-14: subnormal half (or zero)
+      float a;
+      std::memcpy(&a, &x, sizeof(a));
+      return sign | static_cast<uint16_t>(std::nearbyint(a * 16777216.0f));
+    }
+    uint32_t h = ((x >> 23) - 112) << 10 | (x & 0x7fffff) >> 13;
+    uint32_t rest = x & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (h & 1)))
+      ++h; // A carry into the exponent is still the right encoding
+    return sign | static_cast<uint16_t>(h);
+  }
+
+  static float fromHalf(uint16_t h) {
+    const uint32_t sign = uint32_t(h & 0x8000) << 16;
+    const uint32_t exp = (h >> 10) & 0x1f;
+    const uint32_t mant = h & 0x3ff;
+    uint32_t bits;
+    if (exp == 0) {
+      float f = mant * (1.0f / 16777216.0f); // mant * 2^-24
+      return sign ? -f : f;
+    }
+    if (exp == 31)
+      bits = sign | 0x7f800000 | mant << 13;
+    else
+      bits = sign | (exp + 112) << 23 | mant << 13;
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+  }
+
+private:
+  struct Table {
+    Dot int8;
+    Dot float16;
+    Dot32 float32;
+    Dot32x4x4 float32x4x4;
+    const char *name;
+  };
+
+  static float int8Scalar(const void *pa, const void *pb, size_t dim) {
+    const auto *a = static_cast<const int8_t *>(pa);
+    const auto *b = static_cast<const int8_t *>(pb);
+    int32_t sum = 0;
+    for (size_t i = 0; i < dim; ++i)
+      sum += int32_t(a[i]) * b[i];
+    return static_cast<float>(sum);
+  }
+
+  static float float16Scalar(const void *pa, const void *pb, size_t dim) {
+    const auto *a = static_cast<const uint16_t *>(pa);
+    const auto *b = static_cast<const uint16_t *>(pb);
+    float sum = 0;
+    for (size_t i = 0; i < dim; ++i)
+      sum += fromHalf(a[i]) * fromHalf(b[i]);
+    return sum;
+  }
+
+  static float float32Scalar(const float *a, const float *b, size_t dim) {
+    float sum = 0;
+    for (size_t i = 0; i < dim; ++i)
+      sum += a[i] * b[i];
+    return sum;
+  }
+
+  static void float32x4x4Scalar(const float *a, const float *b, size_t dim,
+                                float *out) {
+    #pragma GCC unroll 4
+    for (int r = 0; r < 4; ++r)
+      #pragma GCC unroll 4
+      for (int k = 0; k < 4; ++k)
+        out[4 * r + k] = float32Scalar(a + r * dim, b + k * dim, dim);
+  }
+
+#if VECTOR_X86
+  __attribute__((target("avx2"))) static float hsum(__m256 v) {
+    __m128 s =
+        _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+  }
+
+  __attribute__((target("avx2,fma"))) static float
+  float32Avx2(const float *a, const float *b, size_t dim) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= dim; i += 16) {
+      acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i),
+                             acc0);
+      acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8),
+                             _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    return hsum(_mm256_add_ps(acc0, acc1)) +
+           float32Scalar(a + i, b + i, dim - i);
+  }
+
+  // 16 ymm registers: two rows of a against four of b at a time.
+  __attribute__((target("avx2,fma"))) static void
+  float32x4x4Avx2(const float *a, const float *b, size_t dim, float *out) {
+    const size_t tail = dim - dim % 8;
+    for (int r = 0; r < 4; r += 2) {
+      const float *a0 = a + r * dim, *a1 = a0 + dim;
+      __m256 acc[2][4] = {};
+      for (size_t i = 0; i < tail; i += 8) {
+        const __m256 x0 = _mm256_loadu_ps(a0 + i);
+        const __m256 x1 = _mm256_loadu_ps(a1 + i);
+        #pragma GCC unroll 4
+        for (int k = 0; k < 4; ++k) {
+          const __m256 y = _mm256_loadu_ps(b + k * dim + i);
+          acc[0][k] = _mm256_fmadd_ps(x0, y, acc[0][k]);
+          acc[1][k] = _mm256_fmadd_ps(x1, y, acc[1][k]);
+        }
+      }
+      #pragma GCC unroll 4
+      for (int h = 0; h < 2; ++h)
+        #pragma GCC unroll 4
+        for (int k = 0; k < 4; ++k)
+          out[4 * (r + h) + k] =
+              hsum(acc[h][k]) + float32Scalar(a0 + h * dim + tail,
+                                              b + k * dim + tail, dim - tail);
+    }
+  }
+
+  __attribute__((target("avx2"))) static float
+  int8Avx2(const void *pa, const void *pb, size_t dim) {
+    const auto *a = static_cast<const int8_t *>(pa);
+    const auto *b = static_cast<const int8_t *>(pb);
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= dim; i += 32) {
+      const __m256i a0 = _mm256_cvtepi8_epi16(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)));
+      const __m256i b0 = _mm256_cvtepi8_epi16(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+      const __m256i a1 = _mm256_cvtepi8_epi16(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i + 16)));
+      const __m256i b1 = _mm256_cvtepi8_epi16(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i + 16)));
+      acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(a0, b0));
+      acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(a1, b1));
+    }
+    __m256i acc = _mm256_add_epi32(acc0, acc1);
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+    return static_cast<float>(_mm_cvtsi128_si32(s)) +
+           int8Scalar(a + i, b + i, dim - i);
+  }
+
+  __attribute__((target("avx2,f16c,fma"))) static float
+  float16Avx2(const void *pa, const void *pb, size_t dim) {
+    const auto *a = static_cast<const uint16_t *>(pa);
+    const auto *b = static_cast<const uint16_t *>(pb);
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= dim; i += 16) {
+      const __m256 a0 = _mm256_cvtph_ps(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)));
+      const __m256 b0 = _mm256_cvtph_ps(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+      const __m256 a1 = _mm256_cvtph_ps(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i + 8)));
+      const __m256 b1 = _mm256_cvtph_ps(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i + 8)));
+      acc0 = _mm256_fmadd_ps(a0, b0, acc0);
+      acc1 = _mm256_fmadd_ps(a1, b1, acc1);
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc),
+                          _mm256_extractf128_ps(acc, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s) + float16Scalar(a + i, b + i, dim - i);
+  }
+
+  // GCC 12 warns about the intrinsics' own _mm512_undefined_* placeholders.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+  __attribute__((target("avx512f,avx512bw"))) static float
+  int8Avx512(const void *pa, const void *pb, size_t dim) {
+    const auto *a = static_cast<const int8_t *>(pa);
+    const auto *b = static_cast<const int8_t *>(pb);
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 32 <= dim; i += 32) {
+      const __m512i a0 = _mm512_cvtepi8_epi16(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)));
+      const __m512i b0 = _mm512_cvtepi8_epi16(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+      acc = _mm512_add_epi32(acc, _mm512_madd_epi16(a0, b0));
+    }
+    return static_cast<float>(_mm512_reduce_add_epi32(acc)) +
+           int8Scalar(a + i, b + i, dim - i);
+  }
+
+  __attribute__((target("avx512f"))) static float
+  float16Avx512(const void *pa, const void *pb, size_t dim) {
+    const auto *a = static_cast<const uint16_t *>(pa);
+    const auto *b = static_cast<const uint16_t *>(pb);
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= dim; i += 16) {
+      const __m512 a0 = _mm512_cvtph_ps(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)));
+      const __m512 b0 = _mm512_cvtph_ps(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+      acc = _mm512_fmadd_ps(a0, b0, acc);
+    }
+    return _mm512_reduce_add_ps(acc) + float16Scalar(a + i, b + i, dim - i);
+  }
+
+  __attribute__((target("avx512f"))) static float
+  float32Avx512(const float *a, const float *b, size_t dim) {
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= dim; i += 16)
+      acc = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i),
+                            acc);
+    return _mm512_reduce_add_ps(acc) + float32Scalar(a + i, b + i, dim - i);
+  }
+
+  __attribute__((target("avx512f"))) static void
+  float32x4x4Avx512(const float *a, const float *b, size_t dim, float *out) {
+    const size_t tail = dim - dim % 16;
+    __m512 acc[4][4] = {};
+    for (size_t i = 0; i < tail; i += 16) {
+      __m512 x[4];
+      #pragma GCC unroll 4
+      for (int r = 0; r < 4; ++r)
+        x[r] = _mm512_loadu_ps(a + r * dim + i);
+      #pragma GCC unroll 4
+      for (int k = 0; k < 4; ++k) {
+        const __m512 y = _mm512_loadu_ps(b + k * dim + i);
+        #pragma GCC unroll 4
+        for (int r = 0; r < 4; ++r)
+          acc[r][k] = _mm512_fmadd_ps(x[r], y, acc[r][k]);
+      }
+    }
+    #pragma GCC unroll 4
+    for (int r = 0; r < 4; ++r)
+      #pragma GCC unroll 4
+      for (int k = 0; k < 4; ++k)
+        out[4 * r + k] =
+            _mm512_reduce_add_ps(acc[r][k]) +
+            float32Scalar(a + r * dim + tail, b + k * dim + tail, dim - tail);
+  }
+#pragma GCC diagnostic pop
+#endif
+
+#if VECTOR_NEON
+  static float int8Neon(const void *pa, const void *pb, size_t dim) {
+    const auto *a = static_cast<const int8_t *>(pa);
+    const auto *b = static_cast<const int8_t *>(pb);
+    int32x4_t acc = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + 16 <= dim; i += 16) {
+      const int8x16_t x = vld1q_s8(a + i), y = vld1q_s8(b + i);
+      int16x8_t p = vmull_s8(vget_low_s8(x), vget_low_s8(y));
+      p = vmlal_s8(p, vget_high_s8(x), vget_high_s8(y)); // |p| <= 2 * 127^2
+      acc = vpadalq_s16(acc, p);
+    }
+    return static_cast<float>(vaddvq_s32(acc)) +
+           int8Scalar(a + i, b + i, dim - i);
+  }
+
+  static float float16Neon(const void *pa, const void *pb, size_t dim) {
+    const auto *a = static_cast<const uint16_t *>(pa);
+    const auto *b = static_cast<const uint16_t *>(pb);
+    float32x4_t acc = vdupq_n_f32(0);
+    size_t i = 0;
+    for (; i + 4 <= dim; i += 4) {
+      const float32x4_t x =
+          vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(a + i)));
+      const float32x4_t y =
+          vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(b + i)));
+      acc = vfmaq_f32(acc, x, y);
+    }
+    return vaddvq_f32(acc) + float16Scalar(a + i, b + i, dim - i);
+  }
+
+  static float float32Neon(const float *a, const float *b, size_t dim) {
+    float32x4_t acc = vdupq_n_f32(0);
+    size_t i = 0;
+    for (; i + 4 <= dim; i += 4)
+      acc = vfmaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    return vaddvq_f32(acc) + float32Scalar(a + i, b + i, dim - i);
+  }
+
+  static void float32x4x4Neon(const float *a, const float *b, size_t dim,
+                              float *out) {
+    const size_t tail = dim - dim % 4;
+    float32x4_t acc[4][4] = {};
+    for (size_t i = 0; i < tail; i += 4) {
+      float32x4_t x[4];
+      #pragma GCC unroll 4
+      for (int r = 0; r < 4; ++r)
+        x[r] = vld1q_f32(a + r * dim + i);
+      #pragma GCC unroll 4
+      for (int k = 0; k < 4; ++k) {
+        const float32x4_t y = vld1q_f32(b + k * dim + i);
+        #pragma GCC unroll 4
+        for (int r = 0; r < 4; ++r)
+          acc[r][k] = vfmaq_f32(acc[r][k], x[r], y);
+      }
+    }
+    #pragma GCC unroll 4
+    for (int r = 0; r < 4; ++r)
+      #pragma GCC unroll 4
+      for (int k = 0; k < 4; ++k)
+        out[4 * r + k] =
+            vaddvq_f32(acc[r][k]) +
+            float32Scalar(a + r * dim + tail, b + k * dim + tail, dim - tail);
+  }
+#endif
+
+  static const Table &table() {
+    static const Table t = []() -> Table {
+#if VECTOR_X86
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512bw"))
+        return {&int8Avx512, &float16Avx512, &float32Avx512,
+                &float32x4x4Avx512, "avx512bw"};
+      if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c") &&
+          __builtin_cpu_supports("fma"))
+        return {&int8Avx2, &float16Avx2, &float32Avx2, &float32x4x4Avx2,
+                "avx2"};
+#elif VECTOR_NEON
+      return {&int8Neon, &float16Neon, &float32Neon, &float32x4x4Neon, "neon"};
+#endif
+      return {&int8Scalar, &float16Scalar, &float32Scalar, &float32x4x4Scalar,
+              "scalar"};
+    }();
+    return t;
+  }
+};
@@ -0,0 +1,193 @@
+#include "../data-preprocessing/LatencyHistogram.hpp"
+#include "../graph-engine/GraphEngine.hpp"
+#include "VectorStore.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief Embedder.py-shaped output: `rows` unit vectors in `topics`
+ * clusters, written as <base>.npy plus <base>.json with one {"id": ...}
+ * record per row.
+ */
+static void writeCorpus(const std::string &base, size_t rows, size_t dim,
+                        size_t topics, uint64_t firstId) {
+  std::mt19937_64 gen(7);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  std::vector<float> centers(topics * dim);
+  for (float &c : centers)
+    c = noise(gen);
+  std::vector<float> data(rows * dim);
+  for (size_t r = 0; r < rows; ++r) {
+    const float *c = centers.data() + (r % topics) * dim;
+    for (size_t d = 0; d < dim; ++d)
+      data[r * dim + d] = c[d] + 0.6f * noise(gen);
+  }
+  EmbeddingMatrix::write(base + ".npy", data.data(), rows, dim);
+  std::ofstream meta(base + ".json");
+  meta << "[\n";
+  for (size_t r = 0; r < rows; ++r)
+    meta << "    {\n        \"id\": " << firstId + r
+         << ",\n        \"text\": \"chunk " << r << " of topic " << r % topics
+         << "\"\n    }" << (r + 1 < rows ? ",\n" : "\n");
+  meta << "]\n";
+}
+
+static double msSince(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - t)
+      .count();
+}
+
+/**
+ * @brief Exact float32 cosine top-k straight from the mapped matrix.
+ */
+static std::vector<uint64_t> groundTruth(const EmbeddingMatrix &m,
+                                         const std::vector<uint64_t> &ids,
+                                         const float *query, size_t k) {
+  std::vector<std::pair<float, uint64_t>> scored(m.rows());
+  double qn = 0;
+  for (size_t d = 0; d < m.dimension(); ++d)
+    qn += double(query[d]) * query[d];
+  for (size_t r = 0; r < m.rows(); ++r) {
+    const float *v = m.row(r);
+    double dot = 0, vn = 0;
+    for (size_t d = 0; d < m.dimension(); ++d) {
+      dot += double(v[d]) * query[d];
+      vn += double(v[d]) * v[d];
+    }
+    scored[r] = {static_cast<float>(dot / std::sqrt(qn * vn)), ids[r]};
+  }
+  std::partial_sort(scored.begin(), scored.begin() + k, scored.end(),
+                    [](const auto &a, const auto &b) { return a > b; });
+  std::vector<uint64_t> top;
+  for (size_t i = 0; i < k; ++i)
+    top.push_back(scored[i].second);
+  return top;
+}
+
+int main(int argc, char **argv) {
+  const size_t rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  const size_t dim = 384, topics = 200, k = 10, queries = 200;
+  const uint64_t firstId = 1000;
+  const std::string dir =
+      (std::filesystem::temp_directory_path() /
+       ("vector_store_" + std::to_string(::getpid())))
+          .string();
+  std::filesystem::create_directories(dir);
+  const std::string base = dir + "/knowledge_vectors";
+
+  std::cout << "--- Vector Store: " << rows << " x " << dim << " embeddings, "
+            << VectorKernels::kernelName() << " kernels ---" << std::endl;
+  writeCorpus(base, rows, dim, topics, firstId);
+  std::string error;
+  auto matrix = EmbeddingMatrix::open(base + ".npy", &error);
+  std::vector<uint64_t> ids;
+  if (!matrix ||
+      !EmbeddingMatrix::readMetadataIds(base + ".json", "id", ids, &error)) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  std::cout << "Mapped " << matrix->mappedBytes() / 1e6 << " MB, "
+            << ids.size() << " IDs from the metadata" << std::endl;
+
+  // Queries: perturbed copies of random rows.
+  std::mt19937_64 gen(11);
+  std::normal_distribution<float> noise(0.0f, 0.3f);
+  std::vector<float> batch(queries * dim);
+  for (size_t q = 0; q < queries; ++q) {
+    const float *row = matrix->row(gen() % matrix->rows());
+    for (size_t d = 0; d < dim; ++d)
+      batch[q * dim + d] = row[d] + noise(gen);
+  }
+  std::vector<std::vector<uint64_t>> truth;
+  for (size_t q = 0; q < queries; ++q)
+    truth.push_back(groundTruth(*matrix, ids, batch.data() + q * dim, k));
+
+  for (VectorEncoding encoding :
+       {VectorEncoding::INT8, VectorEncoding::FLOAT16}) {
+    const char *name = encoding == VectorEncoding::INT8 ? "int8" : "float16";
+    std::cout << "\n--- " << name << " ---" << std::endl;
+    VectorStore::Options opts;
+    opts.encoding = encoding;
+    VectorStore store(dim, opts);
+    auto t = std::chrono::steady_clock::now();
+    if (!store.build(*matrix, ids, &error)) {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+    std::cout << "Built in " << msSince(t) << " ms, "
+              << store.memoryBytes() / 1e6 << " MB in memory" << std::endl;
+
+    for (size_t ef : {16, 64, 256}) {
+      LatencyHistogram latency;
+      size_t hits = 0;
+      for (size_t q = 0; q < queries; ++q) {
+        t = std::chrono::steady_clock::now();
+        auto top = store.search(batch.data() + q * dim, k, ef);
+        latency.record(static_cast<uint64_t>(msSince(t) * 1e6));
+        for (const VectorStore::Hit &h : top)
+          hits += std::count(truth[q].begin(), truth[q].end(), h.nodeId);
+      }
+      std::printf("ef %3zu: recall@%zu %.3f | p50 %.1f us, p99 %.1f us\n",
+                  ef, k, double(hits) / (queries * k),
+                  latency.percentileNs(0.50) / 1e3,
+                  latency.percentileNs(0.99) / 1e3);
+    }
+    t = std::chrono::steady_clock::now();
+    auto answers = store.searchBatch(batch.data(), queries, k);
+    double batchMs = msSince(t);
+    size_t batchHits = 0;
+    for (size_t q = 0; q < queries; ++q)
+      for (const VectorStore::Hit &h : answers[q])
+        batchHits += std::count(truth[q].begin(), truth[q].end(), h.nodeId);
+    std::printf("Batch of %zu on %zu threads: %.1f us per query, recall "
+                "%.3f\n",
+                queries, store.options().threads, batchMs * 1e3 / queries,
+                double(batchHits) / (queries * k));
+
+    if (encoding != VectorEncoding::INT8)
+      continue;
+    // Vector-seeded traversal: the hits are node IDs the graph knows, so
+    // they seed a causal query without leaving the process.
+    std::cout << "\n--- Vector-Seeded Graph Traversal ---" << std::endl;
+    GraphEngine graph;
+    for (uint64_t id : ids)
+      graph.addNode(id, "CHUNK");
+    const uint64_t linkDown = 1, bgpReset = 2;
+    graph.addNode(linkDown, "PHYSICAL_EVENT");
+    graph.addNode(bgpReset, "PROTOCOL_EVENT");
+    graph.addEdge(1, linkDown, bgpReset, "CAUSES");
+    uint64_t edgeId = 1;
+    for (size_t r = 0; r < ids.size(); r += topics) // Topic 0 chunks
+      graph.addEdge(++edgeId, ids[r], linkDown, "DESCRIBES");
+    const float *topic0 = matrix->row(0);
+    auto seeds = store.search(topic0, 5);
+    std::vector<uint64_t> seedIds;
+    for (const VectorStore::Hit &h : seeds)
+      seedIds.push_back(h.nodeId);
+    auto chains = graph.explainSymptoms(seedIds, {bgpReset});
+    std::cout << "Seeds:";
+    for (const VectorStore::Hit &h : seeds)
+      std::printf(" %llu (%.3f)", static_cast<unsigned long long>(h.nodeId),
+                  h.score);
+    std::cout << "\nBGP reset explained from chunk " << chains[0].rootCauseId
+              << " via";
+    for (uint64_t id : chains[0].path)
+      std::cout << ' ' << id;
+    std::cout << std::endl;
+  }
+
+  std::filesystem::remove_all(dir);
+  return 0;
+}
@@ -0,0 +1,525 @@
+#pragma once
+
+#include "../data-preprocessing/ParallelFor.hpp"
+#include "EmbeddingMatrix.hpp"
+#include "VectorKernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class VectorStore
+ * @brief Approximate top-k vector search (HNSW) over quantized
+ * embeddings, returning GraphEngine node IDs.
+ *
+ * Vectors are stored as INT8 (1 byte per dimension and a scale) or
+ * FLOAT16 (2 bytes per dimension) and compared with the SIMD kernels in
+ * VectorKernels. COSINE normalizes every vector and query first, so the
+ * score is a plain dot product.
+ *
+ * The index is a Hierarchical Navigable Small World graph. Each node gets
+ * a random top level. Upper levels are sparse express lanes with up to
+ * `neighbors` links per node; level 0 holds every node with up to twice
+ * that. A query walks greedily down the upper levels, then runs a beam
+ * search of width ef on level 0. Neighbours are chosen with the HNSW
+ * diversity heuristic: a candidate is kept only if it is closer to the
+ * new node than to any neighbour already kept.
+ *
+ * Level-0 links live in one flat array of fixed-size slots (a count, then
+ * the links) so a hop touches one cache line run. Upper-level slots are
+ * packed in a second array.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: Search cost grows with log(n); recall is tuned per query via ef.
+ * - PRO: At 10M x 384 dims, INT8 takes 3.8 GB of codes plus 1.3 GB of
+ *   level-0 links (M = 16), small enough for one process next to the
+ *   graph.
+ * - CON: Build is the expensive part (about efConstruction distance
+ *   evaluations per level per insert). It runs on `threads` workers with
+ *   one spin lock per node list, so with more than one thread the graph
+ *   depends on scheduling.
+ * - CON: No deletion, and add() must not run concurrently with search().
+ *   Both are fine for a store rebuilt from Embedder.py output.
+ * - CON: Scores come from the quantized codes. INT8 scores are within
+ *   about 1% of the float cosine; re-rank from the EmbeddingMatrix if
+ *   exact scores matter.
+ */
+class VectorStore {
+public:
+  enum class Metric : uint8_t {
+    COSINE, // Vectors and queries are normalized on the way in
+    DOT     // Raw inner product
+  };
+
+  struct Options {
+    VectorEncoding encoding = VectorEncoding::INT8;
+    Metric metric = Metric::COSINE;
+    uint32_t neighbors = 16;       // M: links per node above level 0
+    uint32_t efConstruction = 128; // Beam width while inserting
+    uint32_t efSearch = 64;        // Default beam width for search()
+    size_t threads = 0;            // Build/batch workers; 0 = all cores
+    uint64_t seed = 42;            // Level assignment
+  };
+
+  struct Hit {
+    uint64_t nodeId;
+    float score; // Cosine or dot product, higher is closer
+  };
+
+  explicit VectorStore(size_t dimension) : VectorStore(dimension, Options()) {}
+
+  VectorStore(size_t dimension, Options options)
+      : dim(dimension), opts(options),
+        codeBytes(dimension * VectorKernels::bytesPerDimension(opts.encoding)),
+        dot(VectorKernels::dot(opts.encoding)),
+        maxLinks(std::max<uint32_t>(2, opts.neighbors)),
+        maxLinks0(2 * maxLinks), levelScale(1.0 / std::log(double(maxLinks))),
+        gen(opts.seed) {
+    if (opts.threads == 0)
+      opts.threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  VectorStore(const VectorStore &) = delete;
+  VectorStore &operator=(const VectorStore &) = delete;
+
+  size_t size() const { return ids.size(); }
+  size_t dimension() const { return dim; }
+  const Options &options() const { return opts; }
+
+  size_t memoryBytes() const {
+    return codes.capacity() + scales.capacity() * sizeof(float) +
+           ids.capacity() * sizeof(uint64_t) + levels.capacity() +
+           (base.capacity() + upper.capacity() + upperSlot.capacity()) *
+               sizeof(uint32_t) +
+           lockCount * sizeof(std::atomic<bool>);
+  }
+
+  /**
+   * @brief Adds every row of an embedding matrix, row i as nodeIds[i].
+   * @return false if the dimension or the ID count does not match the
+   * matrix (reason in *error); nothing is added then.
+   */
+  bool build(const EmbeddingMatrix &matrix,
+             const std::vector<uint64_t> &nodeIds,
+             std::string *error = nullptr) {
+    if (matrix.dimension() != dim)
+      return fail(error, "matrix has " + std::to_string(matrix.dimension()) +
+                             " dimensions, store has " + std::to_string(dim));
+    if (nodeIds.size() != matrix.rows())
+      return fail(error, std::to_string(nodeIds.size()) + " node IDs for " +
+                             std::to_string(matrix.rows()) + " rows");
+    add(matrix.data(), matrix.rows(), nodeIds.data());
+    return true;
+  }
+
+  /**
+   * @brief Inserts count vectors (count x dimension floats) in parallel.
+   */
+  void add(const float *vectors, size_t count, const uint64_t *nodeIds) {
+    if (count == 0)
+      return;
+    const uint32_t first = static_cast<uint32_t>(ids.size());
+    const size_t n = first + count;
+    codes.resize(n * codeBytes);
+    scales.resize(n);
+    ids.insert(ids.end(), nodeIds, nodeIds + count);
+    base.resize(n * (maxLinks0 + 1), 0);
+    if (lockCount < n) {
+      // No insert is running, so every lock is free and can be replaced.
+      lockCount = std::max(n, lockCount * 2);
+      locks.reset(new std::atomic<bool>[lockCount]());
+    }
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t i = 0; i < count; ++i) {
+      int level = static_cast<int>(-std::log(1.0 - unit(gen)) * levelScale);
+      levels.push_back(static_cast<uint8_t>(std::min(level, MAX_LEVEL)));
+      upperSlot.push_back(static_cast<uint32_t>(upper.size() /
+                                                (maxLinks + 1)));
+      upper.resize(upper.size() + levels.back() * (maxLinks + 1), 0);
+    }
+
+    ParallelFor::run(count, opts.threads, [&](size_t i) {
+      const uint32_t node = first + static_cast<uint32_t>(i);
+      scales[node] = encodeInto(vectors + i * dim, codeAt(node), scratch());
+    });
+
+    size_t start = 0;
+    if (entry.load() == NONE) {
+      entry.store(first);
+      topLevel.store(levels[first]);
+      start = 1;
+    }
+    ParallelFor::run(count - start, opts.threads, [&](size_t i) {
+      insert(first + static_cast<uint32_t>(start + i), scratch());
+    });
+  }
+
+  void add(uint64_t nodeId, const float *vector) { add(vector, 1, &nodeId); }
+
+  /**
+   * @brief Approximate top-k for one query, best first.
+   * @param ef Beam width (at least k); 0 uses options().efSearch.
+   */
+  std::vector<Hit> search(const float *query, size_t k, size_t ef = 0) const {
+    std::vector<Hit> hits;
+    if (ids.empty() || k == 0)
+      return hits;
+    Scratch &s = scratch();
+    Query q = encodeQuery(query, s);
+    int top = topLevel.load(std::memory_order_acquire);
+    uint32_t ep = entry.load(std::memory_order_acquire);
+    float epSim = similarity(q, ep);
+    ep = descend<false>(q, ep, epSim, top, 0, s);
+    ef = std::max<size_t>(k, ef ? ef : opts.efSearch);
+    searchLayer<false>(q, ep, epSim, ef, 0, s);
+    hits.reserve(std::min(k, s.best.size()));
+    for (size_t i = 0; i < s.best.size() && i < k; ++i)
+      hits.push_back({ids[s.best[i].node], s.best[i].sim});
+    return hits;
+  }
+
+  /**
+   * @brief search() for count queries (count x dimension floats) on
+   * options().threads workers. out[i] answers query i.
+   */
+  std::vector<std::vector<Hit>> searchBatch(const float *queries, size_t count,
+                                            size_t k, size_t ef = 0) const {
+    std::vector<std::vector<Hit>> out(count);
+    ParallelFor::run(count, opts.threads, [&](size_t i) {
+      out[i] = search(queries + i * dim, k, ef);
+    });
+    return out;
+  }
+
+  /**
+   * @brief Brute-force top-k over the same codes, for measuring recall.
+   */
+  std::vector<Hit> exactSearch(const float *query, size_t k) const {
+    Scratch &s = scratch();
+    Query q = encodeQuery(query, s);
+    std::vector<Candidate> all(ids.size());
+    for (uint32_t v = 0; v < ids.size(); ++v)
+      all[v] = {similarity(q, v), v};
+    k = std::min(k, all.size());
+    std::partial_sort(all.begin(), all.begin() + k, all.end(), Closer());
+    std::vector<Hit> hits;
+    for (size_t i = 0; i < k; ++i)
+      hits.push_back({ids[all[i].node], all[i].sim});
+    return hits;
+  }
+
+private:
+  static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+  static constexpr int MAX_LEVEL = 15;
+
+  struct Candidate {
+    float sim;
+    uint32_t node;
+  };
+
+  // As a heap comparator this keeps the farthest candidate on top; as a
+  // sort comparator it orders best first.
+  struct Closer {
+    bool operator()(const Candidate &a, const Candidate &b) const {
+      return a.sim > b.sim;
+    }
+  };
+  struct Farther {
+    bool operator()(const Candidate &a, const Candidate &b) const {
+      return a.sim < b.sim;
+    }
+  };
+
+  struct Query {
+    const uint8_t *code;
+    float scale;
+  };
+
+  /**
+   * @brief Per-thread search state: epoch-stamped visited marks (as in
+   * VisitMarks), the two beams and the encoded query.
+   */
+  struct Scratch {
+    std::vector<uint32_t> stamp;
+    uint32_t epoch = 0;
+    std::vector<Candidate> frontier; // Max-heap: closest unexpanded first
+    std::vector<Candidate> best;     // Min-heap of the ef closest so far
+    std::vector<Candidate> chosen;
+    std::vector<Candidate> pruned;
+    std::vector<uint32_t> links;
+    std::vector<float> unit;
+    std::vector<uint8_t> query;
+
+    void begin(size_t n) {
+      if (stamp.size() < n)
+        stamp.resize(n, 0);
+      if (++epoch == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        epoch = 1;
+      }
+    }
+    bool visit(uint32_t v) {
+      if (stamp[v] == epoch)
+        return false;
+      stamp[v] = epoch;
+      return true;
+    }
+  };
+
+  size_t dim;
+  Options opts;
+  size_t codeBytes;
+  VectorKernels::Dot dot;
+  uint32_t maxLinks;  // Per upper-level list
+  uint32_t maxLinks0; // Per level-0 list
+  double levelScale;
+  std::mt19937_64 gen;
+
+  std::vector<uint8_t> codes;  // codeBytes per node
+  std::vector<float> scales;   // INT8 scale per node (1 for FLOAT16)
+  std::vector<uint64_t> ids;   // Dense index -> GraphEngine node ID
+  std::vector<uint8_t> levels; // Top level of each node
+  // Level 0: node * (maxLinks0 + 1) -> count, then the links.
+  std::vector<uint32_t> base;
+  // Levels 1..top of a node: slots upperSlot[node] + level - 1, each
+  // (maxLinks + 1) wide.
+  std::vector<uint32_t> upper;
+  std::vector<uint32_t> upperSlot;
+  std::unique_ptr<std::atomic<bool>[]> locks; // Held while a list changes
+  size_t lockCount = 0;
+  std::mutex topMutex; // Held by inserts that raise the top level
+  std::atomic<uint32_t> entry{NONE};
+  std::atomic<int> topLevel{-1};
+
+  static bool fail(std::string *error, const std::string &why) {
+    if (error)
+      *error = why;
+    return false;
+  }
+
+  static Scratch &scratch() {
+    static thread_local Scratch s;
+    return s;
+  }
+
+  uint8_t *codeAt(uint32_t node) { return codes.data() + node * codeBytes; }
+  const uint8_t *codeAt(uint32_t node) const {
+    return codes.data() + node * codeBytes;
+  }
+
+  uint32_t *linksAt(uint32_t node, int level) {
+    return level == 0 ? base.data() + size_t(node) * (maxLinks0 + 1)
+                      : upper.data() + size_t(upperSlot[node] + level - 1) *
+                                           (maxLinks + 1);
+  }
+  const uint32_t *linksAt(uint32_t node, int level) const {
+    return const_cast<VectorStore *>(this)->linksAt(node, level);
+  }
+
+  float similarity(const Query &q, uint32_t v) const {
+    return dot(q.code, codeAt(v), dim) * q.scale * scales[v];
+  }
+
+  float similarity(uint32_t a, uint32_t b) const {
+    return similarity(Query{codeAt(a), scales[a]}, b);
+  }
+
+  float encodeInto(const float *x, uint8_t *out, Scratch &s) const {
+    if (opts.metric == Metric::COSINE) {
+      double norm = 0;
+      for (size_t i = 0; i < dim; ++i)
+        norm += double(x[i]) * x[i];
+      const float inv = norm > 0 ? float(1.0 / std::sqrt(norm)) : 0.0f;
+      s.unit.resize(dim);
+      for (size_t i = 0; i < dim; ++i)
+        s.unit[i] = x[i] * inv;
+      x = s.unit.data();
+    }
+    return VectorKernels::encode(opts.encoding, x, dim, out);
+  }
+
+  Query encodeQuery(const float *query, Scratch &s) const {
+    s.query.resize(codeBytes);
+    float scale = encodeInto(query, s.query.data(), s);
+    return {s.query.data(), scale};
+  }
+
+  void lock(uint32_t node) const {
+    while (locks[node].exchange(true, std::memory_order_acquire))
+      while (locks[node].load(std::memory_order_relaxed))
+        std::this_thread::yield();
+  }
+
+  void unlock(uint32_t node) const {
+    locks[node].store(false, std::memory_order_release);
+  }
+
+  /**
+   * @brief A node's list at level. While inserting (Locked) it is copied
+   * out under the node's lock; once built it is read in place.
+   */
+  template <bool Locked>
+  const uint32_t *neighborsOf(uint32_t node, int level, Scratch &s) const {
+    const uint32_t *list = linksAt(node, level);
+    if (!Locked)
+      return list;
+    lock(node);
+    s.links.assign(list, list + 1 + list[0]);
+    unlock(node);
+    return s.links.data();
+  }
+
+  /**
+   * @brief Greedy walk from ep down to level `to` + 1: at each level, move
+   * to the closest neighbour until none is closer.
+   */
+  template <bool Locked>
+  uint32_t descend(const Query &q, uint32_t ep, float &epSim, int from, int to,
+                   Scratch &s) const {
+    for (int level = from; level > to; --level) {
+      for (bool moved = true; moved;) {
+        moved = false;
+        const uint32_t *list = neighborsOf<Locked>(ep, level, s);
+        for (uint32_t i = 1; i <= list[0]; ++i) {
+          float sim = similarity(q, list[i]);
+          if (sim > epSim) {
+            epSim = sim;
+            ep = list[i];
+            moved = true;
+          }
+        }
+      }
+    }
+    return ep;
+  }
+
+  /**
+   * @brief Beam search of width ef on one level. Leaves the beam in
+   * s.best, sorted best first.
+   */
+  template <bool Locked>
+  void searchLayer(const Query &q, uint32_t ep, float epSim, size_t ef,
+                   int level, Scratch &s) const {
+    s.begin(ids.size());
+    s.visit(ep);
+    s.frontier.assign(1, {epSim, ep});
+    s.best.assign(1, {epSim, ep});
+    while (!s.frontier.empty()) {
+      const Candidate c = s.frontier.front();
+      if (s.best.size() >= ef && c.sim < s.best.front().sim)
+        break;
+      std::pop_heap(s.frontier.begin(), s.frontier.end(), Farther());
+      s.frontier.pop_back();
+      const uint32_t *list = neighborsOf<Locked>(c.node, level, s);
+      const uint32_t count = list[0];
+      for (uint32_t i = 1; i <= count; ++i) {
+        if (i < count)
+          __builtin_prefetch(codeAt(list[i + 1]));
+        const uint32_t v = list[i];
+        if (!s.visit(v))
+          continue;
+        const float sim = similarity(q, v);
+        if (s.best.size() < ef || sim > s.best.front().sim) {
+          s.frontier.push_back({sim, v});
+          std::push_heap(s.frontier.begin(), s.frontier.end(), Farther());
+          s.best.push_back({sim, v});
+          std::push_heap(s.best.begin(), s.best.end(), Closer());
+          if (s.best.size() > ef) {
+            std::pop_heap(s.best.begin(), s.best.end(), Closer());
+            s.best.pop_back();
+          }
+        }
+      }
+    }
+    std::sort(s.best.begin(), s.best.end(), Closer());
+  }
+
+  /**
+   * @brief HNSW neighbour heuristic over candidates sorted best first
+   * (by similarity to the node being linked). Keeps at most m.
+   */
+  void selectNeighbors(std::vector<Candidate> &candidates, size_t m) const {
+    if (candidates.size() <= m)
+      return;
+    size_t kept = 0;
+    for (size_t i = 0; i < candidates.size() && kept < m; ++i) {
+      bool diverse = true;
+      for (size_t j = 0; j < kept && diverse; ++j)
+        diverse = similarity(candidates[i].node, candidates[j].node) <=
+                  candidates[i].sim;
+      if (diverse)
+        candidates[kept++] = candidates[i];
+    }
+    candidates.resize(kept);
+  }
+
+  void insert(uint32_t node, Scratch &s) {
+    const int level = levels[node];
+    std::unique_lock<std::mutex> raising(topMutex, std::defer_lock);
+    if (level > topLevel.load(std::memory_order_acquire))
+      raising.lock();
+    // topLevel is read before entry and written after it, so an entry
+    // point always has every level up to the top level seen here.
+    const int top = topLevel.load(std::memory_order_acquire);
+    uint32_t ep = entry.load(std::memory_order_acquire);
+    const Query q{codeAt(node), scales[node]};
+    float epSim = similarity(q, ep);
+    ep = descend<true>(q, ep, epSim, top, level, s);
+
+    for (int l = std::min(level, top); l >= 0; --l) {
+      searchLayer<true>(q, ep, epSim, opts.efConstruction, l, s);
+      std::vector<Candidate> &chosen = s.chosen;
+      chosen = s.best;
+      ep = chosen.front().node;
+      epSim = chosen.front().sim;
+      selectNeighbors(chosen, maxLinks);
+      lock(node);
+      uint32_t *mine = linksAt(node, l);
+      mine[0] = static_cast<uint32_t>(chosen.size());
+      for (size_t i = 0; i < chosen.size(); ++i)
+        mine[i + 1] = chosen[i].node;
+      unlock(node);
+      for (const Candidate &c : chosen)
+        link(c.node, node, l, s);
+    }
+
+    if (level > top) {
+      entry.store(node, std::memory_order_release);
+      topLevel.store(level, std::memory_order_release);
+    }
+  }
+
+  /**
+   * @brief Adds the back link from -> to, re-running the heuristic over
+   * from's list when it is full.
+   */
+  void link(uint32_t from, uint32_t to, int level, Scratch &s) {
+    const uint32_t cap = level ? maxLinks : maxLinks0;
+    lock(from);
+    uint32_t *list = linksAt(from, level);
+    if (list[0] < cap) {
+      list[++list[0]] = to;
+      unlock(from);
+      return;
+    }
+    s.pruned.clear();
+    for (uint32_t i = 1; i <= list[0]; ++i)
+      s.pruned.push_back({similarity(from, list[i]), list[i]});
+    s.pruned.push_back({similarity(from, to), to});
+    std::sort(s.pruned.begin(), s.pruned.end(), Closer());
+    selectNeighbors(s.pruned, cap);
+    list[0] = static_cast<uint32_t>(s.pruned.size());
+    for (size_t i = 0; i < s.pruned.size(); ++i)
+      list[i + 1] = s.pruned[i].node;
+    unlock(from);
+  }
+};
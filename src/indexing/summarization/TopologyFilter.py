@@ -1,5 +1,6 @@
 import pandas as pd
 import igraph as ig
+import hashlib
 import json
 import os
 from collections import defaultdict
@@ -17,9 +18,14 @@ class TopologyFilter:
         self.top_k = top_k
         print(f"Topology Filter initialized (Top-K per community: {top_k})")
 
-    def extract_hubs(self, projection_path, community_map_path):
+    def extract_hubs(self, projection_path, community_map_path,
+                     previous_hubs=None, touched_communities=None):
         """
         Rank nodes within each community by their local PageRank.
+
+        With previous_hubs and touched_communities (LeidenEngine's
+        community delta), only the touched communities are ranked again;
+        the others reuse their previous hubs.
         """
         print(f"Loading projection from {projection_path} and community map from {community_map_path}...")
         
@@ -33,22 +39,34 @@ class TopologyFilter:
         for node_id, data in community_map.items():
             comm_to_nodes[data['micro_community']].append(node_id)
 
-        # 3. Process each community
+        # 3. Assign every intra-community edge to its community in one pass
+        node_comm = {node_id: data['micro_community'] for node_id, data in community_map.items()}
+        src_comm = edges_df['source'].astype(str).map(node_comm)
+        tgt_comm = edges_df['target'].astype(str).map(node_comm)
+        intra = edges_df[src_comm.notna() & (src_comm == tgt_comm)]
+        edges_by_comm = dict(list(intra.groupby(src_comm[intra.index])))
+
+        # 4. Process each community
         community_hubs = {}
+        reuse = previous_hubs is not None and touched_communities is not None
+        touched = {str(c) for c in touched_communities} if reuse else set()
+        reused = 0
 
         for comm_id, nodes in comm_to_nodes.items():
+            if reuse and str(comm_id) not in touched and str(comm_id) in previous_hubs:
+                community_hubs[str(comm_id)] = previous_hubs[str(comm_id)]
+                reused += 1
+                continue
+
             if len(nodes) < 2:
                 # Minimum nodes to form a meaningful graph
                 community_hubs[str(comm_id)] = [{"node_id": n, "rank": 1, "score": 1.0} for n in nodes]
                 continue
 
-            # Filter edges belonging solely to this community
-            comm_edges_df = edges_df[
-                (edges_df['source'].astype(str).isin(nodes)) & 
-                (edges_df['target'].astype(str).isin(nodes))
-            ]
+            # Edges belonging solely to this community
+            comm_edges_df = edges_by_comm.get(comm_id)
 
-            if comm_edges_df.empty:
+            if comm_edges_df is None or comm_edges_df.empty:
                 community_hubs[str(comm_id)] = [{"node_id": n, "rank": 1, "score": 1.0} for n in nodes[:self.top_k]]
                 continue
 
@@ -77,6 +95,8 @@ class TopologyFilter:
 
             community_hubs[str(comm_id)] = top_hubs
 
+        if reuse:
+            print(f"Re-ranked {len(community_hubs) - reused} touched communities, reused {reused}.")
         return community_hubs
 
     def save_hubs(self, hubs, output_path):
@@ -97,7 +117,21 @@ if __name__ == "__main__":
     cmap_file = os.path.join(base_dir, "community_map.json")
     
     if os.path.exists(proj_file) and os.path.exists(cmap_file):
-        hubs = filter_engine.extract_hubs(proj_file, cmap_file)
+        # After an incremental clustering run, only touched communities are re-ranked
+        hubs_file = "data/processed/community_hubs.json"
+        delta_file = os.path.join(base_dir, "community_delta.json")
+        current = False  # The delta must describe this community map
+        if os.path.exists(hubs_file) and os.path.exists(delta_file):
+            with open(hubs_file, 'r') as f:
+                previous_hubs = json.load(f)
+            with open(delta_file, 'r') as f:
+                delta = json.load(f)
+            with open(cmap_file, 'rb') as f:
+                current = delta.get("map_sha256") == hashlib.sha256(f.read()).hexdigest()
+        if current:
+            hubs = filter_engine.extract_hubs(proj_file, cmap_file, previous_hubs, delta["micro_community"])
+        else:
+            hubs = filter_engine.extract_hubs(proj_file, cmap_file)
         
         print("\n--- Hub Extraction Sample ---")
         for comm_id, nodes in list(hubs.items())[:2]:
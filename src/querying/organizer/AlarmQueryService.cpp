@@ -0,0 +1,183 @@
+#include "AlarmQueryService.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Layered causal topology: root causes -> protocol events ->
+ * protocol states -> the interfaces, neighbors and error codes that show
+ * up in alarms. Every node has two causal parents in the layer above.
+ */
+static void buildTopology(ConcurrentGraph &graph, size_t interfaces,
+                          uint64_t seed) {
+  std::mt19937_64 gen(seed);
+  auto confidence = [&gen] { return 0.5f + (gen() % 500) / 1000.0f; };
+  uint64_t edgeId = 0;
+  auto layer = [&](const char *label, const std::string &prefix, size_t n) {
+    std::vector<uint64_t> ids;
+    for (size_t i = 0; i < n; ++i)
+      ids.push_back(graph.resolveNode(label, prefix + std::to_string(i)));
+    return ids;
+  };
+  auto link = [&](const std::vector<uint64_t> &parents,
+                  const std::vector<uint64_t> &children) {
+    for (uint64_t child : children)
+      for (int p = 0; p < 2; ++p)
+        graph.addEdge(++edgeId, parents[gen() % parents.size()], child,
+                      "CAUSES", confidence());
+  };
+
+  std::vector<uint64_t> causes = layer("PHYSICAL_EVENT", "FIBER_CUT_", 500);
+  auto config = layer("CONFIG_ERROR", "MTU_MISMATCH_", 500);
+  causes.insert(causes.end(), config.begin(), config.end());
+  auto events = layer("PROTOCOL_EVENT", "LINK_DOWN_", interfaces / 4);
+  auto states = layer("PROTOCOL_STATE", "ADJ_LOSS_", interfaces / 4);
+  std::vector<uint64_t> symptoms;
+  for (size_t i = 0; i < interfaces; ++i)
+    symptoms.push_back(graph.resolveNode(
+        "INTERFACE", "GigabitEthernet0/" + std::to_string(i)));
+  for (size_t i = 0; i < interfaces / 4; ++i)
+    symptoms.push_back(graph.resolveNode(
+        "IP_ADDRESS", "10.0." + std::to_string(i / 250) + "." +
+                          std::to_string(i % 250 + 1)));
+  for (const char *code : {"%LINK-3-UPDOWN", "%BGP-5-ADJCHANGE",
+                          "%OSPF-5-ADJCHG", "%LINEPROTO-5-UPDOWN"})
+    symptoms.push_back(graph.resolveNode("ERROR_CODE", code));
+  link(causes, events);
+  link(events, states);
+  link(states, symptoms);
+  graph.publish();
+}
+
+static std::string makeAlarm(std::mt19937_64 &gen, size_t interfaces) {
+  size_t i = gen() % interfaces;
+  switch (gen() % 3) {
+  case 0:
+    return "%LINK-3-UPDOWN: Interface GigabitEthernet0/" + std::to_string(i) +
+           ", changed state to down";
+  case 1:
+    i %= interfaces / 4;
+    return "%BGP-5-ADJCHANGE: neighbor 10.0." + std::to_string(i / 250) + "." +
+           std::to_string(i % 250 + 1) + " Down BGP Notification sent";
+  default:
+    return "%LINEPROTO-5-UPDOWN: Line protocol on Interface "
+           "GigabitEthernet0/" +
+           std::to_string(i) + ", changed state to down";
+  }
+}
+
+static bool sameExplanations(const AlarmQueryService::AlarmResult &a,
+                             const AlarmQueryService::AlarmResult &b) {
+  if (a.symptomIds != b.symptomIds ||
+      a.explanations.size() != b.explanations.size())
+    return false;
+  for (size_t i = 0; i < a.explanations.size(); ++i)
+    if (a.explanations[i].chain.nodeIds != b.explanations[i].chain.nodeIds ||
+        a.explanations[i].chain.credibility !=
+            b.explanations[i].chain.credibility)
+      return false;
+  return true;
+}
+
+/**
+ * @brief Closed-loop clients: each sends a small request, waits for the
+ * answer, and repeats.
+ */
+static void runLoad(ConcurrentGraph &graph,
+                    AlarmQueryService::Options options, const char *name,
+                    size_t clients, size_t requestsPerClient,
+                    size_t interfaces) {
+  AlarmQueryService service(graph, options);
+  std::vector<LatencyHistogram> seen(clients);
+  std::atomic<size_t> explained{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t c = 0; c < clients; ++c)
+    threads.emplace_back([&, c] {
+      std::mt19937_64 gen(100 + c);
+      for (size_t r = 0; r < requestsPerClient; ++r) {
+        std::vector<std::string> alarms;
+        for (size_t a = 1 + gen() % 4; a > 0; --a)
+          alarms.push_back(makeAlarm(gen, interfaces));
+        auto sent = std::chrono::steady_clock::now();
+        auto pending = service.submit(std::move(alarms));
+        if (!pending)
+          continue;
+        AlarmQueryService::BatchResult result = pending->get();
+        seen[c].record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - sent)
+                           .count());
+        for (const auto &alarm : result.alarms)
+          explained += !alarm.explanations.empty();
+      }
+    });
+  for (std::thread &t : threads)
+    t.join();
+  std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+  service.stop();
+
+  AlarmQueryService::Metrics m = service.metrics();
+  LatencyHistogram client;
+  for (const LatencyHistogram &h : seen)
+    client.merge(h);
+  std::printf("%-10s %7.0f req/s | p50 %6.3f ms p99 %6.3f ms | "
+              "%.1f alarms/batch, max queue %zu, %zu rejected, "
+              "%zu alarms explained\n",
+              name, m.requests / wall.count(), client.percentileNs(0.5) / 1e6,
+              client.percentileNs(0.99) / 1e6,
+              m.batches ? double(m.alarms) / m.batches : 0.0, m.maxQueueDepth,
+              static_cast<size_t>(m.rejected), explained.load());
+}
+
+int main() {
+  const size_t interfaces = 40000;
+  ConcurrentGraph graph;
+  buildTopology(graph, interfaces, 42);
+  auto view = graph.pin();
+  std::cout << "--- Alarm Query Service ---" << std::endl;
+  std::cout << "Graph: " << view.snapshot().csr->nodeCount() << " nodes, "
+            << view.snapshot().csr->edgeCount() << " edges" << std::endl;
+
+  AlarmQueryService service(graph);
+  std::string alarm = "%LINK-3-UPDOWN: Interface GigabitEthernet0/17, "
+                      "changed state to down";
+  auto answer = service.submit({alarm});
+  AlarmQueryService::BatchResult result = answer->get();
+  std::cout << "\nAlarm: " << alarm << std::endl;
+  for (const auto &e : result.alarms[0].explanations) {
+    std::cout << "  (credibility " << e.chain.credibility << ") ";
+    for (size_t i = 0; i < e.chain.nodeIds.size(); ++i)
+      std::cout << (i ? " -> " : "")
+                << view.canonicalNameOf(e.chain.nodeIds[i]);
+    std::cout << std::endl;
+  }
+
+  // A micro-batch must answer each alarm exactly as a lone request does.
+  std::mt19937_64 gen(7);
+  std::vector<std::string> storm;
+  for (int i = 0; i < 200; ++i)
+    storm.push_back(makeAlarm(gen, interfaces));
+  AlarmQueryService::BatchResult together = service.submit(storm)->get();
+  size_t mismatches = 0;
+  for (size_t i = 0; i < storm.size(); ++i) {
+    AlarmQueryService::BatchResult alone = service.submit({storm[i]})->get();
+    mismatches += !sameExplanations(alone.alarms[0], together.alarms[i]);
+  }
+  std::cout << "\nBatched vs single-alarm answers: " << mismatches
+            << " mismatches over " << storm.size() << " alarms\n"
+            << std::endl;
+  service.stop();
+
+  AlarmQueryService::Options unbatched;
+  unbatched.maxBatchAlarms = 1;
+  unbatched.maxWait = std::chrono::microseconds(0);
+  runLoad(graph, unbatched, "unbatched", 8, 1000, interfaces);
+  runLoad(graph, AlarmQueryService::Options(), "batched", 8, 1000,
+          interfaces);
+  return 0;
+}
@@ -0,0 +1,417 @@
+#pragma once
+
+#include "../../indexing/data-preprocessing/Instrumentation.hpp"
+#include "../../indexing/data-preprocessing/LatencyHistogram.hpp"
+#include "../../indexing/extraction/DeterministicExtractor.hpp"
+#include "../../indexing/graph-engine/ConcurrentGraph.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class AlarmQueryService
+ * @brief Long-running RCA service: alarm text in, ranked causal chains out.
+ *
+ * REQUEST PATH:
+ * - submit() queues a batch of raw alarm lines and returns a future.
+ * - A worker takes the oldest request and lingers up to maxWait for more,
+ *   so alarms from concurrent callers (an alarm storm) form one
+ *   micro-batch of up to maxBatchAlarms lines.
+ * - Every line goes through DeterministicExtractor; each entity maps to
+ *   the node (entityTypeName(type), value) through the graph's registry.
+ *   These are the symptoms. Symptoms repeated across the batch are
+ *   searched once.
+ * - One bit-parallel reverse BFS per 64 distinct symptoms walks
+ *   edgeLabels edges back up to maxDepth hops. It finds the nearest
+ *   causesPerSymptom ancestors whose label is in causeLabels, for every
+ *   symptom in that one pass.
+ * - Each (cause, symptom) pair is ranked with RankedPathSearch (Yen,
+ *   -log credibility). An alarm gets the pathsPerAlarm most credible
+ *   chains over all of its symptoms.
+ *
+ * All of a batch runs against one pinned ConcurrentGraph snapshot, so
+ * ingestion can publish meanwhile and every answer is self-consistent.
+ *
+ * TRADE-OFF ANALYSIS:
+ * - PRO: Per-request cost falls as load rises: the BFS and the pair
+ *   rankings are shared by every alarm naming the same entities.
+ * - CON: A lone request pays up to maxWait of lingering. Keep it well
+ *   under the latency target (the default is 0.2 ms against a 5 ms p99).
+ * - CON: Causes further than maxDepth hops, or beyond the nearest
+ *   causesPerSymptom, are not considered.
+ */
+class AlarmQueryService {
+public:
+  struct Options {
+    size_t workers = 2;
+    size_t maxBatchAlarms = 256; // Alarm lines per micro-batch
+    std::chrono::microseconds maxWait{200};
+    size_t queueCapacity = 4096; // Pending requests before submit() refuses
+    std::vector<std::string> causeLabels = {"PHYSICAL_EVENT", "CONFIG_ERROR"};
+    std::vector<std::string> edgeLabels = {"CAUSES"}; // Empty = all edges
+    uint32_t maxDepth = 6;
+    size_t causesPerSymptom = 4;
+    size_t pathsPerAlarm = 3;
+  };
+
+  struct Explanation {
+    uint64_t symptomId = 0;
+    uint64_t rootCauseId = 0;
+    RankedPathSearch::CredibleChain chain; // Root cause first
+  };
+
+  struct AlarmResult {
+    std::vector<uint64_t> symptomIds;      // Graph nodes named by the alarm
+    std::vector<Explanation> explanations; // Most credible first
+  };
+
+  struct BatchResult {
+    uint64_t snapshotVersion = 0;
+    std::vector<AlarmResult> alarms; // Same order as submitted
+  };
+
+  struct Metrics {
+    size_t queueDepth = 0; // Requests waiting now
+    size_t maxQueueDepth = 0;
+    uint64_t requests = 0; // Completed
+    uint64_t rejected = 0;
+    uint64_t alarms = 0;
+    uint64_t batches = 0;
+    LatencyHistogram queueWait; // submit() to start of processing
+    LatencyHistogram latency;   // submit() to result
+  };
+
+  explicit AlarmQueryService(ConcurrentGraph &graph)
+      : AlarmQueryService(graph, Options()) {}
+
+  AlarmQueryService(ConcurrentGraph &graph, Options options)
+      : graph(graph), opts(std::move(options)) {
+    opts.workers = std::max<size_t>(1, opts.workers);
+    opts.maxBatchAlarms = std::max<size_t>(1, opts.maxBatchAlarms);
+    for (size_t w = 0; w < opts.workers; ++w)
+      workers.emplace_back([this] { serve(); });
+  }
+
+  ~AlarmQueryService() { stop(); }
+
+  AlarmQueryService(const AlarmQueryService &) = delete;
+  AlarmQueryService &operator=(const AlarmQueryService &) = delete;
+
+  /**
+   * @brief Queues alarm lines for explanation.
+   * @return The pending result, or nullopt if the queue is full or the
+   * service is stopping (the caller should shed or retry).
+   */
+  std::optional<std::future<BatchResult>>
+  submit(std::vector<std::string> alarms) {
+    Request r;
+    r.alarms = std::move(alarms);
+    r.enqueued = Clock::now();
+    std::future<BatchResult> result = r.promise.get_future();
+    bool full;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (stopping || queue.size() >= opts.queueCapacity) {
+        ++stats.rejected;
+        return std::nullopt;
+      }
+      queuedAlarms += r.alarms.size();
+      queue.push_back(std::move(r));
+      stats.maxQueueDepth = std::max(stats.maxQueueDepth, queue.size());
+      full = queuedAlarms >= opts.maxBatchAlarms;
+    }
+    if (full)
+      ready.notify_all(); // Cut lingering short
+    else
+      ready.notify_one();
+    return result;
+  }
+
+  /**
+   * @brief Finishes every queued request, then joins the workers.
+   */
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    ready.notify_all();
+    for (std::thread &t : workers)
+      t.join();
+    workers.clear();
+  }
+
+  Metrics metrics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Metrics m = stats;
+    m.queueDepth = queue.size();
+    return m;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    std::vector<std::string> alarms;
+    std::promise<BatchResult> promise;
+    Clock::time_point enqueued;
+  };
+
+  /**
+   * @brief Per-worker traversal state, reused across batches.
+   */
+  struct Scratch {
+    DeterministicExtractor extractor;
+    std::vector<EntitySpan> spans;
+    RankedPathSearch ranked;
+    std::vector<uint32_t> symptomSlot; // Dense node -> slot + 1, or 0
+    std::vector<uint32_t> symptoms;    // Slot -> dense node
+    std::vector<uint64_t> seen;        // Per dense node, symptom bits
+    std::vector<uint64_t> visit;
+    std::vector<uint64_t> visitNext;
+    std::vector<uint32_t> touched; // Nodes with nonzero seen
+    std::vector<uint32_t> frontier;
+    std::vector<uint32_t> next;
+    std::vector<std::pair<uint32_t, uint32_t>> found; // (slot, cause)
+    std::vector<std::vector<uint32_t>> causes;        // Per slot
+    std::vector<std::vector<Explanation>> explained;  // Per slot
+    std::vector<uint8_t> isCause;                     // Per label ID
+  };
+
+  ConcurrentGraph &graph;
+  Options opts;
+  std::vector<std::thread> workers;
+
+  mutable std::mutex mutex; // Guards everything below
+  std::condition_variable ready;
+  std::deque<Request> queue;
+  size_t queuedAlarms = 0;
+  bool stopping = false;
+  Metrics stats;
+
+  static uint64_t nanosBetween(Clock::time_point a, Clock::time_point b) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count());
+  }
+
+  void serve() {
+    Scratch scratch;
+    std::vector<Request> batch;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty())
+          return; // Stopping, and drained
+        // Linger for company, but never past the oldest request's deadline.
+        auto deadline = queue.front().enqueued + opts.maxWait;
+        while (!stopping && !queue.empty() &&
+               queuedAlarms < opts.maxBatchAlarms &&
+               Clock::now() < deadline)
+          ready.wait_until(lock, deadline);
+        if (queue.empty())
+          continue; // Another worker took it
+        size_t alarms = 0;
+        do {
+          alarms += queue.front().alarms.size();
+          batch.push_back(std::move(queue.front()));
+          queue.pop_front();
+        } while (!queue.empty() &&
+                 alarms + queue.front().alarms.size() <= opts.maxBatchAlarms);
+        queuedAlarms -= alarms;
+      }
+
+      auto started = Clock::now();
+      std::vector<BatchResult> results = explain(scratch, batch);
+      auto finished = Clock::now();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.batches++;
+        for (const Request &r : batch) {
+          stats.requests++;
+          stats.alarms += r.alarms.size();
+          stats.queueWait.record(nanosBetween(r.enqueued, started));
+          stats.latency.record(nanosBetween(r.enqueued, finished));
+        }
+      }
+      for (size_t i = 0; i < batch.size(); ++i)
+        batch[i].promise.set_value(std::move(results[i]));
+      batch.clear();
+    }
+  }
+
+  std::vector<BatchResult> explain(Scratch &s, std::vector<Request> &batch) {
+    RCA_SPAN("AlarmQueryService::explain");
+    ConcurrentGraph::ReadView view = graph.pin();
+    const GraphSnapshot &snap = view.snapshot();
+    const CsrGraph &g = *snap.csr;
+    const uint32_t n = static_cast<uint32_t>(g.nodeCount());
+    auto filter = RankedPathSearch::makeFilter(g, opts.edgeLabels);
+
+    s.isCause.assign(snap.directory->labelCount(), 0);
+    for (uint32_t l = 0; l < s.isCause.size(); ++l)
+      for (const std::string &label : opts.causeLabels)
+        if (snap.directory->labelName(l) == label)
+          s.isCause[l] = 1;
+
+    // Map every alarm line to its distinct symptom nodes.
+    if (s.symptomSlot.size() < n)
+      s.symptomSlot.resize(n, 0);
+    s.symptoms.clear();
+    std::vector<BatchResult> results(batch.size());
+    std::string name;
+    std::vector<std::vector<uint32_t>> alarmSlots;
+    for (size_t r = 0; r < batch.size(); ++r) {
+      results[r].snapshotVersion = snap.version;
+      results[r].alarms.resize(batch[r].alarms.size());
+      for (size_t a = 0; a < batch[r].alarms.size(); ++a) {
+        alarmSlots.emplace_back();
+        s.spans.clear();
+        s.extractor.extractSpans(batch[r].alarms[a], s.spans);
+        for (const EntitySpan &span : s.spans) {
+          name.assign(span.value);
+          uint64_t id;
+          if (!graph.findNode(entityTypeName(span.type), name, id) ||
+              !snap.hasNode(id))
+            continue;
+          uint32_t idx = g.indexOfNode(id);
+          if (!s.symptomSlot[idx]) {
+            s.symptoms.push_back(idx);
+            s.symptomSlot[idx] = static_cast<uint32_t>(s.symptoms.size());
+          }
+          uint32_t slot = s.symptomSlot[idx] - 1;
+          auto &mine = alarmSlots.back();
+          if (std::find(mine.begin(), mine.end(), slot) == mine.end()) {
+            mine.push_back(slot);
+            results[r].alarms[a].symptomIds.push_back(id);
+          }
+        }
+      }
+    }
+
+    for (uint32_t idx : s.symptoms)
+      s.symptomSlot[idx] = 0;
+
+    s.causes.assign(s.symptoms.size(), {});
+    for (size_t first = 0; first < s.symptoms.size(); first += 64)
+      findCauses(s, g, *snap.directory, filter, first);
+
+    // Rank each (cause, symptom) pair once for the whole batch.
+    s.explained.assign(s.symptoms.size(), {});
+    for (size_t slot = 0; slot < s.symptoms.size(); ++slot) {
+      for (uint32_t cause : s.causes[slot]) {
+        auto paths = s.ranked.topK(g, *snap.weights, cause, s.symptoms[slot],
+                                   opts.pathsPerAlarm, filter);
+        for (const auto &p : paths)
+          s.explained[slot].push_back({g.nodeIdAt(s.symptoms[slot]),
+                                       g.nodeIdAt(cause),
+                                       RankedPathSearch::toChain(g, p)});
+      }
+    }
+
+    size_t k = 0;
+    for (BatchResult &result : results)
+      for (AlarmResult &alarm : result.alarms) {
+        for (uint32_t slot : alarmSlots[k++])
+          alarm.explanations.insert(alarm.explanations.end(),
+                                    s.explained[slot].begin(),
+                                    s.explained[slot].end());
+        std::stable_sort(alarm.explanations.begin(), alarm.explanations.end(),
+                         [](const Explanation &a, const Explanation &b) {
+                           return a.chain.credibility > b.chain.credibility;
+                         });
+        if (alarm.explanations.size() > opts.pathsPerAlarm)
+          alarm.explanations.resize(opts.pathsPerAlarm);
+      }
+    return results;
+  }
+
+  /**
+   * @brief Multi-source BFS over in-edges from symptoms [first, first+64),
+   * one bit per symptom. A node is expanded once per level however many
+   * symptoms reach it. Fills s.causes with the nearest cause-labelled
+   * ancestors; ties at equal depth go to the lower dense index, so the
+   * choice does not depend on what else is in the batch.
+   */
+  void findCauses(Scratch &s, const CsrGraph &g, const NodeDirectory &dir,
+                  const RankedPathSearch::LabelFilter &filter, size_t first) {
+    const size_t n = g.nodeCount();
+    if (s.seen.size() < n) {
+      s.seen.resize(n, 0);
+      s.visit.resize(n, 0);
+      s.visitNext.resize(n, 0);
+    }
+    const size_t last = std::min(s.symptoms.size(), first + 64);
+    size_t open = last - first; // Symptoms still short of causes
+    s.frontier.clear();
+    for (size_t slot = first; slot < last; ++slot) {
+      uint32_t v = s.symptoms[slot];
+      uint64_t bit = uint64_t(1) << (slot - first);
+      s.seen[v] |= bit;
+      s.visit[v] |= bit;
+      s.frontier.push_back(v);
+      s.touched.push_back(v);
+    }
+
+    for (uint32_t depth = 1;
+         depth <= opts.maxDepth && open > 0 && !s.frontier.empty(); ++depth) {
+      s.next.clear();
+      s.found.clear();
+      for (uint32_t v : s.frontier) {
+        uint64_t bits = s.visit[v];
+        s.visit[v] = 0;
+        for (uint64_t r = g.inBegin(v); r < g.inEnd(v); ++r) {
+          if (!filter.admits(g.edgeLabelAt(g.inEdgePosAt(r))))
+            continue;
+          uint32_t u = g.inNeighborAt(r);
+          uint64_t fresh = bits & ~s.seen[u];
+          if (!fresh)
+            continue;
+          if (!s.seen[u])
+            s.touched.push_back(u);
+          if (!s.visitNext[u])
+            s.next.push_back(u);
+          s.seen[u] |= fresh;
+          s.visitNext[u] |= fresh;
+        }
+      }
+      for (uint32_t u : s.next) {
+        uint64_t bits = s.visitNext[u];
+        if (!s.isCause[dir.labelIdAt(u)])
+          continue;
+        for (; bits; bits &= bits - 1)
+          s.found.push_back(
+              {static_cast<uint32_t>(first + __builtin_ctzll(bits)), u});
+      }
+      std::sort(s.found.begin(), s.found.end());
+      for (const auto &[slot, cause] : s.found) {
+        auto &mine = s.causes[slot];
+        if (mine.size() < opts.causesPerSymptom) {
+          mine.push_back(cause);
+          if (mine.size() == opts.causesPerSymptom)
+            open--;
+        }
+      }
+      for (uint32_t u : s.next) {
+        s.visit[u] = s.visitNext[u];
+        s.visitNext[u] = 0;
+      }
+      s.frontier.swap(s.next);
+    }
+
+    for (uint32_t v : s.frontier)
+      s.visit[v] = 0;
+    for (uint32_t v : s.touched)
+      s.seen[v] = 0;
+    s.touched.clear();
+  }
+};